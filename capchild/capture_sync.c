@@ -421,6 +421,10 @@ sync_pipe_start(capture_options *capture_opts, capture_session *cap_session, voi
         argv = sync_pipe_add_arg(argv, &argc, "--capture-comment");
         argv = sync_pipe_add_arg(argv, &argc, capture_opts->capture_comment);
     }
+    if (capture_opts->shm_ring_file) {
+        argv = sync_pipe_add_arg(argv, &argc, "--shm-ring");
+        argv = sync_pipe_add_arg(argv, &argc, capture_opts->shm_ring_file);
+    }
 
     if (capture_opts->multi_files_on) {
         if (capture_opts->has_autostop_filesize) {
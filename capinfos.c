@@ -817,7 +817,8 @@ process_cap_file(wtap *wth, const char *filename)
   int                   err;
   gchar                *err_info;
   gint64                size;
-  gint64                data_offset;
+  wtap_batch           *batch;
+  wtap_batch_rec       *rec;
 
   guint32               packet = 0;
   gint64                bytes  = 0;
@@ -839,8 +840,9 @@ process_cap_file(wtap *wth, const char *filename)
   cf_info.encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
 
   /* Tally up data that we need to parse through the file to find */
-  while (wtap_read(wth, &err, &err_info, &data_offset))  {
-    phdr = wtap_phdr(wth);
+  batch = wtap_batch_new(256);
+  while ((rec = wtap_batch_next(wth, batch, &err, &err_info)) != NULL)  {
+    phdr = &rec->phdr;
     if (phdr->presence_flags & WTAP_HAS_TS) {
       prev_time = cur_time;
       cur_time = nstime_to_sec(&phdr->ts);
@@ -890,6 +892,7 @@ process_cap_file(wtap *wth, const char *filename)
     }
 
   } /* while */
+  wtap_batch_free(batch);
 
   if (err != 0) {
     fprintf(stderr,
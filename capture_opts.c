@@ -120,6 +120,7 @@ capture_opts_init(capture_options *capture_opts)
   capture_opts->has_autostop_duration           = FALSE;
   capture_opts->autostop_duration               = 60;               /* 1 min */
   capture_opts->capture_comment                 = NULL;
+  capture_opts->shm_ring_file                   = NULL;
 
   capture_opts->output_to_pipe                  = FALSE;
   capture_opts->capture_child                   = FALSE;
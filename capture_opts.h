@@ -313,6 +313,9 @@ typedef struct capture_options_tag {
     gchar *capture_comment;         /** capture comment to write to the
                                         output file */
 
+    gchar *shm_ring_file;           /**< shared-memory ring to also hand
+                                         the packets over in, if any */
+
     /* internally used (don't touch from outside) */
     gboolean output_to_pipe;        /**< save_file is a pipe (named or stdout) */
     gboolean capture_child;         /**< hidden option: Wireshark child mode */
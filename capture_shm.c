@@ -0,0 +1,337 @@
+/* capture_shm.c
+ * Shared-memory ring for handing captured packets from dumpcap to
+ * the process that's dissecting them
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <config.h>
+
+#include <string.h>
+#include <errno.h>
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include <glib.h>
+
+#include <wsutil/file_util.h>
+#include <wsutil/tempfile.h>
+
+#include "capture_shm.h"
+
+#define CAPTURE_SHM_MAGIC   0x57534852  /* "WSHR" */
+#define CAPTURE_SHM_PAD     0xFFFFFFFF  /* interface_id of a padding record */
+
+/* Records are aligned on 8-byte boundaries */
+#define CAPTURE_SHM_ALIGN(n) (((n) + 7) & ~7U)
+
+/*
+ * Layout of the start of the shared file; the data area follows it,
+ * at offset CAPTURE_SHM_DATA_OFFSET.
+ *
+ * "head" and "tail" are the total number of bytes ever put into and
+ * taken out of the data area, modulo 2^32; the data area's size is a
+ * power of 2, so they wrap around along with it.  "head" is only
+ * written by the producer and "tail" only by the consumer.
+ */
+typedef struct {
+    guint32        magic;
+    guint32        size;        /* size of the data area */
+    volatile gint  head;
+    volatile gint  tail;
+    volatile gint  abandoned;   /* producer has stopped using the ring */
+    volatile gint  flushed;     /* the capture file has every packet put into the ring */
+} capture_shm_header;
+
+#define CAPTURE_SHM_DATA_OFFSET 64
+
+struct capture_shm_ring {
+    capture_shm_header *hdr;
+    guint8             *data;
+    gsize               map_len;
+    gchar              *path;       /* set for the creator only */
+    guint32             pending;    /* length of the record last gotten */
+};
+
+#ifndef _WIN32
+
+static capture_shm_ring *
+capture_shm_map(int fd, gsize map_len, int *err)
+{
+    capture_shm_ring *ring;
+    void *map;
+
+    map = mmap(NULL, map_len, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        *err = errno;
+        return NULL;
+    }
+
+    ring = g_new0(capture_shm_ring, 1);
+    ring->hdr = (capture_shm_header *)map;
+    ring->data = (guint8 *)map + CAPTURE_SHM_DATA_OFFSET;
+    ring->map_len = map_len;
+    return ring;
+}
+
+capture_shm_ring *
+capture_shm_create(gchar **path, guint32 size, int *err)
+{
+    capture_shm_ring *ring;
+    char *tmp_path;
+    guint32 data_size;
+    int fd;
+
+    /* Round the size up to a power of 2 */
+    for (data_size = 4096; data_size < size && data_size < 0x40000000; data_size <<= 1)
+        ;
+
+    fd = create_tempfile(&tmp_path, "wireshark_shm");
+    if (fd == -1) {
+        *err = errno;
+        return NULL;
+    }
+    if (ftruncate(fd, CAPTURE_SHM_DATA_OFFSET + data_size) == -1) {
+        *err = errno;
+        ws_close(fd);
+        ws_unlink(tmp_path);
+        return NULL;
+    }
+
+    ring = capture_shm_map(fd, CAPTURE_SHM_DATA_OFFSET + data_size, err);
+    ws_close(fd);
+    if (ring == NULL) {
+        ws_unlink(tmp_path);
+        return NULL;
+    }
+
+    ring->hdr->size = data_size;
+    ring->hdr->head = 0;
+    ring->hdr->tail = 0;
+    ring->hdr->abandoned = 0;
+    ring->hdr->flushed = 0;
+    ring->hdr->magic = CAPTURE_SHM_MAGIC;
+
+    /* create_tempfile() hands us a static buffer */
+    ring->path = g_strdup(tmp_path);
+    *path = g_strdup(tmp_path);
+    return ring;
+}
+
+capture_shm_ring *
+capture_shm_attach(const char *path, int *err)
+{
+    capture_shm_ring *ring;
+    ws_statb64 statb;
+    int flags = O_RDWR;
+    int fd;
+
+#ifdef O_NOFOLLOW
+    flags |= O_NOFOLLOW;
+#endif
+    fd = ws_open(path, flags, 0);
+    if (fd == -1) {
+        *err = errno;
+        return NULL;
+    }
+
+    /*
+     * dumpcap may be running with elevated privileges; only use a
+     * plain file owned by the user who ran us, and only if it looks
+     * like a ring.
+     */
+    if (ws_fstat64(fd, &statb) == -1) {
+        *err = errno;
+        ws_close(fd);
+        return NULL;
+    }
+    if (!S_ISREG(statb.st_mode) || statb.st_uid != getuid() ||
+        statb.st_size < CAPTURE_SHM_DATA_OFFSET + 4096) {
+        *err = EINVAL;
+        ws_close(fd);
+        return NULL;
+    }
+
+    ring = capture_shm_map(fd, (gsize)statb.st_size, err);
+    ws_close(fd);
+    if (ring == NULL)
+        return NULL;
+
+    if (ring->hdr->magic != CAPTURE_SHM_MAGIC ||
+        ring->hdr->size == 0 || (ring->hdr->size & (ring->hdr->size - 1)) != 0 ||
+        CAPTURE_SHM_DATA_OFFSET + (gint64)ring->hdr->size > statb.st_size) {
+        *err = EINVAL;
+        capture_shm_close(ring);
+        return NULL;
+    }
+    return ring;
+}
+
+void
+capture_shm_close(capture_shm_ring *ring)
+{
+    if (ring == NULL)
+        return;
+
+    munmap((void *)ring->hdr, ring->map_len);
+    if (ring->path != NULL) {
+        ws_unlink(ring->path);
+        g_free(ring->path);
+    }
+    g_free(ring);
+}
+
+#else /* _WIN32 */
+
+capture_shm_ring *
+capture_shm_create(gchar **path _U_, guint32 size _U_, int *err)
+{
+    *err = ENOSYS;
+    return NULL;
+}
+
+capture_shm_ring *
+capture_shm_attach(const char *path _U_, int *err)
+{
+    *err = ENOSYS;
+    return NULL;
+}
+
+void
+capture_shm_close(capture_shm_ring *ring _U_)
+{
+}
+
+#endif /* _WIN32 */
+
+void
+capture_shm_abandon(capture_shm_ring *ring)
+{
+    g_atomic_int_set(&ring->hdr->abandoned, 1);
+}
+
+gboolean
+capture_shm_abandoned(capture_shm_ring *ring)
+{
+    return g_atomic_int_get(&ring->hdr->abandoned) != 0;
+}
+
+void
+capture_shm_set_flushed(capture_shm_ring *ring)
+{
+    g_atomic_int_set(&ring->hdr->flushed, 1);
+}
+
+gboolean
+capture_shm_flushed(capture_shm_ring *ring)
+{
+    return g_atomic_int_get(&ring->hdr->flushed) != 0;
+}
+
+gboolean
+capture_shm_put(capture_shm_ring *ring, const capture_shm_record *rec,
+                const guint8 *data)
+{
+    capture_shm_header *hdr = ring->hdr;
+    capture_shm_record *dst;
+    guint32 head, tail, pos, contig, need, total;
+
+    if (hdr->abandoned)
+        return FALSE;
+
+    need = CAPTURE_SHM_ALIGN((guint32)sizeof(capture_shm_record) + rec->caplen);
+    head = (guint32)hdr->head;
+    tail = (guint32)g_atomic_int_get(&hdr->tail);
+    pos = head & (hdr->size - 1);
+    contig = hdr->size - pos;
+
+    /* If the record doesn't fit before the end, pad to the end and
+     * put it at the beginning. */
+    total = (contig < need) ? contig + need : need;
+    if (need > hdr->size / 2 || total > hdr->size - (head - tail)) {
+        capture_shm_abandon(ring);
+        return FALSE;
+    }
+
+    if (contig < need) {
+        dst = (capture_shm_record *)(ring->data + pos);
+        dst->rec_len = contig;
+        dst->interface_id = CAPTURE_SHM_PAD;
+        head += contig;
+        pos = 0;
+    }
+
+    dst = (capture_shm_record *)(ring->data + pos);
+    memcpy(dst, rec, sizeof *rec);
+    dst->rec_len = need;
+    memcpy(dst + 1, data, rec->caplen);
+
+    /* Publish the record */
+    g_atomic_int_set(&hdr->head, (gint)(head + need));
+    return TRUE;
+}
+
+gboolean
+capture_shm_get(capture_shm_ring *ring, capture_shm_record *rec,
+                const guint8 **data)
+{
+    capture_shm_header *hdr = ring->hdr;
+    const capture_shm_record *src;
+    guint32 head, tail;
+
+    tail = (guint32)hdr->tail;
+    for (;;) {
+        head = (guint32)g_atomic_int_get(&hdr->head);
+        if (head == tail)
+            return FALSE;
+
+        src = (const capture_shm_record *)(ring->data + (tail & (hdr->size - 1)));
+        if (src->interface_id != CAPTURE_SHM_PAD)
+            break;
+
+        /* Skip the padding at the end of the data area */
+        tail += src->rec_len;
+        g_atomic_int_set(&hdr->tail, (gint)tail);
+    }
+
+    memcpy(rec, src, sizeof *rec);
+    *data = (const guint8 *)(src + 1);
+    ring->pending = src->rec_len;
+    return TRUE;
+}
+
+void
+capture_shm_release(capture_shm_ring *ring)
+{
+    capture_shm_header *hdr = ring->hdr;
+
+    g_atomic_int_set(&hdr->tail, (gint)((guint32)hdr->tail + ring->pending));
+    ring->pending = 0;
+}
@@ -0,0 +1,125 @@
+/* capture_shm.h
+ * Shared-memory ring for handing captured packets from dumpcap to
+ * the process that's dissecting them
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __CAPTURE_SHM_H__
+#define __CAPTURE_SHM_H__
+
+/*
+ * While capturing, dumpcap writes every packet to the capture file
+ * and tells its parent, over the sync pipe, how many packets it has
+ * written; the parent then reads them back from the file.
+ *
+ * With a shared-memory ring, dumpcap additionally puts each packet
+ * it writes into a memory-mapped file shared with the parent, which
+ * can then dissect the packets straight out of memory; the capture
+ * file is still written, but dumpcap no longer has to flush it before
+ * telling the parent about new packets.
+ *
+ * The ring is single-producer, single-consumer.  If it fills up, or
+ * dumpcap can't use it for some other reason, dumpcap marks it as
+ * abandoned and stops putting packets into it; the records in the
+ * ring are therefore always the first N packets of the capture file,
+ * and once the consumer has drained it, it goes back to reading the
+ * capture file, starting with packet N+1.
+ */
+
+/* Default size of the ring's data area */
+#define CAPTURE_SHM_DEFAULT_SIZE (16*1024*1024)
+
+typedef struct capture_shm_ring capture_shm_ring;
+
+/* Header for a packet in the ring; the packet data follows it */
+typedef struct {
+    guint32 rec_len;        /* length of the record, including padding */
+    guint32 interface_id;   /* interface the packet was captured on */
+    guint32 caplen;
+    guint32 len;
+    gint64  ts_secs;
+    gint32  ts_nsecs;
+    guint32 reserved;
+    gint64  file_offset;    /* offset of the packet in the capture file */
+} capture_shm_record;
+
+/*
+ * Consumer: create a ring with a data area of (at least) "size" bytes.
+ * Returns NULL, with *err set, on failure; *path is set to the
+ * g_malloc()ed path name to pass to dumpcap.
+ */
+capture_shm_ring *capture_shm_create(gchar **path, guint32 size, int *err);
+
+/*
+ * Producer: attach to a ring created by the parent.
+ */
+capture_shm_ring *capture_shm_attach(const char *path, int *err);
+
+/*
+ * Detach from the ring; the consumer also removes it.
+ */
+void capture_shm_close(capture_shm_ring *ring);
+
+/*
+ * Producer: add a packet to the ring.  If there's no room for it, the
+ * ring is abandoned and FALSE is returned; so is it for any packet
+ * added after that.
+ */
+gboolean capture_shm_put(capture_shm_ring *ring, const capture_shm_record *rec,
+                         const guint8 *data);
+
+/*
+ * Producer: stop using the ring.
+ */
+void capture_shm_abandon(capture_shm_ring *ring);
+
+/*
+ * TRUE if the producer has stopped using the ring.
+ */
+gboolean capture_shm_abandoned(capture_shm_ring *ring);
+
+/*
+ * Producer: note that every packet put into the ring has been flushed
+ * to the capture file.  The consumer may also abandon the ring; it can
+ * only go back to reading the capture file once this has been done, as
+ * the producer doesn't flush the file while it's using the ring.
+ */
+void capture_shm_set_flushed(capture_shm_ring *ring);
+
+/*
+ * TRUE if every packet put into the ring is in the capture file.
+ */
+gboolean capture_shm_flushed(capture_shm_ring *ring);
+
+/*
+ * Consumer: get the next packet from the ring.  Returns FALSE if the
+ * ring is empty.  The data pointed to by *data stays valid until
+ * capture_shm_release() is called.
+ */
+gboolean capture_shm_get(capture_shm_ring *ring, capture_shm_record *rec,
+                         const guint8 **data);
+
+/*
+ * Consumer: hand the space of the packet returned by the last
+ * capture_shm_get() back to the producer.
+ */
+void capture_shm_release(capture_shm_ring *ring);
+
+#endif /* capture_shm.h */
@@ -128,6 +128,7 @@ typedef struct _capture_file {
   const frame_data *ref;
   frame_data  *prev_dis;
   frame_data  *prev_cap;
+  guint32      first_pass_next; /* If the frames were added from an index, the first one not yet dissected in order; else 0 */
 } capture_file;
 
 extern void cap_file_init(capture_file *cf);
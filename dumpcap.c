@@ -125,6 +125,7 @@
 
 #include "conditions.h"
 #include "capture_stop_conditions.h"
+#include "capture_shm.h"
 
 #include "wsutil/tempfile.h"
 #include "log.h"
@@ -338,6 +339,7 @@ typedef struct _loop_data {
     int       save_file_fd;
     guint64   bytes_written;
     guint32   autostop_files;
+    capture_shm_ring *shm_ring; /**< ring shared with our parent, if any */
 } loop_data;
 
 typedef struct _pcap_queue_element {
@@ -3485,6 +3487,7 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
     global_ld.pdh                 = NULL;
     global_ld.autostop_files      = 0;
     global_ld.save_file_fd        = -1;
+    global_ld.shm_ring            = NULL;
 
     /* We haven't yet gotten the capture statistics. */
     *stats_known      = FALSE;
@@ -3555,6 +3558,22 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
            update its windows to indicate that we have a live capture in
            progress. */
         fflush(global_ld.pdh);
+
+        /* Our parent asked us to also hand the packets over in a
+           shared-memory ring; it only works if they all go to the
+           file it's reading, so don't bother with a ring buffer. */
+        if (capture_opts->shm_ring_file != NULL) {
+            int shm_err;
+
+            global_ld.shm_ring = capture_shm_attach(capture_opts->shm_ring_file, &shm_err);
+            if (global_ld.shm_ring == NULL) {
+                g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_WARNING,
+                      "Can't attach to the shared-memory ring %s: %s",
+                      capture_opts->shm_ring_file, g_strerror(shm_err));
+            } else if (capture_opts->multi_files_on) {
+                capture_shm_abandon(global_ld.shm_ring);
+            }
+        }
         report_new_capture_file(capture_opts->save_file);
     }
 
@@ -3703,8 +3722,11 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
 #endif
             /* Let the parent process know. */
             if (global_ld.inpkts_to_sync_pipe) {
-                /* do sync here */
-                fflush(global_ld.pdh);
+                /* do sync here, unless our parent is getting the
+                   packets from the shared-memory ring; it only reads
+                   the file once the ring has been abandoned */
+                if (global_ld.shm_ring == NULL || capture_shm_abandoned(global_ld.shm_ring))
+                    fflush(global_ld.pdh);
 
                 /* Send our parent a message saying we've written out
                    "global_ld.inpkts_to_sync_pipe" packets to the capture file. */
@@ -3837,11 +3859,15 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
 
     /* there might be packets not yet notified to the parent */
     /* (do this after closing the file, so all packets are already flushed) */
+    if (global_ld.shm_ring != NULL)
+        capture_shm_set_flushed(global_ld.shm_ring);
     if (global_ld.inpkts_to_sync_pipe) {
         if (!quiet)
             report_packet_count(global_ld.inpkts_to_sync_pipe);
         global_ld.inpkts_to_sync_pipe = 0;
     }
+    capture_shm_close(global_ld.shm_ring);
+    global_ld.shm_ring = NULL;
 
     /* If we've displayed a message about a write error, there's no point
        in displaying another message about an error on close. */
@@ -4014,6 +4040,7 @@ capture_loop_write_packet_cb(u_char *pcap_opts_p, const struct pcap_pkthdr *phdr
 
     if (global_ld.pdh) {
         gboolean successful;
+        gint64   file_offset = (gint64)global_ld.bytes_written;
 
         /* We're supposed to write the packet to a file; do so.
            If this fails, set "ld->go" to FALSE, to stop the capture, and set
@@ -4046,6 +4073,26 @@ capture_loop_write_packet_cb(u_char *pcap_opts_p, const struct pcap_pkthdr *phdr
 #endif
             global_ld.packet_count++;
             pcap_opts->received++;
+            if (global_ld.shm_ring != NULL) {
+                capture_shm_record rec;
+
+                rec.interface_id = pcap_opts->interface_id;
+                rec.caplen       = phdr->caplen;
+                rec.len          = phdr->len;
+                rec.ts_secs      = phdr->ts.tv_sec;
+                rec.ts_nsecs     = (gint32)phdr->ts.tv_usec * (pcap_opts->ts_nsec ? 1 : 1000);
+                rec.reserved     = 0;
+                rec.file_offset  = file_offset;
+                if (!capture_shm_put(global_ld.shm_ring, &rec, pd)) {
+                    /* Our parent goes back to reading the file, once
+                       everything written so far is in it; we might
+                       not be the ones who stopped using the ring. */
+                    fflush(global_ld.pdh);
+                    capture_shm_set_flushed(global_ld.shm_ring);
+                    capture_shm_close(global_ld.shm_ring);
+                    global_ld.shm_ring = NULL;
+                }
+            }
             /* if the user told us to stop after x packets, do we already have enough? */
             if ((global_ld.packet_max > 0) && (global_ld.packet_count >= global_ld.packet_max)) {
                 global_ld.go = FALSE;
@@ -4194,6 +4241,10 @@ get_dumpcap_runtime_info(GString *str)
 #endif
 }
 
+/* Hidden long option; see capture_shm.h */
+#define LONGOPT_SHM_RING MIN_NON_CAPTURE_LONGOPT
+
+
 /* And now our feature presentation... [ fade to music ] */
 int
 main(int argc, char *argv[])
@@ -4204,6 +4255,7 @@ main(int argc, char *argv[])
     static const struct option long_options[] = {
         {(char *)"help", no_argument, NULL, 'h'},
         {(char *)"version", no_argument, NULL, 'v'},
+        {(char *)"shm-ring", required_argument, NULL, LONGOPT_SHM_RING},
         LONGOPT_CAPTURE_COMMON
         {0, 0, 0, 0 }
     };
@@ -4594,6 +4646,10 @@ main(int argc, char *argv[])
                 exit_main(status);
             }
             break;
+            /*** hidden option: shared-memory ring to hand packets to our parent in ***/
+        case LONGOPT_SHM_RING:
+            global_capture_opts.shm_ring_file = g_strdup(optarg);
+            break;
             /*** hidden option: Wireshark child mode (using binary output messages) ***/
         case 'Z':
             capture_child = TRUE;
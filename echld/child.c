@@ -25,6 +25,13 @@
 
 
 #include "echld-int.h"
+
+#include "wiretap/wtap.h"
+#include "epan/column.h"
+#include "epan/epan_dissect.h"
+#include "epan/epan-int.h"
+#include "epan/frame_data.h"
+#include "epan/tvbuff.h"
 // echld_
 
 typedef struct _child {
@@ -57,6 +64,21 @@ typedef struct _child {
 //	capture_file cfile;
 	dfilter_t* df;
 
+	// the file being read
+	wtap* wth;
+	epan_t* epan;
+	column_info cinfo;
+	int read_reqh_id; /* the reqh_id of the open_file request */
+	guint32 framenum;
+	guint32 cum_bytes;
+	nstime_t elapsed_time;
+	frame_data ref_frame;
+	frame_data prev_dis_frame;
+	frame_data prev_cap_frame;
+	const frame_data* ref;
+	const frame_data* prev_dis;
+	const frame_data* prev_cap;
+
 } echld_child_t;
 
 static echld_epan_stuff_t* stuff = NULL;
@@ -331,6 +353,17 @@ static echld_bool_t param_set_add_hosts_file(char* val, char** err) {
 	}
 }
 
+/*
+ * When the child is part of a dissection farm (see echld_farm_read_file())
+ * it reads the whole file but only dissects its own share of the frames:
+ * chunks of farm_chunk frames are dealt out round-robin to the farm_size
+ * children, this being the farm_index-th one.  Only the summaries of those
+ * frames are sent back; taps run, but their results stay in the child.
+ */
+PARAM_INT(farm_size,1);
+PARAM_INT(farm_index,0);
+PARAM_INT(farm_chunk,1000);
+
 PARAM_BOOL(quiet,FALSE);
 PARAM_BOOL(start_capture,FALSE);
 PARAM_BOOL(push_details,FALSE);
@@ -352,6 +385,9 @@ static param_t child_params[] = {
 	PARAM(push_details,"Whether details of dissection should be passed"),
 	PARAM(print_hex,"Output in hex"),
 	PARAM(out_file_type,"Output File Type"),
+	PARAM(farm_size,"Number of Children in the Farm (int)"),
+	PARAM(farm_index,"Index of this Child in the Farm (int)"),
+	PARAM(farm_chunk,"Frames per Chunk Dealt to each Child (int)"),
 	WO_PARAM(add_hosts_file,"Add a Hosts File"),
 	RO_PARAM(params,"This List"),
 	{NULL,NULL,NULL,NULL}
@@ -361,9 +397,60 @@ static char* param_get_params(char** err _U_) {
 	return paramset_get_params_list(child_params,PARAM_LIST_FMT);
 }
 
+static const nstime_t* child_get_frame_ts(void* data _U_, guint32 frame_num) {
+	if (child.ref && child.ref->num == frame_num)
+		return &(child.ref->abs_ts);
+
+	if (child.prev_dis && child.prev_dis->num == frame_num)
+		return &(child.prev_dis->abs_ts);
+
+	if (child.prev_cap && child.prev_cap->num == frame_num)
+		return &(child.prev_cap->abs_ts);
+
+	return NULL;
+}
+
 static void child_open_file(char* filename) {
+	int err = 0;
+	gchar* err_info = NULL;
+
 	CHILD_DBG((2,"CMD open file filename='%s'",filename));
-	child_err(ECHLD_ERR_UNIMPLEMENTED,child.reqh_id,"open file not implemented yet!");
+
+	child.wth = wtap_open_offline(filename, WTAP_TYPE_AUTO, &err, &err_info, FALSE);
+
+	if (!child.wth) {
+		child_err(ECHLD_ERR_CANNOT_OPEN_FILE,child.reqh_id,"cannot open file='%s' reason='%s'",
+			filename, err_info ? err_info : wtap_strerror(err));
+		g_free(err_info);
+		return;
+	}
+
+	if (child.cf_name) g_free(child.cf_name);
+	child.cf_name = g_strdup(filename);
+
+	child.epan = epan_new();
+	child.epan->data = &child;
+	child.epan->get_frame_ts = child_get_frame_ts;
+	child.epan->get_interface_name = NULL;
+	child.epan->get_user_comment = NULL;
+
+	if (child.cinfo.num_cols == 0) {
+		build_column_format_array(&child.cinfo, prefs.num_cols, TRUE);
+	}
+
+	child.read_reqh_id = child.reqh_id;
+	child.framenum = 0;
+	child.cum_bytes = 0;
+	nstime_set_zero(&child.elapsed_time);
+	child.ref = NULL;
+	child.prev_dis = NULL;
+	child.prev_cap = NULL;
+	packet_count = 0;
+
+	if (param_farm_chunk < 1) param_farm_chunk = 1;
+	if (param_farm_size < 1) param_farm_size = 1;
+
+	CHILD_RESP(NULL,ECHLD_FILE_OPENED);
 	child.state = READING;
 }
 
@@ -633,8 +720,132 @@ static int child_dumpcap_read(void) {
 	return FALSE;
 }
 
+static gboolean child_owns_frame(guint32 framenum) {
+	if (param_farm_size <= 1) return TRUE;
+
+	return (int)(((framenum - 1) / (guint32)param_farm_chunk) % (guint32)param_farm_size) == param_farm_index;
+}
+
+static void child_send_summary(guint32 framenum, column_info* cinfo) {
+	GString* sum = g_string_new("");
+	GByteArray* ba;
+	int i;
+
+	for (i = 0; i < cinfo->num_cols; i++) {
+		if (i) g_string_append_c(sum,'\t');
+		g_string_append(sum,cinfo->col_data[i]);
+	}
+
+	ba = child.enc->packet_sum((int)framenum, sum->str);
+	echld_write_frame(child.fds.pipe_to_parent, ba, child.chld_id, ECHLD_PACKET_SUM, child.read_reqh_id, NULL);
+	g_byte_array_free(ba,TRUE);
+	g_string_free(sum,TRUE);
+}
+
+static void child_process_packet(gint64 offset, struct wtap_pkthdr* whdr, const guchar* pd) {
+	frame_data fdata;
+	epan_dissect_t edt;
+	gboolean passed = TRUE;
+
+	child.framenum++;
+	frame_data_init(&fdata, child.framenum, whdr, offset, child.cum_bytes);
+
+	if ( ! child_owns_frame(child.framenum) ) {
+		/*
+		 * Another child dissects this one; we only keep track of the
+		 * time references. We don't know whether it passed the display
+		 * filter, so prev_dis may differ from a sequential read at the
+		 * chunk boundaries.
+		 */
+		frame_data_set_before_dissect(&fdata, &child.elapsed_time, &child.ref, child.prev_dis);
+		if (child.ref == &fdata) {
+			child.ref_frame = fdata;
+			child.ref = &child.ref_frame;
+		}
+		frame_data_set_after_dissect(&fdata, &child.cum_bytes);
+		child.prev_dis_frame = fdata;
+		child.prev_dis = &child.prev_dis_frame;
+		child.prev_cap_frame = fdata;
+		child.prev_cap = &child.prev_cap_frame;
+		frame_data_destroy(&fdata);
+		return;
+	}
+
+	epan_dissect_init(&edt, child.epan, child.df != NULL || have_custom_cols(&child.cinfo), FALSE);
+
+	if (child.df)
+		epan_dissect_prime_dfilter(&edt, child.df);
+
+	col_custom_prime_edt(&edt, &child.cinfo);
+
+	frame_data_set_before_dissect(&fdata, &child.elapsed_time, &child.ref, child.prev_dis);
+	if (child.ref == &fdata) {
+		child.ref_frame = fdata;
+		child.ref = &child.ref_frame;
+	}
+
+	epan_dissect_run_with_taps(&edt, wtap_file_type_subtype(child.wth), whdr,
+		tvb_new_real_data(pd, fdata.cap_len, fdata.pkt_len), &fdata, &child.cinfo);
+
+	if (child.df)
+		passed = dfilter_apply_edt(child.df, &edt);
+
+	if (passed) {
+		frame_data_set_after_dissect(&fdata, &child.cum_bytes);
+
+		if (!param_quiet) {
+			epan_dissect_fill_in_columns(&edt, FALSE, TRUE);
+			child_send_summary(child.framenum, &child.cinfo);
+		}
+
+		child.prev_dis_frame = fdata;
+		child.prev_dis = &child.prev_dis_frame;
+	}
+
+	child.prev_cap_frame = fdata;
+	child.prev_cap = &child.prev_cap_frame;
+
+	epan_dissect_cleanup(&edt);
+	frame_data_destroy(&fdata);
+	packet_count++;
+}
+
+static void child_file_done(void) {
+	wtap_close(child.wth);
+	child.wth = NULL;
+
+	epan_free(child.epan);
+	child.epan = NULL;
+
+	echld_write_frame(child.fds.pipe_to_parent, NULL, child.chld_id, ECHLD_EOF, child.read_reqh_id, NULL);
+	child.state = DONE;
+}
+
+/* packets read in each pass of the loop, so that we still get to serve the parent */
+#define CHILD_READ_BATCH 256
+
 static void child_file_read(void) {
+	int err = 0;
+	gchar* err_info = NULL;
+	gint64 data_offset;
+	int i;
+
+	if (!child.wth) return;
+
+	for (i = 0; i < CHILD_READ_BATCH; i++) {
+		if ( ! wtap_read(child.wth, &err, &err_info, &data_offset) ) {
+			if (err != 0) {
+				child_err(ECHLD_ERR_OTHER,child.read_reqh_id,"error reading file='%s' reason='%s'",
+					child.cf_name, err_info ? err_info : wtap_strerror(err));
+				g_free(err_info);
+			}
 
+			child_file_done();
+			return;
+		}
+
+		child_process_packet(data_offset, wtap_phdr(child.wth), wtap_buf_ptr(child.wth));
+	}
 }
 
 int echld_child_loop(void) {
@@ -672,7 +883,8 @@ int echld_child_loop(void) {
 		if (step <= 20) CHILD_DBG((4,"child_loop: select()ing step=%d",step++));
 #endif
 		timeout.tv_sec = 0;
-		timeout.tv_usec = 999999;
+		/* don't wait while there's a file to read */
+		timeout.tv_usec = (child.state == READING) ? 0 : 999999;
 
 		nfds = select(FD_SETSIZE, &rfds, &wfds, &efds, &timeout);
 #ifdef DEBUG_CHILD
@@ -208,3 +208,336 @@ echld_state_t echld_close(int child_id, echld_close_cb_t pcb, void* cb_data) {
 }
 
 
+
+
+typedef struct _open_file {
+	int chld_id;
+	echild_get_packet_summary_cb_t cb;
+	void* cb_data;
+	int sum_msgh_id;
+	int eof_msgh_id;
+} open_file_t;
+
+static gboolean got_packet_sum(echld_msg_type_t type _U_, GByteArray* ba, void* data) {
+	open_file_t* o = (open_file_t*)data;
+	parent_decoder_t* dec;
+	int framenum;
+	char* sum;
+
+	echld_get_all_codecs(NULL, NULL, NULL, &dec);
+
+	if ( o->cb && dec->packet_sum(ba, &framenum, &sum) ) {
+		o->cb(sum,o->cb_data);
+	}
+
+	return TRUE;
+}
+
+static gboolean file_read(echld_msg_type_t type _U_, GByteArray* ba _U_, void* data) {
+	open_file_t* o = (open_file_t*)data;
+
+	echld_msgh_detach(o->chld_id,o->sum_msgh_id);
+	echld_msgh_detach(o->chld_id,o->eof_msgh_id);
+	g_free(o);
+
+	return TRUE;
+}
+
+static gboolean file_opened(echld_msg_type_t type, GByteArray* ba _U_, void* data) {
+	open_file_t* o = (open_file_t*)data;
+
+	switch (type) {
+		case ECHLD_FILE_OPENED:
+			o->sum_msgh_id = echld_msgh(o->chld_id, ECHLD_PACKET_SUM, got_packet_sum, o);
+			o->eof_msgh_id = echld_msgh(o->chld_id, ECHLD_EOF, file_read, o);
+			break;
+		default:
+			g_free(o);
+			break;
+	}
+
+	return TRUE;
+}
+
+echld_state_t echld_open_file(int chld_id, const char* filename, echild_get_packet_summary_cb_t cb, void* cb_data) {
+	open_file_t* o = g_new0(open_file_t,1);
+	echld_parent_encoder_t* enc;
+
+	echld_get_all_codecs(NULL, NULL, &enc, NULL);
+
+	o->chld_id = chld_id;
+	o->cb = cb;
+	o->cb_data = cb_data;
+
+	return echld_reqh(chld_id, ECHLD_OPEN_FILE, 0, enc->open_file(filename), file_opened, o);
+}
+
+
+/*
+ * A dissection farm: every child reads the whole file, but only dissects its
+ * share of the frames, dealt out in chunks of farm->chunk frames.  Each child
+ * sends its summaries in frame order, so we merge them back into a single
+ * ordered stream by emitting one chunk at a time, from the child owning it.
+ */
+
+typedef struct _farm_sum {
+	int framenum;
+	char* summary;
+} farm_sum_t;
+
+typedef struct _farm_worker {
+	echld_farm_t* farm;
+	int index;
+	echld_chld_id_t chld_id;
+	GQueue* queue; /* farm_sum_t*s received but not yet emitted */
+	gboolean finished;
+	int open_reqh_id;
+	int msgh_ids[4];
+	int n_msghs;
+} farm_worker_t;
+
+struct _echld_farm {
+	int n_children;
+	int chunk;
+	char* filename;
+	echld_farm_sum_cb_t sum_cb;
+	echld_farm_done_cb_t done_cb;
+	void* cb_data;
+	farm_worker_t* workers;
+	int n_running;
+	int cur_chunk; /* the chunk being emitted, counting from 0 */
+	GString* errors;
+	gboolean done;
+};
+
+static void farm_error(farm_worker_t* w, const char* fmt, ...) G_GNUC_PRINTF(2, 3);
+
+static void farm_error(farm_worker_t* w, const char* fmt, ...) {
+	va_list ap;
+
+	g_string_append_printf(w->farm->errors, "%schild %d: ", w->farm->errors->len ? "; " : "", w->index);
+	va_start(ap, fmt);
+	g_string_append_vprintf(w->farm->errors, fmt, ap);
+	va_end(ap);
+}
+
+static void farm_worker_finished(farm_worker_t* w) {
+	if (w->finished) return;
+
+	w->finished = TRUE;
+	w->farm->n_running--;
+}
+
+static void farm_flush(echld_farm_t* f) {
+	int i;
+
+	while (!f->done) {
+		farm_worker_t* w = &(f->workers[f->cur_chunk % f->n_children]);
+		int last = (f->cur_chunk + 1) * f->chunk;
+		farm_sum_t* s;
+
+		while ( (s = (farm_sum_t*)g_queue_peek_head(w->queue)) && s->framenum <= last ) {
+			g_queue_pop_head(w->queue);
+			if (f->sum_cb) f->sum_cb(s->framenum, s->summary, f->cb_data);
+			g_free(s->summary);
+			g_free(s);
+		}
+
+		if (s || w->finished) {
+			/* this chunk is complete */
+			f->cur_chunk++;
+		} else {
+			return;
+		}
+
+		if (f->n_running == 0) {
+			for (i = 0; i < f->n_children; i++) {
+				if ( ! g_queue_is_empty(f->workers[i].queue) ) break;
+			}
+
+			if (i == f->n_children) {
+				f->done = TRUE;
+				if (f->done_cb) f->done_cb(f->errors->len ? f->errors->str : NULL, f->cb_data);
+			}
+		}
+	}
+}
+
+static gboolean farm_got_sum(echld_msg_type_t type _U_, GByteArray* ba, void* data) {
+	farm_worker_t* w = (farm_worker_t*)data;
+	parent_decoder_t* dec;
+	farm_sum_t* s;
+	int framenum;
+	char* sum;
+
+	echld_get_all_codecs(NULL, NULL, NULL, &dec);
+
+	if ( ! dec->packet_sum(ba, &framenum, &sum) ) {
+		farm_error(w, "cannot decode packet summary");
+		return TRUE;
+	}
+
+	/* the decoded string lives in ba, which goes away when we return */
+	s = g_new(farm_sum_t,1);
+	s->framenum = framenum;
+	s->summary = g_strdup(sum);
+	g_queue_push_tail(w->queue, s);
+
+	farm_flush(w->farm);
+	return TRUE;
+}
+
+static gboolean farm_got_eof(echld_msg_type_t type _U_, GByteArray* ba _U_, void* data) {
+	farm_worker_t* w = (farm_worker_t*)data;
+
+	farm_worker_finished(w);
+	farm_flush(w->farm);
+	return TRUE;
+}
+
+static gboolean farm_got_error(echld_msg_type_t type, GByteArray* ba, void* data) {
+	farm_worker_t* w = (farm_worker_t*)data;
+	parent_decoder_t* dec;
+	int errnum;
+	char* err_msg;
+
+	echld_get_all_codecs(NULL, NULL, NULL, &dec);
+
+	if (type == ECHLD_CHILD_DEAD) {
+		/* we lose whatever it hadn't sent us yet, but the others go on */
+		if ( dec->child_dead(ba, &err_msg) ) {
+			farm_error(w, "died: %s", err_msg);
+		} else {
+			farm_error(w, "died");
+		}
+	} else if ( dec->error(ba, &errnum, &err_msg) ) {
+		farm_error(w, "%s", err_msg);
+	} else {
+		farm_error(w, "other type='%s'", TY(type));
+	}
+
+	farm_worker_finished(w);
+	farm_flush(w->farm);
+	return TRUE;
+}
+
+static gboolean farm_file_opened(echld_msg_type_t type, GByteArray* ba, void* data) {
+	farm_worker_t* w = (farm_worker_t*)data;
+
+	if (type != ECHLD_FILE_OPENED) {
+		/* the error is reported by its msgh */
+		return TRUE;
+	}
+
+	w->msgh_ids[w->n_msghs++] = echld_msgh(w->chld_id, ECHLD_PACKET_SUM, farm_got_sum, w);
+	w->msgh_ids[w->n_msghs++] = echld_msgh(w->chld_id, ECHLD_EOF, farm_got_eof, w);
+	return TRUE;
+}
+
+static void farm_child_new(void* child_data, const char* err) {
+	farm_worker_t* w = (farm_worker_t*)child_data;
+	echld_parent_encoder_t* enc;
+
+	if (err) {
+		farm_error(w, "%s", err);
+		farm_worker_finished(w);
+		farm_flush(w->farm);
+		return;
+	}
+
+	echld_get_all_codecs(NULL, NULL, &enc, NULL);
+
+	w->msgh_ids[w->n_msghs++] = echld_msgh(w->chld_id, ECHLD_ERROR, farm_got_error, w);
+	w->msgh_ids[w->n_msghs++] = echld_msgh(w->chld_id, ECHLD_CHILD_DEAD, farm_got_error, w);
+	w->open_reqh_id = echld_reqh(w->chld_id, ECHLD_OPEN_FILE, 0, enc->open_file(w->farm->filename), farm_file_opened, w);
+}
+
+static void farm_child_closed(const char* error _U_, void* data _U_) {
+}
+
+echld_farm_t* echld_farm_read_file(const char* filename, int n_children, int chunk, const char* dfilter,
+		echld_farm_sum_cb_t sum_cb, echld_farm_done_cb_t done_cb, void* cb_data) {
+	echld_farm_t* f;
+	int i;
+
+	if (n_children < 1 || n_children >= ECHLD_MAX_CHILDREN || chunk < 1) return NULL;
+
+	f = g_new0(echld_farm_t,1);
+	f->n_children = n_children;
+	f->chunk = chunk;
+	f->filename = g_strdup(filename);
+	f->sum_cb = sum_cb;
+	f->done_cb = done_cb;
+	f->cb_data = cb_data;
+	f->errors = g_string_new("");
+	f->workers = g_new0(farm_worker_t,n_children);
+	f->n_running = n_children;
+
+	for (i = 0; i < n_children; i++) {
+		farm_worker_t* w = &(f->workers[i]);
+		enc_msg_t* em = echld_new_child_params();
+		char* size_s = g_strdup_printf("%d",n_children);
+		char* index_s = g_strdup_printf("%d",i);
+		char* chunk_s = g_strdup_printf("%d",chunk);
+
+		w->farm = f;
+		w->index = i;
+		w->queue = g_queue_new();
+
+		echld_new_child_params_add_params(em, "farm_size", size_s, "farm_index", index_s, "farm_chunk", chunk_s, NULL);
+		if (dfilter && *dfilter) {
+			echld_new_child_params_add_params(em, "dfilter", dfilter, NULL);
+		}
+
+		g_free(size_s);
+		g_free(index_s);
+		g_free(chunk_s);
+
+		w->chld_id = echld_new(em, farm_child_new, w);
+
+		if (w->chld_id <= 0) {
+			farm_error(w, "cannot create child");
+			farm_worker_finished(w);
+		}
+	}
+
+	farm_flush(f);
+
+	return f;
+}
+
+echld_bool_t echld_farm_done(echld_farm_t* f) {
+	return f->done;
+}
+
+void echld_farm_free(echld_farm_t* f) {
+	int i;
+
+	for (i = 0; i < f->n_children; i++) {
+		farm_worker_t* w = &(f->workers[i]);
+		farm_sum_t* s;
+
+		if (w->chld_id > 0 && echld_get_data(w->chld_id) == w) {
+			int j;
+
+			/* it's going away: don't let it call us back */
+			if (w->open_reqh_id > 0) echld_reqh_detach(w->chld_id, w->open_reqh_id);
+			for (j = 0; j < w->n_msghs; j++) {
+				echld_msgh_detach(w->chld_id, w->msgh_ids[j]);
+			}
+			echld_set_data(w->chld_id, NULL);
+			echld_close(w->chld_id, farm_child_closed, NULL);
+		}
+
+		while ( (s = (farm_sum_t*)g_queue_pop_head(w->queue)) ) {
+			g_free(s->summary);
+			g_free(s);
+		}
+		g_queue_free(w->queue);
+	}
+
+	g_free(f->workers);
+	g_free(f->filename);
+	g_string_free(f->errors,TRUE);
+	g_free(f);
+}
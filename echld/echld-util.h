@@ -42,6 +42,36 @@ WS_DLL_PUBLIC echld_state_t echld_set_param(int chld_id, const char* param, cons
 typedef void (*echild_get_packet_summary_cb_t)(char* summary, void* data);
 WS_DLL_PUBLIC echld_state_t echld_open_file(int child_id, const char* filename,echild_get_packet_summary_cb_t,void*);
 
+/*
+ * Dissection farm: read a file with n_children children at once, each one
+ * dissecting every n_children-th chunk of chunk frames (and skipping over the
+ * rest), and get the summaries back merged in frame order.
+ *
+ * Each child only sees its own frames dissected, so the output matches that of
+ * a single child only for what doesn't depend on earlier frames.
+ *
+ * done_cb is called once all the children are done; error is NULL unless
+ * some child failed, in which case the frames it owned are missing.
+ * Keep calling echld_wait() or echld_select() until echld_farm_done().
+ *
+ * This is a building block, not yet a faster way to read a file: only
+ * echld_test's FARM command uses it, as neither TShark nor the GUIs link
+ * echld.  Every child still reads the whole file and only skips dissecting
+ * the frames it doesn't own.  Only the packet summaries come back; the
+ * children's tap results are neither collected nor merged, as there's no
+ * message to send them to the parent with.  Once there is, the parent can
+ * add them up with merge_tap_listener() (see epan/tap.h).
+ */
+typedef struct _echld_farm echld_farm_t;
+typedef void (*echld_farm_sum_cb_t)(int framenum, const char* summary, void* data);
+typedef void (*echld_farm_done_cb_t)(const char* error, void* data);
+
+WS_DLL_PUBLIC echld_farm_t* echld_farm_read_file(const char* filename, int n_children, int chunk, const char* dfilter,
+	echld_farm_sum_cb_t sum_cb, echld_farm_done_cb_t done_cb, void* cb_data);
+WS_DLL_PUBLIC echld_bool_t echld_farm_done(echld_farm_t* farm);
+/* closes the children if they're still at it */
+WS_DLL_PUBLIC void echld_farm_free(echld_farm_t* farm);
+
 
 
 WS_DLL_PUBLIC echld_state_t echld_open_interface(int child_id, const char* intf_name, const char* params);
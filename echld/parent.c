@@ -466,6 +466,7 @@ extern gboolean echld_reqh_detach(int child_id, int reqh_id) {
 static echld_bool_t parent_dead_child(echld_msg_type_t type, enc_msg_t* ba, void* data) {
 	echld_t* c = (echld_t*)data;
 	char* s;
+	guint i;
 
 	if (type !=  ECHLD_CHILD_DEAD) {
 		PARENT_DBG((1, "Must Be ECHLD_CHILD_DEAD"));
@@ -477,6 +478,14 @@ static echld_bool_t parent_dead_child(echld_msg_type_t type, enc_msg_t* ba, void
 		g_free(s);
 	}
 
+	/* let the others watching for this child's death know before its handlers are gone */
+	for (i = 0; i < c->handlers->len; i++) {
+		hdlr_t* h = &(((hdlr_t*)(c->handlers->data))[i]);
+
+		if (h->type == ECHLD_CHILD_DEAD && h->cb && h->cb != parent_dead_child)
+			h->cb(type,ba,h->cb_data);
+	}
+
 	parent_child_cleanup(c);
 	return 0;
 }
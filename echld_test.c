@@ -234,9 +234,61 @@ static char* quit_cmd(char** params _U_, char** err _U_) {
 
 static char* help_cmd(char**, char**);
 
-static char* open_file_cmd(char** pars _U_, char** err _U_) {
-	*err = g_strdup("Not Implemented");
-	return NULL;
+static void sum_cb(char* summary, void* data) {
+	fprintf(stdout, "Sum: child=%d %s\n", *((int*)data), summary);
+}
+
+static char* open_file_cmd(char** params, char** err) {
+	int child = (int) strtol(params[1], NULL, 10);
+	char* filename = params[2];
+	int* cmdp = g_new(int,1);
+	*cmdp = child;
+
+	if ( ! echld_open_file(child,filename,sum_cb,cmdp) ) {
+		*err = g_strdup_printf("Could not open file child=%d filename='%s'",child,filename);
+		g_free(cmdp);
+		return NULL;
+	} else {
+		return g_strdup_printf("Open file command sent child=%d filename='%s'",child,filename);
+	}
+}
+
+static echld_farm_t* farm = NULL;
+
+static void farm_sum_cb(int framenum, const char* summary, void* data _U_) {
+	fprintf(stdout, "%d\t%s\n", framenum, summary);
+}
+
+static void farm_done_cb(const char* error, void* data _U_) {
+	if (error) {
+		fprintf(stdout, "Farm Error msg=%s\n", error );
+	} else {
+		fprintf(stdout, "Farm Done\n");
+	}
+}
+
+static char* farm_cmd(char** params, char** err) {
+	int n_children = (int) strtol(params[1], NULL, 10);
+	int chunk = (int) strtol(params[2], NULL, 10);
+	char* filename = params[3];
+	char* dfilter = params[4];
+
+	if (farm) {
+		if ( ! echld_farm_done(farm) ) {
+			*err = g_strdup("Farm already running");
+			return NULL;
+		}
+		echld_farm_free(farm);
+	}
+
+	farm = echld_farm_read_file(filename, n_children, chunk, dfilter, farm_sum_cb, farm_done_cb, NULL);
+
+	if (!farm) {
+		*err = g_strdup_printf("Could not start farm n_children=%d chunk=%d",n_children,chunk);
+		return NULL;
+	} else {
+		return g_strdup_printf("Farm started n_children=%d chunk=%d filename='%s'",n_children,chunk,filename);
+	}
 }
 
 static char* prepare_capture_cmd(char** pars _U_, char** err _U_) {
@@ -302,6 +354,7 @@ cmd_t commands[] = {
 	{ "GET", get_cmd, 2, "GET child_id param_name"},
 	{ "CLOSE", close_cmd, 1, "CLOSE child_id"},
 	{ "FILE", open_file_cmd, 2, "FILE child_id filename"},
+	{ "FARM", farm_cmd, 4, "FARM n_children chunk filename [dfilter]"},
 	{ "PREP", prepare_capture_cmd, 2, "PREP child_id intfname params"},
 	{ "START",start_capture_cmd,1,"START child_id"},
 	{ "SUM", get_sum_cmd,2,"SUM child_id packet_range"},
@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 
 /*
  * Win32 doesn't have SIGALRM (and it's the OS where name lookup calls
@@ -118,6 +119,7 @@
 
 #include "packet.h"
 #include "addr_and_mask.h"
+#include "resolv_db.h"
 #include "ipv6-utils.h"
 #include "addr_resolv.h"
 #include "wsutil/filesystem.h"
@@ -251,6 +253,15 @@ static gboolean new_resolved_objects = FALSE;
 
 static GPtrArray* extra_hosts_files = NULL;
 
+/* Compiled forms of the name resolution files, if they're in use */
+static const char *resolv_db_dir = "";  /* where they're kept; preference */
+static char *ethers_db_dir = NULL;      /* resolv_db_dir when the ethers and
+                                           manuf files were last loaded */
+static GPtrArray *hosts_dbs = NULL;     /* in the order the files were read */
+static resolv_db *manuf_db = NULL;
+static resolv_db *ethers_db = NULL;
+static resolv_db *pethers_db = NULL;
+
 static hashether_t *add_eth_name(const guint8 *addr, const gchar *name);
 static void add_serv_port_cb(const guint32 port);
 
@@ -290,6 +301,36 @@ ipv6_equal(gconstpointer v1, gconstpointer v2)
     return FALSE;
 }
 
+typedef gboolean (*resolv_db_fill_func)(resolv_db_builder *builder, const char *path);
+
+/*
+ * If the "resolv_db_dir" preference is set, get the compiled form of the
+ * name resolution file at path from that directory, compiling the file
+ * with fill if there isn't an up-to-date one.  Returns NULL if it isn't
+ * set or the file can't be read, leaving errno as set by the failed call.
+ */
+static resolv_db *
+get_resolv_db(const char *path, gboolean first_wins, resolv_db_fill_func fill)
+{
+    const char *dir = resolv_db_dir;
+    resolv_db_builder *builder;
+    resolv_db *db;
+
+    if (dir == NULL || *dir == '\0')
+        return NULL;
+
+    if ((db = resolv_db_open(dir, path)) != NULL)
+        return db;
+
+    if ((builder = resolv_db_builder_new(path, first_wins)) == NULL)
+        return NULL;
+    if (!(*fill)(builder, path)) {
+        resolv_db_builder_free(builder);
+        return NULL;
+    }
+    return resolv_db_builder_finish(builder, dir);
+}
+
 /*
  * Flag controlling what names to resolve.
  */
@@ -297,6 +338,7 @@ e_addr_resolve gbl_resolv_flags = {TRUE, FALSE, FALSE, TRUE, TRUE, FALSE};
 #if defined(HAVE_C_ARES) || defined(HAVE_GNU_ADNS)
 static guint name_resolve_concurrency = 500;
 #endif
+static guint name_resolve_cache_ttl = 0;    /* hours; 0 means no DNS cache */
 
 /*
  *  Global variables (can be changed in GUI sections)
@@ -316,8 +358,8 @@ gchar *g_pservices_path = NULL;     /* personal services file */
 #ifdef HAVE_C_ARES
 /*
  * Submitted queries trigger a callback (c_ares_ghba_cb()).
- * Queries are added to c_ares_queue_head. During processing, queries are
- * popped off the front of c_ares_queue_head and submitted using
+ * Queries are added to async_dns_queue. During processing, queries are
+ * popped off the front of async_dns_queue and submitted using
  * ares_gethostbyaddr().
  * The callback processes the response, then frees the request.
  */
@@ -353,7 +395,7 @@ ares_channel ghbn_chan; /* ares_gethostbyname -- Usually interactive, timeout */
 #define ASYNC_DNS
 /*
  * Submitted queries have to be checked individually using adns_check().
- * Queries are added to adns_queue_head. During processing, the list is
+ * Queries are added to async_dns_queue. During processing, the list is
  * iterated twice: once to request queries up to the concurrency limit,
  * and once to check the status of each query.
  */
@@ -373,7 +415,7 @@ typedef struct _async_dns_queue_msg
 #ifdef ASYNC_DNS
 static  gboolean  async_dns_initialized = FALSE;
 static  guint       async_dns_in_flight = 0;
-static  GList    *async_dns_queue_head = NULL;
+static  GQueue    async_dns_queue = G_QUEUE_INIT;
 
 /* push a dns request */
 static void
@@ -390,7 +432,7 @@ add_async_dns_ipv4(int type, guint32 addr)
     msg->ip4_addr = addr;
     msg->submitted = FALSE;
 #endif
-    async_dns_queue_head = g_list_append(async_dns_queue_head, (gpointer) msg);
+    g_queue_push_tail(&async_dns_queue, (gpointer) msg);
 }
 
 #endif
@@ -795,6 +837,176 @@ fill_dummy_ip4(const guint addr, hashipv4_t* volatile tp)
     }
 }
 
+/*
+ * Results of reverse DNS lookups, kept in the personal configuration
+ * directory between runs for name_resolve_cache_ttl hours, so that
+ * addresses seen again aren't looked up again.  Each line of the file
+ * holds an address, its name, or "-" if it has none, and the time at
+ * which the entry expires.
+ */
+#define ENAME_DNS_CACHE "dns_cache"
+
+typedef struct {
+    gchar  *name;       /* NULL if the address has no name */
+    time_t  expires;
+} dns_cache_entry_t;
+
+static GHashTable *dns_cache = NULL;    /* address string -> dns_cache_entry_t */
+static gboolean    dns_cache_changed = FALSE;
+
+static void
+dns_cache_entry_free(gpointer data)
+{
+    dns_cache_entry_t *entry = (dns_cache_entry_t *)data;
+
+    g_free(entry->name);
+    g_free(entry);
+}
+
+/* Add the entries in the cache file that haven't expired and that we
+   don't already have. */
+static void
+dns_cache_read(const char *path, time_t now)
+{
+    FILE *fp;
+    char *line = NULL;
+    int size = 0;
+    gchar *cp, *addr, *name;
+    time_t expires;
+    dns_cache_entry_t *entry;
+
+    if ((fp = ws_fopen(path, "r")) == NULL)
+        return;
+
+    while (fgetline(&line, &size, fp) >= 0) {
+        if ((cp = strchr(line, '#')))
+            *cp = '\0';
+
+        if ((addr = strtok(line, " \t")) == NULL ||
+                (name = strtok(NULL, " \t")) == NULL ||
+                (cp = strtok(NULL, " \t")) == NULL)
+            continue;
+
+        expires = (time_t)g_ascii_strtoll(cp, NULL, 10);
+        if (expires <= now || g_hash_table_lookup(dns_cache, addr) != NULL)
+            continue;
+
+        entry = g_new(dns_cache_entry_t, 1);
+        entry->name = strcmp(name, "-") == 0 ? NULL : g_strdup(name);
+        entry->expires = expires;
+        g_hash_table_insert(dns_cache, g_strdup(addr), entry);
+    }
+    g_free(line);
+
+    fclose(fp);
+}
+
+static void
+dns_cache_init(void)
+{
+    char *path;
+
+    if (name_resolve_cache_ttl == 0)
+        return;
+
+    dns_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+            dns_cache_entry_free);
+    path = get_persconffile_path(ENAME_DNS_CACHE, FALSE);
+    dns_cache_read(path, time(NULL));
+    g_free(path);
+    dns_cache_changed = FALSE;
+}
+
+typedef struct {
+    GString *buf;
+    time_t   now;
+} dns_cache_write_ctx_t;
+
+static void
+dns_cache_write_entry(gpointer key, gpointer value, gpointer user_data)
+{
+    dns_cache_entry_t *entry = (dns_cache_entry_t *)value;
+    dns_cache_write_ctx_t *ctx = (dns_cache_write_ctx_t *)user_data;
+
+    if (entry->expires <= ctx->now)
+        return;
+
+    g_string_append_printf(ctx->buf, "%s %s %" G_GINT64_MODIFIER "d\n",
+            (const gchar *)key, entry->name ? entry->name : "-",
+            (gint64)entry->expires);
+}
+
+/* Write the cache back if we've added to it, keeping what other
+   processes have added since we read it, and free it. */
+static void
+dns_cache_cleanup(void)
+{
+    dns_cache_write_ctx_t ctx;
+    char *pf_dir_path, *path;
+
+    if (dns_cache == NULL)
+        return;
+
+    if (dns_cache_changed && create_persconffile_dir(&pf_dir_path) != -1) {
+        path = get_persconffile_path(ENAME_DNS_CACHE, FALSE);
+        ctx.now = time(NULL);
+        dns_cache_read(path, ctx.now);
+
+        ctx.buf = g_string_new("# Reverse DNS lookup results: address, name"
+                " (\"-\" if none), expiry time\n");
+        g_hash_table_foreach(dns_cache, dns_cache_write_entry, &ctx);
+        /* Another process may be reading it; g_file_set_contents() replaces
+           it atomically. */
+        g_file_set_contents(path, ctx.buf->str, ctx.buf->len, NULL);
+        g_string_free(ctx.buf, TRUE);
+        g_free(path);
+    } else if (dns_cache_changed) {
+        g_free(pf_dir_path);
+    }
+
+    g_hash_table_destroy(dns_cache);
+    dns_cache = NULL;
+}
+
+static const dns_cache_entry_t *
+dns_cache_lookup(const gchar *addr_str)
+{
+    const dns_cache_entry_t *entry;
+
+    if (dns_cache == NULL)
+        return NULL;
+
+    entry = (const dns_cache_entry_t *)g_hash_table_lookup(dns_cache, addr_str);
+    if (entry == NULL || entry->expires <= time(NULL))
+        return NULL;
+    return entry;
+}
+
+#ifdef ASYNC_DNS
+/* Remember the result of a reverse lookup of an IPv4 or IPv6 address;
+   name is NULL if the address has no name. */
+static void
+dns_cache_add(int family, const void *addr, const gchar *name)
+{
+    gchar addr_str[MAX_IP6_STR_LEN];
+    dns_cache_entry_t *entry;
+
+    if (dns_cache == NULL)
+        return;
+
+    if (family == AF_INET6)
+        ip6_to_str_buf((const struct e_in6_addr *)addr, addr_str);
+    else
+        ip_to_str_buf((const guint8 *)addr, addr_str, sizeof addr_str);
+
+    entry = g_new(dns_cache_entry_t, 1);
+    entry->name = g_strdup(name);
+    entry->expires = time(NULL) + (time_t)name_resolve_cache_ttl * 60 * 60;
+    g_hash_table_replace(dns_cache, g_strdup(addr_str), entry);
+    dns_cache_changed = TRUE;
+}
+#endif /* ASYNC_DNS */
+
 #ifdef HAVE_C_ARES
 
 static void
@@ -831,12 +1043,37 @@ c_ares_ghba_cb(
                     break;
             }
         }
+        dns_cache_add(caqm->family, &caqm->addr, he->h_name);
+    } else if (status == ARES_ENOTFOUND) {
+        dns_cache_add(caqm->family, &caqm->addr, NULL);
     }
     g_free(caqm);
 }
 #endif /* HAVE_C_ARES */
 
 /* --------------- */
+/* Look an address up in the compiled hosts files, the one read last first,
+   as later files override earlier ones. */
+static gboolean
+hosts_db_lookup(resolv_db_table table, const guint8 *key, gchar *name)
+{
+    const char *db_name;
+    guint i;
+
+    if (hosts_dbs == NULL)
+        return FALSE;
+
+    for (i = hosts_dbs->len; i > 0; i--) {
+        db_name = resolv_db_lookup((resolv_db *)g_ptr_array_index(hosts_dbs, i - 1),
+                table, key);
+        if (db_name != NULL) {
+            g_strlcpy(name, db_name, MAXNAMELEN);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
 static hashipv4_t *
 new_ipv4(const guint addr)
 {
@@ -851,6 +1088,7 @@ static hashipv4_t *
 host_lookup(const guint addr, gboolean *found)
 {
     hashipv4_t * volatile tp;
+    const dns_cache_entry_t *cached;
 
     *found = TRUE;
 
@@ -858,6 +1096,10 @@ host_lookup(const guint addr, gboolean *found)
     if(tp == NULL){
         tp = new_ipv4(addr);
         g_hash_table_insert(ipv4_hash_table, GUINT_TO_POINTER(addr), tp);
+        if (hosts_db_lookup(RESOLV_DB_IPV4, (const guint8 *)&addr, tp->name)) {
+            tp->flags = tp->flags | TRIED_RESOLVE_ADDRESS;
+            return tp;
+        }
     }else{
         if ((tp->flags & DUMMY_AND_RESOLVE_FLGS) ==  DUMMY_ADDRESS_ENTRY){
             goto try_resolv;
@@ -872,8 +1114,16 @@ try_resolv:
     if (gbl_resolv_flags.network_name && gbl_resolv_flags.use_external_net_name_resolver) {
         tp->flags = tp->flags|TRIED_RESOLVE_ADDRESS;
 
+        /* Don't look it up again if we already know the answer */
+        cached = dns_cache_lookup(tp->ip);
+        if (cached != NULL && cached->name != NULL) {
+            g_strlcpy(tp->name, cached->name, MAXNAMELEN);
+            tp->flags = tp->flags & ~DUMMY_ADDRESS_ENTRY;
+            return tp;
+        }
+
 #ifdef ASYNC_DNS
-        if (gbl_resolv_flags.concurrent_dns &&
+        if (cached == NULL && gbl_resolv_flags.concurrent_dns &&
                 name_resolve_concurrency > 0 &&
                 async_dns_initialized) {
             add_async_dns_ipv4(AF_INET, addr);
@@ -912,6 +1162,7 @@ static hashipv6_t *
 host_lookup6(const struct e_in6_addr *addr, gboolean *found)
 {
     hashipv6_t * volatile tp;
+    const dns_cache_entry_t *cached;
 #ifdef INET6
 #ifdef HAVE_C_ARES
     async_dns_queue_msg_t *caqm;
@@ -928,6 +1179,10 @@ host_lookup6(const struct e_in6_addr *addr, gboolean *found)
         tp = new_ipv6(addr);
         memcpy(addr_key, addr, 16);
         g_hash_table_insert(ipv6_hash_table, addr_key, tp);
+        if (hosts_db_lookup(RESOLV_DB_IPV6, (const guint8 *)addr, tp->name)) {
+            tp->flags = tp->flags | TRIED_RESOLVE_ADDRESS;
+            return tp;
+        }
     }else{
         if ((tp->flags & DUMMY_AND_RESOLVE_FLGS) ==  DUMMY_ADDRESS_ENTRY){
             goto try_resolv;
@@ -942,16 +1197,23 @@ try_resolv:
     if (gbl_resolv_flags.network_name &&
             gbl_resolv_flags.use_external_net_name_resolver) {
         tp->flags = tp->flags|TRIED_RESOLVE_ADDRESS;
+
+        cached = dns_cache_lookup(tp->ip6);
+        if (cached != NULL && cached->name != NULL) {
+            g_strlcpy(tp->name, cached->name, MAXNAMELEN);
+            tp->flags = tp->flags & ~DUMMY_ADDRESS_ENTRY;
+            return tp;
+        }
 #ifdef INET6
 
 #ifdef HAVE_C_ARES
-        if ((gbl_resolv_flags.concurrent_dns) &&
+        if (cached == NULL && (gbl_resolv_flags.concurrent_dns) &&
                 name_resolve_concurrency > 0 &&
                 async_dns_initialized) {
             caqm = g_new(async_dns_queue_msg_t,1);
             caqm->family = AF_INET6;
             memcpy(&caqm->addr.ip6, addr, sizeof(caqm->addr.ip6));
-            async_dns_queue_head = g_list_append(async_dns_queue_head, (gpointer) caqm);
+            g_queue_push_tail(&async_dns_queue, (gpointer) caqm);
 
             /* XXX found is set to TRUE, which seems a bit odd, but I'm not
              * going to risk changing the semantics.
@@ -1167,7 +1429,7 @@ parse_ether_line(char *line, ether_t *eth, unsigned int *mask,
 static FILE *eth_p = NULL;
 
 static void
-set_ethent(char *path)
+set_ethent(const char *path)
 {
     if (eth_p)
         rewind(eth_p);
@@ -1232,20 +1494,59 @@ get_ethbyname(const gchar *name)
 } /* get_ethbyname */
 #endif
 
+/* Compile an ethers file; the first entry for an address is the one used */
+static gboolean
+parse_ethers_file(resolv_db_builder *builder, const char *path)
+{
+    ether_t *eth;
+
+    end_ethent();
+    set_ethent(path);
+    if (eth_p == NULL)
+        return FALSE;
+
+    while ((eth = get_ethent(NULL, FALSE)) != NULL)
+        resolv_db_builder_add(builder, RESOLV_DB_ETHER, eth->addr, eth->name);
+
+    end_ethent();
+    return TRUE;
+}
+
+static ether_t *
+get_ethbyaddr_db(const resolv_db *db, const guint8 *addr)
+{
+    static ether_t eth;
+    const char *name;
+
+    if ((name = resolv_db_lookup(db, RESOLV_DB_ETHER, addr)) == NULL)
+        return NULL;
+
+    memcpy(eth.addr, addr, 6);
+    g_strlcpy(eth.name, name, MAXNAMELEN);
+    return &eth;
+}
+
 static ether_t *
 get_ethbyaddr(const guint8 *addr)
 {
 
     ether_t *eth;
 
-    set_ethent(g_pethers_path);
+    if (pethers_db != NULL) {
+        eth = get_ethbyaddr_db(pethers_db, addr);
+    } else {
+        set_ethent(g_pethers_path);
 
-    while (((eth = get_ethent(NULL, FALSE)) != NULL) && memcmp(addr, eth->addr, 6) != 0)
-        ;
+        while (((eth = get_ethent(NULL, FALSE)) != NULL) && memcmp(addr, eth->addr, 6) != 0)
+            ;
+    }
 
     if (eth == NULL) {
         end_ethent();
 
+        if (ethers_db != NULL)
+            return get_ethbyaddr_db(ethers_db, addr);
+
         set_ethent(g_ethers_path);
 
         while (((eth = get_ethent(NULL, FALSE)) != NULL) && memcmp(addr, eth->addr, 6) != 0)
@@ -1299,12 +1600,28 @@ add_manuf_name(const guint8 *addr, unsigned int mask, gchar *name)
 
 } /* add_manuf_name */
 
-static gchar *
+/* Look up the manufacturer for the OUI in the low 3 octets of manuf_key */
+static const gchar *
+manuf_key_lookup(int manuf_key)
+{
+    guint8 oui[3];
+
+    if (manuf_db != NULL) {
+        oui[0] = (manuf_key >> 16) & 0xFF;
+        oui[1] = (manuf_key >> 8) & 0xFF;
+        oui[2] = manuf_key & 0xFF;
+        return resolv_db_lookup(manuf_db, RESOLV_DB_MANUF, oui);
+    }
+
+    return (const gchar *)g_hash_table_lookup(manuf_hashtable, &manuf_key);
+}
+
+static const gchar *
 manuf_name_lookup(const guint8 *addr)
 {
     gint32       manuf_key = 0;
     guint8       oct;
-    gchar        *name;
+    const gchar *name;
 
     /* manuf needs only the 3 most significant octets of the ethernet address */
     manuf_key = addr[0];
@@ -1317,7 +1634,7 @@ manuf_name_lookup(const guint8 *addr)
 
 
     /* first try to find a "perfect match" */
-    name = (gchar *)g_hash_table_lookup(manuf_hashtable, &manuf_key);
+    name = manuf_key_lookup(manuf_key);
     if(name != NULL){
         return name;
     }
@@ -1329,7 +1646,7 @@ manuf_name_lookup(const guint8 *addr)
      * 0x02 locally administered bit */
     if((manuf_key & 0x00010000) != 0){
         manuf_key &= 0x00FEFFFF;
-        name = (gchar *)g_hash_table_lookup(manuf_hashtable, &manuf_key);
+        name = manuf_key_lookup(manuf_key);
         if(name != NULL){
             return name;
         }
@@ -1339,15 +1656,14 @@ manuf_name_lookup(const guint8 *addr)
 
 } /* manuf_name_lookup */
 
-static gchar *
+static const gchar *
 wka_name_lookup(const guint8 *addr, const unsigned int mask)
 {
     guint8     masked_addr[6];
     guint      num;
     gint       i;
-    gchar     *name;
 
-    if(wka_hashtable == NULL){
+    if(wka_hashtable == NULL && manuf_db == NULL){
         return NULL;
     }
     /* Get the part of the address covered by the mask. */
@@ -1360,9 +1676,10 @@ wka_name_lookup(const guint8 *addr, const unsigned int mask)
     for (; i < 6; i++)
         masked_addr[i] = 0;
 
-    name = (gchar *)g_hash_table_lookup(wka_hashtable, masked_addr);
+    if (manuf_db != NULL)
+        return resolv_db_lookup(manuf_db, RESOLV_DB_WKA, masked_addr);
 
-    return name;
+    return (const gchar *)g_hash_table_lookup(wka_hashtable, masked_addr);
 
 } /* wka_name_lookup */
 
@@ -1378,6 +1695,32 @@ eth_addr_cmp(gconstpointer a, gconstpointer b)
     return (memcmp(a, b, 6) == 0);
 }
 
+/* Compile the manuf file; as with add_manuf_name(), the last entry for an
+   address is the one used */
+static gboolean
+parse_manuf_file(resolv_db_builder *builder, const char *path)
+{
+    ether_t *eth;
+    guint    mask;
+
+    end_ethent();
+    set_ethent(path);
+    if (eth_p == NULL)
+        return FALSE;
+
+    while ((eth = get_ethent(&mask, TRUE))) {
+        if (mask >= 48)
+            resolv_db_builder_add(builder, RESOLV_DB_ETHER, eth->addr, eth->name);
+        else if (mask == 0)
+            resolv_db_builder_add(builder, RESOLV_DB_MANUF, eth->addr, eth->name);
+        else
+            resolv_db_builder_add(builder, RESOLV_DB_WKA, eth->addr, eth->name);
+    }
+
+    end_ethent();
+    return TRUE;
+}
+
 static void
 initialize_ethers(void)
 {
@@ -1402,17 +1745,26 @@ initialize_ethers(void)
     if (g_pethers_path == NULL)
         g_pethers_path = get_persconffile_path(ENAME_ETHERS, FALSE);
 
+    g_free(ethers_db_dir);
+    ethers_db_dir = g_strdup(resolv_db_dir);
+    pethers_db = get_resolv_db(g_pethers_path, TRUE, parse_ethers_file);
+    ethers_db = get_resolv_db(g_ethers_path, TRUE, parse_ethers_file);
+
     /* Compute the pathname of the manuf file */
     manuf_path = get_datafile_path(ENAME_MANUF);
 
-    /* Read it and initialize the hash table */
-    set_ethent(manuf_path);
+    /* Use its compiled form if we can, otherwise read it and initialize
+       the hash tables */
+    manuf_db = get_resolv_db(manuf_path, FALSE, parse_manuf_file);
+    if (manuf_db == NULL) {
+        set_ethent(manuf_path);
 
-    while ((eth = get_ethent(&mask, TRUE))) {
-        add_manuf_name(eth->addr, mask, eth->name);
-    }
+        while ((eth = get_ethent(&mask, TRUE))) {
+            add_manuf_name(eth->addr, mask, eth->name);
+        }
 
-    end_ethent();
+        end_ethent();
+    }
 
     g_free(manuf_path);
 
@@ -1437,6 +1789,15 @@ eth_name_lookup_cleanup(void)
         eth_hashtable = NULL;
     }
 
+    resolv_db_close(manuf_db);
+    manuf_db = NULL;
+    resolv_db_close(ethers_db);
+    ethers_db = NULL;
+    resolv_db_close(pethers_db);
+    pethers_db = NULL;
+    g_free(ethers_db_dir);
+    ethers_db_dir = NULL;
+
 }
 
 /* Resolve ethernet address */
@@ -1444,6 +1805,16 @@ static hashether_t *
 eth_addr_resolve(hashether_t *tp) {
     ether_t      *eth;
     const guint8 *addr = tp->addr;
+    const gchar  *wka;
+
+    /* Well-known addresses from the manuf file come first, as they do
+       when they're put straight into the Ethernet hash table */
+    if (manuf_db != NULL &&
+            (wka = resolv_db_lookup(manuf_db, RESOLV_DB_ETHER, addr)) != NULL) {
+        g_strlcpy(tp->resolved_name, wka, MAXNAMELEN);
+        tp->status = HASHETHER_STATUS_RESOLVED_NAME;
+        return tp;
+    }
 
     if ( (eth = get_ethbyaddr(addr)) != NULL) {
         g_strlcpy(tp->resolved_name, eth->name, MAXNAMELEN);
@@ -1451,7 +1822,7 @@ eth_addr_resolve(hashether_t *tp) {
         return tp;
     } else {
         guint         mask;
-        gchar        *name;
+        const gchar  *name;
 
         /* Unknown name.  Try looking for it in the well-known-address
            tables for well-known address ranges smaller than 2^24. */
@@ -1931,15 +2302,32 @@ ipxnet_addr_lookup(const gchar *name _U_, gboolean *success)
 #endif
 } /* ipxnet_addr_lookup */
 
+/* Add a hosts file entry to the hash tables, or to builder if it's
+   being compiled */
+static void
+add_hosts_entry(resolv_db_builder *builder, const guint32 *host_addr,
+        gboolean is_ipv6, const gchar *name)
+{
+    struct e_in6_addr ip6_addr;
+
+    if (builder != NULL) {
+        resolv_db_builder_add(builder, is_ipv6 ? RESOLV_DB_IPV6 : RESOLV_DB_IPV4,
+                (const guint8 *)host_addr, name);
+    } else if (is_ipv6) {
+        memcpy(&ip6_addr, host_addr, sizeof ip6_addr);
+        add_ipv6_name(&ip6_addr, name);
+    } else
+        add_ipv4_name(host_addr[0], name);
+}
+
 static gboolean
-read_hosts_file (const char *hostspath)
+parse_hosts_file(resolv_db_builder *builder, const char *hostspath)
 {
     FILE *hf;
     char *line = NULL;
     int size = 0;
     gchar *cp;
     guint32 host_addr[4]; /* IPv4 or IPv6 */
-    struct e_in6_addr ip6_addr;
     gboolean is_ipv6;
     int ret;
 
@@ -1973,28 +2361,35 @@ read_hosts_file (const char *hostspath)
         if ((cp = strtok(NULL, " \t")) == NULL)
             continue; /* no host name */
 
-        if (is_ipv6) {
-            memcpy(&ip6_addr, host_addr, sizeof ip6_addr);
-            add_ipv6_name(&ip6_addr, cp);
-        } else
-            add_ipv4_name(host_addr[0], cp);
+        add_hosts_entry(builder, host_addr, is_ipv6, cp);
 
         /*
          * Add the aliases, too, if there are any.
          * XXX - host_lookup() only returns the first entry.
          */
         while ((cp = strtok(NULL, " \t")) != NULL) {
-            if (is_ipv6) {
-                memcpy(&ip6_addr, host_addr, sizeof ip6_addr);
-                add_ipv6_name(&ip6_addr, cp);
-            } else
-                add_ipv4_name(host_addr[0], cp);
+            add_hosts_entry(builder, host_addr, is_ipv6, cp);
         }
     }
     g_free(line);
 
     fclose(hf);
     return TRUE;
+} /* parse_hosts_file */
+
+static gboolean
+read_hosts_file (const char *hostspath)
+{
+    resolv_db *db;
+
+    db = get_resolv_db(hostspath, FALSE, parse_hosts_file);
+    if (db == NULL)
+        return parse_hosts_file(NULL, hostspath);
+
+    if (hosts_dbs == NULL)
+        hosts_dbs = g_ptr_array_new();
+    g_ptr_array_add(hosts_dbs, db);
+    return TRUE;
 } /* read_hosts_file */
 
 gboolean
@@ -2342,6 +2737,15 @@ addr_resolve_pref_init(module_t *nameres)
             " your DNS server behave badly.",
             10,
             &name_resolve_concurrency);
+
+    prefs_register_uint_preference(nameres, "name_resolve_cache_ttl",
+            "Hours to remember DNS results",
+            "How long, in hours, the names found with DNS,"
+            " and the addresses found to have no name, are"
+            " remembered between sessions, so that they aren't"
+            " looked up again. 0 means they aren't remembered.",
+            10,
+            &name_resolve_cache_ttl);
 #else
     prefs_register_static_text_preference(nameres, "concurrent_dns",
             "Enable concurrent DNS name resolution: N/A",
@@ -2355,12 +2759,50 @@ addr_resolve_pref_init(module_t *nameres)
             " Checking this box only loads the \"hosts\" in the current profile.",
             &gbl_resolv_flags.load_hosts_file_from_profile_only);
 
+    prefs_register_directory_preference(nameres, "resolv_db_dir",
+            "Directory for compiled name resolution files",
+            "If set, the \"hosts\", \"manuf\" and \"ethers\" files are"
+            " compiled into sorted tables kept in this directory, and names"
+            " are looked up in those tables rather than in copies of the"
+            " files read into memory. A file is compiled again if it has"
+            " changed. Several processes can share the directory.",
+            &resolv_db_dir);
+}
+
+void
+addr_resolve_pref_apply(void)
+{
+    /* The hosts files are read again with each capture file; the
+       ethers and manuf files have to be reloaded now. */
+    if (ethers_db_dir != NULL && strcmp(ethers_db_dir, resolv_db_dir) != 0) {
+        eth_name_lookup_cleanup();
+        initialize_ethers();
+    }
 }
 
 #ifdef HAVE_C_ARES
+/* Submit queued lookups, as long as there aren't too many in flight */
+static void
+async_dns_submit(void)
+{
+    async_dns_queue_msg_t *caqm;
+
+    while (!g_queue_is_empty(&async_dns_queue) && async_dns_in_flight <= name_resolve_concurrency) {
+        caqm = (async_dns_queue_msg_t *) g_queue_pop_head(&async_dns_queue);
+        if (caqm->family == AF_INET) {
+            ares_gethostbyaddr(ghba_chan, &caqm->addr.ip4, sizeof(guint32), AF_INET,
+                    c_ares_ghba_cb, caqm);
+            async_dns_in_flight++;
+        } else if (caqm->family == AF_INET6) {
+            ares_gethostbyaddr(ghba_chan, &caqm->addr.ip6, sizeof(struct e_in6_addr),
+                    AF_INET6, c_ares_ghba_cb, caqm);
+            async_dns_in_flight++;
+        }
+    }
+}
+
 gboolean
 host_name_lookup_process(void) {
-    async_dns_queue_msg_t *caqm;
     struct timeval tv = { 0, 0 };
     int nfds;
     fd_set rfds, wfds;
@@ -2372,21 +2814,7 @@ host_name_lookup_process(void) {
         /* c-ares not initialized. Bail out and cancel timers. */
         return nro;
 
-    async_dns_queue_head = g_list_first(async_dns_queue_head);
-
-    while (async_dns_queue_head != NULL && async_dns_in_flight <= name_resolve_concurrency) {
-        caqm = (async_dns_queue_msg_t *) async_dns_queue_head->data;
-        async_dns_queue_head = g_list_remove(async_dns_queue_head, (void *) caqm);
-        if (caqm->family == AF_INET) {
-            ares_gethostbyaddr(ghba_chan, &caqm->addr.ip4, sizeof(guint32), AF_INET,
-                    c_ares_ghba_cb, caqm);
-            async_dns_in_flight++;
-        } else if (caqm->family == AF_INET6) {
-            ares_gethostbyaddr(ghba_chan, &caqm->addr.ip6, sizeof(struct e_in6_addr),
-                    AF_INET6, c_ares_ghba_cb, caqm);
-            async_dns_in_flight++;
-        }
-    }
+    async_dns_submit();
 
     FD_ZERO(&rfds);
     FD_ZERO(&wfds);
@@ -2403,18 +2831,45 @@ host_name_lookup_process(void) {
     return nro;
 }
 
-static void
-_host_name_lookup_cleanup(void) {
-    GList *cur;
+void
+host_name_lookup_wait(void) {
+    struct timeval tv, *tvp;
+    int nfds;
+    fd_set rfds, wfds;
 
-    cur = g_list_first(async_dns_queue_head);
-    while (cur) {
-        g_free(cur->data);
-        cur = g_list_next (cur);
+    if (!async_dns_initialized)
+        return;
+
+    for (;;) {
+        async_dns_submit();
+
+        FD_ZERO(&rfds);
+        FD_ZERO(&wfds);
+        nfds = ares_fds(ghba_chan, &rfds, &wfds);
+        if (nfds == 0) {
+            if (g_queue_is_empty(&async_dns_queue))
+                break;      /* nothing queued or in flight */
+            continue;       /* all of them were answered straight away */
+        }
+
+        /* Wait for answers, or until c-ares has to time a query out */
+        tvp = ares_timeout(ghba_chan, NULL, &tv);
+        if (select(nfds, &rfds, &wfds, NULL, tvp) == -1) {
+            if (errno == EINTR)
+                continue;
+            fprintf(stderr, "Warning: call to select() failed, error is %s\n", g_strerror(errno));
+            return;
+        }
+        ares_process(ghba_chan, &rfds, &wfds);
     }
+}
 
-    g_list_free(async_dns_queue_head);
-    async_dns_queue_head = NULL;
+static void
+_host_name_lookup_cleanup(void) {
+    async_dns_queue_msg_t *caqm;
+
+    while ((caqm = (async_dns_queue_msg_t *) g_queue_pop_head(&async_dns_queue)) != NULL)
+        g_free(caqm);
 
     if (async_dns_initialized) {
         ares_destroy(ghba_chan);
@@ -2434,7 +2889,7 @@ _host_name_lookup_cleanup(void) {
 gboolean
 host_name_lookup_process(void) {
     async_dns_queue_msg_t *almsg;
-    GList *cur;
+    GList *cur, *link;
     char addr_str[] = "111.222.333.444.in-addr.arpa.";
     guint8 *addr_bytes;
     adns_answer *ans;
@@ -2443,9 +2898,8 @@ host_name_lookup_process(void) {
     gboolean nro = new_resolved_objects;
 
     new_resolved_objects = FALSE;
-    async_dns_queue_head = g_list_first(async_dns_queue_head);
 
-    cur = async_dns_queue_head;
+    cur = async_dns_queue.head;
     while (cur &&  async_dns_in_flight <= name_resolve_concurrency) {
         almsg = (async_dns_queue_msg_t *) cur->data;
         if (! almsg->submitted && almsg->type == AF_INET) {
@@ -2460,7 +2914,7 @@ host_name_lookup_process(void) {
         cur = cur->next;
     }
 
-    cur = async_dns_queue_head;
+    cur = async_dns_queue.head;
     while (cur) {
         dequeue = FALSE;
         almsg = (async_dns_queue_msg_t *) cur->data;
@@ -2469,13 +2923,18 @@ host_name_lookup_process(void) {
             if (ret == 0) {
                 if (ans->status == adns_s_ok) {
                     add_ipv4_name(almsg->ip4_addr, *ans->rrs.str);
+                    dns_cache_add(AF_INET, &almsg->ip4_addr, *ans->rrs.str);
+                } else if (ans->status == adns_s_nxdomain ||
+                        ans->status == adns_s_nodata) {
+                    dns_cache_add(AF_INET, &almsg->ip4_addr, NULL);
                 }
                 dequeue = TRUE;
             }
         }
+        link = cur;
         cur = cur->next;
         if (dequeue) {
-            async_dns_queue_head = g_list_remove(async_dns_queue_head, (void *) almsg);
+            g_queue_delete_link(&async_dns_queue, link);
             g_free(almsg);
             /* XXX, what to do if async_dns_in_flight == 0? */
             async_dns_in_flight--;
@@ -2486,16 +2945,32 @@ host_name_lookup_process(void) {
     return nro;
 }
 
+void
+host_name_lookup_wait(void) {
+    gboolean nro = new_resolved_objects;
+
+    if (!async_dns_initialized)
+        return;
+
+    /* ADNS can't wait for whichever of several queries is answered
+       first, so poll */
+    while (!g_queue_is_empty(&async_dns_queue)) {
+        if (host_name_lookup_process())
+            nro = TRUE;
+        if (!g_queue_is_empty(&async_dns_queue))
+            g_usleep(10 * 1000);
+    }
+
+    /* Leave the news for the next host_name_lookup_process() call */
+    new_resolved_objects = nro;
+}
+
 static void
 _host_name_lookup_cleanup(void) {
     void *qdata;
 
-    async_dns_queue_head = g_list_first(async_dns_queue_head);
-    while (async_dns_queue_head) {
-        qdata = async_dns_queue_head->data;
-        async_dns_queue_head = g_list_remove(async_dns_queue_head, qdata);
+    while ((qdata = g_queue_pop_head(&async_dns_queue)) != NULL)
         g_free(qdata);
-    }
 
     if (async_dns_initialized)
         adns_finish(ads);
@@ -2513,6 +2988,10 @@ host_name_lookup_process(void) {
     return nro;
 }
 
+void
+host_name_lookup_wait(void) {
+}
+
 static void
 _host_name_lookup_cleanup(void) {
 }
@@ -2669,6 +3148,8 @@ host_name_lookup_init(void)
     g_assert(ipv6_hash_table == NULL);
     ipv6_hash_table = g_hash_table_new_full(ipv6_oat_hash, ipv6_equal, g_free, g_free);
 
+    dns_cache_init();
+
     /*
      * Load the global hosts file, if we have one.
      */
@@ -2765,10 +3246,17 @@ host_name_lookup_init(void)
     add_manually_resolved();
 }
 
+static void
+close_resolv_db(gpointer data, gpointer user_data _U_)
+{
+    resolv_db_close((resolv_db *)data);
+}
+
 void
 host_name_lookup_cleanup(void)
 {
     _host_name_lookup_cleanup();
+    dns_cache_cleanup();
 
     if(ipxnet_hash_table){
         g_hash_table_destroy(ipxnet_hash_table);
@@ -2785,6 +3273,12 @@ host_name_lookup_cleanup(void)
         ipv6_hash_table = NULL;
     }
 
+    if(hosts_dbs){
+        g_ptr_array_foreach(hosts_dbs, close_resolv_db, NULL);
+        g_ptr_array_free(hosts_dbs, TRUE);
+        hosts_dbs = NULL;
+    }
+
     memset(subnet_length_entries, 0, sizeof(subnet_length_entries));
 
     have_subnet_entry = FALSE;
@@ -3028,7 +3522,7 @@ get_ipxnet_addr(const gchar *name, gboolean *known)
 const gchar *
 get_manuf_name(const guint8 *addr)
 {
-    gchar *cur;
+    const gchar *cur;
     int manuf_key;
     guint8 oct;
 
@@ -3041,7 +3535,7 @@ get_manuf_name(const guint8 *addr)
     oct = addr[2];
     manuf_key = manuf_key | oct;
 
-    if (!gbl_resolv_flags.mac_name || ((cur = (gchar *)g_hash_table_lookup(manuf_hashtable, &manuf_key)) == NULL)) {
+    if (!gbl_resolv_flags.mac_name || ((cur = manuf_key_lookup(manuf_key)) == NULL)) {
         cur=ep_strdup_printf("%02x:%02x:%02x", addr[0], addr[1], addr[2]);
         return cur;
     }
@@ -3070,7 +3564,7 @@ tvb_get_manuf_name(tvbuff_t *tvb, gint offset)
 const gchar *
 get_manuf_name_if_known(const guint8 *addr)
 {
-    gchar  *cur;
+    const gchar *cur;
     int manuf_key;
     guint8 oct;
 
@@ -3083,7 +3577,7 @@ get_manuf_name_if_known(const guint8 *addr)
     oct = addr[2];
     manuf_key = manuf_key | oct;
 
-    if ((cur = (gchar *)g_hash_table_lookup(manuf_hashtable, &manuf_key)) == NULL) {
+    if ((cur = manuf_key_lookup(manuf_key)) == NULL) {
         return NULL;
     }
 
@@ -3094,9 +3588,9 @@ get_manuf_name_if_known(const guint8 *addr)
 const gchar *
 uint_get_manuf_name_if_known(const guint manuf_key)
 {
-    gchar  *cur;
+    const gchar *cur;
 
-    if ((cur = (gchar *)g_hash_table_lookup(manuf_hashtable, &manuf_key)) == NULL) {
+    if ((cur = manuf_key_lookup(manuf_key)) == NULL) {
         return NULL;
     }
 
@@ -3112,7 +3606,8 @@ tvb_get_manuf_name_if_known(tvbuff_t *tvb, gint offset)
 const gchar *
 ep_eui64_to_display(const guint64 addr_eui64)
 {
-    gchar *cur, *name;
+    gchar *cur;
+    const gchar *name;
     guint8 *addr = (guint8 *)ep_alloc(8);
 
     /* Copy and convert the address to network byte order. */
@@ -3131,7 +3626,8 @@ ep_eui64_to_display(const guint64 addr_eui64)
 const gchar *
 ep_eui64_to_display_if_known(const guint64 addr_eui64)
 {
-    gchar *cur, *name;
+    gchar *cur;
+    const gchar *name;
     guint8 *addr = (guint8 *)ep_alloc(8);
 
     /* Copy and convert the address to network byte order. */
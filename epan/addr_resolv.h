@@ -161,6 +161,9 @@ const gchar *get_addr_name(const address *addr);
 struct pref_module;
 extern void addr_resolve_pref_init(struct pref_module *nameres);
 
+/* Apply changed name resolution preferences */
+extern void addr_resolve_pref_apply(void);
+
 /** If we're using c-ares or ADNS, process outstanding host name lookups.
  *  This is called from a GLIB timeout in Wireshark and before processing
  *  each packet in TShark.
@@ -170,6 +173,13 @@ extern void addr_resolve_pref_init(struct pref_module *nameres);
  */
 WS_DLL_PUBLIC gboolean host_name_lookup_process(void);
 
+/** If we're using c-ares or ADNS, wait until all the host name lookups
+ *  that have been queued have been answered or have timed out.  TShark
+ *  calls this between the passes of a two-pass analysis, so that the
+ *  second pass can show the names of all the addresses seen in the first.
+ */
+WS_DLL_PUBLIC void host_name_lookup_wait(void);
+
 /* get_hostname returns the host name or "%d.%d.%d.%d" if not found */
 WS_DLL_PUBLIC const gchar *get_hostname(const guint addr);
 
@@ -30,6 +30,7 @@
 #include "sna-utils.h"
 #include "atalk-utils.h"
 #include "to_str.h"
+#include "to_str-int.h"
 #include "packet_info.h"
 #include "wsutil/pint.h"
 #include "addr_resolv.h"
@@ -752,93 +753,143 @@ col_has_time_fmt(column_info *cinfo, const gint col)
           (cinfo->fmt_matx[col][COL_DELTA_TIME_DIS]));
 }
 
+typedef enum {
+  ABS_TIME_HMS,   /* hh:mm:ss */
+  ABS_TIME_YMD,   /* YYYY-MM-DD hh:mm:ss */
+  ABS_TIME_YDOY,  /* YYYY/DOY hh:mm:ss */
+  NUM_ABS_TIME_FORMATS
+} abs_time_format_e;
+
+/*
+ * Consecutive packets are almost always in the same second, so for
+ * each format, in local time and in UTC, we keep the date and time of
+ * the last second we converted and formatted, and for each packet
+ * only format the fraction of a second.
+ */
+typedef struct {
+  gboolean valid;
+  time_t   secs;
+  gsize    len;
+  gchar    str[32];
+} abs_time_cache_t;
+
+static abs_time_cache_t abs_time_cache[NUM_ABS_TIME_FORMATS][2];
+
 static void
-set_abs_ymd_time(const frame_data *fd, gchar *buf, gboolean local)
+set_abs_time_common(const frame_data *fd, gchar *buf, abs_time_format_e format,
+                    gboolean local)
 {
-  struct tm *tmp;
-  time_t then;
+  abs_time_cache_t *cache = &abs_time_cache[format][local ? 1 : 0];
+  gchar   *p;
+  gchar    num[10];
+  gchar   *num_start;
+  guint32  frac;
+  int      digits;
+
+  if (!fd->flags.has_ts) {
+    buf[0] = '\0';
+    return;
+  }
+
+  if (!cache->valid || cache->secs != fd->abs_ts.secs) {
+    struct tm *tmp;
+    time_t then;
 
-  if (fd->flags.has_ts) {
     then = fd->abs_ts.secs;
     if (local)
       tmp = localtime(&then);
     else
       tmp = gmtime(&then);
-  } else
-    tmp = NULL;
-  if (tmp != NULL) {
-    switch (timestamp_get_precision()) {
-    case TS_PREC_FIXED_SEC:
-    case TS_PREC_AUTO_SEC:
-      g_snprintf(buf, COL_MAX_LEN,"%04d-%02d-%02d %02d:%02d:%02d",
-        tmp->tm_year + 1900,
-        tmp->tm_mon + 1,
-        tmp->tm_mday,
+    if (tmp == NULL) {
+      cache->valid = FALSE;
+      buf[0] = '\0';
+      return;
+    }
+
+    switch (format) {
+    case ABS_TIME_HMS:
+      g_snprintf(cache->str, sizeof cache->str, "%02d:%02d:%02d",
         tmp->tm_hour,
         tmp->tm_min,
         tmp->tm_sec);
       break;
-    case TS_PREC_FIXED_DSEC:
-    case TS_PREC_AUTO_DSEC:
-      g_snprintf(buf, COL_MAX_LEN,"%04d-%02d-%02d %02d:%02d:%02d.%01d",
-        tmp->tm_year + 1900,
-        tmp->tm_mon + 1,
-        tmp->tm_mday,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 100000000);
-      break;
-    case TS_PREC_FIXED_CSEC:
-    case TS_PREC_AUTO_CSEC:
-      g_snprintf(buf, COL_MAX_LEN,"%04d-%02d-%02d %02d:%02d:%02d.%02d",
-        tmp->tm_year + 1900,
-        tmp->tm_mon + 1,
-        tmp->tm_mday,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 10000000);
-      break;
-    case TS_PREC_FIXED_MSEC:
-    case TS_PREC_AUTO_MSEC:
-      g_snprintf(buf, COL_MAX_LEN, "%04d-%02d-%02d %02d:%02d:%02d.%03d",
-        tmp->tm_year + 1900,
-        tmp->tm_mon + 1,
-        tmp->tm_mday,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 1000000);
-      break;
-    case TS_PREC_FIXED_USEC:
-    case TS_PREC_AUTO_USEC:
-      g_snprintf(buf, COL_MAX_LEN, "%04d-%02d-%02d %02d:%02d:%02d.%06d",
+    case ABS_TIME_YMD:
+      g_snprintf(cache->str, sizeof cache->str, "%04d-%02d-%02d %02d:%02d:%02d",
         tmp->tm_year + 1900,
         tmp->tm_mon + 1,
         tmp->tm_mday,
         tmp->tm_hour,
         tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 1000);
+        tmp->tm_sec);
       break;
-    case TS_PREC_FIXED_NSEC:
-    case TS_PREC_AUTO_NSEC:
-      g_snprintf(buf, COL_MAX_LEN, "%04d-%02d-%02d %02d:%02d:%02d.%09d",
+    case ABS_TIME_YDOY:
+      g_snprintf(cache->str, sizeof cache->str, "%04d/%03d %02d:%02d:%02d",
         tmp->tm_year + 1900,
-        tmp->tm_mon + 1,
-        tmp->tm_mday,
+        tmp->tm_yday + 1,
         tmp->tm_hour,
         tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs);
+        tmp->tm_sec);
       break;
     default:
       g_assert_not_reached();
     }
-  } else {
-    buf[0] = '\0';
+    cache->len = strlen(cache->str);
+    cache->secs = fd->abs_ts.secs;
+    cache->valid = TRUE;
+  }
+
+  switch (timestamp_get_precision()) {
+  case TS_PREC_FIXED_SEC:
+  case TS_PREC_AUTO_SEC:
+    digits = 0;
+    frac = 0;
+    break;
+  case TS_PREC_FIXED_DSEC:
+  case TS_PREC_AUTO_DSEC:
+    digits = 1;
+    frac = fd->abs_ts.nsecs / 100000000;
+    break;
+  case TS_PREC_FIXED_CSEC:
+  case TS_PREC_AUTO_CSEC:
+    digits = 2;
+    frac = fd->abs_ts.nsecs / 10000000;
+    break;
+  case TS_PREC_FIXED_MSEC:
+  case TS_PREC_AUTO_MSEC:
+    digits = 3;
+    frac = fd->abs_ts.nsecs / 1000000;
+    break;
+  case TS_PREC_FIXED_USEC:
+  case TS_PREC_AUTO_USEC:
+    digits = 6;
+    frac = fd->abs_ts.nsecs / 1000;
+    break;
+  case TS_PREC_FIXED_NSEC:
+  case TS_PREC_AUTO_NSEC:
+    digits = 9;
+    frac = fd->abs_ts.nsecs;
+    break;
+  default:
+    g_assert_not_reached();
+    digits = 0;
+    frac = 0;
   }
+
+  memcpy(buf, cache->str, cache->len);
+  p = buf + cache->len;
+  if (digits != 0) {
+    *p++ = '.';
+    num_start = uint_to_str_back_len(num + sizeof num, frac, digits);
+    memcpy(p, num_start, num + sizeof num - num_start);
+    p += num + sizeof num - num_start;
+  }
+  *p = '\0';
+}
+
+static void
+set_abs_ymd_time(const frame_data *fd, gchar *buf, gboolean local)
+{
+  set_abs_time_common(fd, buf, ABS_TIME_YMD, local);
 }
 
 static void
@@ -864,84 +915,7 @@ col_set_utc_ymd_time(const frame_data *fd, column_info *cinfo, const int col)
 static void
 set_abs_ydoy_time(const frame_data *fd, gchar *buf, gboolean local)
 {
-  struct tm *tmp;
-  time_t then;
-
-  if (fd->flags.has_ts) {
-    then = fd->abs_ts.secs;
-    if (local)
-      tmp = localtime(&then);
-    else
-      tmp = gmtime(&then);
-  } else
-    tmp = NULL;
-  if (tmp != NULL) {
-    switch (timestamp_get_precision()) {
-    case TS_PREC_FIXED_SEC:
-    case TS_PREC_AUTO_SEC:
-      g_snprintf(buf, COL_MAX_LEN,"%04d/%03d %02d:%02d:%02d",
-        tmp->tm_year + 1900,
-        tmp->tm_yday + 1,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec);
-      break;
-    case TS_PREC_FIXED_DSEC:
-    case TS_PREC_AUTO_DSEC:
-      g_snprintf(buf, COL_MAX_LEN,"%04d/%03d %02d:%02d:%02d.%01d",
-        tmp->tm_year + 1900,
-        tmp->tm_yday + 1,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 100000000);
-      break;
-    case TS_PREC_FIXED_CSEC:
-    case TS_PREC_AUTO_CSEC:
-      g_snprintf(buf, COL_MAX_LEN,"%04d/%03d %02d:%02d:%02d.%02d",
-        tmp->tm_year + 1900,
-        tmp->tm_yday + 1,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 10000000);
-      break;
-    case TS_PREC_FIXED_MSEC:
-    case TS_PREC_AUTO_MSEC:
-      g_snprintf(buf, COL_MAX_LEN, "%04d/%03d %02d:%02d:%02d.%03d",
-        tmp->tm_year + 1900,
-        tmp->tm_yday + 1,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 1000000);
-      break;
-    case TS_PREC_FIXED_USEC:
-    case TS_PREC_AUTO_USEC:
-      g_snprintf(buf, COL_MAX_LEN, "%04d/%03d %02d:%02d:%02d.%06d",
-        tmp->tm_year + 1900,
-        tmp->tm_yday + 1,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 1000);
-      break;
-    case TS_PREC_FIXED_NSEC:
-    case TS_PREC_AUTO_NSEC:
-      g_snprintf(buf, COL_MAX_LEN, "%04d/%03d %02d:%02d:%02d.%09d",
-        tmp->tm_year + 1900,
-        tmp->tm_yday + 1,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs);
-      break;
-    default:
-      g_assert_not_reached();
-    }
-  } else {
-    buf[0] = '\0';
-  }
+  set_abs_time_common(fd, buf, ABS_TIME_YDOY, local);
 }
 
 static void
@@ -1241,73 +1215,7 @@ col_set_delta_time_dis(const frame_data *fd, column_info *cinfo, const int col)
 static void
 set_abs_time(const frame_data *fd, gchar *buf, gboolean local)
 {
-  struct tm *tmp;
-  time_t then;
-
-  if (fd->flags.has_ts) {
-    then = fd->abs_ts.secs;
-    if (local)
-      tmp = localtime(&then);
-    else
-      tmp = gmtime(&then);
-  } else
-    tmp = NULL;
-  if (tmp != NULL) {
-    switch (timestamp_get_precision()) {
-    case TS_PREC_FIXED_SEC:
-    case TS_PREC_AUTO_SEC:
-      g_snprintf(buf, COL_MAX_LEN,"%02d:%02d:%02d",
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec);
-      break;
-    case TS_PREC_FIXED_DSEC:
-    case TS_PREC_AUTO_DSEC:
-      g_snprintf(buf, COL_MAX_LEN,"%02d:%02d:%02d.%01d",
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 100000000);
-      break;
-    case TS_PREC_FIXED_CSEC:
-    case TS_PREC_AUTO_CSEC:
-      g_snprintf(buf, COL_MAX_LEN,"%02d:%02d:%02d.%02d",
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 10000000);
-      break;
-    case TS_PREC_FIXED_MSEC:
-    case TS_PREC_AUTO_MSEC:
-      g_snprintf(buf, COL_MAX_LEN,"%02d:%02d:%02d.%03d",
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 1000000);
-      break;
-    case TS_PREC_FIXED_USEC:
-    case TS_PREC_AUTO_USEC:
-      g_snprintf(buf, COL_MAX_LEN,"%02d:%02d:%02d.%06d",
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 1000);
-      break;
-    case TS_PREC_FIXED_NSEC:
-    case TS_PREC_AUTO_NSEC:
-      g_snprintf(buf, COL_MAX_LEN, "%02d:%02d:%02d.%09d",
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs);
-      break;
-    default:
-      g_assert_not_reached();
-    }
-
-  } else {
-    *buf = '\0';
-  }
+  set_abs_time_common(fd, buf, ABS_TIME_HMS, local);
 }
 
 static void
@@ -552,48 +552,17 @@ add_conversation_table_data(conv_hash_t *ch, const address *src, const address *
     add_conversation_table_data_with_conv_id(ch, src, dst, src_port, dst_port, CONV_ID_UNSET, num_frames, num_bytes, ts, abs_ts, ct_info, ptype);
 }
 
-void
-add_conversation_table_data_with_conv_id(
-    conv_hash_t *ch,
-    const address *src,
-    const address *dst,
-    guint32 src_port,
-    guint32 dst_port,
-    conv_id_t conv_id,
-    int num_frames,
-    int num_bytes,
-    nstime_t *ts,
-    nstime_t *abs_ts,
-    ct_dissector_info_t *ct_info,
-    port_type ptype)
+/*
+ * Find the conversation between addr1:port1 and addr2:port2, in that
+ * order, adding it if it's not there yet.
+ */
+static conv_item_t *
+get_conversation_item(conv_hash_t *ch, const address *addr1, const address *addr2, guint32 port1, guint32 port2,
+        conv_id_t conv_id, nstime_t *ts, nstime_t *abs_ts, ct_dissector_info_t *ct_info, port_type ptype)
 {
-    const address *addr1, *addr2;
-    guint32 port1, port2;
     conv_item_t *conv_item = NULL;
     unsigned int conversation_idx = 0;
 
-    if (src_port > dst_port) {
-        addr1 = src;
-        addr2 = dst;
-        port1 = src_port;
-        port2 = dst_port;
-    } else if (src_port < dst_port) {
-        addr2 = src;
-        addr1 = dst;
-        port2 = src_port;
-        port1 = dst_port;
-    } else if (CMP_ADDRESS(src, dst) < 0) {
-        addr1 = src;
-        addr2 = dst;
-        port1 = src_port;
-        port2 = dst_port;
-    } else {
-        addr2 = src;
-        addr1 = dst;
-        port2 = src_port;
-        port1 = dst_port;
-    }
-
     /* if we don't have any entries at all yet */
     if (ch->conv_array == NULL) {
         ch->conv_array = g_array_sized_new(FALSE, FALSE, sizeof(conv_item_t), 10000);
@@ -659,6 +628,52 @@ add_conversation_table_data_with_conv_id(
         g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(conversation_idx));
     }
 
+    return conv_item;
+}
+
+void
+add_conversation_table_data_with_conv_id(
+    conv_hash_t *ch,
+    const address *src,
+    const address *dst,
+    guint32 src_port,
+    guint32 dst_port,
+    conv_id_t conv_id,
+    int num_frames,
+    int num_bytes,
+    nstime_t *ts,
+    nstime_t *abs_ts,
+    ct_dissector_info_t *ct_info,
+    port_type ptype)
+{
+    const address *addr1, *addr2;
+    guint32 port1, port2;
+    conv_item_t *conv_item;
+
+    if (src_port > dst_port) {
+        addr1 = src;
+        addr2 = dst;
+        port1 = src_port;
+        port2 = dst_port;
+    } else if (src_port < dst_port) {
+        addr2 = src;
+        addr1 = dst;
+        port2 = src_port;
+        port1 = dst_port;
+    } else if (CMP_ADDRESS(src, dst) < 0) {
+        addr1 = src;
+        addr2 = dst;
+        port1 = src_port;
+        port2 = dst_port;
+    } else {
+        addr2 = src;
+        addr1 = dst;
+        port2 = src_port;
+        port1 = dst_port;
+    }
+
+    conv_item = get_conversation_item(ch, addr1, addr2, port1, port2, conv_id, ts, abs_ts, ct_info, ptype);
+
     /* update the conversation struct */
     conv_item->modified = TRUE;
     if ( (!CMP_ADDRESS(src, addr1)) && (!CMP_ADDRESS(dst, addr2)) && (src_port==port1) && (dst_port==port2) ) {
@@ -679,6 +694,41 @@ add_conversation_table_data_with_conv_id(
     }
 }
 
+void
+merge_conversation_table(conv_hash_t *ch, const conv_hash_t *src)
+{
+    guint i;
+
+    if (src->conv_array == NULL)
+        return;
+
+    for (i = 0; i < src->conv_array->len; i++) {
+        conv_item_t *src_item = &g_array_index(src->conv_array, conv_item_t, i);
+        conv_item_t *conv_item;
+
+        /* The source table has already put the addresses in key order */
+        conv_item = get_conversation_item(ch, &src_item->src_address, &src_item->dst_address,
+                src_item->src_port, src_item->dst_port, src_item->conv_id, NULL, NULL,
+                src_item->dissector_info, src_item->ptype);
+
+        conv_item->modified = TRUE;
+        conv_item->tx_frames += src_item->tx_frames;
+        conv_item->tx_bytes += src_item->tx_bytes;
+        conv_item->rx_frames += src_item->rx_frames;
+        conv_item->rx_bytes += src_item->rx_bytes;
+
+        if (!nstime_is_unset(&src_item->start_time) &&
+            (nstime_is_unset(&conv_item->start_time) || nstime_cmp(&src_item->start_time, &conv_item->start_time) < 0)) {
+            conv_item->start_time = src_item->start_time;
+            conv_item->start_abs_time = src_item->start_abs_time;
+        }
+        if (!nstime_is_unset(&src_item->stop_time) &&
+            (nstime_is_unset(&conv_item->stop_time) || nstime_cmp(&src_item->stop_time, &conv_item->stop_time) > 0)) {
+            conv_item->stop_time = src_item->stop_time;
+        }
+    }
+}
+
 /*
  * Compute the hash value for a given address/port pairs if the match
  * is to be exact.
@@ -714,8 +764,11 @@ host_match(gconstpointer v, gconstpointer w)
     return 0;
 }
 
-void
-add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboolean sender, int num_frames, int num_bytes, hostlist_dissector_info_t *host_info, port_type port_type_val)
+/*
+ * Find the talker addr:port, adding it if it's not there yet.
+ */
+static hostlist_talker_t *
+get_hostlist_talker(conv_hash_t *ch, const address *addr, guint32 port, hostlist_dissector_info_t *host_info, port_type port_type_val)
 {
     hostlist_talker_t *talker=NULL;
     int talker_idx=0;
@@ -769,6 +822,16 @@ add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboo
         g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(talker_idx));
     }
 
+    return talker;
+}
+
+void
+add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboolean sender, int num_frames, int num_bytes, hostlist_dissector_info_t *host_info, port_type port_type_val)
+{
+    hostlist_talker_t *talker;
+
+    talker = get_hostlist_talker(ch, addr, port, host_info, port_type_val);
+
     /* if this is a new talker we need to initialize the struct */
     talker->modified = TRUE;
 
@@ -782,6 +845,29 @@ add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboo
     }
 }
 
+void
+merge_hostlist_table(conv_hash_t *ch, const conv_hash_t *src)
+{
+    guint i;
+
+    if (src->conv_array == NULL)
+        return;
+
+    for (i = 0; i < src->conv_array->len; i++) {
+        hostlist_talker_t *src_talker = &g_array_index(src->conv_array, hostlist_talker_t, i);
+        hostlist_talker_t *talker;
+
+        talker = get_hostlist_talker(ch, &src_talker->myaddress, src_talker->port,
+                src_talker->dissector_info, src_talker->ptype);
+
+        talker->modified = TRUE;
+        talker->tx_frames += src_talker->tx_frames;
+        talker->tx_bytes += src_talker->tx_bytes;
+        talker->rx_frames += src_talker->rx_frames;
+        talker->rx_bytes += src_talker->rx_bytes;
+    }
+}
+
 /*
  * Editor modelines
  *
@@ -304,7 +304,7 @@ WS_DLL_PUBLIC const char *get_hostlist_filter(hostlist_talker_t *host);
  * @param ct_info callback handlers from the dissector
  * @param ptype the port type (e.g. PT_TCP)
  */
-extern void add_conversation_table_data(conv_hash_t *ch, const address *src, const address *dst,
+WS_DLL_PUBLIC void add_conversation_table_data(conv_hash_t *ch, const address *src, const address *dst,
             guint32 src_port, guint32 dst_port, int num_frames, int num_bytes, nstime_t *ts, nstime_t *abs_ts,
             ct_dissector_info_t *ct_info, port_type ptype);
 
@@ -339,9 +339,24 @@ add_conversation_table_data_with_conv_id(conv_hash_t *ch, const address *src, co
  * @param num_frames number of packets
  * @param num_bytes number of bytes
  */
-void add_hostlist_table_data(conv_hash_t *ch, const address *addr,
+WS_DLL_PUBLIC void add_hostlist_table_data(conv_hash_t *ch, const address *addr,
                              guint32 port, gboolean sender, int num_frames, int num_bytes, hostlist_dissector_info_t *host_info, port_type port_type_val);
 
+/** Add the conversations of another table to this one, e.g. one that was
+ *  filled in from another part of the same capture.
+ *
+ * @param ch the table to add the data to
+ * @param src the table to add the data from
+ */
+WS_DLL_PUBLIC void merge_conversation_table(conv_hash_t *ch, const conv_hash_t *src);
+
+/** Add the hosts of another table to this one.
+ *
+ * @param ch the table to add the data to
+ * @param src the table to add the data from
+ */
+WS_DLL_PUBLIC void merge_hostlist_table(conv_hash_t *ch, const conv_hash_t *src);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -512,11 +512,33 @@ static int st_node_resp_400 = -1;
 static int st_node_resp_500 = -1;
 static int st_node_other = -1;
 
+/* the node of each valid response code (100-599), once seen, by tree */
+#define ST_N_RESP_CODES 500
+static GHashTable *st_resp_code_nodes = NULL;
+
+static int *
+http_stats_tree_resp_codes(stats_tree* st)
+{
+	int *resp_code_nodes;
+
+	if (st_resp_code_nodes == NULL)
+		st_resp_code_nodes = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+
+	resp_code_nodes = (int *)g_hash_table_lookup(st_resp_code_nodes, st);
+	if (resp_code_nodes == NULL) {
+		resp_code_nodes = g_new(int, ST_N_RESP_CODES);
+		g_hash_table_insert(st_resp_code_nodes, st, resp_code_nodes);
+	}
+	return resp_code_nodes;
+}
 
 /* HTTP/Packet Counter stats init function */
 static void
 http_stats_tree_init(stats_tree* st)
 {
+	int *resp_code_nodes;
+	guint i;
+
 	st_node_packets = stats_tree_create_node(st, st_str_packets, 0, TRUE);
 	st_node_requests = stats_tree_create_pivot(st, st_str_requests, st_node_packets);
 	st_node_responses = stats_tree_create_node(st, st_str_responses, st_node_packets, TRUE);
@@ -527,6 +549,18 @@ http_stats_tree_init(stats_tree* st)
 	st_node_resp_400    = stats_tree_create_node(st, st_str_resp_400,    st_node_responses, TRUE);
 	st_node_resp_500    = stats_tree_create_node(st, st_str_resp_500,    st_node_responses, TRUE);
 	st_node_other = stats_tree_create_node(st, st_str_other, st_node_packets,FALSE);
+
+	resp_code_nodes = http_stats_tree_resp_codes(st);
+	for (i = 0; i < ST_N_RESP_CODES; i++)
+		resp_code_nodes[i] = -1;
+}
+
+/* HTTP/Packet Counter stats cleanup function */
+static void
+http_stats_tree_cleanup(stats_tree* st)
+{
+	if (st_resp_code_nodes != NULL)
+		g_hash_table_remove(st_resp_code_nodes, st);
 }
 
 /* HTTP/Packet Counter stats packet function */
@@ -536,43 +570,49 @@ http_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* e
 	const http_info_value_t* v = (const http_info_value_t*)p;
 	guint i = v->response_code;
 	int resp_grp;
-	const gchar *resp_str;
+	int *resp_node = NULL;
+	int resp_code_node;
 	gchar str[64];
 
-	tick_stat_node(st, st_str_packets, 0, FALSE);
+	tick_stat_node_id(st, st_node_packets);
 
 	if (i) {
-		tick_stat_node(st, st_str_responses, st_node_packets, FALSE);
+		tick_stat_node_id(st, st_node_responses);
 
 		if ( (i<100)||(i>=600) ) {
 			resp_grp = st_node_resp_broken;
-			resp_str = st_str_resp_broken;
 		} else if (i<200) {
 			resp_grp = st_node_resp_100;
-			resp_str = st_str_resp_100;
 		} else if (i<300) {
 			resp_grp = st_node_resp_200;
-			resp_str = st_str_resp_200;
 		} else if (i<400) {
 			resp_grp = st_node_resp_300;
-			resp_str = st_str_resp_300;
 		} else if (i<500) {
 			resp_grp = st_node_resp_400;
-			resp_str = st_str_resp_400;
 		} else {
 			resp_grp = st_node_resp_500;
-			resp_str = st_str_resp_500;
 		}
 
-		tick_stat_node(st, resp_str, st_node_responses, FALSE);
+		tick_stat_node_id(st, resp_grp);
+
+		if (resp_grp != st_node_resp_broken)
+			resp_node = &http_stats_tree_resp_codes(st)[i-100];
+
+		if (resp_node == NULL || *resp_node < 0) {
+			g_snprintf(str, sizeof(str), "%u %s", i,
+				   val_to_str(i, vals_status_code, "Unknown (%d)"));
+			resp_code_node = stats_tree_get_node_id(st, str, resp_grp, FALSE);
+			if (resp_node)
+				*resp_node = resp_code_node;
+		} else {
+			resp_code_node = *resp_node;
+		}
 
-		g_snprintf(str, sizeof(str), "%u %s", i,
-			   val_to_str(i, vals_status_code, "Unknown (%d)"));
-		tick_stat_node(st, str, resp_grp, FALSE);
+		tick_stat_node_id(st, resp_code_node);
 	} else if (v->request_method) {
 		stats_tree_tick_pivot(st,st_node_requests,v->request_method);
 	} else {
-		tick_stat_node(st, st_str_other, st_node_packets, FALSE);
+		tick_stat_node_id(st, st_node_other);
 	}
 
 	return 1;
@@ -3261,7 +3301,7 @@ proto_reg_handoff_http(void)
 	ntlmssp_handle = find_dissector("ntlmssp");
 	gssapi_handle = find_dissector("gssapi");
 
-	stats_tree_register("http", "http",     "HTTP/Packet Counter",   0, http_stats_tree_packet,      http_stats_tree_init, NULL );
+	stats_tree_register("http", "http",     "HTTP/Packet Counter",   0, http_stats_tree_packet,      http_stats_tree_init, http_stats_tree_cleanup );
 	stats_tree_register("http", "http_req", "HTTP/Requests",         0, http_req_stats_tree_packet,  http_req_stats_tree_init, NULL );
 	stats_tree_register("http", "http_srv", "HTTP/Load Distribution",0, http_reqs_stats_tree_packet, http_reqs_stats_tree_init, NULL );
 
@@ -964,13 +964,36 @@ pdu_store_window_scale_option(guint8 ws, struct tcp_analysis *tcpd)
         tcpd->fwd->win_scale=ws;
 }
 
+/*
+ * Per-frame sequence analysis results.
+ *
+ * Nearly every frame carries at most one TCP segment, so the tcp_acked
+ * structure of the first segment in a frame is kept in the frame's own
+ * proto data; finding it again when the frame is redissected is then a
+ * short list walk instead of a walk down a three-level tree.  It's only
+ * added to frames that have analysis results at all.  The tcp_acked
+ * structures of any other segments in the frame (tunnels, duplicated
+ * segments, ...) go into the conversation's acked_table.
+ */
+typedef struct {
+    struct tcp_analysis *tcpd;
+    struct tcp_acked *ta;
+    guint32 seq;
+    guint32 ack;
+} tcp_frame_acked_t;
+
+/* Key of the tcp_frame_acked_t in the frame's proto data; the
+   tcp_per_packet_data_t is under key 0 */
+#define TCP_FRAME_ACKED_KEY 1
+
 /* when this function returns, it will (if createflag) populate the ta pointer.
  */
 static void
-tcp_analyze_get_acked_struct(guint32 frame, guint32 seq, guint32 ack, gboolean createflag, struct tcp_analysis *tcpd)
+tcp_analyze_get_acked_struct(packet_info *pinfo, guint32 seq, guint32 ack, gboolean createflag, struct tcp_analysis *tcpd)
 {
-
+    tcp_frame_acked_t *fa;
     wmem_tree_key_t key[4];
+    guint32 frame = pinfo->fd->num;
 
     key[0].length = 1;
     key[0].key = &frame;
@@ -988,6 +1011,26 @@ tcp_analyze_get_acked_struct(guint32 frame, guint32 seq, guint32 ack, gboolean c
         return;
     }
 
+    fa = (tcp_frame_acked_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_tcp, TCP_FRAME_ACKED_KEY);
+    if (fa == NULL) {
+        /* This is the first segment of the frame we've looked at */
+        tcpd->ta = NULL;
+        if (createflag) {
+            tcpd->ta = wmem_new0(wmem_file_scope(), struct tcp_acked);
+            fa = wmem_new(wmem_file_scope(), tcp_frame_acked_t);
+            fa->tcpd = tcpd;
+            fa->ta = tcpd->ta;
+            fa->seq = seq;
+            fa->ack = ack;
+            p_add_proto_data(wmem_file_scope(), pinfo, proto_tcp, TCP_FRAME_ACKED_KEY, fa);
+        }
+        return;
+    }
+    if (fa->tcpd == tcpd && fa->seq == seq && fa->ack == ack) {
+        tcpd->ta = fa->ta;
+        return;
+    }
+
     tcpd->ta = (struct tcp_acked *)wmem_tree_lookup32_array(tcpd->acked_table, key);
     if((!tcpd->ta) && createflag) {
         tcpd->ta = wmem_new0(wmem_file_scope(), struct tcp_acked);
@@ -1068,7 +1111,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     &&  seq==tcpd->fwd->nextseq
     &&  tcpd->rev->window==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_ZERO_WINDOW_PROBE;
         goto finished_fwd;
@@ -1081,7 +1124,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     if( window==0
     && (flags&(TH_RST|TH_FIN|TH_SYN))==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_ZERO_WINDOW;
     }
@@ -1099,7 +1142,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     &&  GT_SEQ(seq, tcpd->fwd->nextseq)
     &&  (flags&(TH_RST))==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_LOST_PACKET;
 
@@ -1117,7 +1160,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     &&  seq==(tcpd->fwd->nextseq-1)
     &&  (flags&(TH_SYN|TH_FIN|TH_RST))==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_KEEP_ALIVE;
     }
@@ -1133,7 +1176,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     &&  ack==tcpd->fwd->lastack
     &&  (flags&(TH_SYN|TH_FIN|TH_RST))==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_WINDOW_UPDATE;
     }
@@ -1151,7 +1194,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     &&  (seq+seglen)==(tcpd->rev->lastack+(tcpd->rev->window<<(tcpd->rev->win_scale==-2?0:tcpd->rev->win_scale)))
     &&  (flags&(TH_SYN|TH_FIN|TH_RST))==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_WINDOW_FULL;
     }
@@ -1169,7 +1212,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     && (tcpd->rev->lastsegmentflags&TCP_A_KEEP_ALIVE)
     &&  (flags&(TH_SYN|TH_FIN|TH_RST))==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_KEEP_ALIVE_ACK;
         goto finished_fwd;
@@ -1189,7 +1232,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     && (tcpd->rev->lastsegmentflags&TCP_A_ZERO_WINDOW_PROBE)
     &&  (flags&(TH_SYN|TH_FIN|TH_RST))==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_ZERO_WINDOW_PROBE_ACK;
         goto finished_fwd;
@@ -1208,7 +1251,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     &&  (flags&(TH_SYN|TH_FIN|TH_RST))==0 ) {
         tcpd->fwd->dupacknum++;
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_DUPLICATE_ACK;
         tcpd->ta->dupack_num=tcpd->fwd->dupacknum;
@@ -1237,7 +1280,7 @@ finished_fwd:
     &&  GT_SEQ(ack, tcpd->rev->maxseqtobeacked )
     &&  (flags&(TH_ACK))!=0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_ACK_LOST_PACKET;
         /* update 'max seq to be acked' in the other direction so we don't get
@@ -1283,7 +1326,7 @@ finished_fwd:
         &&  tcpd->rev->lastack==seq
         &&  t<20000000 ) {
             if(!tcpd->ta) {
-                tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+                tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
             }
             tcpd->ta->flags|=TCP_A_FAST_RETRANSMISSION;
             goto finished_checking_retransmission_type;
@@ -1298,7 +1341,7 @@ finished_fwd:
         if( t < ooo_thres
         && tcpd->fwd->nextseq != seq + seglen ) {
             if(!tcpd->ta) {
-                tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+                tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
             }
             tcpd->ta->flags|=TCP_A_OUT_OF_ORDER;
             goto finished_checking_retransmission_type;
@@ -1310,7 +1353,7 @@ finished_fwd:
          */
         if ( seq + seglen < tcpd->rev->lastack ) {
             if(!tcpd->ta){
-                tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+                tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
             }
             tcpd->ta->flags|=TCP_A_SPURIOUS_RETRANSMISSION;
             goto finished_checking_retransmission_type;
@@ -1318,7 +1361,7 @@ finished_fwd:
 
         /* Then it has to be a generic retransmission */
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_RETRANSMISSION;
         nstime_delta(&tcpd->ta->rto_ts, &pinfo->fd->abs_ts, &tcpd->fwd->nextseqtime);
@@ -1395,7 +1438,7 @@ finished_checking_retransmission_type:
 
         /* If this ack matches the segment, process accordingly */
         if(ack==ual->nextseq) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
             tcpd->ta->frame_acked=ual->frame;
             nstime_delta(&tcpd->ta->ts, &pinfo->fd->abs_ts, &ual->ts);
         }
@@ -1454,7 +1497,7 @@ finished_checking_retransmission_type:
 
         if (in_flight>0 && in_flight<2000000000) {
             if(!tcpd->ta) {
-                tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+                tcp_analyze_get_acked_struct(pinfo, seq, ack, TRUE, tcpd);
             }
             tcpd->ta->bytes_in_flight = in_flight;
         }
@@ -1679,7 +1722,7 @@ tcp_print_sequence_number_analysis(packet_info *pinfo, tvbuff_t *tvb, proto_tree
         return;
     }
     if(!tcpd->ta) {
-        tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, FALSE, tcpd);
+        tcp_analyze_get_acked_struct(pinfo, seq, ack, FALSE, tcpd);
     }
     ta=tcpd->ta;
     if(!ta) {
@@ -4347,7 +4390,7 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
             tcpd=get_tcp_conversation_data(conv,pinfo);
         }
         if(!tcpd->ta)
-            tcp_analyze_get_acked_struct(pinfo->fd->num, tcph->th_seq, tcph->th_ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, tcph->th_seq, tcph->th_ack, TRUE, tcpd);
         tcpd->ta->flags|=TCP_A_REUSED_PORTS;
     }
 
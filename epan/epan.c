@@ -48,6 +48,7 @@
 #include "emem.h"
 #include "wmem/wmem.h"
 #include "expert.h"
+#include "print.h"
 
 #ifdef HAVE_LUA
 #include <lua.h>
@@ -142,6 +143,7 @@ epan_cleanup(void)
 #endif
 	except_deinit();
 	addr_resolv_cleanup();
+	print_cleanup();
 
 	if (pinfo_pool_cache != NULL) {
 		wmem_destroy_allocator(pinfo_pool_cache);
@@ -29,13 +29,17 @@
 
 #include "config.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #include <glib.h>
 
+#include "geoip_db.h"
+
 #ifdef HAVE_GEOIP
 #include <GeoIP.h>
 #include <GeoIPCity.h>
 
-#include "geoip_db.h"
 #include "uat.h"
 #include "prefs.h"
 #include "value_string.h"
@@ -91,6 +95,128 @@ static guint num_geoip_db_paths = 0;
 static uat_t *geoip_db_paths_uat = NULL;
 UAT_DIRECTORYNAME_CB_DEF(geoip_mod, path, geoip_db_path_t)
 
+/*
+ * Cache of lookup results, so that an address seen in many packets, or
+ * shown again and again in the endpoint statistics, is only looked up in
+ * each database once.  The least recently used entries are dropped when
+ * there are more than geoip_cache_size of them.  The values are kept in
+ * a string chunk, which dedups them and keeps them for as long as the
+ * databases are open, so the pointers we return stay valid when their
+ * entries are dropped.
+ */
+typedef struct {
+    guint32 dbnum;
+    guint32 is_ipv6;
+    guint8  addr[16];           /* IPv4 addresses use the first 4 bytes */
+} geoip_cache_key_t;
+
+typedef struct {
+    geoip_cache_key_t key;      /* must be first */
+    const char *val;            /* NULL if the address isn't in the database */
+    GList      *lru_link;       /* in geoip_cache_lru */
+} geoip_cache_entry_t;
+
+static guint geoip_cache_size = 100000;
+static GHashTable *geoip_cache = NULL;
+static GQueue geoip_cache_lru = G_QUEUE_INIT;   /* most recently used first */
+static GStringChunk *geoip_vals = NULL;
+static guint64 geoip_cache_hits = 0;
+static guint64 geoip_cache_misses = 0;
+
+static guint
+geoip_cache_key_hash(gconstpointer key)
+{
+    const guint8 *p = (const guint8 *)key;
+    guint32 h = 2166136261U;
+    gsize i;
+
+    for (i = 0; i < sizeof (geoip_cache_key_t); i++) {
+        h ^= p[i];
+        h *= 16777619U;
+    }
+    return h;
+}
+
+static gboolean
+geoip_cache_key_equal(gconstpointer a, gconstpointer b)
+{
+    return memcmp(a, b, sizeof (geoip_cache_key_t)) == 0;
+}
+
+static void
+geoip_cache_clear(void)
+{
+    if (geoip_cache) {
+        g_hash_table_destroy(geoip_cache);
+        geoip_cache = NULL;
+    }
+    g_queue_clear(&geoip_cache_lru);
+    if (geoip_vals) {
+        g_string_chunk_free(geoip_vals);
+        geoip_vals = NULL;
+    }
+}
+
+/* Copy a value out of a database, or out of ephemeral memory */
+static const char *
+geoip_intern(const char *val)
+{
+    if (val == NULL)
+        return NULL;
+    if (geoip_vals == NULL)
+        geoip_vals = g_string_chunk_new(4096);
+    return g_string_chunk_insert_const(geoip_vals, val);
+}
+
+static geoip_cache_entry_t *
+geoip_cache_lookup(const geoip_cache_key_t *key)
+{
+    geoip_cache_entry_t *entry;
+
+    if (geoip_cache_size == 0 || geoip_cache == NULL) {
+        geoip_cache_misses++;
+        return NULL;
+    }
+
+    entry = (geoip_cache_entry_t *)g_hash_table_lookup(geoip_cache, key);
+    if (entry == NULL) {
+        geoip_cache_misses++;
+        return NULL;
+    }
+
+    geoip_cache_hits++;
+    if (entry->lru_link != geoip_cache_lru.head) {
+        g_queue_unlink(&geoip_cache_lru, entry->lru_link);
+        g_queue_push_head_link(&geoip_cache_lru, entry->lru_link);
+    }
+    return entry;
+}
+
+static void
+geoip_cache_insert(const geoip_cache_key_t *key, const char *val)
+{
+    geoip_cache_entry_t *entry;
+
+    if (geoip_cache_size == 0)
+        return;
+
+    if (geoip_cache == NULL)
+        geoip_cache = g_hash_table_new_full(geoip_cache_key_hash,
+                geoip_cache_key_equal, NULL, g_free);
+
+    while (geoip_cache_lru.length >= geoip_cache_size) {
+        entry = (geoip_cache_entry_t *)g_queue_pop_tail(&geoip_cache_lru);
+        g_hash_table_remove(geoip_cache, &entry->key);
+    }
+
+    entry = g_new(geoip_cache_entry_t, 1);
+    entry->key = *key;
+    entry->val = val;
+    g_queue_push_head(&geoip_cache_lru, entry);
+    entry->lru_link = geoip_cache_lru.head;
+    g_hash_table_insert(geoip_cache, &entry->key, entry);
+}
+
 
 /**
  * Scan a directory for GeoIP databases and load them
@@ -143,6 +269,7 @@ static void geoip_db_post_update_cb(void) {
     /* If we have old data, clear out the whole thing
      * and start again. TODO: Just update the ones that
      * have changed for efficiency's sake. */
+    geoip_cache_clear();
     if (geoip_dat_arr) {
         /* skip the last two, as they are fake */
         for (i = 0; i < geoip_db_num_dbs() - 2; i++) {
@@ -224,6 +351,15 @@ geoip_db_pref_init(module_t *nameres)
                 "Wireshark will look in each directory for files beginning\n"
                 "with \"Geo\" and ending with \".dat\".",
             geoip_db_paths_uat);
+
+    prefs_register_uint_preference(nameres,
+            "geoip_cache_size",
+            "GeoIP lookups to remember",
+            "The number of GeoIP lookup results, one for each address"
+            " and database, to keep so that the address isn't looked up"
+            " again. 0 turns this off.",
+            10,
+            &geoip_cache_size);
 }
 
 guint
@@ -269,6 +405,7 @@ geoip_db_lookup_latlon4(guint32 addr, float *lat, float *lon) {
                     if(gir) {
                         *lat = gir->latitude;
                         *lon = gir->longitude;
+                        GeoIPRecord_delete(gir);
                         return 0;
                     }
                     return -1;
@@ -305,11 +442,12 @@ db_val_to_utf_8(const char *val, GeoIP *gi) {
     return val;
 }
 
-const char *
-geoip_db_lookup_ipv4(guint dbnum, guint32 addr, const char *not_found) {
+/* Look addr up in database dbnum; returns NULL if it isn't there. */
+static const char *
+geoip_db_query_ipv4(guint dbnum, guint32 addr) {
     GeoIP *gi;
     GeoIPRecord *gir;
-    const char *raw_val, *ret = not_found;
+    const char *raw_val, *ret = NULL;
     char *val;
 
     gi = g_array_index(geoip_dat_arr, GeoIP *, dbnum);
@@ -331,6 +469,10 @@ geoip_db_lookup_ipv4(guint dbnum, guint32 addr, const char *not_found) {
                 } else if (gir && gir->city) {
                     ret = db_val_to_utf_8(gir->city, gi);
                 }
+                /* Copy the value before the record goes away */
+                ret = geoip_intern(ret);
+                if (gir)
+                    GeoIPRecord_delete(gir);
                 break;
 
             case GEOIP_ORG_EDITION:
@@ -374,7 +516,25 @@ geoip_db_lookup_ipv4(guint dbnum, guint32 addr, const char *not_found) {
                 break;
         }
     }
-    return ret;
+    return geoip_intern(ret);
+}
+
+const char *
+geoip_db_lookup_ipv4(guint dbnum, guint32 addr, const char *not_found) {
+    geoip_cache_key_t key;
+    geoip_cache_entry_t *entry;
+    const char *val;
+
+    memset(&key, 0, sizeof key);
+    key.dbnum = dbnum;
+    memcpy(key.addr, &addr, 4);
+    if ((entry = geoip_cache_lookup(&key)) != NULL) {
+        val = entry->val;
+    } else {
+        val = geoip_db_query_ipv4(dbnum, addr);
+        geoip_cache_insert(&key, val);
+    }
+    return val ? val : not_found;
 }
 
 #ifdef HAVE_GEOIP_V6
@@ -396,6 +556,7 @@ geoip_db_lookup_latlon6(geoipv6_t addr, float *lat, float *lon) {
                     if(gir) {
                         *lat = gir->latitude;
                         *lon = gir->longitude;
+                        GeoIPRecord_delete(gir);
                         return 0;
                     }
                     return -1;
@@ -414,17 +575,17 @@ geoip_db_lookup_latlon6(geoipv6_t addr _U_, float *lat _U_, float *lon _U_) {
 }
 #endif /* NUM_DB_TYPES */
 
-const char *
-geoip_db_lookup_ipv6(guint dbnum, struct e_in6_addr addr, const char *not_found) {
+static const char *
+geoip_db_query_ipv6(guint dbnum, const struct e_in6_addr *addr) {
     GeoIP *gi;
     geoipv6_t gaddr;
-    const char *raw_val, *ret = not_found;
+    const char *raw_val, *ret = NULL;
     char *val;
 #if NUM_DB_TYPES > 31
     GeoIPRecord *gir;
 #endif
 
-    memcpy(&gaddr, &addr, sizeof(addr));
+    memcpy(&gaddr, addr, sizeof(*addr));
 
     gi = g_array_index(geoip_dat_arr, GeoIP *, dbnum);
     if (gi) {
@@ -446,6 +607,9 @@ geoip_db_lookup_ipv6(guint dbnum, struct e_in6_addr addr, const char *not_found)
                 } else if (gir && gir->city) {
                     ret = db_val_to_utf_8(gir->city, gi);
                 }
+                ret = geoip_intern(ret);
+                if (gir)
+                    GeoIPRecord_delete(gir);
                 break;
 
             case GEOIP_ORG_EDITION_V6:
@@ -490,18 +654,112 @@ geoip_db_lookup_ipv6(guint dbnum, struct e_in6_addr addr, const char *not_found)
                 break;
         }
     }
-    return ret;
+    return geoip_intern(ret);
 }
 
 #else /* HAVE_GEOIP_V6 */
 
-const char *
-geoip_db_lookup_ipv6(guint dbnum _U_, struct e_in6_addr addr _U_, const char *not_found) {
-    return not_found;
+static const char *
+geoip_db_query_ipv6(guint dbnum _U_, const struct e_in6_addr *addr _U_) {
+    return NULL;
 }
 
 #endif /* HAVE_GEOIP_V6 */
 
+const char *
+geoip_db_lookup_ipv6(guint dbnum, struct e_in6_addr addr, const char *not_found) {
+    geoip_cache_key_t key;
+    geoip_cache_entry_t *entry;
+    const char *val;
+
+    memset(&key, 0, sizeof key);
+    key.dbnum = dbnum;
+    key.is_ipv6 = 1;
+    memcpy(key.addr, &addr, 16);
+    if ((entry = geoip_cache_lookup(&key)) != NULL) {
+        val = entry->val;
+    } else {
+        val = geoip_db_query_ipv6(dbnum, &addr);
+        geoip_cache_insert(&key, val);
+    }
+    return val ? val : not_found;
+}
+
+/* Order the indexes of the addresses in the bulk lookup functions by
+   address */
+static int
+ipv4_index_cmp(const void *a, const void *b, void *user_data) {
+    const guint32 *addrs = (const guint32 *)user_data;
+    guint32 addr_a = addrs[*(const guint *)a];
+    guint32 addr_b = addrs[*(const guint *)b];
+
+    return addr_a < addr_b ? -1 : (addr_a > addr_b ? 1 : 0);
+}
+
+static int
+ipv6_index_cmp(const void *a, const void *b, void *user_data) {
+    const struct e_in6_addr *addrs = (const struct e_in6_addr *)user_data;
+
+    return memcmp(&addrs[*(const guint *)a], &addrs[*(const guint *)b],
+            sizeof (struct e_in6_addr));
+}
+
+static guint *
+sorted_indexes(guint count, GCompareDataFunc cmp, gconstpointer addrs) {
+    guint *idx = g_new(guint, count);
+    guint i;
+
+    for (i = 0; i < count; i++)
+        idx[i] = i;
+    g_qsort_with_data(idx, (gint)count, sizeof (guint), cmp, (gpointer)addrs);
+    return idx;
+}
+
+void
+geoip_db_lookup_ipv4_bulk(guint dbnum, const guint32 *addrs, guint count,
+        const char **results, const char *not_found) {
+    guint *idx;
+    const char *val;
+    guint i;
+
+    if (count == 0)
+        return;
+
+    idx = sorted_indexes(count, ipv4_index_cmp, addrs);
+    for (i = 0; i < count; i++) {
+        val = geoip_db_lookup_ipv4(dbnum, addrs[idx[i]], not_found);
+        if (results)
+            results[idx[i]] = val;
+    }
+    g_free(idx);
+}
+
+void
+geoip_db_lookup_ipv6_bulk(guint dbnum, const struct e_in6_addr *addrs,
+        guint count, const char **results, const char *not_found) {
+    guint *idx;
+    const char *val;
+    guint i;
+
+    if (count == 0)
+        return;
+
+    idx = sorted_indexes(count, ipv6_index_cmp, addrs);
+    for (i = 0; i < count; i++) {
+        val = geoip_db_lookup_ipv6(dbnum, addrs[idx[i]], not_found);
+        if (results)
+            results[idx[i]] = val;
+    }
+    g_free(idx);
+}
+
+void
+geoip_db_cache_stats(guint64 *hits, guint64 *misses, guint *entries) {
+    *hits = geoip_cache_hits;
+    *misses = geoip_cache_misses;
+    *entries = geoip_cache_lru.length;
+}
+
 gchar *
 geoip_db_get_paths(void) {
     GString* path_str = NULL;
@@ -551,10 +809,39 @@ geoip_db_lookup_ipv4(guint dbnum _U_, guint32 addr _U_, const char *not_found) {
 }
 
 const char *
-geoip_db_lookup_ipv6(guint dbnum _U_, guint32 addr _U_, const char *not_found) {
+geoip_db_lookup_ipv6(guint dbnum _U_, struct e_in6_addr addr _U_, const char *not_found) {
     return not_found;
 }
 
+void
+geoip_db_lookup_ipv4_bulk(guint dbnum _U_, const guint32 *addrs _U_, guint count,
+        const char **results, const char *not_found) {
+    guint i;
+
+    if (results) {
+        for (i = 0; i < count; i++)
+            results[i] = not_found;
+    }
+}
+
+void
+geoip_db_lookup_ipv6_bulk(guint dbnum _U_, const struct e_in6_addr *addrs _U_,
+        guint count, const char **results, const char *not_found) {
+    guint i;
+
+    if (results) {
+        for (i = 0; i < count; i++)
+            results[i] = not_found;
+    }
+}
+
+void
+geoip_db_cache_stats(guint64 *hits, guint64 *misses, guint *entries) {
+    *hits = 0;
+    *misses = 0;
+    *entries = 0;
+}
+
 gchar *
 geoip_db_get_paths(void) {
     return g_strdup("");
@@ -74,7 +74,8 @@ WS_DLL_PUBLIC int geoip_db_type(guint dbnum);
  * @param addr IPv4 address to look up
  * @param not_found The string to return if the lookup fails. May be NULL.
  *
- * @return The database entry if found, else not_found. Return value must not be freed.
+ * @return The database entry if found, else not_found. Return value must not be freed;
+ * it remains valid until the database paths are changed.
  */
 WS_DLL_PUBLIC const char *geoip_db_lookup_ipv4(guint dbnum, guint32 addr, const char *not_found);
 
@@ -89,6 +90,37 @@ WS_DLL_PUBLIC const char *geoip_db_lookup_ipv4(guint dbnum, guint32 addr, const
  */
 WS_DLL_PUBLIC const char *geoip_db_lookup_ipv6(guint dbnum, struct e_in6_addr addr, const char *not_found);
 
+/**
+ * Look up several IPv4 addresses in a database.  They're looked up in
+ * address order, which is faster than looking them up in a random order,
+ * and the results are cached as with geoip_db_lookup_ipv4(), so this can
+ * also be used to load the cache before looking the addresses up one by
+ * one, e.g. for the rows of an endpoint table.
+ *
+ * @param dbnum Database index
+ * @param addrs IPv4 addresses to look up
+ * @param count Number of addresses
+ * @param results Filled in with the database entry for each address, or
+ * not_found. May be NULL.
+ * @param not_found The string to use if a lookup fails. May be NULL.
+ */
+WS_DLL_PUBLIC void geoip_db_lookup_ipv4_bulk(guint dbnum, const guint32 *addrs, guint count, const char **results, const char *not_found);
+
+/**
+ * Look up several IPv6 addresses in a database, as with
+ * geoip_db_lookup_ipv4_bulk().
+ */
+WS_DLL_PUBLIC void geoip_db_lookup_ipv6_bulk(guint dbnum, const struct e_in6_addr *addrs, guint count, const char **results, const char *not_found);
+
+/**
+ * Get the lookup cache's statistics
+ *
+ * @param hits Set to the number of lookups answered from the cache
+ * @param misses Set to the number of lookups that went to a database
+ * @param entries Set to the number of results in the cache
+ */
+WS_DLL_PUBLIC void geoip_db_cache_stats(guint64 *hits, guint64 *misses, guint *entries);
+
 /**
  * Get all configured paths
  *
@@ -44,6 +44,7 @@
 #include <epan/packet.h>
 #include <epan/prefs.h>
 #include <epan/proto.h>
+#include <epan/reassemble.h>
 #include <epan/strutil.h>
 #include <epan/column.h>
 #include "print.h"
@@ -1283,6 +1284,12 @@ static const enum_val_t st_sort_col_vals[] = {
     { NULL,      NULL,         0 }
 };
 
+static void
+protocols_callback(void)
+{
+    reassembly_set_memory_limit((guint64)prefs.reassembly_memory_limit * 1024 * 1024);
+}
+
 static void
 stats_callback(void)
 {
@@ -2365,6 +2372,17 @@ prefs_register_modules(void)
                                    "Enable Packet Editor",
                                    "Enable Packet Editor (Experimental)",
                                    &prefs.gui_packet_editor);
+
+    prefs_register_bool_preference(gui_module, "frame_index",
+                                   "Keep an index of capture files to open them faster",
+                                   "Write an index of the packets of each capture file that's read completely"
+                                   " to a file next to it, with \".wsidx\" appended to its name, and fill in the"
+                                   " packet list from it the next time the file is opened, if it hasn't changed;"
+                                   " the packets are then dissected in the background."
+                                   " Not used for compressed files, files with records other than packets and"
+                                   " interface descriptions, such as pcapng name resolution or interface statistics"
+                                   " blocks, or if a display filter is set or statistics are being gathered.",
+                                   &prefs.gui_frame_index);
     /* Console
      * These are preferences that can be read/written using the
      * preference module API.  These preferences still use their own
@@ -2458,7 +2476,7 @@ prefs_register_modules(void)
 
     /* Name Resolution */
     nameres_module = prefs_register_module(NULL, "nameres", "Name Resolution",
-        "Name Resolution", NULL, TRUE);
+        "Name Resolution", addr_resolve_pref_apply, TRUE);
     addr_resolve_pref_init(nameres_module);
     oid_pref_init(nameres_module);
 #ifdef HAVE_GEOIP
@@ -2574,13 +2592,21 @@ prefs_register_modules(void)
 
     /* Protocols */
     protocols_module = prefs_register_module(NULL, "protocols", "Protocols",
-                                             "Protocols", NULL, TRUE);
+                                             "Protocols", &protocols_callback, TRUE);
 
     prefs_register_bool_preference(protocols_module, "display_hidden_proto_items",
                                    "Display hidden protocol items",
                                    "Display all hidden protocol items in the packet list.",
                                    &prefs.display_hidden_proto_items);
 
+    prefs_register_uint_preference(protocols_module, "reassembly_memory_limit",
+                                   "Reassembly memory limit (MB)",
+                                   "Maximum amount of fragment and reassembled data kept in memory; "
+                                   "beyond that, the least recently used data is moved to a temporary "
+                                   "file. 0 means no limit.",
+                                   10,
+                                   &prefs.reassembly_memory_limit);
+
     /* Obsolete preferences
      * These "modules" were reorganized/renamed to correspond to their GUI
      * configuration screen within the preferences dialog
@@ -2979,6 +3005,7 @@ pre_init_prefs(void)
     prefs.gui_layout_content_3       = layout_pane_content_pbytes;
     prefs.gui_qt_language            = 0; /* (Auto-Detect) */
     prefs.gui_packet_editor          = FALSE;
+    prefs.gui_frame_index            = FALSE;
 
     prefs.col_list = NULL;
     for (i = 0; i < DEF_NUM_COLS; i++) {
@@ -3027,6 +3054,7 @@ pre_init_prefs(void)
     prefs.st_sort_defdescending = TRUE;
     prefs.st_sort_showfullname = FALSE;
     prefs.display_hidden_proto_items = FALSE;
+    prefs.reassembly_memory_limit = 0;
 
     prefs_pre_initialized = TRUE;
 }
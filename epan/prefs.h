@@ -203,6 +203,7 @@ typedef struct _e_prefs {
   guint        rtp_player_max_visible;
   guint        tap_update_interval;
   gboolean     display_hidden_proto_items;
+  guint        reassembly_memory_limit;
   gpointer     filter_expressions;/* Actually points to &head */
   gboolean     gui_update_enabled;
   software_update_channel_e gui_update_channel;
@@ -212,6 +213,7 @@ typedef struct _e_prefs {
   gboolean     unknown_colorfilters; /* unknown or obsolete color filter(s) */
   guint        gui_qt_language; /* Qt Translation language selection */
   gboolean     gui_packet_editor; /* Enable Packet Editor */
+  gboolean     gui_frame_index; /* Keep an index of the frames of capture files next to them */
   gboolean     st_enable_burstinfo;
   gboolean     st_burst_showcount;
   gint         st_burst_resolution;
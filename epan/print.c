@@ -63,13 +63,62 @@ typedef struct {
     epan_dissect_t      *edt;
 } print_data;
 
+/*
+ * Buffered writer used by the PDML, PSML and EK output routines.
+ *
+ * Those formats emit a handful of short attribute strings for every
+ * field, and escaping used to hand each character to stdio separately.
+ * Instead, output for a packet is collected in one large, reusable
+ * buffer that is written out with a single fwrite() when the packet is
+ * complete or the buffer fills up.
+ */
+#define OUTPUT_BUF_SIZE (128*1024)
+
+typedef struct {
+    FILE  *fh;
+    gsize  len;
+    gchar  data[OUTPUT_BUF_SIZE];
+} output_buf_t;
+
+/*
+ * Escaped forms of a field's abbreviation, computed the first time
+ * the field is written and then reused for every later occurrence.
+ */
+typedef struct {
+    gchar *pdml;        /* XML-escaped abbreviation */
+    gsize  pdml_len;
+    gchar *ek;          /* JSON-escaped key, with '.' mapped to '_' */
+    gsize  ek_len;
+} escaped_name_t;
+
 typedef struct {
     int             level;
-    FILE           *fh;
+    output_buf_t   *ob;
     GSList         *src_list;
     epan_dissect_t *edt;
 } write_pdml_data;
 
+typedef struct {
+    output_buf_t   *ob;
+    GSList         *src_list;
+    gboolean        first;      /* no member written yet in current object */
+} write_ek_data;
+
+/*
+ * The nodes for one key of an EK object; fields that occur more than
+ * once are written as one key with an array of values, as JSON
+ * objects shouldn't have duplicate keys.
+ */
+typedef struct {
+    header_field_info *hfinfo;
+    GPtrArray         *nodes;   /* proto_node *, in tree order */
+} ek_member_t;
+
+typedef struct {
+    GHashTable *by_name;        /* escaped EK key -> ek_member_t * */
+    GPtrArray  *members;        /* ek_member_t *, by first occurrence */
+} ek_members_t;
+
 typedef struct {
     output_fields_t *fields;
     epan_dissect_t  *edt;
@@ -91,21 +140,289 @@ GHashTable *output_only_tables = NULL;
 
 static gboolean write_headers = FALSE;
 
+static output_buf_t   *output_buf         = NULL;
+static escaped_name_t *escaped_names      = NULL;
+static guint           num_escaped_names  = 0;
+
+static const gchar hex_digits[] = "0123456789abcdef";
+
 static gchar *get_field_hex_value(GSList *src_list, field_info *fi);
 static void proto_tree_print_node(proto_node *node, gpointer data);
 static void proto_tree_write_node_pdml(proto_node *node, gpointer data);
 static const guint8 *get_field_data(GSList *src_list, field_info *fi);
-static void write_pdml_field_hex_value(write_pdml_data *pdata, field_info *fi);
+static void write_field_hex_value(output_buf_t *ob, GSList *src_list, field_info *fi);
+static void write_ek_members(write_ek_data *pdata, ek_members_t *members);
 static gboolean print_hex_data_buffer(print_stream_t *stream, const guchar *cp,
                                       guint length, packet_char_enc encoding);
 static void ps_clean_string(char *out, const char *in,
                             int outbuf_size);
-static void print_escaped_xml(FILE *fh, const char *unescaped_string);
 
-static void print_pdml_geninfo(proto_tree *tree, FILE *fh);
+static void print_pdml_geninfo(proto_tree *tree, output_buf_t *ob);
 
 static void proto_tree_get_node_field_values(proto_node *node, gpointer data);
 
+static void
+output_buf_flush(output_buf_t *ob)
+{
+    if (ob->len != 0) {
+        fwrite(ob->data, 1, ob->len, ob->fh);
+        ob->len = 0;
+    }
+}
+
+/*
+ * Start buffered output to "fh"; any output still pending for another
+ * file is written out first.
+ */
+static output_buf_t *
+output_buf_start(FILE *fh)
+{
+    if (output_buf == NULL) {
+        output_buf      = g_new(output_buf_t, 1);
+        output_buf->len = 0;
+    }
+    else if (output_buf->fh != fh) {
+        output_buf_flush(output_buf);
+    }
+    output_buf->fh = fh;
+    return output_buf;
+}
+
+static void
+output_buf_append(output_buf_t *ob, const gchar *str, gsize len)
+{
+    if (len > OUTPUT_BUF_SIZE - ob->len) {
+        output_buf_flush(ob);
+        if (len > OUTPUT_BUF_SIZE) {
+            /* Too big to buffer; write it straight through. */
+            fwrite(str, 1, len, ob->fh);
+            return;
+        }
+    }
+    memcpy(ob->data + ob->len, str, len);
+    ob->len += len;
+}
+
+static void
+output_buf_puts(output_buf_t *ob, const gchar *str)
+{
+    output_buf_append(ob, str, strlen(str));
+}
+
+static void
+output_buf_putc(output_buf_t *ob, gchar c)
+{
+    if (ob->len == OUTPUT_BUF_SIZE)
+        output_buf_flush(ob);
+    ob->data[ob->len++] = c;
+}
+
+static void
+output_buf_put_uint(output_buf_t *ob, guint32 val)
+{
+    gchar  digits[10];
+    gchar *p = digits + sizeof(digits);
+
+    do {
+        *--p = '0' + (val % 10);
+        val /= 10;
+    } while (val != 0);
+    output_buf_append(ob, p, (digits + sizeof(digits)) - p);
+}
+
+static void
+output_buf_put_int(output_buf_t *ob, gint32 val)
+{
+    if (val < 0) {
+        output_buf_putc(ob, '-');
+        output_buf_put_uint(ob, 0U - (guint32)val);
+    } else {
+        output_buf_put_uint(ob, (guint32)val);
+    }
+}
+
+/* Write "len" bytes as lower-case hex, directly into the buffer. */
+static void
+output_buf_put_hex_bytes(output_buf_t *ob, const guint8 *pd, gint len)
+{
+    gint   chunk, i;
+    gchar *p;
+
+    while (len > 0) {
+        chunk = MIN(len, OUTPUT_BUF_SIZE / 2);
+        if ((gsize)chunk * 2 > OUTPUT_BUF_SIZE - ob->len)
+            output_buf_flush(ob);
+        p = ob->data + ob->len;
+        for (i = 0; i < chunk; i++) {
+            *p++ = hex_digits[pd[i] >> 4];
+            *p++ = hex_digits[pd[i] & 0xf];
+        }
+        ob->len += chunk * 2;
+        pd      += chunk;
+        len     -= chunk;
+    }
+}
+
+/*
+ * Return the XML escape sequence for "c", or NULL if it can be written
+ * as is.  "tmp" must be able to hold at least 5 characters.
+ */
+static const gchar *
+xml_escape_char(gchar c, gchar *tmp)
+{
+    switch (c) {
+    case '&':
+        return "&amp;";
+    case '<':
+        return "&lt;";
+    case '>':
+        return "&gt;";
+    case '"':
+        return "&quot;";
+    case '\'':
+        return "&apos;";
+    default:
+        if (g_ascii_isprint(c))
+            return NULL;
+        /* Same as "\\x%x" */
+        tmp[0] = '\\';
+        tmp[1] = 'x';
+        if ((guint8)c >= 0x10) {
+            tmp[2] = hex_digits[(guint8)c >> 4];
+            tmp[3] = hex_digits[(guint8)c & 0xf];
+            tmp[4] = '\0';
+        } else {
+            tmp[2] = hex_digits[(guint8)c];
+            tmp[3] = '\0';
+        }
+        return tmp;
+    }
+}
+
+/*
+ * Return the JSON escape sequence for "c", or NULL if it can be written
+ * as is.  "tmp" must be able to hold at least 7 characters.
+ */
+static const gchar *
+json_escape_char(gchar c, gchar *tmp)
+{
+    switch (c) {
+    case '"':
+        return "\\\"";
+    case '\\':
+        return "\\\\";
+    case '\n':
+        return "\\n";
+    case '\r':
+        return "\\r";
+    case '\t':
+        return "\\t";
+    default:
+        if ((guint8)c >= 0x20)
+            return NULL;
+        tmp[0] = '\\';
+        tmp[1] = 'u';
+        tmp[2] = '0';
+        tmp[3] = '0';
+        tmp[4] = hex_digits[(guint8)c >> 4];
+        tmp[5] = hex_digits[(guint8)c & 0xf];
+        tmp[6] = '\0';
+        return tmp;
+    }
+}
+
+/*
+ * Write "str", escaped with "escape_char".  Runs of characters that
+ * need no escaping are copied in one go.
+ */
+static void
+output_buf_put_escaped(output_buf_t *ob, const gchar *str,
+                       const gchar *(*escape_char)(gchar, gchar *))
+{
+    const gchar *run = str;
+    const gchar *p;
+    const gchar *esc;
+    gchar        tmp[8];
+
+    for (p = str; *p != '\0'; p++) {
+        esc = escape_char(*p, tmp);
+        if (esc == NULL)
+            continue;
+        output_buf_append(ob, run, p - run);
+        output_buf_puts(ob, esc);
+        run = p + 1;
+    }
+    output_buf_append(ob, run, p - run);
+}
+
+#define output_buf_put_escaped_xml(ob, str)  output_buf_put_escaped(ob, str, xml_escape_char)
+#define output_buf_put_escaped_json(ob, str) output_buf_put_escaped(ob, str, json_escape_char)
+
+static gchar *
+escape_string(const gchar *str, gchar dot_replacement,
+              const gchar *(*escape_char)(gchar, gchar *), gsize *len)
+{
+    GString     *escaped = g_string_sized_new(strlen(str) + 8);
+    const gchar *p;
+    const gchar *esc;
+    gchar        tmp[8];
+
+    for (p = str; *p != '\0'; p++) {
+        if (*p == '.' && dot_replacement != '\0') {
+            g_string_append_c(escaped, dot_replacement);
+            continue;
+        }
+        esc = escape_char(*p, tmp);
+        if (esc != NULL)
+            g_string_append(escaped, esc);
+        else
+            g_string_append_c(escaped, *p);
+    }
+    *len = escaped->len;
+    return g_string_free(escaped, FALSE);
+}
+
+void
+print_cleanup(void)
+{
+    guint i;
+
+    for (i = 0; i < num_escaped_names; i++) {
+        g_free(escaped_names[i].pdml);
+        g_free(escaped_names[i].ek);
+    }
+    g_free(escaped_names);
+    escaped_names = NULL;
+    num_escaped_names = 0;
+
+    /* Everything written has been flushed at the end of its packet. */
+    g_free(output_buf);
+    output_buf = NULL;
+}
+
+/* Look up (and create, on first use) the escaped names for a field. */
+static const escaped_name_t *
+get_escaped_name(header_field_info *hfinfo)
+{
+    escaped_name_t *name;
+    guint           new_num;
+
+    if ((guint)hfinfo->id >= num_escaped_names) {
+        new_num = MAX((guint)hfinfo->id + 1, num_escaped_names * 2);
+        escaped_names = g_renew(escaped_name_t, escaped_names, new_num);
+        memset(escaped_names + num_escaped_names, 0,
+               (new_num - num_escaped_names) * sizeof(escaped_name_t));
+        num_escaped_names = new_num;
+    }
+
+    name = &escaped_names[hfinfo->id];
+    if (name->pdml == NULL) {
+        name->pdml = escape_string(hfinfo->abbrev, '\0', xml_escape_char, &name->pdml_len);
+        name->ek   = escape_string(hfinfo->abbrev, '_', json_escape_char, &name->ek_len);
+    }
+    return name;
+}
+
 static FILE *
 open_print_dest(gboolean to_file, const char *dest)
 {
@@ -270,19 +587,44 @@ proto_tree_write_pdml(epan_dissect_t *edt, FILE *fh)
 
     /* Create the output */
     data.level    = 0;
-    data.fh       = fh;
+    data.ob       = output_buf_start(fh);
     data.src_list = edt->pi.data_src;
     data.edt      = edt;
 
-    fprintf(fh, "<packet>\n");
+    output_buf_puts(data.ob, "<packet>\n");
 
     /* Print a "geninfo" protocol as required by PDML */
-    print_pdml_geninfo(edt->tree, fh);
+    print_pdml_geninfo(edt->tree, data.ob);
 
     proto_tree_children_foreach(edt->tree, proto_tree_write_node_pdml,
                                 &data);
 
-    fprintf(fh, "</packet>\n\n");
+    output_buf_puts(data.ob, "</packet>\n\n");
+    output_buf_flush(data.ob);
+}
+
+static void
+write_pdml_indent(output_buf_t *ob, int level)
+{
+    int i;
+
+    for (i = -1; i < level; i++) {
+        output_buf_append(ob, "  ", 2);
+    }
+}
+
+/* Write out the size and pos attributes of a field */
+static void
+write_pdml_size_pos(output_buf_t *ob, proto_node *node, field_info *fi)
+{
+    output_buf_puts(ob, "\" size=\"");
+    output_buf_put_int(ob, fi->length);
+    output_buf_puts(ob, "\" pos=\"");
+    if (node->parent && node->parent->finfo && (fi->start < node->parent->finfo->start)) {
+        output_buf_put_int(ob, node->parent->finfo->start + fi->start);
+    } else {
+        output_buf_put_int(ob, fi->start);
+    }
 }
 
 /* Write out a tree's data, and any child nodes, as PDML */
@@ -291,10 +633,11 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
 {
     field_info      *fi    = PNODE_FINFO(node);
     write_pdml_data *pdata = (write_pdml_data*) data;
+    output_buf_t    *ob    = pdata->ob;
     const gchar     *label_ptr;
     gchar            label_str[ITEM_LABEL_LENGTH];
     char            *dfilter_string;
-    int              i;
+    const escaped_name_t *name;
     gboolean         wrap_in_fake_protocol;
 
     /* dissection with an invisible proto tree? */
@@ -308,19 +651,15 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
          (pdata->level == 0));
 
     /* Indent to the correct level */
-    for (i = -1; i < pdata->level; i++) {
-        fputs("  ", pdata->fh);
-    }
+    write_pdml_indent(ob, pdata->level);
 
     if (wrap_in_fake_protocol) {
         /* Open fake protocol wrapper */
-        fputs("<proto name=\"fake-field-wrapper\">\n", pdata->fh);
+        output_buf_puts(ob, "<proto name=\"fake-field-wrapper\">\n");
 
         /* Indent to increased level before writing out field */
         pdata->level++;
-        for (i = -1; i < pdata->level; i++) {
-            fputs("  ", pdata->fh);
-        }
+        write_pdml_indent(ob, pdata->level);
     }
 
     /* Text label. It's printed as a field with no name. */
@@ -334,25 +673,20 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
         }
 
         /* Show empty name since it is a required field */
-        fputs("<field name=\"", pdata->fh);
-        fputs("\" show=\"", pdata->fh);
-        print_escaped_xml(pdata->fh, label_ptr);
+        output_buf_puts(ob, "<field name=\"");
+        output_buf_puts(ob, "\" show=\"");
+        output_buf_put_escaped_xml(ob, label_ptr);
 
-        fprintf(pdata->fh, "\" size=\"%d", fi->length);
-        if (node->parent && node->parent->finfo && (fi->start < node->parent->finfo->start)) {
-            fprintf(pdata->fh, "\" pos=\"%d", node->parent->finfo->start + fi->start);
-        } else {
-            fprintf(pdata->fh, "\" pos=\"%d", fi->start);
-        }
+        write_pdml_size_pos(ob, node, fi);
 
-        fputs("\" value=\"", pdata->fh);
-        write_pdml_field_hex_value(pdata, fi);
+        output_buf_puts(ob, "\" value=\"");
+        write_field_hex_value(ob, pdata->src_list, fi);
 
         if (node->first_child != NULL) {
-            fputs("\">\n", pdata->fh);
+            output_buf_puts(ob, "\">\n");
         }
         else {
-            fputs("\"/>\n", pdata->fh);
+            output_buf_puts(ob, "\"/>\n");
         }
     }
 
@@ -361,19 +695,20 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
     else if (fi->hfinfo->id == proto_data) {
 
         /* Write out field with data */
-        fputs("<field name=\"data\" value=\"", pdata->fh);
-        write_pdml_field_hex_value(pdata, fi);
-        fputs("\">\n", pdata->fh);
+        output_buf_puts(ob, "<field name=\"data\" value=\"");
+        write_field_hex_value(ob, pdata->src_list, fi);
+        output_buf_puts(ob, "\">\n");
     }
     /* Normal protocols and fields */
     else {
         if ((fi->hfinfo->type == FT_PROTOCOL) && (fi->hfinfo->id != proto_expert)) {
-            fputs("<proto name=\"", pdata->fh);
+            output_buf_puts(ob, "<proto name=\"");
         }
         else {
-            fputs("<field name=\"", pdata->fh);
+            output_buf_puts(ob, "<field name=\"");
         }
-        print_escaped_xml(pdata->fh, fi->hfinfo->abbrev);
+        name = get_escaped_name(fi->hfinfo);
+        output_buf_append(ob, name->pdml, name->pdml_len);
 
 #if 0
         /* PDML spec, see:
@@ -389,30 +724,25 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
          * (like it's contained in the fi->rep->representation).
          * Unfortunately, we don't have the field data representation for
          * all fields, so this isn't currently possible */
-        fputs("\" showname=\"", pdata->fh);
-        print_escaped_xml(pdata->fh, fi->hfinfo->name);
+        output_buf_puts(ob, "\" showname=\"");
+        output_buf_put_escaped_xml(ob, fi->hfinfo->name);
 #endif
 
         if (fi->rep) {
-            fputs("\" showname=\"", pdata->fh);
-            print_escaped_xml(pdata->fh, fi->rep->representation);
+            output_buf_puts(ob, "\" showname=\"");
+            output_buf_put_escaped_xml(ob, fi->rep->representation);
         }
         else {
             label_ptr = label_str;
             proto_item_fill_label(fi, label_str);
-            fputs("\" showname=\"", pdata->fh);
-            print_escaped_xml(pdata->fh, label_ptr);
+            output_buf_puts(ob, "\" showname=\"");
+            output_buf_put_escaped_xml(ob, label_ptr);
         }
 
         if (PROTO_ITEM_IS_HIDDEN(node))
-            fprintf(pdata->fh, "\" hide=\"yes");
+            output_buf_puts(ob, "\" hide=\"yes");
 
-        fprintf(pdata->fh, "\" size=\"%d", fi->length);
-        if (node->parent && node->parent->finfo && (fi->start < node->parent->finfo->start)) {
-            fprintf(pdata->fh, "\" pos=\"%d", node->parent->finfo->start + fi->start);
-        } else {
-            fprintf(pdata->fh, "\" pos=\"%d", fi->start);
-        }
+        write_pdml_size_pos(ob, node, fi);
 /*      fprintf(pdata->fh, "\" id=\"%d", fi->hfinfo->id);*/
 
         /* show, value, and unmaskedvalue attributes */
@@ -421,14 +751,14 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
         case FT_PROTOCOL:
             break;
         case FT_NONE:
-            fputs("\" show=\"\" value=\"",  pdata->fh);
+            output_buf_puts(ob, "\" show=\"\" value=\"");
             break;
         default:
             dfilter_string = fvalue_to_string_repr(&fi->value, FTREPR_DISPLAY, NULL);
             if (dfilter_string != NULL) {
 
-                fputs("\" show=\"", pdata->fh);
-                print_escaped_xml(pdata->fh, dfilter_string);
+                output_buf_puts(ob, "\" show=\"");
+                output_buf_put_escaped_xml(ob, dfilter_string);
             }
             g_free(dfilter_string);
 
@@ -440,7 +770,9 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
              * they might be generated fields.
              */
             if (fi->length > 0) {
-                fputs("\" value=\"", pdata->fh);
+                gchar masked_str[20];
+
+                output_buf_puts(ob, "\" value=\"");
 
                 if (fi->hfinfo->bitmask!=0) {
                     switch (fi->value.ftype->ftype) {
@@ -448,40 +780,41 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
                         case FT_INT16:
                         case FT_INT24:
                         case FT_INT32:
-                            fprintf(pdata->fh, "%X", (guint) fvalue_get_sinteger(&fi->value));
+                            g_snprintf(masked_str, sizeof(masked_str), "%X", (guint) fvalue_get_sinteger(&fi->value));
                             break;
                         case FT_UINT8:
                         case FT_UINT16:
                         case FT_UINT24:
                         case FT_UINT32:
                         case FT_BOOLEAN:
-                            fprintf(pdata->fh, "%X", fvalue_get_uinteger(&fi->value));
+                            g_snprintf(masked_str, sizeof(masked_str), "%X", fvalue_get_uinteger(&fi->value));
                             break;
                         case FT_INT64:
                         case FT_UINT64:
-                            fprintf(pdata->fh, "%" G_GINT64_MODIFIER "X",
-                                    fvalue_get_integer64(&fi->value));
+                            g_snprintf(masked_str, sizeof(masked_str), "%" G_GINT64_MODIFIER "X",
+                                       fvalue_get_integer64(&fi->value));
                             break;
                         default:
                             g_assert_not_reached();
                     }
-                    fputs("\" unmaskedvalue=\"", pdata->fh);
-                    write_pdml_field_hex_value(pdata, fi);
+                    output_buf_puts(ob, masked_str);
+                    output_buf_puts(ob, "\" unmaskedvalue=\"");
+                    write_field_hex_value(ob, pdata->src_list, fi);
                 }
                 else {
-                    write_pdml_field_hex_value(pdata, fi);
+                    write_field_hex_value(ob, pdata->src_list, fi);
                 }
             }
         }
 
         if (node->first_child != NULL) {
-            fputs("\">\n", pdata->fh);
+            output_buf_puts(ob, "\">\n");
         }
         else if (fi->hfinfo->id == proto_data) {
-            fputs("\">\n", pdata->fh);
+            output_buf_puts(ob, "\">\n");
         }
         else {
-            fputs("\"/>\n", pdata->fh);
+            output_buf_puts(ob, "\"/>\n");
         }
     }
 
@@ -500,26 +833,24 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
 
     if (node->first_child != NULL) {
         /* Indent to correct level */
-        for (i = -1; i < pdata->level; i++) {
-            fputs("  ", pdata->fh);
-        }
+        write_pdml_indent(ob, pdata->level);
         /* Close off current element */
         /* Data and expert "protocols" use simple tags */
         if ((fi->hfinfo->id != proto_data) && (fi->hfinfo->id != proto_expert)) {
             if (fi->hfinfo->type == FT_PROTOCOL) {
-                fputs("</proto>\n", pdata->fh);
+                output_buf_puts(ob, "</proto>\n");
             }
             else {
-                fputs("</field>\n", pdata->fh);
+                output_buf_puts(ob, "</field>\n");
             }
         } else {
-            fputs("</field>\n", pdata->fh);
+            output_buf_puts(ob, "</field>\n");
         }
     }
 
     /* Close off fake wrapper protocol */
     if (wrap_in_fake_protocol) {
-        fputs("</proto>\n", pdata->fh);
+        output_buf_puts(ob, "</proto>\n");
     }
 }
 
@@ -528,13 +859,14 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
  * but we produce a 'geninfo' protocol in the PDML to conform to spec.
  * The 'frame' protocol follows the 'geninfo' protocol in the PDML. */
 static void
-print_pdml_geninfo(proto_tree *tree, FILE *fh)
+print_pdml_geninfo(proto_tree *tree, output_buf_t *ob)
 {
     guint32     num, len, caplen;
     nstime_t   *timestamp;
     GPtrArray  *finfo_array;
     field_info *frame_finfo;
     gchar      *tmp;
+    gchar       line[256];
 
     /* Get frame protocol's finfo. */
     finfo_array = proto_find_finfo(tree, proto_frame);
@@ -577,37 +909,41 @@ print_pdml_geninfo(proto_tree *tree, FILE *fh)
     g_ptr_array_free(finfo_array, TRUE);
 
     /* Print geninfo start */
-    fprintf(fh,
+    g_snprintf(line, sizeof(line),
             "  <proto name=\"geninfo\" pos=\"0\" showname=\"General information\" size=\"%u\">\n",
             frame_finfo->length);
+    output_buf_puts(ob, line);
 
     /* Print geninfo.num */
-    fprintf(fh,
+    g_snprintf(line, sizeof(line),
             "    <field name=\"num\" pos=\"0\" show=\"%u\" showname=\"Number\" value=\"%x\" size=\"%u\"/>\n",
             num, num, frame_finfo->length);
+    output_buf_puts(ob, line);
 
     /* Print geninfo.len */
-    fprintf(fh,
+    g_snprintf(line, sizeof(line),
             "    <field name=\"len\" pos=\"0\" show=\"%u\" showname=\"Frame Length\" value=\"%x\" size=\"%u\"/>\n",
             len, len, frame_finfo->length);
+    output_buf_puts(ob, line);
 
     /* Print geninfo.caplen */
-    fprintf(fh,
+    g_snprintf(line, sizeof(line),
             "    <field name=\"caplen\" pos=\"0\" show=\"%u\" showname=\"Captured Length\" value=\"%x\" size=\"%u\"/>\n",
             caplen, caplen, frame_finfo->length);
+    output_buf_puts(ob, line);
 
     tmp = abs_time_to_str(NULL, timestamp, ABSOLUTE_TIME_LOCAL, TRUE);
 
     /* Print geninfo.timestamp */
-    fprintf(fh,
+    g_snprintf(line, sizeof(line),
             "    <field name=\"timestamp\" pos=\"0\" show=\"%s\" showname=\"Captured Time\" value=\"%d.%09d\" size=\"%u\"/>\n",
             tmp, (int) timestamp->secs, timestamp->nsecs, frame_finfo->length);
+    output_buf_puts(ob, line);
 
     wmem_free(NULL, tmp);
 
     /* Print geninfo end */
-    fprintf(fh,
-            "  </proto>\n");
+    output_buf_puts(ob, "  </proto>\n");
 }
 
 void
@@ -628,32 +964,34 @@ write_psml_preamble(FILE *fh)
 void
 proto_tree_write_psml(epan_dissect_t *edt, FILE *fh)
 {
-    gint i;
+    output_buf_t *ob = output_buf_start(fh);
+    gint          i;
 
     /* if this is the first packet, we have to create the PSML structure output */
     if (write_headers) {
-        fprintf(fh, "<structure>\n");
+        output_buf_puts(ob, "<structure>\n");
 
         for (i = 0; i < edt->pi.cinfo->num_cols; i++) {
-            fprintf(fh, "<section>");
-            print_escaped_xml(fh, edt->pi.cinfo->col_title[i]);
-            fprintf(fh, "</section>\n");
+            output_buf_puts(ob, "<section>");
+            output_buf_put_escaped_xml(ob, edt->pi.cinfo->col_title[i]);
+            output_buf_puts(ob, "</section>\n");
         }
 
-        fprintf(fh, "</structure>\n\n");
+        output_buf_puts(ob, "</structure>\n\n");
 
         write_headers = FALSE;
     }
 
-    fprintf(fh, "<packet>\n");
+    output_buf_puts(ob, "<packet>\n");
 
     for (i = 0; i < edt->pi.cinfo->num_cols; i++) {
-        fprintf(fh, "<section>");
-        print_escaped_xml(fh, edt->pi.cinfo->col_data[i]);
-        fprintf(fh, "</section>\n");
+        output_buf_puts(ob, "<section>");
+        output_buf_put_escaped_xml(ob, edt->pi.cinfo->col_data[i]);
+        output_buf_puts(ob, "</section>\n");
     }
 
-    fprintf(fh, "</packet>\n\n");
+    output_buf_puts(ob, "</packet>\n\n");
+    output_buf_flush(ob);
 }
 
 void
@@ -662,6 +1000,224 @@ write_psml_finale(FILE *fh)
     fputs("</psml>\n", fh);
 }
 
+void
+write_ek_preamble(FILE *fh _U_)
+{
+    /* Nothing to do; every packet is a self-contained bulk request. */
+}
+
+static void
+ek_members_init(ek_members_t *members)
+{
+    members->by_name = g_hash_table_new(g_str_hash, g_str_equal);
+    members->members = g_ptr_array_new();
+}
+
+static void
+ek_members_cleanup(ek_members_t *members)
+{
+    guint i;
+
+    for (i = 0; i < members->members->len; i++) {
+        ek_member_t *member = (ek_member_t *)g_ptr_array_index(members->members, i);
+
+        g_ptr_array_free(member->nodes, TRUE);
+        g_free(member);
+    }
+    g_ptr_array_free(members->members, TRUE);
+    g_hash_table_destroy(members->by_name);
+}
+
+static void
+ek_members_add(ek_members_t *members, proto_node *node)
+{
+    header_field_info *hfinfo = PNODE_FINFO(node)->hfinfo;
+    gchar             *key    = get_escaped_name(hfinfo)->ek;
+    ek_member_t       *member;
+
+    /* Different fields registered with the same name share a key. */
+    member = (ek_member_t *)g_hash_table_lookup(members->by_name, key);
+    if (member == NULL) {
+        member = g_new(ek_member_t, 1);
+        member->hfinfo = hfinfo;
+        member->nodes  = g_ptr_array_new();
+        g_hash_table_insert(members->by_name, key, member);
+        g_ptr_array_add(members->members, member);
+    }
+    g_ptr_array_add(member->nodes, node);
+}
+
+/* Add the fields with values under node, at any depth, to members */
+static void
+ek_members_add_fields(ek_members_t *members, proto_node *node)
+{
+    proto_node *child;
+    field_info *fi;
+
+    for (child = node->first_child; child != NULL; child = child->next) {
+        fi = PNODE_FINFO(child);
+
+        /* dissection with an invisible proto tree? */
+        g_assert(fi);
+
+        /* Text labels and nested protocols carry no value of their own. */
+        if ((fi->hfinfo->id != hf_text_only) && (fi->hfinfo->type != FT_PROTOCOL)
+            && (fi->hfinfo->type != FT_NONE))
+            ek_members_add(members, child);
+
+        if (child->first_child != NULL)
+            ek_members_add_fields(members, child);
+    }
+}
+
+static void
+write_ek_member_name(write_ek_data *pdata, header_field_info *hfinfo)
+{
+    const escaped_name_t *name = get_escaped_name(hfinfo);
+
+    if (!pdata->first)
+        output_buf_puts(pdata->ob, ", ");
+    pdata->first = FALSE;
+
+    output_buf_putc(pdata->ob, '"');
+    output_buf_append(pdata->ob, name->ek, name->ek_len);
+    output_buf_puts(pdata->ob, "\": ");
+}
+
+static void
+write_ek_value(write_ek_data *pdata, field_info *fi)
+{
+    output_buf_t *ob = pdata->ob;
+    char         *dfilter_string;
+
+    output_buf_putc(ob, '"');
+    dfilter_string = fvalue_to_string_repr(&fi->value, FTREPR_DISPLAY, NULL);
+    if (dfilter_string != NULL) {
+        output_buf_put_escaped_json(ob, dfilter_string);
+        g_free(dfilter_string);
+    } else {
+        write_field_hex_value(ob, pdata->src_list, fi);
+    }
+    output_buf_putc(ob, '"');
+}
+
+/* Write a top-level protocol as an object holding all its fields, flattened */
+static void
+write_ek_protocol(write_ek_data *pdata, proto_node *node)
+{
+    output_buf_t *ob = pdata->ob;
+    ek_members_t  members;
+
+    output_buf_putc(ob, '{');
+    pdata->first = TRUE;
+
+    ek_members_init(&members);
+    ek_members_add_fields(&members, node);
+    write_ek_members(pdata, &members);
+    ek_members_cleanup(&members);
+
+    output_buf_putc(ob, '}');
+}
+
+/* Write each member, as an array if there's more than one node for it */
+static void
+write_ek_members(write_ek_data *pdata, ek_members_t *members)
+{
+    output_buf_t *ob = pdata->ob;
+    guint         i, j;
+
+    for (i = 0; i < members->members->len; i++) {
+        ek_member_t *member = (ek_member_t *)g_ptr_array_index(members->members, i);
+
+        write_ek_member_name(pdata, member->hfinfo);
+        if (member->nodes->len > 1)
+            output_buf_putc(ob, '[');
+        for (j = 0; j < member->nodes->len; j++) {
+            proto_node *node = (proto_node *)g_ptr_array_index(member->nodes, j);
+
+            if (j > 0)
+                output_buf_puts(ob, ", ");
+            if (member->hfinfo->type == FT_PROTOCOL)
+                write_ek_protocol(pdata, node);
+            else
+                write_ek_value(pdata, PNODE_FINFO(node));
+        }
+        if (member->nodes->len > 1)
+            output_buf_putc(ob, ']');
+        pdata->first = FALSE;
+    }
+}
+
+/*
+ * Write the packet as a pair of lines in Elasticsearch bulk format: an
+ * "index" action naming a per-day index, followed by the document.
+ * Each top-level protocol becomes an object in "layers" that holds all
+ * of that protocol's fields, flattened, keyed by the field abbreviation
+ * with '.' replaced by '_'.  A field that occurs more than once in a
+ * protocol, or a protocol that occurs more than once in the packet, gets
+ * an array of values.
+ */
+void
+proto_tree_write_ek(epan_dissect_t *edt, FILE *fh)
+{
+    write_ek_data  data;
+    ek_members_t   layers;
+    proto_node    *node;
+    frame_data    *fd = edt->pi.fd;
+    time_t         secs;
+    struct tm     *tm;
+    gchar          line[128];
+
+    data.ob       = output_buf_start(fh);
+    data.src_list = edt->pi.data_src;
+    data.first    = TRUE;
+
+    secs = fd->abs_ts.secs;
+    tm   = localtime(&secs);
+    if (tm != NULL) {
+        g_snprintf(line, sizeof(line),
+                   "{\"index\" : {\"_index\": \"packets-%04d-%02d-%02d\", \"_type\": \"pcap_file\", \"_score\": null}}\n",
+                   tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday);
+    } else {
+        g_snprintf(line, sizeof(line),
+                   "{\"index\" : {\"_index\": \"packets-XXXX-XX-XX\", \"_type\": \"pcap_file\", \"_score\": null}}\n");
+    }
+    output_buf_puts(data.ob, line);
+
+    g_snprintf(line, sizeof(line), "{\"timestamp\" : \"%" G_GINT64_MODIFIER "d\", \"layers\" : {",
+               (gint64)fd->abs_ts.secs * 1000 + fd->abs_ts.nsecs / 1000000);
+    output_buf_puts(data.ob, line);
+
+    /* Top-level protocols get an object of their own; anything else
+       at the top level is written as a plain value. */
+    ek_members_init(&layers);
+    for (node = edt->tree->first_child; node != NULL; node = node->next) {
+        field_info *fi = PNODE_FINFO(node);
+
+        /* dissection with an invisible proto tree? */
+        g_assert(fi);
+
+        if (fi->hfinfo->type == FT_PROTOCOL) {
+            ek_members_add(&layers, node);
+        } else {
+            if ((fi->hfinfo->id != hf_text_only) && (fi->hfinfo->type != FT_NONE))
+                ek_members_add(&layers, node);
+            ek_members_add_fields(&layers, node);
+        }
+    }
+    write_ek_members(&data, &layers);
+    ek_members_cleanup(&layers);
+
+    output_buf_puts(data.ob, "}}\n");
+    output_buf_flush(data.ob);
+}
+
+void
+write_ek_finale(FILE *fh _U_)
+{
+    /* Nothing to do */
+}
+
 void
 write_csv_preamble(FILE *fh _U_)
 {
@@ -844,64 +1400,25 @@ get_field_data(GSList *src_list, field_info *fi)
     return NULL;  /* not found */
 }
 
-/* Print a string, escaping out certain characters that need to
- * escaped out for XML. */
-static void
-print_escaped_xml(FILE *fh, const char *unescaped_string)
-{
-    const char *p;
-    char        temp_str[8];
-
-    for (p = unescaped_string; *p != '\0'; p++) {
-        switch (*p) {
-        case '&':
-            fputs("&amp;", fh);
-            break;
-        case '<':
-            fputs("&lt;", fh);
-            break;
-        case '>':
-            fputs("&gt;", fh);
-            break;
-        case '"':
-            fputs("&quot;", fh);
-            break;
-        case '\'':
-            fputs("&apos;", fh);
-            break;
-        default:
-            if (g_ascii_isprint(*p))
-                fputc(*p, fh);
-            else {
-                g_snprintf(temp_str, sizeof(temp_str), "\\x%x", (guint8)*p);
-                fputs(temp_str, fh);
-            }
-        }
-    }
-}
-
 static void
-write_pdml_field_hex_value(write_pdml_data *pdata, field_info *fi)
+write_field_hex_value(output_buf_t *ob, GSList *src_list, field_info *fi)
 {
-    int           i;
     const guint8 *pd;
 
     if (!fi->ds_tvb)
         return;
 
     if (fi->length > tvb_length_remaining(fi->ds_tvb, fi->start)) {
-        fprintf(pdata->fh, "field length invalid!");
+        output_buf_puts(ob, "field length invalid!");
         return;
     }
 
     /* Find the data for this field. */
-    pd = get_field_data(pdata->src_list, fi);
+    pd = get_field_data(src_list, fi);
 
     if (pd) {
         /* Print a simple hex dump */
-        for (i = 0 ; i < fi->length; i++) {
-            fprintf(pdata->fh, "%02x", pd[i]);
-        }
+        output_buf_put_hex_bytes(ob, pd, fi->length);
     }
 }
 
@@ -1840,8 +2357,8 @@ get_field_hex_value(GSList *src_list, field_info *fi)
         p = buffer;
         /* Print a simple hex dump */
         for (i = 0 ; i < fi->length; i++) {
-            g_snprintf(p, chars_per_byte+1, "%02x", pd[i]);
-            p += chars_per_byte;
+            *p++ = hex_digits[pd[i] >> 4];
+            *p++ = hex_digits[pd[i] & 0xf];
         }
         return buffer;
     } else {
@@ -146,6 +146,13 @@ WS_DLL_PUBLIC void write_psml_preamble(FILE *fh);
 WS_DLL_PUBLIC void proto_tree_write_psml(epan_dissect_t *edt, FILE *fh);
 WS_DLL_PUBLIC void write_psml_finale(FILE *fh);
 
+/* Free the escaped field names cached by the PDML and EK writers */
+extern void print_cleanup(void);
+
+WS_DLL_PUBLIC void write_ek_preamble(FILE *fh);
+WS_DLL_PUBLIC void proto_tree_write_ek(epan_dissect_t *edt, FILE *fh);
+WS_DLL_PUBLIC void write_ek_finale(FILE *fh);
+
 WS_DLL_PUBLIC void write_csv_preamble(FILE *fh);
 WS_DLL_PUBLIC void proto_tree_write_csv(epan_dissect_t *edt, FILE *fh);
 WS_DLL_PUBLIC void write_csv_finale(FILE *fh);
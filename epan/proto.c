@@ -268,6 +268,10 @@ static expert_field ei_number_string_decoding_erange_error = EI_INIT;
 static void register_number_string_decoding_error(void);
 
 static int proto_register_field_init(header_field_info *hfinfo, const int parent);
+static int proto_register_field_id(header_field_info *hfinfo, const int parent);
+static void proto_check_field(header_field_info *hfinfo);
+static void proto_index_field(header_field_info *hfinfo);
+static gboolean proto_index_deferred_prefix(const char *field_name);
 
 /* special-case header field used within proto.c */
 static header_field_info hfi_text_only =
@@ -284,6 +288,8 @@ struct _protocol {
 	gboolean    is_enabled;   /* TRUE if protocol is enabled */
 	gboolean    can_toggle;   /* TRUE if is_enabled can be changed */
 	gboolean    is_private;   /* TRUE is protocol is private */
+	gboolean    fields_deferred; /* TRUE if fields aren't in gpa_name_map yet */
+	const char *last_prefix;  /* abbrev of the last deferred field added */
 };
 
 /* List of all protocols */
@@ -333,6 +339,80 @@ static void save_same_name_hfinfo(gpointer data)
 	same_name_hfinfo = (header_field_info*)data;
 }
 
+/*
+ * Lookup indexes for the value_strings and range_strings of fields,
+ * indexed by field ID; see hf_strings_index().  They're built the first
+ * time a value of the field is looked up, as most fields never are, and
+ * that would be a lot of work to do at startup.  An entry points to
+ * hf_strings_no_index if the field's strings aren't worth indexing.
+ */
+static GPtrArray  *hf_strings_indexes = NULL;
+static int         hf_strings_no_index;
+
+/*
+ * The fields registered for a protocol are given their IDs, and
+ * checked, right away, but they're not entered into gpa_name_map
+ * until something looks up a field name with a prefix they use (or
+ * until all of them are needed, see proto_initialize_all_prefixes());
+ * that's most of the work done at startup for fields nobody asks for.
+ *
+ * Indexed by the part of the field name before the first dot,
+ * contains a GSList of the protocols with deferred fields with
+ * that prefix, most recently registered first.
+ */
+static GHashTable *deferred_prefixes = NULL;
+
+/*
+ * If proto_set_field_snapshot() has been called, it named a file
+ * holding a sorted copy of the name index, written by an earlier
+ * run; with it, the
+ * fields registered by proto_init() don't even need their prefixes
+ * remembered, as a lookup that misses gpa_name_map can find the IDs
+ * of the fields with that name in the snapshot.
+ *
+ * Only names and IDs are kept: everything else registration sets up
+ * points into the program's own data, and has to be set up by running
+ * the registration routines anyway, as they fill in the dissectors'
+ * hf_ and ett_ variables.
+ *
+ * The snapshot is only used if it was written by this version, with
+ * the same plugins, for the same fields, with the same names in the
+ * same order; that's checked at the end of proto_init().  If it's
+ * stale, or if a name found in it turns out not to be the name of the
+ * field with that ID, everything is indexed and the snapshot is
+ * written again.
+ */
+#define FIELD_SNAPSHOT_MAGIC	0x57534649	/* "WSFI" */
+#define FIELD_SNAPSHOT_FORMAT	3
+
+typedef struct {
+	guint32 magic;
+	guint32 format;
+	char    version[32];
+	guint32 num_fields;	/* number of fields registered by proto_init() */
+	guint32 plugins_hash;	/* hash of the names and versions of the plugins */
+	guint32 names_hash;	/* hash of the names of those fields, by ID */
+	guint32 num_entries;
+	guint32 strings_len;
+	/* followed by num_entries field_snapshot_entry's, sorted by name,
+	   and then by strings_len bytes of names */
+} field_snapshot_header;
+
+typedef struct {
+	guint32 name_offset;
+	gint32  id;
+} field_snapshot_entry;
+
+static char        *field_snapshot_path;
+static GMappedFile *field_snapshot;
+static gboolean     in_proto_init;
+static guint32      init_num_fields;	/* gpa_hfinfo.len after proto_init() */
+
+static void field_snapshot_open(void);
+static void field_snapshot_check(void);
+static void field_snapshot_close(void);
+static void field_snapshot_write(void);
+
 /* Points to the first element of an array of bits, indexed by
    a subtree item type; that array element is TRUE if subtrees of
    an item of that type are to be expanded. */
@@ -455,6 +535,10 @@ proto_init(void (register_all_protocols_func)(register_cb cb, gpointer client_da
 	gpa_hfinfo.hfi           = NULL;
 	gpa_name_map             = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, save_same_name_hfinfo);
 
+	if (field_snapshot_path != NULL)
+		field_snapshot_open();
+	in_proto_init = TRUE;
+
 	/* Initialize the ftype subsystem */
 	ftypes_initialize();
 
@@ -501,6 +585,11 @@ proto_init(void (register_all_protocols_func)(register_cb cb, gpointer client_da
 	/* We've assigned all the subtree type values; allocate the array
 	   for them, and zero it out. */
 	tree_is_expanded = g_new0(guint32, (num_tree_types/32)+1);
+
+	in_proto_init = FALSE;
+	init_num_fields = gpa_hfinfo.len;
+	if (field_snapshot_path != NULL)
+		field_snapshot_check();
 }
 
 void
@@ -512,6 +601,12 @@ proto_cleanup(void)
 		gpa_name_map = NULL;
 	}
 
+	if (deferred_prefixes) {
+		g_hash_table_destroy(deferred_prefixes);
+		deferred_prefixes = NULL;
+	}
+	field_snapshot_close();
+
 	while (protocols) {
 		protocol_t        *protocol = (protocol_t *)protocols->data;
 		header_field_info *hfinfo;
@@ -539,6 +634,18 @@ proto_cleanup(void)
 		proto_filter_names = NULL;
 	}
 
+	if (hf_strings_indexes) {
+		guint i;
+
+		for (i = 0; i < hf_strings_indexes->len; i++) {
+			gpointer vsi = g_ptr_array_index(hf_strings_indexes, i);
+			if (vsi != &hf_strings_no_index)
+				value_string_index_free((value_string_index *)vsi);
+		}
+		g_ptr_array_free(hf_strings_indexes, TRUE);
+		hf_strings_indexes = NULL;
+	}
+
 	if (gpa_hfinfo.allocated_len) {
 		gpa_hfinfo.len           = 0;
 		gpa_hfinfo.allocated_len = 0;
@@ -830,10 +937,364 @@ initialize_prefix(gpointer k, gpointer v, gpointer u _U_) {
 	return TRUE;
 }
 
-/** Initialize every remaining uninitialized prefix. */
+/* Enter the deferred fields of a protocol in gpa_name_map */
+static void
+proto_index_deferred_fields(protocol_t *protocol)
+{
+	guint i;
+
+	protocol->fields_deferred = FALSE;
+	protocol->last_prefix = NULL;
+	for (i = 0; i < protocol->fields->len; i++)
+		proto_index_field((header_field_info *)g_ptr_array_index(protocol->fields, i));
+}
+
+/* Remember that there are deferred fields with the prefix of "abbrev" */
+static void
+proto_defer_prefix(protocol_t *protocol, const char *abbrev)
+{
+	GSList *protos;
+
+	/* Fields of a protocol mostly share a prefix; don't bother
+	   hashing it again if it's the same as the last one's. */
+	if (protocol->last_prefix != NULL &&
+	    prefix_equal(protocol->last_prefix, abbrev))
+		return;
+	protocol->last_prefix = abbrev;
+
+	if (!deferred_prefixes) {
+		deferred_prefixes = g_hash_table_new_full(prefix_hash, prefix_equal,
+		    NULL, (GDestroyNotify)g_slist_free);
+	}
+
+	protos = (GSList *)g_hash_table_lookup(deferred_prefixes, abbrev);
+	if (g_slist_find(protos, protocol) != NULL)
+		return;
+	/* Steal, so that the destroy notify doesn't free the list
+	   we're prepending to */
+	g_hash_table_steal(deferred_prefixes, abbrev);
+	g_hash_table_insert(deferred_prefixes, (gpointer)abbrev,
+	    g_slist_prepend(protos, protocol));
+}
+
+/*
+ * Index the deferred fields of all protocols with fields with the
+ * prefix of "field_name"; returns TRUE if there were any.
+ */
+static gboolean
+proto_index_deferred_prefix(const char *field_name)
+{
+	gpointer  key, value;
+	GSList   *protos, *l;
+
+	if (!deferred_prefixes ||
+	    !g_hash_table_lookup_extended(deferred_prefixes, field_name, &key, &value))
+		return FALSE;
+
+	g_hash_table_steal(deferred_prefixes, key);
+	/* Index them in the order in which they were registered, so
+	   that fields with the same name are chained as they would
+	   have been had they been indexed right away. */
+	protos = g_slist_reverse((GSList *)value);
+	for (l = protos; l != NULL; l = l->next) {
+		protocol_t *protocol = (protocol_t *)l->data;
+
+		if (protocol->fields_deferred)
+			proto_index_deferred_fields(protocol);
+	}
+	g_slist_free(protos);
+	return TRUE;
+}
+
+/* Index every remaining deferred field */
+static void
+proto_index_all_deferred_fields(void)
+{
+	GList *l;
+
+	for (l = protocols; l != NULL; l = l->next) {
+		protocol_t *protocol = (protocol_t *)l->data;
+
+		if (protocol->fields_deferred)
+			proto_index_deferred_fields(protocol);
+	}
+	if (deferred_prefixes) {
+		g_hash_table_destroy(deferred_prefixes);
+		deferred_prefixes = NULL;
+	}
+	field_snapshot_close();
+}
+
+/** Initialize every remaining uninitialized prefix, and index every
+    remaining deferred field. */
 void
 proto_initialize_all_prefixes(void) {
-	g_hash_table_foreach_remove(prefixes, initialize_prefix, NULL);
+	if (prefixes)
+		g_hash_table_foreach_remove(prefixes, initialize_prefix, NULL);
+
+	proto_index_all_deferred_fields();
+}
+
+/* Does the field go into gpa_name_map? */
+#define FIELD_IS_NAMED(hfinfo) \
+	((hfinfo)->name[0] != 0 && (hfinfo)->abbrev[0] != 0)
+
+#ifdef HAVE_PLUGINS
+static void
+field_snapshot_hash_plugin(const char *name, const char *version,
+			   const char *types _U_, const char *filename _U_,
+			   void *user_data)
+{
+	guint32 *hash = (guint32 *)user_data;
+
+	*hash = *hash * 31 + g_str_hash(name);
+	*hash = *hash * 31 + g_str_hash(version);
+}
+#endif
+
+static guint32
+field_snapshot_plugins_hash(void)
+{
+	guint32 hash = 0;
+
+#ifdef HAVE_PLUGINS
+	plugins_get_descriptions(field_snapshot_hash_plugin, &hash);
+#endif
+	return hash;
+}
+
+/* Hash the names of the fields registered by proto_init(), in ID order */
+static guint32
+field_snapshot_names_hash(void)
+{
+	guint32 hash = 0;
+	guint32 i;
+
+	for (i = 0; i < init_num_fields; i++)
+		hash = hash * 31 + g_str_hash(gpa_hfinfo.hfi[i]->abbrev);
+	return hash;
+}
+
+void
+proto_set_field_snapshot(const char *path)
+{
+	g_free(field_snapshot_path);
+	field_snapshot_path = g_strdup(path);
+}
+
+/* Map the snapshot, if there is one and it's for this version */
+static void
+field_snapshot_open(void)
+{
+	const field_snapshot_header *hdr;
+	gsize len;
+
+	field_snapshot = g_mapped_file_new(field_snapshot_path, FALSE, NULL);
+	if (field_snapshot == NULL)
+		return;
+
+	len = g_mapped_file_get_length(field_snapshot);
+	hdr = (const field_snapshot_header *)g_mapped_file_get_contents(field_snapshot);
+	if (len < sizeof *hdr ||
+	    hdr->magic != FIELD_SNAPSHOT_MAGIC ||
+	    hdr->format != FIELD_SNAPSHOT_FORMAT ||
+	    strncmp(hdr->version, VERSION, sizeof hdr->version) != 0) {
+		field_snapshot_close();
+		return;
+	}
+
+	/* Make sure the entries and the names fit, without overflowing,
+	   and that the last name is terminated. */
+	len -= sizeof *hdr;
+	if (hdr->num_entries > len / sizeof(field_snapshot_entry) ||
+	    hdr->strings_len != len - hdr->num_entries * sizeof(field_snapshot_entry) ||
+	    (hdr->strings_len != 0 &&
+	     ((const char *)hdr)[sizeof *hdr + len - 1] != '\0')) {
+		field_snapshot_close();
+	}
+}
+
+/*
+ * At the end of proto_init(), drop the snapshot if it's for another set
+ * of fields, and write one if there isn't one we can use.
+ */
+static void
+field_snapshot_check(void)
+{
+	const field_snapshot_header *hdr;
+
+	if (field_snapshot != NULL) {
+		hdr = (const field_snapshot_header *)g_mapped_file_get_contents(field_snapshot);
+		if (hdr->num_fields == init_num_fields &&
+		    hdr->plugins_hash == field_snapshot_plugins_hash() &&
+		    hdr->names_hash == field_snapshot_names_hash())
+			return;
+
+		/* The fields registered so far didn't have their
+		   prefixes remembered. */
+		proto_index_all_deferred_fields();
+	}
+	field_snapshot_write();
+}
+
+static void
+field_snapshot_close(void)
+{
+	if (field_snapshot) {
+		g_mapped_file_unref(field_snapshot);
+		field_snapshot = NULL;
+	}
+}
+
+static int
+field_snapshot_compare(const void *a, const void *b)
+{
+	const header_field_info *hfa = gpa_hfinfo.hfi[*(const guint32 *)a];
+	const header_field_info *hfb = gpa_hfinfo.hfi[*(const guint32 *)b];
+
+	return strcmp(hfa->abbrev, hfb->abbrev);
+}
+
+/* Write a snapshot of the names of the fields registered by proto_init() */
+static void
+field_snapshot_write(void)
+{
+	field_snapshot_header hdr;
+	field_snapshot_entry  entry;
+	GByteArray *buf;
+	guint32    *ids;
+	guint32     num_ids = 0;
+	guint32     i;
+	GError     *error = NULL;
+
+	ids = g_new(guint32, init_num_fields);
+	for (i = 0; i < init_num_fields; i++) {
+		if (FIELD_IS_NAMED(gpa_hfinfo.hfi[i]))
+			ids[num_ids++] = i;
+	}
+	qsort(ids, num_ids, sizeof ids[0], field_snapshot_compare);
+
+	memset(&hdr, 0, sizeof hdr);
+	hdr.magic = FIELD_SNAPSHOT_MAGIC;
+	hdr.format = FIELD_SNAPSHOT_FORMAT;
+	g_strlcpy(hdr.version, VERSION, sizeof hdr.version);
+	hdr.num_fields = init_num_fields;
+	hdr.plugins_hash = field_snapshot_plugins_hash();
+	hdr.names_hash = field_snapshot_names_hash();
+	hdr.num_entries = num_ids;
+	for (i = 0; i < num_ids; i++)
+		hdr.strings_len += (guint32)strlen(gpa_hfinfo.hfi[ids[i]]->abbrev) + 1;
+
+	buf = g_byte_array_sized_new((guint)(sizeof hdr + num_ids * sizeof entry + hdr.strings_len));
+	g_byte_array_append(buf, (const guint8 *)&hdr, sizeof hdr);
+	entry.name_offset = 0;
+	for (i = 0; i < num_ids; i++) {
+		entry.id = (gint32)ids[i];
+		g_byte_array_append(buf, (const guint8 *)&entry, sizeof entry);
+		entry.name_offset += (guint32)strlen(gpa_hfinfo.hfi[ids[i]]->abbrev) + 1;
+	}
+	for (i = 0; i < num_ids; i++) {
+		const char *abbrev = gpa_hfinfo.hfi[ids[i]]->abbrev;
+
+		g_byte_array_append(buf, (const guint8 *)abbrev, (guint)strlen(abbrev) + 1);
+	}
+	g_free(ids);
+
+	/* Other processes may be reading or writing it at the same time;
+	   g_file_set_contents() replaces it atomically. */
+	if (!g_file_set_contents(field_snapshot_path, (const gchar *)buf->data, buf->len, &error)) {
+		g_warning("Can't write the field snapshot: %s", error->message);
+		g_error_free(error);
+	}
+	g_byte_array_free(buf, TRUE);
+}
+
+/*
+ * The name of entry i of the snapshot, or NULL if its offset is outside
+ * the names; field_snapshot_open() checked that the last one ends there.
+ */
+static const char *
+field_snapshot_name(const field_snapshot_header *hdr, guint32 i)
+{
+	const field_snapshot_entry *entries = (const field_snapshot_entry *)(hdr + 1);
+	const char *strings = (const char *)(entries + hdr->num_entries);
+
+	if (entries[i].name_offset >= hdr->strings_len)
+		return NULL;
+	return strings + entries[i].name_offset;
+}
+
+/* Give up on a snapshot that turned out to be stale or damaged */
+static void
+field_snapshot_discard(void)
+{
+	/* Index everything, which closes it, and write a new one for
+	   next time. */
+	proto_index_all_deferred_fields();
+	field_snapshot_write();
+}
+
+/*
+ * Index the deferred fields of all protocols with a field named
+ * "field_name" in the snapshot; returns TRUE if there were any.
+ */
+static gboolean
+field_snapshot_index(const char *field_name)
+{
+	const field_snapshot_header *hdr;
+	const field_snapshot_entry  *entries;
+	const char *name;
+	guint32     lo, hi, mid;
+	gboolean    found = FALSE;
+
+	if (field_snapshot == NULL)
+		return FALSE;
+
+	hdr = (const field_snapshot_header *)g_mapped_file_get_contents(field_snapshot);
+	entries = (const field_snapshot_entry *)(hdr + 1);
+
+	/* Find the first entry with that name */
+	lo = 0;
+	hi = hdr->num_entries;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		name = field_snapshot_name(hdr, mid);
+		if (name == NULL) {
+			field_snapshot_discard();
+			return TRUE;
+		}
+		if (strcmp(name, field_name) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for (; lo < hdr->num_entries; lo++) {
+		header_field_info *hfinfo;
+		protocol_t *protocol;
+
+		name = field_snapshot_name(hdr, lo);
+		if (name == NULL) {
+			field_snapshot_discard();
+			return TRUE;
+		}
+		if (strcmp(name, field_name) != 0)
+			break;
+
+		if (entries[lo].id < 0 || (guint32)entries[lo].id >= init_num_fields ||
+		    strcmp(gpa_hfinfo.hfi[entries[lo].id]->abbrev, field_name) != 0) {
+			field_snapshot_discard();
+			return TRUE;
+		}
+		hfinfo = gpa_hfinfo.hfi[entries[lo].id];
+		if (hfinfo->parent == -1)
+			continue;
+		protocol = find_protocol_by_id(hfinfo->parent);
+		if (protocol->fields_deferred)
+			proto_index_deferred_fields(protocol);
+		found = TRUE;
+	}
+	return found;
 }
 
 /* Finds a record in the hfinfo array by name.
@@ -855,6 +1316,12 @@ proto_registrar_get_byname(const char *field_name)
 	if (hfinfo)
 		return hfinfo;
 
+	if (field_snapshot_index(field_name) || proto_index_deferred_prefix(field_name)) {
+		hfinfo = (header_field_info *)g_hash_table_lookup(gpa_name_map, field_name);
+		if (hfinfo)
+			return hfinfo;
+	}
+
 	if (!prefixes)
 		return NULL;
 
@@ -865,6 +1332,9 @@ proto_registrar_get_byname(const char *field_name)
 		return NULL;
 	}
 
+	/* The initializer may have registered deferred fields */
+	proto_index_deferred_prefix(field_name);
+
 	return (header_field_info *)g_hash_table_lookup(gpa_name_map, field_name);
 }
 
@@ -4866,6 +5336,8 @@ proto_register_protocol(const char *name, const char *short_name,
 	protocol->is_enabled = TRUE; /* protocol is enabled by default */
 	protocol->can_toggle = TRUE;
 	protocol->is_private = FALSE;
+	protocol->fields_deferred = TRUE;
+	protocol->last_prefix = NULL;
 	/* list will be sorted later by name, when all protocols completed registering */
 	protocols = g_list_prepend(protocols, protocol);
 	g_hash_table_insert(proto_filter_names, (gpointer)filter_name, protocol);
@@ -5158,6 +5630,17 @@ proto_register_field_common(protocol_t *proto, header_field_info *hfi, const int
 {
 	if (proto != NULL) {
 		g_ptr_array_add(proto->fields, hfi);
+
+		if (proto->fields_deferred) {
+			int id = proto_register_field_id(hfi, parent);
+
+			proto_check_field(hfi);
+			/* The snapshot has the fields registered by proto_init() */
+			if (hfi->abbrev && hfi->abbrev[0] != 0 &&
+			    !(in_proto_init && field_snapshot != NULL))
+				proto_defer_prefix(proto, hfi->abbrev);
+			return id;
+		}
 	}
 
 	return proto_register_field_init(hfi, parent);
@@ -5589,11 +6072,8 @@ register_number_string_decoding_error(void)
 
 #define PROTO_PRE_ALLOC_HF_FIELDS_MEM (144000+PRE_ALLOC_EXPERT_FIELDS_MEM)
 static int
-proto_register_field_init(header_field_info *hfinfo, const int parent)
+proto_register_field_id(header_field_info *hfinfo, const int parent)
 {
-
-	tmp_fld_check_assert(hfinfo);
-
 	hfinfo->parent         = parent;
 	hfinfo->same_name_next = NULL;
 	hfinfo->same_name_prev_id = -1;
@@ -5614,10 +6094,16 @@ proto_register_field_init(header_field_info *hfinfo, const int parent)
 	gpa_hfinfo.len++;
 	hfinfo->id = gpa_hfinfo.len - 1;
 
-	/* if we have real names, enter this field in the name tree */
-	if ((hfinfo->name[0] != 0) && (hfinfo->abbrev[0] != 0 )) {
+	return hfinfo->id;
+}
 
-		header_field_info *same_name_next_hfinfo;
+/* Check the field for registration bugs */
+static void
+proto_check_field(header_field_info *hfinfo)
+{
+	tmp_fld_check_assert(hfinfo);
+
+	if ((hfinfo->name[0] != 0) && (hfinfo->abbrev[0] != 0 )) {
 		guchar c;
 
 		/* Check that the filter name (abbreviation) is legal;
@@ -5627,6 +6113,17 @@ proto_register_field_init(header_field_info *hfinfo, const int parent)
 			fprintf(stderr, "Invalid character '%c' in filter name '%s'\n", c, hfinfo->abbrev);
 			DISSECTOR_ASSERT_NOT_REACHED();
 		}
+	}
+}
+
+/* Enter the field in the name tree */
+static void
+proto_index_field(header_field_info *hfinfo)
+{
+	/* if we have real names, enter this field in the name tree */
+	if ((hfinfo->name[0] != 0) && (hfinfo->abbrev[0] != 0 )) {
+
+		header_field_info *same_name_next_hfinfo;
 
 		/* We allow multiple hfinfo's to be registered under the same
 		 * abbreviation. This was done for X.25, as, depending
@@ -5661,8 +6158,17 @@ proto_register_field_init(header_field_info *hfinfo, const int parent)
 			hfinfo->same_name_prev_id = same_name_hfinfo->id;
 		}
 	}
+}
 
-	return hfinfo->id;
+static int
+proto_register_field_init(header_field_info *hfinfo, const int parent)
+{
+	int id;
+
+	id = proto_register_field_id(hfinfo, parent);
+	proto_check_field(hfinfo);
+	proto_index_field(hfinfo);
+	return id;
 }
 
 void
@@ -6032,11 +6538,39 @@ fill_label_boolean(field_info *fi, gchar *label_str)
 	label_fill(label_str, bitfield_byte_length, hfinfo, value ? tfstring->true_string : tfstring->false_string);
 }
 
+/* Returns the lookup index for the plain value_string or range_string of
+   hfinfo, building it if need be, or NULL if it doesn't have one */
+static const value_string_index *
+hf_strings_index(const header_field_info *hfinfo)
+{
+	gpointer vsi;
+
+	if (hfinfo->id < 0 || !hfinfo->strings)
+		return NULL;
+
+	if (!hf_strings_indexes)
+		hf_strings_indexes = g_ptr_array_new();
+	if ((guint)hfinfo->id >= hf_strings_indexes->len)
+		g_ptr_array_set_size(hf_strings_indexes, gpa_hfinfo.len);
+
+	vsi = g_ptr_array_index(hf_strings_indexes, hfinfo->id);
+	if (vsi == NULL) {
+		if (hfinfo->display & BASE_RANGE_STRING)
+			vsi = range_string_index_new((const range_string *) hfinfo->strings);
+		else
+			vsi = value_string_index_new((const value_string *) hfinfo->strings);
+		if (vsi == NULL)
+			vsi = &hf_strings_no_index;
+		g_ptr_array_index(hf_strings_indexes, hfinfo->id) = vsi;
+	}
+
+	return (vsi != &hf_strings_no_index) ? (const value_string_index *)vsi : NULL;
+}
+
 static const char *
 hf_try_val_to_str(guint32 value, const header_field_info *hfinfo)
 {
-	if (hfinfo->display & BASE_RANGE_STRING)
-		return try_rval_to_str(value, (const range_string *) hfinfo->strings);
+	const value_string_index *vsi;
 
 	if (hfinfo->display & BASE_EXT_STRING)
 		return try_val_to_str_ext(value, (value_string_ext *) hfinfo->strings);
@@ -6044,6 +6578,13 @@ hf_try_val_to_str(guint32 value, const header_field_info *hfinfo)
 	if (hfinfo->display & BASE_VAL64_STRING)
 		return try_val64_to_str(value, (const val64_string *) hfinfo->strings);
 
+	vsi = hf_strings_index(hfinfo);
+	if (vsi)
+		return value_string_index_lookup(value, vsi);
+
+	if (hfinfo->display & BASE_RANGE_STRING)
+		return try_rval_to_str(value, (const range_string *) hfinfo->strings);
+
 	return try_val_to_str(value, (const value_string *) hfinfo->strings);
 }
 
@@ -1899,9 +1899,17 @@ typedef void (*prefix_initializer_t)(const char* match);
 WS_DLL_PUBLIC void
 proto_register_prefix(const char *prefix,  prefix_initializer_t initializer);
 
-/** Initialize every remaining uninitialized prefix. */
+/** Initialize every remaining uninitialized prefix, and enter every
+    field whose indexing was deferred in the field name table; call
+    this before walking all the fields. */
 WS_DLL_PUBLIC void proto_initialize_all_prefixes(void);
 
+/** Keep a snapshot of the field name table in a file between runs, so
+    that fewer fields have to be indexed at startup; call this before
+    epan_init().  The file is written if it doesn't exist or is stale.
+@param path the name of the file */
+WS_DLL_PUBLIC void proto_set_field_snapshot(const char *path);
+
 WS_DLL_PUBLIC void proto_register_fields_manual(const int parent, header_field_info **hfi, const int num_records);
 WS_DLL_PUBLIC void proto_register_fields_section(const int parent, header_field_info *hfi, const int num_records);
 
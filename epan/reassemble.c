@@ -29,6 +29,10 @@
 #include <epan/emem.h>
 #include <epan/reassemble.h>
 #include <epan/tvbuff-int.h>
+#include <epan/app_mem_usage.h>
+
+#include <wsutil/file_util.h>
+#include <wsutil/tempfile.h>
 
 /*
  * Functions for reassembly tables where the endpoint addresses, and a
@@ -322,6 +326,564 @@ reassembled_hash(gconstpointer k)
 	return key->frame;
 }
 
+/*
+ * Lookup index for the fragments of a reassembly.
+ *
+ * The fragment list hanging off a fragment_head is kept sorted by
+ * offset, and used to be walked both to find where a new fragment goes
+ * and to find out how much contiguous data we have.  With many
+ * fragments, e.g. for TCP streams with large windows and lots of
+ * retransmissions, that made reassembly quadratic.
+ *
+ * "frags" holds the fragments in list order, so that the insertion
+ * point for a new fragment can be found with a binary search.  "ranges"
+ * holds the ranges covered by the fragments, sorted, with overlapping
+ * and adjacent ranges coalesced, so that it rarely has more than a few
+ * entries and the amount of data contiguous from offset 0 is simply the
+ * end of the first range.
+ *
+ * The list itself remains the authoritative data structure, as
+ * dissectors walk it; the index is built on demand and dropped once the
+ * reassembly has been completed.
+ */
+typedef struct {
+	guint32 start;
+	guint32 end;	/* offset just past the end of the range */
+} fragment_range;
+
+typedef struct _fragment_index {
+	GPtrArray *frags;
+	GArray *ranges;
+} fragment_index;
+
+static void
+fragment_index_add_range(fragment_index *frag_index, guint32 start, guint32 len)
+{
+	GArray *ranges = frag_index->ranges;
+	fragment_range *range;
+	fragment_range new_range;
+	guint32 end;
+	guint low, high, mid, last;
+
+	if (len == 0)
+		return;
+
+	end = start + len;
+	if (end < start) {
+		/* Integer overflow */
+		end = G_MAXUINT32;
+	}
+
+	/* Find the first range that ends at or after the new one starts;
+	 * every range before it lies entirely before the new range. */
+	low = 0;
+	high = ranges->len;
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		if (g_array_index(ranges, fragment_range, mid).end < start)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	/* Merge with all the ranges that overlap or touch the new one. */
+	for (last = low; last < ranges->len; last++) {
+		range = &g_array_index(ranges, fragment_range, last);
+		if (range->start > end)
+			break;
+		start = MIN(start, range->start);
+		end = MAX(end, range->end);
+	}
+
+	new_range.start = start;
+	new_range.end = end;
+	if (last == low) {
+		g_array_insert_val(ranges, low, new_range);
+	} else {
+		g_array_index(ranges, fragment_range, low) = new_range;
+		if (last > low + 1)
+			g_array_remove_range(ranges, low + 1, last - low - 1);
+	}
+}
+
+/*
+ * Return the number of bytes of data available contiguously from
+ * offset 0.
+ */
+static guint32
+fragment_index_contiguous_len(const fragment_index *frag_index)
+{
+	const fragment_range *range;
+
+	if (frag_index->ranges->len == 0)
+		return 0;
+
+	range = &g_array_index(frag_index->ranges, fragment_range, 0);
+	return range->start == 0 ? range->end : 0;
+}
+
+static void
+fragment_index_insert(fragment_index *frag_index, guint pos, fragment_item *fd)
+{
+	GPtrArray *frags = frag_index->frags;
+
+	g_ptr_array_add(frags, NULL);
+	memmove(&frags->pdata[pos + 1], &frags->pdata[pos],
+		(frags->len - 1 - pos) * sizeof(gpointer));
+	frags->pdata[pos] = fd;
+	fragment_index_add_range(frag_index, fd->offset, fd->len);
+}
+
+static fragment_index *
+fragment_index_get(fragment_head *fd_head)
+{
+	fragment_index *frag_index = fd_head->frag_index;
+	fragment_item *fd_i;
+
+	if (frag_index == NULL) {
+		frag_index = g_new(fragment_index, 1);
+		frag_index->frags = g_ptr_array_new();
+		frag_index->ranges = g_array_new(FALSE, FALSE, sizeof(fragment_range));
+
+		/* Pick up any fragments linked before the index was built
+		 * (or after it was dropped). */
+		for (fd_i = fd_head->next; fd_i; fd_i = fd_i->next)
+			fragment_index_insert(frag_index, frag_index->frags->len, fd_i);
+
+		fd_head->frag_index = frag_index;
+	}
+	return frag_index;
+}
+
+static void
+fragment_index_free(fragment_head *fd_head)
+{
+	fragment_index *frag_index = fd_head->frag_index;
+
+	if (frag_index != NULL) {
+		g_ptr_array_free(frag_index->frags, TRUE);
+		g_array_free(frag_index->ranges, TRUE);
+		g_free(frag_index);
+		fd_head->frag_index = NULL;
+	}
+}
+
+/*
+ * Memory budget for reassembly data.
+ *
+ * Fragment payloads and reassembled PDUs are kept in "spillable"
+ * tvbuffs.  If a memory limit has been set (see
+ * reassembly_set_memory_limit()) and the amount of payload data held
+ * in memory by all reassembly tables exceeds it, the least recently
+ * used buffers are written to a temporary file and their memory is
+ * released; they are read back in when they're accessed again, e.g.
+ * when the last fragment of a PDU arrives or when a packet is
+ * redissected.
+ *
+ * Subset tvbuffs cache their backing tvbuff's real_data pointer, so a
+ * spillable tvbuff only sets real_data if it's created while there's
+ * no limit, in which case it's never spilled; otherwise all accesses,
+ * including those through subsets, go through spill_get_ptr(), which
+ * reads the data back in if necessary.  Pointers returned from it stay
+ * valid while the buffer is pinned:
+ *
+ *	for as long as the dissection that used it is around, i.e.
+ *	until its pinfo->pool is freed, as the tvbuffs made from the
+ *	data by that dissection are freed along with it;
+ *
+ *	for good if partial reassembly has made fragment subsets of it;
+ *	that pin goes away when the reassembly table is cleaned up.
+ *
+ * Buffers used in the frame being dissected are never spilled either.
+ */
+struct tvb_spill {
+	struct tvbuff tvb;
+
+	reassembly_table *table;
+	guint8 *data;		/* in-memory copy, NULL if spilled */
+	gint64 file_offset;	/* offset in the spill file, -1 if not written */
+	guint32 last_frame;	/* last frame in which the data was used */
+	guint pins;		/* reasons the data must stay in memory */
+	GSList *users;		/* dissections using the data (spill_user) */
+	GList lru_link;		/* link in spill_store.lru */
+};
+
+/* A dissection that uses the data of a spillable tvbuff. */
+typedef struct {
+	struct tvb_spill *spill_tvb;
+	wmem_allocator_t *pool;	/* the dissection's pinfo->pool */
+	guint cb_id;		/* callback registered with the pool */
+} spill_user;
+
+static struct {
+	guint64 limit;		/* 0 means "no limit" */
+	guint64 resident;	/* bytes held in memory by all tables */
+	GQueue lru;		/* unpinned buffers, least recently used first */
+	guint32 frame;		/* frame currently being dissected */
+	int fd;			/* spill file, -1 if not open */
+	char *path;
+	gint64 size;		/* bytes written to the spill file */
+	guint file_refs;	/* buffers with data in the spill file */
+} spill_store = { 0, 0, G_QUEUE_INIT, 0, -1, NULL, 0, 0 };
+
+static const struct tvb_ops tvb_spill_ops;
+
+#define TVB_IS_SPILL(tvb)	((tvb)->ops == &tvb_spill_ops)
+
+static void
+spill_lru_remove(struct tvb_spill *spill_tvb)
+{
+	if (spill_tvb->lru_link.data != NULL) {
+		g_queue_unlink(&spill_store.lru, &spill_tvb->lru_link);
+		spill_tvb->lru_link.data = NULL;
+	}
+}
+
+/*
+ * Note that a buffer was used in the current frame.
+ */
+static void
+spill_touch(struct tvb_spill *spill_tvb)
+{
+	spill_tvb->last_frame = spill_store.frame;
+	if (spill_tvb->pins != 0)
+		return;
+	spill_lru_remove(spill_tvb);
+	spill_tvb->lru_link.data = spill_tvb;
+	g_queue_push_tail_link(&spill_store.lru, &spill_tvb->lru_link);
+}
+
+static void
+spill_file_close(void)
+{
+	if (spill_store.fd != -1) {
+		ws_close(spill_store.fd);
+		spill_store.fd = -1;
+	}
+	if (spill_store.path != NULL) {
+		ws_unlink(spill_store.path);
+		g_free(spill_store.path);
+		spill_store.path = NULL;
+	}
+	spill_store.size = 0;
+}
+
+static gboolean
+spill_file_open(void)
+{
+	char *path;
+
+	if (spill_store.fd != -1)
+		return TRUE;
+
+	spill_store.fd = create_tempfile(&path, "wireshark_reassembly");
+	if (spill_store.fd == -1)
+		return FALSE;
+#ifdef _WIN32
+	spill_store.path = g_strdup(path);
+#else
+	/* Nobody else needs to see it, and this way it goes away when we do. */
+	ws_unlink(path);
+#endif
+	spill_store.size = 0;
+	return TRUE;
+}
+
+/*
+ * Write a buffer out to the spill file (unless it's already there) and
+ * release its memory.
+ */
+static gboolean
+spill_evict(struct tvb_spill *spill_tvb)
+{
+	tvbuff_t *tvb = (tvbuff_t *) spill_tvb;
+
+	if (spill_tvb->file_offset == -1) {
+		if (!spill_file_open())
+			return FALSE;
+		if (ws_lseek64(spill_store.fd, spill_store.size, SEEK_SET) != spill_store.size ||
+		    ws_write(spill_store.fd, spill_tvb->data, tvb->length) != (int) tvb->length)
+			return FALSE;
+		spill_tvb->file_offset = spill_store.size;
+		spill_store.size += tvb->length;
+		spill_store.file_refs++;
+	}
+
+	spill_lru_remove(spill_tvb);
+	g_free(spill_tvb->data);
+	spill_tvb->data = NULL;
+
+	spill_store.resident -= tvb->length;
+	spill_tvb->table->bytes_resident -= tvb->length;
+	spill_tvb->table->bytes_spilled += tvb->length;
+	return TRUE;
+}
+
+static void
+spill_load(struct tvb_spill *spill_tvb)
+{
+	tvbuff_t *tvb = (tvbuff_t *) spill_tvb;
+	guint8 *data;
+
+	data = (guint8 *) g_malloc(tvb->length);
+	if (ws_lseek64(spill_store.fd, spill_tvb->file_offset, SEEK_SET) != spill_tvb->file_offset ||
+	    ws_read(spill_store.fd, data, tvb->length) != (int) tvb->length) {
+		g_free(data);
+		THROW_MESSAGE(ReassemblyError, "can't read back spilled reassembly data");
+	}
+
+	spill_tvb->data = data;
+
+	spill_store.resident += tvb->length;
+	spill_tvb->table->bytes_resident += tvb->length;
+	spill_tvb->table->bytes_spilled -= tvb->length;
+}
+
+/*
+ * Keep a buffer in memory until spill_unpin() is called.
+ */
+static void
+spill_pin(struct tvb_spill *spill_tvb)
+{
+	if (spill_tvb->data == NULL && spill_tvb->file_offset != -1)
+		spill_load(spill_tvb);
+	spill_lru_remove(spill_tvb);
+	spill_tvb->pins++;
+}
+
+static void
+spill_unpin(struct tvb_spill *spill_tvb)
+{
+	if (--spill_tvb->pins == 0) {
+		spill_tvb->lru_link.data = spill_tvb;
+		g_queue_push_tail_link(&spill_store.lru, &spill_tvb->lru_link);
+	}
+}
+
+/*
+ * A dissection that used a buffer has been freed, along with any
+ * tvbuffs it made from the buffer's data.
+ */
+static gboolean
+spill_user_done(wmem_allocator_t *allocator _U_, wmem_cb_event_t event _U_,
+		void *user_data)
+{
+	spill_user *user = (spill_user *) user_data;
+
+	user->spill_tvb->users = g_slist_remove(user->spill_tvb->users, user);
+	spill_unpin(user->spill_tvb);
+	g_free(user);
+
+	return FALSE;
+}
+
+/*
+ * Note that a buffer is being used in the dissection of pinfo, and keep
+ * it in memory for as long as that dissection is around.
+ */
+static void
+spill_use(const packet_info *pinfo, struct tvb_spill *spill_tvb)
+{
+	spill_user *user;
+	GSList *l;
+
+	if (pinfo->pool != NULL) {
+		for (l = spill_tvb->users; l != NULL; l = l->next) {
+			if (((spill_user *) l->data)->pool == pinfo->pool)
+				break;
+		}
+		if (l == NULL) {
+			user = g_new(spill_user, 1);
+			user->spill_tvb = spill_tvb;
+			user->pool = pinfo->pool;
+			user->cb_id = wmem_register_callback(pinfo->pool,
+			    spill_user_done, user);
+			spill_tvb->users = g_slist_prepend(spill_tvb->users, user);
+			spill_pin(spill_tvb);
+		}
+	}
+	spill_touch(spill_tvb);
+}
+
+static void
+spill_free(tvbuff_t *tvb)
+{
+	struct tvb_spill *spill_tvb = (struct tvb_spill *) tvb;
+	spill_user *user;
+	GSList *l;
+
+	for (l = spill_tvb->users; l != NULL; l = l->next) {
+		user = (spill_user *) l->data;
+		wmem_unregister_callback(user->pool, user->cb_id);
+		g_free(user);
+	}
+	g_slist_free(spill_tvb->users);
+
+	spill_lru_remove(spill_tvb);
+	if (spill_tvb->data != NULL) {
+		g_free(spill_tvb->data);
+		spill_store.resident -= tvb->length;
+		spill_tvb->table->bytes_resident -= tvb->length;
+	} else
+		spill_tvb->table->bytes_spilled -= tvb->length;
+
+	if (spill_tvb->file_offset != -1) {
+		if (--spill_store.file_refs == 0)
+			spill_file_close();
+	}
+}
+
+static guint
+spill_offset(const tvbuff_t *tvb _U_, const guint counter)
+{
+	return counter;
+}
+
+static const guint8 *
+spill_get_ptr(tvbuff_t *tvb, guint abs_offset, guint abs_length _U_)
+{
+	struct tvb_spill *spill_tvb = (struct tvb_spill *) tvb;
+
+	if (spill_tvb->data == NULL && spill_tvb->file_offset != -1)
+		spill_load(spill_tvb);
+	spill_touch(spill_tvb);
+	return spill_tvb->data + abs_offset;
+}
+
+static void *
+spill_memcpy(tvbuff_t *tvb, void *target, guint abs_offset, guint abs_length)
+{
+	return memcpy(target, spill_get_ptr(tvb, abs_offset, abs_length), abs_length);
+}
+
+static const struct tvb_ops tvb_spill_ops = {
+	sizeof(struct tvb_spill), /* size */
+
+	spill_free,           /* free */
+	spill_offset,         /* offset */
+	spill_get_ptr,        /* get_ptr */
+	spill_memcpy,         /* memcpy */
+	NULL,                 /* find_guint8 */
+	NULL,                 /* pbrk_guint8 */
+	NULL,                 /* clone */
+};
+
+/*
+ * Create a spillable tvbuff for reassembly data; takes ownership of
+ * the g_malloc()ed data.
+ */
+static tvbuff_t *
+spill_tvb_new(reassembly_table *table, guint8 *data, const guint length)
+{
+	tvbuff_t *tvb = tvb_new(&tvb_spill_ops);
+	struct tvb_spill *spill_tvb = (struct tvb_spill *) tvb;
+
+	tvb->length          = length;
+	tvb->reported_length = length;
+	tvb->initialized     = TRUE;
+	tvb->ds_tvb          = tvb;
+
+	spill_tvb->table = table;
+	spill_tvb->data = data;
+	spill_tvb->file_offset = -1;
+	spill_tvb->pins = 0;
+	spill_tvb->users = NULL;
+	spill_tvb->lru_link.data = NULL;
+	if (spill_store.limit == 0) {
+		/* Let subsets get at the data directly; this pins it. */
+		tvb->real_data = data;
+		spill_pin(spill_tvb);
+	}
+	spill_touch(spill_tvb);
+
+	spill_store.resident += length;
+	table->bytes_resident += length;
+
+	return tvb;
+}
+
+/*
+ * Copy fragment data out of a packet into a spillable tvbuff.
+ */
+static tvbuff_t *
+spill_tvb_new_copy(reassembly_table *table, tvbuff_t *tvb, const int offset,
+		   const guint length)
+{
+	return spill_tvb_new(table,
+	    (guint8 *) tvb_memdup(NULL, tvb, offset, length), length);
+}
+
+/*
+ * Keep a buffer in memory for good, because fragment subsets are about
+ * to be made of it.
+ */
+static void
+spill_tvb_pin(tvbuff_t *tvb)
+{
+	if (tvb == NULL || !TVB_IS_SPILL(tvb))
+		return;
+	spill_pin((struct tvb_spill *) tvb);
+}
+
+/*
+ * If we're over the memory limit, spill the least recently used
+ * buffers until we aren't.
+ */
+static void
+spill_enforce_limit(const packet_info *pinfo)
+{
+	struct tvb_spill *spill_tvb;
+	GList *link;
+
+	spill_store.frame = pinfo->fd->num;
+	if (spill_store.limit == 0)
+		return;
+
+	while (spill_store.resident > spill_store.limit) {
+		link = g_queue_peek_head_link(&spill_store.lru);
+		if (link == NULL)
+			break;
+		spill_tvb = (struct tvb_spill *) link->data;
+		/* The rest of the list was used in this frame. */
+		if (spill_tvb->last_frame == spill_store.frame)
+			break;
+		if (!spill_evict(spill_tvb))
+			break;
+	}
+}
+
+/*
+ * Note the frame being dissected, and that the reassembled data of
+ * fd_head (if any) is being used in it.
+ */
+static void
+spill_touch_head(const packet_info *pinfo, fragment_head *fd_head)
+{
+	spill_store.frame = pinfo->fd->num;
+	if (fd_head != NULL && fd_head->tvb_data != NULL &&
+	    TVB_IS_SPILL(fd_head->tvb_data))
+		spill_use(pinfo, (struct tvb_spill *) fd_head->tvb_data);
+
+	/* The first pass enforces the limit before adding fragments;
+	 * later passes don't add any, so do it here. */
+	if (pinfo->fd->flags.visited)
+		spill_enforce_limit(pinfo);
+}
+
+void
+reassembly_set_memory_limit(const guint64 limit)
+{
+	spill_store.limit = limit;
+}
+
+static gsize
+reassembly_memory_usage(void)
+{
+	return (gsize) spill_store.resident;
+}
+
+static const ws_mem_usage_t reassembly_stats = { "reassembly", reassembly_memory_usage, NULL };
+
 /*
  * For a fragment hash table entry, free the associated fragments.
  * The entry value (fd_chain) is freed herein and the entry is freed
@@ -337,6 +899,8 @@ free_all_fragments(gpointer key_arg _U_, gpointer value, gpointer user_data _U_)
 	/* g_hash_table_new_full() was used to supply a function
 	 * to free the key and anything to which it points
 	 */
+	fragment_index_free((fragment_head *)value);
+
 	for (fd_head = (fragment_head *)value; fd_head != NULL; fd_head = tmp_fd) {
 		tmp_fd=fd_head->next;
 
@@ -401,6 +965,7 @@ free_fragments(gpointer data, gpointer user_data _U_)
 {
 	fragment_item *fd_head = (fragment_item *) data;
 
+	fragment_index_free(fd_head);
 	if (fd_head->tvb_data)
 		tvb_free(fd_head->tvb_data);
 	g_slice_free(fragment_item, fd_head);
@@ -413,6 +978,13 @@ void
 reassembly_table_init(reassembly_table *table,
 		      const reassembly_table_functions *funcs)
 {
+	static gboolean stats_registered = FALSE;
+
+	if (!stats_registered) {
+		memory_usage_component_register(&reassembly_stats);
+		stats_registered = TRUE;
+	}
+
 	if (table->temporary_key_func == NULL)
 		table->temporary_key_func = funcs->temporary_key_func;
 	if (table->persistent_key_func == NULL)
@@ -539,6 +1111,8 @@ lookup_fd_head(reassembly_table *table, const packet_info *pinfo,
 	/* Free the key */
 	table->free_temporary_key_func(key);
 
+	spill_touch_head(pinfo, (fragment_head *)value);
+
 	return (fragment_head *)value;
 }
 
@@ -598,6 +1172,7 @@ fragment_delete(reassembly_table *table, const packet_info *pinfo,
 		g_slice_free(fragment_item, fd);
 		fd=tmp_fd;
 	}
+	fragment_index_free(fd_head);
 	g_slice_free(fragment_head, fd_head);
 	g_hash_table_remove(table->fragment_table, key);
 
@@ -640,6 +1215,7 @@ fragment_get_reassembled_id(reassembly_table *table, const packet_info *pinfo,
 	key.frame = pinfo->fd->num;
 	key.id = id;
 	fd_head = (fragment_head *)g_hash_table_lookup(table->reassembled_table, &key);
+	spill_touch_head(pinfo, fd_head);
 
 	return fd_head;
 }
@@ -825,15 +1401,26 @@ fragment_reassembled(reassembly_table *table, fragment_head *fd_head,
 static void
 LINK_FRAG(fragment_head *fd_head,fragment_item *fd)
 {
+	fragment_index *frag_index = fragment_index_get(fd_head);
 	fragment_item *fd_i;
-
-	/* add fragment to list, keep list sorted */
-	for(fd_i= fd_head; fd_i->next;fd_i=fd_i->next) {
-		if (fd->offset < fd_i->next->offset )
-			break;
-	}
+	guint low, high, mid;
+
+	/* add fragment to list, keep list sorted; it goes after all
+	 * fragments with the same or a lower offset */
+	low = 0;
+	high = frag_index->frags->len;
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		if (fd->offset < ((fragment_item *)g_ptr_array_index(frag_index->frags, mid))->offset)
+			high = mid;
+		else
+			low = mid + 1;
+	}
+	fd_i = (low == 0) ? fd_head : (fragment_item *)g_ptr_array_index(frag_index->frags, low - 1);
 	fd->next=fd_i->next;
 	fd_i->next=fd;
+
+	fragment_index_insert(frag_index, low, fd);
 }
 
 /*
@@ -858,7 +1445,8 @@ LINK_FRAG(fragment_head *fd_head,fragment_item *fd)
  * are lowered when a new extension process is started.
  */
 static gboolean
-fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
+fragment_add_work(reassembly_table *table, fragment_head *fd_head,
+		 tvbuff_t *tvb, const int offset,
 		 const packet_info *pinfo, const guint32 frag_offset,
 		 const guint32 frag_data_len, const gboolean more_frags)
 {
@@ -877,6 +1465,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	fd->fragment_nr_offset = 0; /* will only be used with sequence */
 	fd->len  = frag_data_len;
 	fd->tvb_data = NULL;
+	fd->frag_index = NULL;
 	fd->error = NULL;
 
 	/*
@@ -899,6 +1488,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 				 * Yes.  Set flag in already empty fds &
 				 * point old fds to malloc'ed data.
 				 */
+				spill_tvb_pin(fd_head->tvb_data);
 				for(fd_i=fd_head->next; fd_i; fd_i=fd_i->next){
 					if( !fd_i->tvb_data ) {
 						fd_i->tvb_data = tvb_new_subset_remaining(fd_head->tvb_data, fd_i->offset);
@@ -1016,7 +1606,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	 * XXX - what if we didn't capture the entire fragment due
 	 * to a too-short snapshot length?
 	 */
-	fd->tvb_data = tvb_clone_offset_len(tvb, offset, fd->len);
+	fd->tvb_data = spill_tvb_new_copy(table, tvb, offset, fd->len);
 	LINK_FRAG(fd_head,fd);
 
 
@@ -1030,21 +1620,13 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 
 	/*
 	 * Check if we have received the entire fragment.
-	 * This is easy since the list is sorted and the head is faked.
 	 *
-	 * First, we compute the amount of contiguous data that's
-	 * available.  (The check for fd_i->offset <= max rules out
-	 * fragments that don't start before or at the end of the
-	 * previous fragment, i.e. fragments that have a gap between
-	 * them and the previous fragment.)
+	 * First, we get the amount of contiguous data that's
+	 * available from the fragment index, which keeps track of
+	 * the ranges covered by the fragments (fragments that have
+	 * a gap between them and the previous fragment don't count).
 	 */
-	max = 0;
-	for (fd_i=fd_head->next;fd_i;fd_i=fd_i->next) {
-		if ( ((fd_i->offset)<=max) &&
-			((fd_i->offset+fd_i->len)>max) ){
-			max = fd_i->offset+fd_i->len;
-		}
-	}
+	max = fragment_index_contiguous_len(fragment_index_get(fd_head));
 
 	if (max < (fd_head->datalen)) {
 		/*
@@ -1061,8 +1643,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	/* store old data just in case */
 	old_tvb_data=fd_head->tvb_data;
 	data = (guint8 *) g_malloc(fd_head->datalen);
-	fd_head->tvb_data = tvb_new_real_data(data, fd_head->datalen, fd_head->datalen);
-	tvb_set_free_cb(fd_head->tvb_data, g_free);
+	fd_head->tvb_data = spill_tvb_new(table, data, fd_head->datalen);
 
 	/* add all data fragments */
 	for (dfpos=0,fd_i=fd_head;fd_i;fd_i=fd_i->next) {
@@ -1189,6 +1770,9 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	fd_head->flags |= FD_DEFRAGMENTED;
 	fd_head->reassembled_in=pinfo->fd->num;
 
+	/* the index is rebuilt if more fragments show up */
+	fragment_index_free(fd_head);
+
 	/* we don't throw until here to avoid leaking old_data and others */
 	if (fd_head->error) {
 		THROW_MESSAGE(ReassemblyError, fd_head->error);
@@ -1212,6 +1796,8 @@ fragment_add_common(reassembly_table *table, tvbuff_t *tvb, const int offset,
 	/* dissector shouldn't give us garbage tvb info */
 	DISSECTOR_ASSERT(tvb_bytes_exist(tvb, offset, frag_data_len));
 
+	spill_enforce_limit(pinfo);
+
 	fd_head = lookup_fd_head(table, pinfo, id, data, NULL);
 
 #if 0
@@ -1367,7 +1953,7 @@ fragment_add_common(reassembly_table *table, tvbuff_t *tvb, const int offset,
 		insert_fd_head(table, fd_head, pinfo, id, data);
 	}
 
-	if (fragment_add_work(fd_head, tvb, offset, pinfo, frag_offset,
+	if (fragment_add_work(table, fd_head, tvb, offset, pinfo, frag_offset,
 		frag_data_len, more_frags)) {
 		/*
 		 * Reassembly is complete.
@@ -1423,9 +2009,13 @@ fragment_add_check(reassembly_table *table, tvbuff_t *tvb, const int offset,
 	if (pinfo->fd->flags.visited) {
 		reass_key.frame = pinfo->fd->num;
 		reass_key.id = id;
-		return (fragment_head *)g_hash_table_lookup(table->reassembled_table, &reass_key);
+		fd_head = (fragment_head *)g_hash_table_lookup(table->reassembled_table, &reass_key);
+		spill_touch_head(pinfo, fd_head);
+		return fd_head;
 	}
 
+	spill_enforce_limit(pinfo);
+
 	/* Looks up a key in the GHashTable, returning the original key and the associated value
 	 * and a gboolean which is TRUE if the key was found. This is useful if you need to free
 	 * the memory allocated for the original key, for example before calling g_hash_table_remove()
@@ -1450,7 +2040,7 @@ fragment_add_check(reassembly_table *table, tvbuff_t *tvb, const int offset,
 	if (tvb_reported_length(tvb) > tvb_length(tvb))
 		return NULL;
 
-	if (fragment_add_work(fd_head, tvb, offset, pinfo, frag_offset,
+	if (fragment_add_work(table, fd_head, tvb, offset, pinfo, frag_offset,
 		frag_data_len, more_frags)) {
 		/*
 		 * Reassembly is complete.
@@ -1479,7 +2069,8 @@ fragment_add_check(reassembly_table *table, tvbuff_t *tvb, const int offset,
 }
 
 static void
-fragment_defragment_and_free (fragment_head *fd_head, const packet_info *pinfo)
+fragment_defragment_and_free (reassembly_table *table, fragment_head *fd_head,
+			      const packet_info *pinfo)
 {
 	fragment_item *fd_i = NULL;
 	fragment_item *last_fd = NULL;
@@ -1497,8 +2088,7 @@ fragment_defragment_and_free (fragment_head *fd_head, const packet_info *pinfo)
 	/* store old data in case the fd_i->data pointers refer to it */
 	old_tvb_data=fd_head->tvb_data;
 	data = (guint8 *) g_malloc(size);
-	fd_head->tvb_data = tvb_new_real_data(data, size, size);
-	tvb_set_free_cb(fd_head->tvb_data, g_free);
+	fd_head->tvb_data = spill_tvb_new(table, data, size);
 	fd_head->len = size;		/* record size for caller	*/
 
 	/* add all data fragments */
@@ -1539,6 +2129,9 @@ fragment_defragment_and_free (fragment_head *fd_head, const packet_info *pinfo)
 	 */
 	fd_head->flags |= FD_DEFRAGMENTED;
 	fd_head->reassembled_in=pinfo->fd->num;
+
+	/* the index is rebuilt if more fragments show up */
+	fragment_index_free(fd_head);
 }
 
 /*
@@ -1554,7 +2147,8 @@ fragment_defragment_and_free (fragment_head *fd_head, const packet_info *pinfo)
  * The bsn for the first block is 0.
  */
 static gboolean
-fragment_add_seq_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
+fragment_add_seq_work(reassembly_table *table, fragment_head *fd_head,
+		 tvbuff_t *tvb, const int offset,
 		 const packet_info *pinfo, const guint32 frag_number,
 		 const guint32 frag_data_len, const gboolean more_frags)
 {
@@ -1577,6 +2171,7 @@ fragment_add_seq_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 		fd_head->flags & FD_PARTIAL_REASSEMBLY){
 		guint32 lastdfpos = 0;
 		dfpos = 0;
+		spill_tvb_pin(fd_head->tvb_data);
 		for(fd_i=fd_head->next; fd_i; fd_i=fd_i->next){
 			if( !fd_i->tvb_data ) {
 				if( fd_i->flags & FD_OVERLAP ) {
@@ -1607,6 +2202,7 @@ fragment_add_seq_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	fd->offset = frag_number_work;
 	fd->len  = frag_data_len;
 	fd->tvb_data = NULL;
+	fd->frag_index = NULL;
 	fd->error = NULL;
 
 	if (!more_frags) {
@@ -1731,7 +2327,7 @@ fragment_add_seq_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	 */
 	/* check len, there may be a fragment with 0 len, that is actually the tail */
 	if (fd->len) {
-		fd->tvb_data = tvb_clone_offset_len(tvb, offset, fd->len);
+		fd->tvb_data = spill_tvb_new_copy(table, tvb, offset, fd->len);
 	}
 	LINK_FRAG(fd_head,fd);
 
@@ -1773,7 +2369,7 @@ fragment_add_seq_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	/* we have received an entire packet, defragment it and
 	 * free all fragments
 	 */
-	fragment_defragment_and_free(fd_head, pinfo);
+	fragment_defragment_and_free(table, fd_head, pinfo);
 
 	return TRUE;
 }
@@ -1801,6 +2397,8 @@ fragment_add_seq_common(reassembly_table *table, tvbuff_t *tvb,
 	fragment_head *fd_head;
 	gpointer orig_key;
 
+	spill_enforce_limit(pinfo);
+
 	fd_head = lookup_fd_head(table, pinfo, id, data, &orig_key);
 
 	/* have we already seen this frame ?*/
@@ -1904,7 +2502,7 @@ fragment_add_seq_common(reassembly_table *table, tvbuff_t *tvb,
 		}
 	}
 
-	if (fragment_add_seq_work(fd_head, tvb, offset, pinfo,
+	if (fragment_add_seq_work(table, fd_head, tvb, offset, pinfo,
 				  frag_number, frag_data_len, more_frags)) {
 		/*
 		 * Reassembly is complete.
@@ -1982,7 +2580,9 @@ fragment_add_seq_check_work(reassembly_table *table, tvbuff_t *tvb,
 	if (pinfo->fd->flags.visited) {
 		reass_key.frame = pinfo->fd->num;
 		reass_key.id = id;
-		return (fragment_head *)g_hash_table_lookup(table->reassembled_table, &reass_key);
+		fd_head = (fragment_head *)g_hash_table_lookup(table->reassembled_table, &reass_key);
+		spill_touch_head(pinfo, fd_head);
+		return fd_head;
 	}
 
 	fd_head = fragment_add_seq_common(table, tvb, offset, pinfo, id, data,
@@ -2084,6 +2684,7 @@ fragment_start_seq_check(reassembly_table *table, const packet_info *pinfo,
 		fd_head->flags = FD_BLOCKSEQUENCE|FD_DATALEN_SET;
 		fd_head->tvb_data = NULL;
 		fd_head->reassembled_in = 0;
+		fd_head->frag_index = NULL;
 		fd_head->error = NULL;
 
 		insert_fd_head(table, fd_head, pinfo, id, data);
@@ -2106,7 +2707,9 @@ fragment_end_seq_next(reassembly_table *table, const packet_info *pinfo,
 	if (pinfo->fd->flags.visited) {
 		reass_key.frame = pinfo->fd->num;
 		reass_key.id = id;
-		return (fragment_head *)g_hash_table_lookup(table->reassembled_table, &reass_key);
+		fd_head = (fragment_head *)g_hash_table_lookup(table->reassembled_table, &reass_key);
+		spill_touch_head(pinfo, fd_head);
+		return fd_head;
 	}
 
 	fd_head = lookup_fd_head(table, pinfo, id, data, &orig_key);
@@ -2120,7 +2723,7 @@ fragment_end_seq_next(reassembly_table *table, const packet_info *pinfo,
 		fd_head->datalen = fd_head->offset;
 		fd_head->flags |= FD_DATALEN_SET;
 
-		fragment_defragment_and_free (fd_head, pinfo);
+		fragment_defragment_and_free (table, fd_head, pinfo);
 
 		/*
 		 * Remove this from the table of in-progress reassemblies,
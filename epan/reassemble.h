@@ -89,6 +89,15 @@ typedef struct _fragment_item {
 			   a reassembly? */
 	tvbuff_t *tvb_data;
 
+	/*
+	 * Only valid in the first item of the list, and only while
+	 * fragments are being added; lookup structure that lets
+	 * fragments be linked in, and the amount of contiguous data
+	 * be determined, without walking the list.  Private to
+	 * reassemble.c.
+	 */
+	struct _fragment_index *frag_index;
+
 	/*
 	 * Null if the reassembly had no error; non-null if it had
 	 * an error, in which case it's the string for the error.
@@ -133,6 +142,8 @@ typedef struct {
 	fragment_temporary_key temporary_key_func;
 	fragment_persistent_key persistent_key_func;
 	GDestroyNotify free_temporary_key_func;		/* temporary key destruction function */
+	guint64 bytes_resident;		/* fragment and reassembled data held in memory */
+	guint64 bytes_spilled;		/* fragment and reassembled data held in the spill file */
 } reassembly_table;
 
 /*
@@ -170,6 +181,16 @@ reassembly_table_init(reassembly_table *table,
 WS_DLL_PUBLIC void
 reassembly_table_destroy(reassembly_table *table);
 
+/*
+ * Set the maximum number of bytes of fragment and reassembled data that
+ * all reassembly tables together keep in memory; 0 means no limit.
+ * Beyond that, the least recently used data is moved to a temporary
+ * file and read back in when it's needed again.  Data added while there
+ * was no limit stays in memory.
+ */
+WS_DLL_PUBLIC void
+reassembly_set_memory_limit(const guint64 limit);
+
 /*
  * This function adds a new fragment to the reassembly table
  * If this is the first fragment seen for this datagram, a new entry
@@ -1264,6 +1264,75 @@ test_fragment_add_seq_check_multiple(void) {
 }
 #endif
 
+/**********************************************************************************
+ *
+ * fragment_add
+ *
+ *********************************************************************************/
+
+/* Adds byte-offset fragments out of order, with a hole that is filled in
+ * last by a fragment overlapping both of its neighbours, and checks that
+ * the datagram is only reported complete once the hole is filled, that
+ * the fragment list is sorted and that the data is reassembled correctly.
+ */
+static void
+test_fragment_add_out_of_order(void)
+{
+    fragment_head *fd_head;
+    fragment_item *fd;
+    guint32 i, last_offset;
+
+    printf("Starting test test_fragment_add_out_of_order\n");
+
+    /* fragments of 10 bytes for offsets 100..190, in reverse order; the
+     * last one tells us the datagram is 200 bytes long */
+    for (i = 10; i > 0; i--) {
+        pinfo.fd->num = 11 - i;
+        fd_head=fragment_add(&test_reassembly_table, tvb, 100 + (i - 1) * 10,
+                             &pinfo, 12, NULL, 100 + (i - 1) * 10, 10, i != 10);
+        ASSERT_EQ(NULL,fd_head);
+    }
+
+    /* fragments for 0..89, in reverse order, leaving a hole at 90..99 */
+    for (i = 9; i > 0; i--) {
+        pinfo.fd->num = 20 - i;
+        fd_head=fragment_add(&test_reassembly_table, tvb, (i - 1) * 10,
+                             &pinfo, 12, NULL, (i - 1) * 10, 10, TRUE);
+        ASSERT_EQ(NULL,fd_head);
+    }
+    ASSERT_EQ(1,g_hash_table_size(test_reassembly_table.fragment_table));
+
+    /* a retransmission of existing data doesn't complete the datagram */
+    pinfo.fd->num = 20;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 40, &pinfo, 12, NULL,
+                         40, 20, TRUE);
+    ASSERT_EQ(NULL,fd_head);
+
+    /* fill in the hole, overlapping both neighbours */
+    pinfo.fd->num = 21;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 85, &pinfo, 12, NULL,
+                         85, 20, TRUE);
+    ASSERT_NE(NULL,fd_head);
+
+    ASSERT_EQ(200,fd_head->datalen);
+    ASSERT_EQ(21,fd_head->reassembled_in);
+    ASSERT_EQ(FD_DEFRAGMENTED|FD_DATALEN_SET|FD_OVERLAP,fd_head->flags);
+    ASSERT_NE(NULL,fd_head->tvb_data);
+
+    /* the fragments must be sorted by offset */
+    last_offset = 0;
+    i = 0;
+    for (fd = fd_head->next; fd != NULL; fd = fd->next) {
+        ASSERT(fd->offset >= last_offset);
+        last_offset = fd->offset;
+        i++;
+    }
+    ASSERT_EQ(21,i);
+
+    /* test the actual reassembly */
+    ASSERT(!tvb_memeql(fd_head->tvb_data,0,data,200));
+}
+
 /**********************************************************************************
  *
  * fragment_add_seq_next
@@ -1521,6 +1590,96 @@ test_missing_data_fragment_add_seq_next_3(void)
 }
 
 
+/**********************************************************************************
+ *
+ * fragment_add_check with a memory limit
+ *
+ *********************************************************************************/
+
+/* Add a 200-byte datagram in 20-byte fragments, one per frame, with a
+ * memory limit that's smaller than that; cold fragments, and then the
+ * reassembled datagram, must be spilled and read back in on demand.
+ */
+static void
+test_fragment_add_check_spill(void)
+{
+    fragment_head *fd_head, *fd_head2;
+    wmem_allocator_t *pool;
+    guint32 i;
+
+    printf("Starting test test_fragment_add_check_spill\n");
+
+    reassembly_set_memory_limit(64);
+
+    for (i = 0; i < 9; i++) {
+        pinfo.fd->num = i + 1;
+        fd_head=fragment_add_check(&test_reassembly_table, tvb, i * 20,
+                                   &pinfo, 14, NULL, i * 20, 20, TRUE);
+        ASSERT_EQ(NULL,fd_head);
+        /* all but the fragment added in this frame may be spilled */
+        ASSERT(test_reassembly_table.bytes_resident <= 64 + 20);
+        ASSERT_EQ((i + 1) * 20,(guint)(test_reassembly_table.bytes_resident +
+                                        test_reassembly_table.bytes_spilled));
+    }
+    ASSERT(test_reassembly_table.bytes_spilled > 0);
+
+    pinfo.fd->num = 10;
+    fd_head=fragment_add_check(&test_reassembly_table, tvb, 180, &pinfo, 14,
+                               NULL, 180, 20, FALSE);
+    ASSERT_NE(NULL,fd_head);
+    ASSERT_EQ(200,fd_head->datalen);
+    ASSERT_EQ(FD_DEFRAGMENTED|FD_DATALEN_SET,fd_head->flags);
+    ASSERT(!tvb_memeql(fd_head->tvb_data,0,data,200));
+
+    /* only the reassembled datagram is left */
+    ASSERT_EQ(200,(guint)test_reassembly_table.bytes_resident);
+    ASSERT_EQ(0,(guint)test_reassembly_table.bytes_spilled);
+
+    /* another datagram in a later frame pushes the first one out */
+    pinfo.fd->num = 11;
+    fd_head2=fragment_add_check(&test_reassembly_table, tvb, 0, &pinfo, 15,
+                                NULL, 0, 20, TRUE);
+    ASSERT_EQ(NULL,fd_head2);
+    ASSERT_EQ(20,(guint)test_reassembly_table.bytes_resident);
+    ASSERT_EQ(200,(guint)test_reassembly_table.bytes_spilled);
+
+    /* redissecting the frame reads it back in, and the limit still
+     * applies, so that pushes the other datagram out */
+    pool = wmem_allocator_new(WMEM_ALLOCATOR_SIMPLE);
+    pinfo.pool = pool;
+    pinfo.fd->flags.visited = 1;
+    pinfo.fd->num = 10;
+    fd_head2=fragment_add_check(&test_reassembly_table, tvb, 180, &pinfo, 14,
+                                NULL, 180, 20, FALSE);
+    ASSERT_EQ(fd_head,fd_head2);
+    ASSERT(!tvb_memeql(fd_head->tvb_data,0,data,200));
+    ASSERT_EQ(200,(guint)test_reassembly_table.bytes_resident);
+    ASSERT_EQ(20,(guint)test_reassembly_table.bytes_spilled);
+
+    /* the redissected data stays in memory for as long as that
+     * dissection is around... */
+    pinfo.pool = NULL;
+    pinfo.fd->flags.visited = 0;
+    pinfo.fd->num = 12;
+    fd_head2=fragment_add_check(&test_reassembly_table, tvb, 20, &pinfo, 15,
+                                NULL, 20, 20, TRUE);
+    ASSERT_EQ(NULL,fd_head2);
+    ASSERT_EQ(220,(guint)test_reassembly_table.bytes_resident);
+    ASSERT_EQ(20,(guint)test_reassembly_table.bytes_spilled);
+
+    /* ...and can be spilled again once it's gone */
+    wmem_destroy_allocator(pool);
+    pinfo.fd->num = 13;
+    fd_head2=fragment_add_check(&test_reassembly_table, tvb, 40, &pinfo, 15,
+                                NULL, 40, 20, TRUE);
+    ASSERT_EQ(NULL,fd_head2);
+    ASSERT_EQ(20,(guint)test_reassembly_table.bytes_resident);
+    ASSERT_EQ(240,(guint)test_reassembly_table.bytes_spilled);
+    ASSERT(!tvb_memeql(fd_head->tvb_data,0,data,200));
+
+    reassembly_set_memory_limit(0);
+}
+
 /**********************************************************************************
  *
  * main
@@ -1548,6 +1707,8 @@ main(int argc _U_, char **argv _U_)
         test_missing_data_fragment_add_seq_next,
         test_missing_data_fragment_add_seq_next_2,
         test_missing_data_fragment_add_seq_next_3,
+        test_fragment_add_out_of_order,
+        test_fragment_add_check_spill,
 #if 0
         test_fragment_add_seq_check_multiple
 #endif
@@ -0,0 +1,370 @@
+/* resolv_db.c
+ * Compiled, memory-mapped forms of the name resolution files
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <wsutil/file_util.h>
+
+#include "resolv_db.h"
+
+#define RESOLV_DB_MAGIC     0x44525357  /* "WSRD" */
+#define RESOLV_DB_VERSION   1
+#define RESOLV_DB_SUFFIX    ".wsdb"
+
+#define RESOLV_DB_MAX_KEY_LEN   16
+
+/* Each entry is its key, padded to a multiple of 4 bytes, followed by the
+   offset of its name in the strings. */
+#define KEY_SPACE(key_len)      (((key_len) + 3) & ~3)
+#define ENTRY_SIZE(key_len)     (KEY_SPACE(key_len) + 4)
+
+static const guint key_lens[RESOLV_DB_NUM_TABLES] = {
+    4,      /* RESOLV_DB_IPV4 */
+    16,     /* RESOLV_DB_IPV6 */
+    6,      /* RESOLV_DB_ETHER */
+    3,      /* RESOLV_DB_MANUF */
+    6       /* RESOLV_DB_WKA */
+};
+
+/* Start of a database file; the tables follow it, in resolv_db_table
+   order, and then the strings.  The first string is the path of the file
+   the database was compiled from. */
+typedef struct {
+    guint32 magic;
+    guint32 version;
+    gint64  file_size;      /* of the source file */
+    gint64  file_mtime;     /* of the source file */
+    guint32 count[RESOLV_DB_NUM_TABLES];
+    guint32 strings_len;
+} resolv_db_file_hdr;
+
+struct resolv_db {
+    GMappedFile  *mapped;   /* NULL if the database is only in memory */
+    gchar        *image;    /* the database, if it's only in memory */
+    const guint8 *entries[RESOLV_DB_NUM_TABLES];
+    guint32       count[RESOLV_DB_NUM_TABLES];
+    const gchar  *strings;
+    guint32       strings_len;
+};
+
+typedef struct {
+    guint8  key[RESOLV_DB_MAX_KEY_LEN];
+    guint32 seq;            /* order in which it was added */
+    guint32 name;           /* offset of the name in the strings */
+} builder_entry;
+
+struct resolv_db_builder {
+    gchar    *source_path;
+    gint64    file_size;
+    gint64    file_mtime;
+    gboolean  first_wins;
+    GArray   *entries[RESOLV_DB_NUM_TABLES];   /* of builder_entry */
+    GString  *strings;
+    guint32   seq;
+};
+
+static gchar *
+resolv_db_path(const char *dir, const char *source_path)
+{
+    gchar *base, *name, *path;
+
+    /* The hash tells apart files with the same name in different
+       directories, such as the global and personal hosts files. */
+    base = g_path_get_basename(source_path);
+    name = g_strdup_printf("%s-%08x" RESOLV_DB_SUFFIX, base,
+            g_str_hash(source_path));
+    path = g_build_filename(dir, name, NULL);
+    g_free(name);
+    g_free(base);
+    return path;
+}
+
+/* Point db at the tables in the image of a database, after making sure
+   that it's consistent and that it's for the file at source_path as
+   described by statb. */
+static gboolean
+resolv_db_attach(resolv_db *db, const gchar *image, gsize len,
+        const char *source_path, const ws_statb64 *statb)
+{
+    const resolv_db_file_hdr *hdr = (const resolv_db_file_hdr *)image;
+    gsize offset;
+    int i;
+
+    if (image == NULL || len < sizeof *hdr ||
+            hdr->magic != RESOLV_DB_MAGIC ||
+            hdr->version != RESOLV_DB_VERSION ||
+            hdr->file_size != statb->st_size ||
+            hdr->file_mtime != (gint64)statb->st_mtime)
+        return FALSE;
+
+    offset = sizeof *hdr;
+    for (i = 0; i < RESOLV_DB_NUM_TABLES; i++) {
+        if (hdr->count[i] > (len - offset) / ENTRY_SIZE(key_lens[i]))
+            return FALSE;
+        db->entries[i] = (const guint8 *)image + offset;
+        db->count[i] = hdr->count[i];
+        offset += (gsize)hdr->count[i] * ENTRY_SIZE(key_lens[i]);
+    }
+    if (hdr->strings_len == 0 || len - offset != hdr->strings_len ||
+            image[len - 1] != '\0')
+        return FALSE;
+    db->strings = image + offset;
+    db->strings_len = hdr->strings_len;
+
+    return strcmp(db->strings, source_path) == 0;
+}
+
+resolv_db *
+resolv_db_open(const char *dir, const char *source_path)
+{
+    ws_statb64 statb;
+    gchar *path;
+    GMappedFile *mapped;
+    resolv_db *db;
+
+    if (ws_stat64(source_path, &statb) < 0)
+        return NULL;
+
+    path = resolv_db_path(dir, source_path);
+    mapped = g_mapped_file_new(path, FALSE, NULL);
+    g_free(path);
+    if (mapped == NULL)
+        return NULL;
+
+    db = g_new0(resolv_db, 1);
+    db->mapped = mapped;
+    if (!resolv_db_attach(db, g_mapped_file_get_contents(mapped),
+                g_mapped_file_get_length(mapped), source_path, &statb)) {
+        resolv_db_close(db);
+        return NULL;
+    }
+    return db;
+}
+
+resolv_db_builder *
+resolv_db_builder_new(const char *source_path, gboolean first_wins)
+{
+    ws_statb64 statb;
+    resolv_db_builder *builder;
+    int i;
+
+    if (ws_stat64(source_path, &statb) < 0)
+        return NULL;
+
+    builder = g_new0(resolv_db_builder, 1);
+    builder->source_path = g_strdup(source_path);
+    builder->file_size = statb.st_size;
+    builder->file_mtime = statb.st_mtime;
+    builder->first_wins = first_wins;
+    for (i = 0; i < RESOLV_DB_NUM_TABLES; i++)
+        builder->entries[i] = g_array_new(FALSE, FALSE, sizeof (builder_entry));
+    builder->strings = g_string_new("");
+    g_string_append_len(builder->strings, source_path, strlen(source_path) + 1);
+    return builder;
+}
+
+void
+resolv_db_builder_add(resolv_db_builder *builder, resolv_db_table table,
+        const guint8 *key, const char *name)
+{
+    builder_entry entry;
+
+    memset(entry.key, 0, sizeof entry.key);
+    memcpy(entry.key, key, key_lens[table]);
+    entry.seq = builder->seq++;
+    entry.name = (guint32)builder->strings->len;
+    g_string_append_len(builder->strings, name, strlen(name) + 1);
+    g_array_append_val(builder->entries[table], entry);
+}
+
+static gint
+builder_entry_cmp(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    const builder_entry *ea = (const builder_entry *)a;
+    const builder_entry *eb = (const builder_entry *)b;
+    int cmp;
+
+    cmp = memcmp(ea->key, eb->key, *(const guint *)user_data);
+    if (cmp != 0)
+        return cmp;
+    return ea->seq < eb->seq ? -1 : (ea->seq > eb->seq ? 1 : 0);
+}
+
+/* Sort a table by key and drop all but one of the entries for each key;
+   returns the number left. */
+static guint
+builder_sort_table(GArray *entries, guint key_len, gboolean first_wins)
+{
+    builder_entry *e = (builder_entry *)(void *)entries->data;
+    guint i, n = 0;
+
+    g_array_sort_with_data(entries, builder_entry_cmp, &key_len);
+    for (i = 0; i < entries->len; i++) {
+        if (n != 0 && memcmp(e[n - 1].key, e[i].key, key_len) == 0) {
+            /* Entries for the same key are in the order they were added */
+            if (!first_wins)
+                e[n - 1] = e[i];
+            continue;
+        }
+        e[n++] = e[i];
+    }
+    g_array_set_size(entries, n);
+    return n;
+}
+
+resolv_db *
+resolv_db_builder_finish(resolv_db_builder *builder, const char *dir)
+{
+    resolv_db_file_hdr hdr;
+    ws_statb64 statb;
+    GByteArray *image;
+    resolv_db *db;
+    gchar *path;
+    guint8 *p;
+    builder_entry *entry;
+    gsize len;
+    guint i, j;
+
+    memset(&hdr, 0, sizeof hdr);
+    hdr.magic = RESOLV_DB_MAGIC;
+    hdr.version = RESOLV_DB_VERSION;
+    hdr.file_size = builder->file_size;
+    hdr.file_mtime = builder->file_mtime;
+    hdr.strings_len = (guint32)builder->strings->len;
+
+    image = g_byte_array_new();
+    g_byte_array_append(image, (const guint8 *)&hdr, sizeof hdr);
+    for (i = 0; i < RESOLV_DB_NUM_TABLES; i++) {
+        hdr.count[i] = builder_sort_table(builder->entries[i], key_lens[i],
+                builder->first_wins);
+        j = image->len;
+        g_byte_array_set_size(image, j + hdr.count[i] * ENTRY_SIZE(key_lens[i]));
+        p = image->data + j;
+        for (j = 0; j < hdr.count[i]; j++) {
+            entry = &g_array_index(builder->entries[i], builder_entry, j);
+            memcpy(p, entry->key, KEY_SPACE(key_lens[i]));
+            memcpy(p + KEY_SPACE(key_lens[i]), &entry->name, 4);
+            p += ENTRY_SIZE(key_lens[i]);
+        }
+    }
+    memcpy(image->data, &hdr, sizeof hdr);
+    g_byte_array_append(image, (const guint8 *)builder->strings->str,
+            (guint)builder->strings->len);
+
+    /* Don't save a database for a file that changed while we were
+       reading it; g_file_set_contents() replaces the database atomically,
+       so other processes never see a partly-written one. */
+    db = NULL;
+    if (ws_stat64(builder->source_path, &statb) == 0 &&
+            statb.st_size == builder->file_size &&
+            (gint64)statb.st_mtime == builder->file_mtime &&
+            g_mkdir_with_parents(dir, 0755) == 0) {
+        path = resolv_db_path(dir, builder->source_path);
+        if (g_file_set_contents(path, (const gchar *)image->data, image->len, NULL))
+            db = resolv_db_open(dir, builder->source_path);
+        g_free(path);
+    }
+
+    if (db == NULL) {
+        len = image->len;
+        statb.st_size = builder->file_size;
+        statb.st_mtime = (time_t)builder->file_mtime;
+        db = g_new0(resolv_db, 1);
+        db->image = (gchar *)g_byte_array_free(image, FALSE);
+        resolv_db_attach(db, db->image, len, builder->source_path, &statb);
+    } else {
+        g_byte_array_free(image, TRUE);
+    }
+
+    resolv_db_builder_free(builder);
+    return db;
+}
+
+void
+resolv_db_builder_free(resolv_db_builder *builder)
+{
+    int i;
+
+    if (builder == NULL)
+        return;
+
+    for (i = 0; i < RESOLV_DB_NUM_TABLES; i++)
+        g_array_free(builder->entries[i], TRUE);
+    g_string_free(builder->strings, TRUE);
+    g_free(builder->source_path);
+    g_free(builder);
+}
+
+const char *
+resolv_db_lookup(const resolv_db *db, resolv_db_table table,
+        const guint8 *key)
+{
+    const guint8 *entries = db->entries[table];
+    guint key_len = key_lens[table];
+    guint32 lo = 0, hi = db->count[table], mid, name;
+    const guint8 *entry;
+    int cmp;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        entry = entries + (gsize)mid * ENTRY_SIZE(key_len);
+        cmp = memcmp(key, entry, key_len);
+        if (cmp == 0) {
+            memcpy(&name, entry + KEY_SPACE(key_len), 4);
+            return name < db->strings_len ? db->strings + name : NULL;
+        }
+        if (cmp < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return NULL;
+}
+
+void
+resolv_db_close(resolv_db *db)
+{
+    if (db == NULL)
+        return;
+
+    if (db->mapped != NULL)
+        g_mapped_file_unref(db->mapped);
+    g_free(db->image);
+    g_free(db);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
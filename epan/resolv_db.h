@@ -0,0 +1,90 @@
+/* resolv_db.h
+ * Compiled, memory-mapped forms of the name resolution files
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __RESOLV_DB_H__
+#define __RESOLV_DB_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * A name resolution file (hosts, manuf, ethers) can be compiled into a
+ * database file holding a sorted table of fixed-size keys for each kind
+ * of address in it, followed by the names.  The database is mapped
+ * rather than read, so looking names up in it doesn't require parsing
+ * the file, and processes using the same file share its pages.
+ *
+ * Databases live in a directory of their own, named after the file they
+ * were compiled from, and are only used if that file has the same size
+ * and modification time as when they were written.  They're in the byte
+ * order of the machine that wrote them; one written on another machine
+ * is ignored and rewritten.
+ */
+
+typedef enum {
+    RESOLV_DB_IPV4,     /* 4-byte IPv4 address, in network byte order */
+    RESOLV_DB_IPV6,     /* 16-byte IPv6 address */
+    RESOLV_DB_ETHER,    /* 6-byte MAC address */
+    RESOLV_DB_MANUF,    /* 3-byte OUI */
+    RESOLV_DB_WKA,      /* 6-byte MAC address with the bits outside the mask cleared */
+    RESOLV_DB_NUM_TABLES
+} resolv_db_table;
+
+typedef struct resolv_db resolv_db;
+typedef struct resolv_db_builder resolv_db_builder;
+
+/** Open the database in dir for the file at source_path.  Returns NULL if
+ * there isn't one, or it's out of date or damaged. */
+resolv_db *resolv_db_open(const char *dir, const char *source_path);
+
+/** Start compiling the file at source_path.  If first_wins is TRUE, the
+ * first name added for an address is the one looked up, otherwise the
+ * last one is.  Returns NULL if the file can't be looked at, with errno
+ * set. */
+resolv_db_builder *resolv_db_builder_new(const char *source_path,
+    gboolean first_wins);
+
+/** Add the name for key, which is as long as table's keys, to table. */
+void resolv_db_builder_add(resolv_db_builder *builder, resolv_db_table table,
+    const guint8 *key, const char *name);
+
+/** Write the database to dir, creating it if necessary, and free builder.
+ * If the file changed while it was being compiled, or the database can't
+ * be written, it's only kept in memory. */
+resolv_db *resolv_db_builder_finish(resolv_db_builder *builder,
+    const char *dir);
+
+/** Free builder without writing the database. */
+void resolv_db_builder_free(resolv_db_builder *builder);
+
+/** Look key up in table; returns NULL if it's not there. */
+const char *resolv_db_lookup(const resolv_db *db, resolv_db_table table,
+    const guint8 *key);
+
+void resolv_db_close(resolv_db *db);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __RESOLV_DB_H__ */
@@ -128,6 +128,7 @@ free_stat_node(stat_node *node)
 		g_free(bucket);
 	}
 
+	g_free(node->rng_index);
 	g_free(node->rng);
 	g_free(node->name);
 	g_free(node);
@@ -255,6 +256,107 @@ stats_tree_reinit(void *p)
 	}
 }
 
+static stat_node*
+new_stat_node(stats_tree *st, const gchar *name, int parent_id,
+	      gboolean with_hash, gboolean as_parent_node);
+static void
+index_range_node(stat_node *rng_root);
+
+/* finds the child of node named name, if any */
+static stat_node*
+find_stat_node_child(stat_node *node, const gchar *name)
+{
+	stat_node *child;
+
+	if (node->hash)
+		return (stat_node *)g_hash_table_lookup(node->hash,name);
+
+	for (child = node->children; child; child = child->next) {
+		if (strcmp(child->name,name) == 0)
+			return child;
+	}
+
+	return NULL;
+}
+
+/* returns node's id, giving it one (without making it a named parent) if needed */
+static int
+stat_node_get_id(stat_node *node)
+{
+	stats_tree *st = node->st;
+
+	if (node->id < 0) {
+		g_ptr_array_add(st->parents,node);
+		node->id = st->parents->len - 1;
+	}
+
+	return node->id;
+}
+
+/* adds the values of src and its children to those of node */
+static void
+merge_stat_node(stat_node *node, const stat_node *src)
+{
+	const stat_node *src_child;
+
+	node->counter += src->counter;
+	node->total += src->total;
+	if (node->minvalue > src->minvalue)
+		node->minvalue = src->minvalue;
+	if (node->maxvalue < src->maxvalue)
+		node->maxvalue = src->maxvalue;
+	node->st_flags |= src->st_flags;
+
+	/*
+	 * We can't tell which bursts overlapped in time without the buckets
+	 * of both, so the best we can do is keep the largest of the two.
+	 */
+	if (src->max_burst > node->max_burst) {
+		node->max_burst = src->max_burst;
+		node->burst_time = src->burst_time;
+	}
+
+	for (src_child = src->children; src_child; src_child = src_child->next) {
+		stat_node *child = find_stat_node_child(node,src_child->name);
+
+		if (child == NULL) {
+			child = new_stat_node(node->st, src_child->name,
+					      stat_node_get_id(node),
+					      src_child->hash != NULL,
+					      src_child->is_parent);
+
+			if (src_child->rng) {
+				child->rng = (range_pair_t *)g_memdup(src_child->rng, sizeof(range_pair_t));
+				index_range_node(node);
+			}
+		}
+
+		merge_stat_node(child,src_child);
+	}
+}
+
+/* adds the counts of another tree of the same cfg to this one */
+extern void
+stats_tree_merge(void *p, const void *p_src)
+{
+	stats_tree *st = (stats_tree *)p;
+	const stats_tree *src = (const stats_tree *)p_src;
+
+	if (st->cfg != src->cfg)
+		return;
+
+	if (src->start >= 0.0 && (st->start < 0.0 || src->start < st->start))
+		st->start = src->start;
+
+	if (src->now > st->now)
+		st->now = src->now;
+
+	if (st->start >= 0.0)
+		st->elapsed = st->now - st->start;
+
+	merge_stat_node(&st->root,&src->root);
+}
+
 /* register a new stats_tree */
 extern void
 stats_tree_register_with_group(const char *tapname, const char *abbr, const char *name,
@@ -339,6 +441,7 @@ stats_tree_new(stats_tree_cfg *cfg, tree_pres *pr, const char *filter)
 
 	st->start = -1.0;
 	st->elapsed = 0.0;
+	st->now = -1.0;
 
 	st->root.counter = 0;
 	st->root.total = 0;
@@ -359,6 +462,8 @@ stats_tree_new(stats_tree_cfg *cfg, tree_pres *pr, const char *filter)
 	st->root.next = NULL;
 	st->root.hash = NULL;
 	st->root.pr = NULL;
+	st->root.id = 0;
+	st->root.is_parent = TRUE;
 
 	st->st_flags = st->cfg->st_flags;
 
@@ -499,6 +604,10 @@ new_stat_node(stats_tree *st, const gchar *name, int parent_id,
 	node->hash = with_hash ? g_hash_table_new(g_str_hash,g_str_equal) : NULL;
 	node->parent = NULL;
 	node->rng  =  NULL;
+	node->rng_index = NULL;
+	node->rng_count = 0;
+
+	node->is_parent = as_parent_node;
 
 	if (as_parent_node) {
 		g_hash_table_insert(st->names,
@@ -659,26 +768,9 @@ update_burst_calc(stat_node *node, gint value)
  * using parent_name as parent node.
  * with_hash=TRUE to indicate that the created node will have a parent
  */
-extern int
-stats_tree_manip_node(manip_node_mode mode, stats_tree *st, const char *name,
-		      int parent_id, gboolean with_hash, gint value)
+static void
+manip_stat_node(manip_node_mode mode, stat_node *node, gint value)
 {
-	stat_node *node = NULL;
-	stat_node *parent = NULL;
-
-	g_assert( parent_id >= 0 && parent_id < (int) st->parents->len );
-
-	parent = (stat_node *)g_ptr_array_index(st->parents,parent_id);
-
-	if( parent->hash ) {
-		node = (stat_node *)g_hash_table_lookup(parent->hash,name);
-	} else {
-		node = (stat_node *)g_hash_table_lookup(st->names,name);
-	}
-
-	if ( node == NULL )
-		node = new_stat_node(st,name,parent_id,with_hash,with_hash);
-
 	switch (mode) {
 		case MN_INCREASE:
 				node->counter += value;
@@ -706,11 +798,60 @@ stats_tree_manip_node(manip_node_mode mode, stats_tree *st, const char *name,
 				node->st_flags &= ~value;
 				break;
 	}
+}
 
-	if (node)
-		return node->id;
-	else
-		return -1;
+/* finds the node named name under parent_id, creating it if needed */
+static stat_node *
+get_stat_node(stats_tree *st, const char *name, int parent_id, gboolean with_hash)
+{
+	stat_node *node = NULL;
+	stat_node *parent = NULL;
+
+	g_assert( parent_id >= 0 && parent_id < (int) st->parents->len );
+
+	parent = (stat_node *)g_ptr_array_index(st->parents,parent_id);
+
+	if( parent->hash ) {
+		node = (stat_node *)g_hash_table_lookup(parent->hash,name);
+	} else {
+		node = (stat_node *)g_hash_table_lookup(st->names,name);
+	}
+
+	if ( node == NULL )
+		node = new_stat_node(st,name,parent_id,with_hash,with_hash);
+
+	return node;
+}
+
+extern int
+stats_tree_manip_node(manip_node_mode mode, stats_tree *st, const char *name,
+		      int parent_id, gboolean with_hash, gint value)
+{
+	stat_node *node = get_stat_node(st,name,parent_id,with_hash);
+
+	manip_stat_node(mode,node,value);
+
+	return node->id;
+}
+
+/*
+ * Returns an id for the node named name (creating it if needed), that can
+ * be used to update it with stats_tree_manip_node_id() without any lookup.
+ */
+extern int
+stats_tree_get_node_id(stats_tree *st, const char *name, int parent_id, gboolean with_hash)
+{
+	return stat_node_get_id(get_stat_node(st,name,parent_id,with_hash));
+}
+
+extern int
+stats_tree_manip_node_id(manip_node_mode mode, stats_tree *st, int node_id, gint value)
+{
+	g_assert( node_id >= 0 && node_id < (int) st->parents->len );
+
+	manip_stat_node(mode,(stat_node *)g_ptr_array_index(st->parents,node_id),value);
+
+	return node_id;
 }
 
 
@@ -791,6 +932,91 @@ get_range(char *rngstr)
 }
 
 
+static int
+range_node_cmp(const void *a, const void *b)
+{
+	const stat_node *na = *(const stat_node * const *)a;
+	const stat_node *nb = *(const stat_node * const *)b;
+
+	if (na->rng->floor < nb->rng->floor) return -1;
+	if (na->rng->floor > nb->rng->floor) return 1;
+	return 0;
+}
+
+/*
+ * Sorts the children of a range node by range so that stats_tree_tick_range()
+ * can binary search them.  Overlapping ranges are matched in the order they
+ * were given, so those are left for it to walk in that order.
+ */
+static void
+index_range_node(stat_node *rng_root)
+{
+	stat_node *child;
+	guint i, count = 0;
+
+	g_free(rng_root->rng_index);
+	rng_root->rng_index = NULL;
+	rng_root->rng_count = 0;
+
+	for (child = rng_root->children; child; child = child->next) {
+		if (!child->rng)
+			return;
+		count++;
+	}
+
+	if (count == 0)
+		return;
+
+	rng_root->rng_index = (stat_node **)g_malloc(count * sizeof(stat_node *));
+	for (i = 0, child = rng_root->children; child; child = child->next)
+		rng_root->rng_index[i++] = child;
+
+	qsort(rng_root->rng_index, count, sizeof(stat_node *), range_node_cmp);
+
+	for (i = 1; i < count; i++) {
+		if (rng_root->rng_index[i]->rng->floor <= rng_root->rng_index[i-1]->rng->ceil) {
+			g_free(rng_root->rng_index);
+			rng_root->rng_index = NULL;
+			return;
+		}
+	}
+
+	rng_root->rng_count = count;
+}
+
+/* finds the child of a range node whose range holds value, if any */
+static stat_node *
+find_range_child(stat_node *node, gint value)
+{
+	stat_node *child;
+
+	if (node->rng_index) {
+		guint lo = 0, hi = node->rng_count;
+
+		/* find the last range starting at or below value */
+		while (lo < hi) {
+			guint mid = (lo + hi) / 2;
+
+			if (node->rng_index[mid]->rng->floor <= value)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		if (lo > 0 && value <= node->rng_index[lo-1]->rng->ceil)
+			return node->rng_index[lo-1];
+
+		return NULL;
+	}
+
+	for (child = node->children; child; child = child->next) {
+		if (value >= child->rng->floor && value <= child->rng->ceil)
+			return child;
+	}
+
+	return NULL;
+}
+
 extern int
 stats_tree_create_range_node(stats_tree *st, const gchar *name, int parent_id, ...)
 {
@@ -806,6 +1032,8 @@ stats_tree_create_range_node(stats_tree *st, const gchar *name, int parent_id, .
 	}
 	va_end( list );
 
+	index_range_node(rng_root);
+
 	return rng_root->id;
 }
 
@@ -823,6 +1051,8 @@ stats_tree_create_range_node_string(stats_tree *st, const gchar *name,
 		range_node->rng = get_range(str_ranges[i]);
 	}
 
+	index_range_node(rng_root);
+
 	return rng_root->id;
 }
 
@@ -856,6 +1086,8 @@ stats_tree_range_node_with_pname(stats_tree *st, const gchar *name,
 	}
 	va_end( list );
 
+	index_range_node(rng_root);
+
 	return rng_root->id;
 }
 
@@ -868,7 +1100,6 @@ stats_tree_tick_range(stats_tree *st, const gchar *name, int parent_id,
 	stat_node *node = NULL;
 	stat_node *parent = NULL;
 	stat_node *child = NULL;
-	gint stat_floor, stat_ceil;
 
 	if (parent_id >= 0 && parent_id < (int) st->parents->len) {
 		parent = (stat_node *)g_ptr_array_index(st->parents,parent_id);
@@ -895,23 +1126,19 @@ stats_tree_tick_range(stats_tree *st, const gchar *name, int parent_id,
 	}
 	node->st_flags |= ST_FLG_AVERAGE;
 
-	for ( child = node->children; child; child = child->next) {
-		stat_floor =  child->rng->floor;
-		stat_ceil = child->rng->ceil;
+	child = find_range_child(node, value_in_range);
 
-		if ( value_in_range >= stat_floor && value_in_range <= stat_ceil ) {
-			child->counter++;
-			child->total += value_in_range;
-			if (child->minvalue > value_in_range) {
-				child->minvalue = value_in_range;
-			}
-			if (child->maxvalue < value_in_range) {
-				child->maxvalue = value_in_range;
-			}
-			child->st_flags |= ST_FLG_AVERAGE;
-			update_burst_calc(child, 1);
-			return node->id;
+	if (child) {
+		child->counter++;
+		child->total += value_in_range;
+		if (child->minvalue > value_in_range) {
+			child->minvalue = value_in_range;
+		}
+		if (child->maxvalue < value_in_range) {
+			child->maxvalue = value_in_range;
 		}
+		child->st_flags |= ST_FLG_AVERAGE;
+		update_burst_calc(child, 1);
 	}
 
 	return node->id;
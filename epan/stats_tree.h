@@ -233,6 +233,36 @@ WS_DLL_PUBLIC int stats_tree_manip_node(manip_node_mode mode,
 #define stat_node_clear_flags(st,name,parent_id,with_children,flags) \
 (stats_tree_manip_node(MN_CLEAR_FLAGS,(st),(name),(parent_id),(with_children),flags))
 
+/*
+ * Returns an id for the node whose name is given, creating it if it does not
+ * exist yet, so that it can be manipulated with the *_stat_node_id() macros
+ * without looking it up by name every time.  Trees that tick a node with a
+ * formatted name for every packet can resolve it once and keep the id
+ * (until the tree is reset by its init callback being called again).
+ */
+WS_DLL_PUBLIC int stats_tree_get_node_id(stats_tree *st,
+				  const gchar *name,
+				  int parent_id,
+				  gboolean with_children);
+
+/* manipulates the value of a node given its id */
+WS_DLL_PUBLIC int stats_tree_manip_node_id(manip_node_mode mode,
+				    stats_tree *st,
+				    int node_id,
+				    gint value);
+
+#define increase_stat_node_id(st,node_id,value) \
+(stats_tree_manip_node_id(MN_INCREASE,(st),(node_id),(value)))
+
+#define tick_stat_node_id(st,node_id) \
+(stats_tree_manip_node_id(MN_INCREASE,(st),(node_id),1))
+
+#define set_stat_node_id(st,node_id,value) \
+(stats_tree_manip_node_id(MN_SET,(st),(node_id),(value)))
+
+#define avg_stat_node_add_value_id(st,node_id,value) \
+(stats_tree_manip_node_id(MN_AVERAGE,(st),(node_id),(value)))
+
 #endif /* __STATS_TREE_H */
 
 /*
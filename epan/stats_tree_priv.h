@@ -67,6 +67,8 @@ struct _burst_bucket {
 struct _stat_node {
 	gchar*			name;
 	int			id;
+	/** whether it's a named parent; other nodes may have an id too */
+	gboolean		is_parent;
 
 	/** the counter it keeps */
 	gint			counter;
@@ -96,6 +98,10 @@ struct _stat_node {
 	/** used to check if value is within range */
 	range_pair_t		*rng;
 
+	/** for a range node: its children sorted by range, if they don't overlap */
+	stat_node		**rng_index;
+	guint			rng_count;
+
 	/** node presentation data */
 	st_node_pres		*pr;
 };
@@ -203,6 +209,9 @@ WS_DLL_PUBLIC void stats_tree_reset(void *p_st);
 /** callback for clear */
 WS_DLL_PUBLIC void stats_tree_reinit(void *p_st);
 
+/** callback for merge: adds the counts of another tree of the same cfg */
+WS_DLL_PUBLIC void stats_tree_merge(void *p_st, const void *p_src);
+
 /* callback for destoy */
 WS_DLL_PUBLIC void stats_tree_free(stats_tree *st);
 
@@ -32,6 +32,7 @@
 # include <netinet/in.h>
 #endif
 
+#include <stdlib.h>
 #include <string.h>
 #include <epan/packet_info.h>
 #include <epan/dfilter/dfilter.h>
@@ -68,13 +69,31 @@ typedef struct _tap_listener_t {
 	gboolean needs_redraw;
 	guint flags;
 	dfilter_t *code;
+	char *fstring;
+	/* Listener, possibly this one, whose filter is applied on behalf of
+	   all of the listeners with the same filter string */
+	struct _tap_listener_t *filter_owner;
+	guint filter_push;	/* push the result below is valid for */
+	gboolean filter_passed;
 	void *tapdata;
 	tap_reset_cb reset;
 	tap_packet_cb packet;
 	tap_draw_cb draw;
+	tap_merge_cb merge;
+	/* Only kept if tap timing is enabled */
+	guint64 packet_calls;
+	double packet_secs;
+	guint64 filter_calls;
+	double filter_secs;
 } tap_listener_t;
 static volatile tap_listener_t *tap_listener_queue=NULL;
 
+/* Counts calls to tap_push_tapped_queue() with anything queued; the
+   filter results cached in the listeners are valid for one push only */
+static guint tap_push_count;
+
+static GTimer *tap_timer=NULL;
+
 #ifdef HAVE_PLUGINS
 
 #include <gmodule.h>
@@ -156,6 +175,7 @@ void
 tap_init(void)
 {
 	tap_packet_index=0;
+	tap_push_count=0;
 }
 
 /* **********************************************************************
@@ -295,6 +315,34 @@ tap_queue_init(epan_dissect_t *edt)
 	tap_build_interesting (edt);
 }
 
+/* Whether the filter of a listener matches the packet in edt.  The result
+   only depends on the packet, not on what was tapped, so it's computed at
+   most once per push for all the listeners that share the same filter
+   string, however many times their taps were queued.
+*/
+static gboolean
+tap_listener_filter_passed(tap_listener_t *tl, epan_dissect_t *edt)
+{
+	tap_listener_t *owner=tl->filter_owner;
+	double start;
+
+	if(!owner->code){
+		return TRUE;
+	}
+	if(owner->filter_push!=tap_push_count){
+		if(tap_timer){
+			start=g_timer_elapsed(tap_timer, NULL);
+			owner->filter_passed=dfilter_apply_edt(owner->code, edt);
+			owner->filter_secs+=g_timer_elapsed(tap_timer, NULL)-start;
+			owner->filter_calls++;
+		} else {
+			owner->filter_passed=dfilter_apply_edt(owner->code, edt);
+		}
+		owner->filter_push=tap_push_count;
+	}
+	return owner->filter_passed;
+}
+
 /* this function is called after a packet has been fully dissected to push the tapped
    data to all extensions that has callbacks registered.
 */
@@ -304,6 +352,7 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 	tap_packet_t *tp;
 	tap_listener_t *tl;
 	guint i;
+	double start;
 
 	/* nothing to do, just return */
 	if(!tapping_is_active){
@@ -317,19 +366,33 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 		return;
 	}
 
+	/* Invalidate the filter results of the previous packet; should the
+	   counter wrap around, make sure no stale result matches it */
+	if(++tap_push_count==0){
+		for(tl=(tap_listener_t *)tap_listener_queue;tl;tl=tl->next){
+			tl->filter_push=0;
+		}
+		tap_push_count=1;
+	}
+
 	/* loop over all tap listeners and call the listener callback
 	   for all packets that match the filter. */
 	for(i=0;i<tap_packet_index;i++){
+		tp=&tap_packet_array[i];
 		for(tl=(tap_listener_t *)tap_listener_queue;tl;tl=tl->next){
-			tp=&tap_packet_array[i];
-			if(tp->tap_id==tl->tap_id){
-				gboolean passed=TRUE;
-				if(tl->code){
-					passed=dfilter_apply_edt(tl->code, edt);
-				}
-				if(passed && tl->packet){
-					tl->needs_redraw|=tl->packet(tl->tapdata, tp->pinfo, edt, tp->tap_specific_data);
-				}
+			if(tp->tap_id!=tl->tap_id || !tl->packet){
+				continue;
+			}
+			if(!tap_listener_filter_passed(tl, edt)){
+				continue;
+			}
+			if(tap_timer){
+				start=g_timer_elapsed(tap_timer, NULL);
+				tl->needs_redraw|=tl->packet(tl->tapdata, tp->pinfo, edt, tp->tap_specific_data);
+				tl->packet_secs+=g_timer_elapsed(tap_timer, NULL)-start;
+				tl->packet_calls++;
+			} else {
+				tl->needs_redraw|=tl->packet(tl->tapdata, tp->pinfo, edt, tp->tap_specific_data);
 			}
 		}
 	}
@@ -459,6 +522,30 @@ find_tap_id(const char *name)
 	return 0;
 }
 
+/* Point every listener at the first one in the queue with the same filter
+   string, so that the filter is only applied once per packet however many
+   listeners use it.  Called whenever a filter is added or goes away.
+*/
+static void
+link_tap_filters(void)
+{
+	tap_listener_t *tl, *tl2;
+
+	for(tl=(tap_listener_t *)tap_listener_queue;tl;tl=tl->next){
+		tl->filter_owner=tl;
+		tl->filter_push=0;
+		if(!tl->fstring){
+			continue;
+		}
+		for(tl2=(tap_listener_t *)tap_listener_queue;tl2!=tl;tl2=tl2->next){
+			if(tl2->fstring && !strcmp(tl2->fstring, tl->fstring)){
+				tl->filter_owner=tl2;
+				break;
+			}
+		}
+	}
+}
+
 /* this function attaches the tap_listener to the named tap.
  * function returns :
  *     NULL: ok.
@@ -480,7 +567,7 @@ register_tap_listener(const char *tapname, void *tapdata, const char *fstring,
 		return error_string;
 	}
 
-	tl=(tap_listener_t *)g_malloc(sizeof(tap_listener_t));
+	tl=(tap_listener_t *)g_malloc0(sizeof(tap_listener_t));
 	tl->code=NULL;
 	tl->needs_redraw=TRUE;
 	tl->flags=flags;
@@ -493,6 +580,9 @@ register_tap_listener(const char *tapname, void *tapdata, const char *fstring,
 			g_free(tl);
 			return error_string;
 		}
+		if(tl->code){
+			tl->fstring=g_strdup(fstring);
+		}
 	}
 
 	tl->tap_id=tap_id;
@@ -500,9 +590,11 @@ register_tap_listener(const char *tapname, void *tapdata, const char *fstring,
 	tl->reset=reset;
 	tl->packet=packet;
 	tl->draw=draw;
+	tl->merge=NULL;
 	tl->next=(tap_listener_t *)tap_listener_queue;
 
 	tap_listener_queue=tl;
+	link_tap_filters();
 
 	return NULL;
 }
@@ -536,21 +628,70 @@ set_tap_dfilter(void *tapdata, const char *fstring)
 			dfilter_free(tl->code);
 			tl->code=NULL;
 		}
+		g_free(tl->fstring);
+		tl->fstring=NULL;
 		tl->needs_redraw=TRUE;
 		if(fstring){
 			if(!dfilter_compile(fstring, &tl->code)){
+				link_tap_filters();
 				error_string = g_string_new("");
 				g_string_printf(error_string,
 						 "Filter \"%s\" is invalid - %s",
 						 fstring, dfilter_error_msg);
 				return error_string;
 			}
+			if(tl->code){
+				tl->fstring=g_strdup(fstring);
+			}
+		}
+		link_tap_filters();
+	}
+
+	return NULL;
+}
+
+static tap_listener_t *
+find_tap_listener(void *tapdata)
+{
+	volatile tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->tapdata==tapdata){
+			return (tap_listener_t *)tl;
 		}
 	}
 
 	return NULL;
 }
 
+/* this function sets the callback that merges another instance's results
+ * into a tap listener's
+ */
+void
+set_tap_merge(void *tapdata, tap_merge_cb merge)
+{
+	tap_listener_t *tl=find_tap_listener(tapdata);
+
+	if(tl){
+		tl->merge=merge;
+	}
+}
+
+gboolean
+merge_tap_listener(void *tapdata, const void *src_tapdata)
+{
+	tap_listener_t *tl=find_tap_listener(tapdata);
+
+	if(!tl || !tl->merge){
+		return FALSE;
+	}
+
+	tl->merge(tapdata, src_tapdata);
+	tl->needs_redraw=TRUE;
+
+	return TRUE;
+}
+
 /* this function removes a tap listener
  */
 void
@@ -580,7 +721,9 @@ remove_tap_listener(void *tapdata)
 		if(tl->code){
 			dfilter_free(tl->code);
 		}
+		g_free(tl->fstring);
 		g_free(tl);
+		link_tap_filters();
 	}
 
 	return;
@@ -653,3 +796,57 @@ union_of_tap_listener_flags(void)
 	}
 	return flags;
 }
+
+/*
+ * Turn the accounting of the time spent in each tap listener on or off.
+ */
+void
+tap_set_timing(gboolean enable)
+{
+	if(enable && !tap_timer){
+		tap_timer=g_timer_new();
+	} else if(!enable && tap_timer){
+		g_timer_destroy(tap_timer);
+		tap_timer=NULL;
+	}
+}
+
+gboolean
+tap_timing_enabled(void)
+{
+	return tap_timer!=NULL;
+}
+
+/*
+ * Print, for each tap listener, how often its filter was applied and its
+ * packet routine was called, and how long that took.  A filter shared by
+ * several listeners is accounted to the first of them only.
+ */
+void
+tap_print_timing(FILE *fh)
+{
+	tap_listener_t *tl;
+	tap_dissector_t *td;
+	const char *tapname;
+	int i;
+
+	if(!tap_timer || !tap_listener_queue){
+		return;
+	}
+
+	fprintf(fh, "%-16s %12s %12s %12s %12s  %s\n", "Tap", "Packets",
+	    "Packet (ms)", "Filtered", "Filter (ms)", "Filter");
+	for(tl=(tap_listener_t *)tap_listener_queue;tl;tl=tl->next){
+		tapname="?";
+		for(i=1,td=tap_dissector_list;td;i++,td=td->next){
+			if(i==tl->tap_id){
+				tapname=td->name;
+				break;
+			}
+		}
+		fprintf(fh, "%-16s %12" G_GINT64_MODIFIER "u %12.3f %12" G_GINT64_MODIFIER "u %12.3f  %s\n",
+		    tapname, tl->packet_calls, tl->packet_secs*1000.0,
+		    tl->filter_calls, tl->filter_secs*1000.0,
+		    tl->fstring ? tl->fstring : "");
+	}
+}
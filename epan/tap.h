@@ -23,6 +23,8 @@
 #ifndef __TAP_H__
 #define __TAP_H__
 
+#include <stdio.h>
+
 #include <epan/epan.h>
 #include "ws_symbol_export.h"
 
@@ -33,6 +35,7 @@ extern "C" {
 typedef void (*tap_reset_cb)(void *tapdata);
 typedef gboolean (*tap_packet_cb)(void *tapdata, packet_info *pinfo, epan_dissect_t *edt, const void *data);
 typedef void (*tap_draw_cb)(void *tapdata);
+typedef void (*tap_merge_cb)(void *tapdata, const void *src_tapdata);
 
 /**
  * Flags to indicate what a tap listener's packet routine requires.
@@ -217,6 +220,24 @@ WS_DLL_PUBLIC GString *register_tap_listener(const char *tapname, void *tapdata,
 /** This function sets a new dfilter to a tap listener */
 WS_DLL_PUBLIC GString *set_tap_dfilter(void *tapdata, const char *fstring);
 
+/** This function sets the callback used to merge the results another instance
+ * of a tap listener has gathered (e.g. over another part of the same capture)
+ * into this one's.
+ *
+ * @param tapdata    the tapdata of a registered listener
+ * @param tap_merge  void (*merge)(void *tapdata, const void *src_tapdata)
+ *                   Adds what src_tapdata holds into tapdata.  src_tapdata
+ *                   is of the same type as tapdata but needn't be registered
+ *                   itself, and it is left untouched.
+ */
+WS_DLL_PUBLIC void set_tap_merge(void *tapdata, tap_merge_cb tap_merge);
+
+/** This function merges src_tapdata into the registered listener tapdata,
+ * using the callback set with set_tap_merge().  Returns FALSE if tapdata
+ * isn't registered or doesn't have one.
+ */
+WS_DLL_PUBLIC gboolean merge_tap_listener(void *tapdata, const void *src_tapdata);
+
 /** this function removes a tap listener */
 WS_DLL_PUBLIC void remove_tap_listener(void *tapdata);
 
@@ -255,6 +276,19 @@ WS_DLL_PUBLIC guint union_of_tap_listener_flags(void);
  */
 WS_DLL_PUBLIC const void *fetch_tapped_data(int tap_id, int idx);
 
+/** Turn the accounting of the number of calls to, and the time spent in,
+ * the filter and packet routine of each tap listener on or off.
+ */
+WS_DLL_PUBLIC void tap_set_timing(gboolean enable);
+
+/** Returns TRUE if tap timing is turned on. */
+WS_DLL_PUBLIC gboolean tap_timing_enabled(void);
+
+/** Print the per-listener tap timing gathered so far to fh; does nothing
+ * if tap timing is turned off.
+ */
+WS_DLL_PUBLIC void tap_print_timing(FILE *fh);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
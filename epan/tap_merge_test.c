@@ -0,0 +1,360 @@
+/* tap_merge_test.c
+ * Tests that tap results gathered over two halves of a capture and then
+ * merged are the same as those gathered in a single pass
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "packet_info.h"
+#include "tap.h"
+#include "timestats.h"
+#include "conversation_table.h"
+#include "stats_tree.h"
+#include "stats_tree_priv.h"
+
+#define TEST_TAP    "tap_merge_test"
+
+/* The "capture": what each packet gives the taps */
+typedef struct {
+    guint32      secs;          /* time relative to the first packet */
+    guint32      nsecs;
+    int          src;           /* index into test_hosts */
+    int          dst;
+    guint32      src_port;
+    guint32      dst_port;
+    int          len;
+    const gchar *type;
+    guint32      rtt_usecs;     /* response time, if it's a response */
+} test_packet_t;
+
+static const guint8 test_hosts[][4] = {
+    { 10, 0, 0, 1 },
+    { 10, 0, 0, 2 },
+    { 192, 168, 1, 1 },
+};
+
+static const test_packet_t test_packets[] = {
+    { 0, 0,         0, 1, 1024, 53,   74,   "query",    0 },
+    { 0, 1200000,   1, 0, 53,   1024, 160,  "response", 1200 },
+    { 1, 0,         2, 1, 5000, 53,   90,   "query",    0 },
+    { 1, 300000,    0, 2, 80,   6000, 1514, "data",     0 },
+    { 2, 0,         1, 2, 53,   5000, 410,  "response", 1000000 },
+    { 2, 500000,    0, 1, 1024, 53,   74,   "query",    0 },
+    { 3, 0,         2, 0, 6000, 80,   60,   "ack",      0 },
+    { 3, 800000,    1, 0, 53,   1024, 96,   "response", 300 },
+    { 4, 0,         0, 2, 80,   6000, 1514, "data",     0 },
+    { 5, 250000,    2, 0, 6000, 80,   60,   "ack",      0 },
+};
+
+#define N_PACKETS   ((int)G_N_ELEMENTS(test_packets))
+
+/* Node ids of the test stats_tree; the same in every tree of it */
+static int st_node_packets = -1;
+static int st_node_sizes = -1;
+static int st_node_types = -1;
+
+static void
+test_stats_tree_init(stats_tree *st)
+{
+    st_node_packets = stats_tree_create_node(st, "Packets", 0, TRUE);
+    st_node_sizes = stats_tree_create_range_node(st, "Sizes", st_node_packets,
+            "0-99", "100-499", "500-", NULL);
+    st_node_types = stats_tree_create_pivot(st, "Types", st_node_packets);
+}
+
+static int
+test_stats_tree_packet(stats_tree *st, packet_info *pinfo _U_,
+                       epan_dissect_t *edt _U_, const void *p)
+{
+    const test_packet_t *packet = (const test_packet_t *)p;
+    gchar *port;
+    int port_id;
+
+    tick_stat_node(st, "Packets", 0, TRUE);
+    stats_tree_tick_range(st, "Sizes", st_node_packets, packet->len);
+    stats_tree_tick_pivot(st, st_node_types, packet->type);
+    avg_stat_node_add_value(st, "Length", st_node_packets, FALSE, packet->len);
+
+    /* Nodes that only some packets, and so maybe only one half, create */
+    port = g_strdup_printf("Port %u", packet->dst_port);
+    port_id = stats_tree_get_node_id(st, port, st_node_packets, TRUE);
+    g_free(port);
+    tick_stat_node_id(st, port_id);
+    tick_stat_node(st, packet->type, port_id, FALSE);
+
+    return 1;
+}
+
+/* Everything the taps gather */
+typedef struct {
+    stats_tree  *st;
+    conv_hash_t  conv;
+    conv_hash_t  hosts;
+    timestat_t   rtt;
+} tap_results_t;
+
+static void
+tap_results_init(tap_results_t *results)
+{
+    stats_tree_cfg *cfg = stats_tree_get_cfg_by_abbr(TEST_TAP);
+    GString *error_string;
+
+    results->st = stats_tree_new(cfg, NULL, NULL);
+    error_string = register_tap_listener(TEST_TAP, results->st, NULL, 0,
+            stats_tree_reset, stats_tree_packet, NULL);
+    g_assert(error_string == NULL);
+    set_tap_merge(results->st, stats_tree_merge);
+    cfg->init(results->st);
+
+    memset(&results->conv, 0, sizeof results->conv);
+    memset(&results->hosts, 0, sizeof results->hosts);
+    time_stat_init(&results->rtt);
+}
+
+static void
+tap_results_cleanup(tap_results_t *results)
+{
+    remove_tap_listener(results->st);
+    stats_tree_free(results->st);
+    reset_conversation_table_data(&results->conv);
+    reset_hostlist_table_data(&results->hosts);
+}
+
+/* Hands packets first to last - 1 to the taps, as the packet routines of
+   the stats_tree, conversation, endpoint and SRT taps would */
+static void
+tap_packets(tap_results_t *results, int first, int last)
+{
+    int i;
+
+    for (i = first; i < last; i++) {
+        const test_packet_t *packet = &test_packets[i];
+        packet_info pinfo;
+        frame_data fd;
+        address src, dst;
+        nstime_t abs_ts, delta;
+
+        memset(&pinfo, 0, sizeof pinfo);
+        memset(&fd, 0, sizeof fd);
+        fd.num = i + 1;
+        pinfo.fd = &fd;
+        pinfo.rel_ts.secs = packet->secs;
+        pinfo.rel_ts.nsecs = packet->nsecs;
+        abs_ts.secs = 1400000000 + packet->secs;
+        abs_ts.nsecs = packet->nsecs;
+
+        stats_tree_packet(results->st, &pinfo, NULL, packet);
+
+        SET_ADDRESS(&src, AT_IPv4, 4, test_hosts[packet->src]);
+        SET_ADDRESS(&dst, AT_IPv4, 4, test_hosts[packet->dst]);
+        add_conversation_table_data(&results->conv, &src, &dst,
+                packet->src_port, packet->dst_port, 1, packet->len,
+                &pinfo.rel_ts, &abs_ts, NULL, PT_UDP);
+        add_hostlist_table_data(&results->hosts, &src, packet->src_port, TRUE,
+                1, packet->len, NULL, PT_UDP);
+        add_hostlist_table_data(&results->hosts, &dst, packet->dst_port, FALSE,
+                1, packet->len, NULL, PT_UDP);
+
+        if (packet->rtt_usecs) {
+            delta.secs = packet->rtt_usecs / 1000000;
+            delta.nsecs = (packet->rtt_usecs % 1000000) * 1000;
+            time_stat_update(&results->rtt, &delta, &pinfo);
+        }
+    }
+}
+
+/* Taps the whole capture in one pass and in two halves at the given
+   packet, merging the second half into the first, as the taps of a farm
+   of children each reading part of the capture would be */
+static void
+tap_merge_test_split(tap_results_t *single, tap_results_t *merged, int split)
+{
+    tap_results_t second;
+
+    tap_results_init(single);
+    tap_packets(single, 0, N_PACKETS);
+
+    tap_results_init(merged);
+    tap_results_init(&second);
+    tap_packets(merged, 0, split);
+    tap_packets(&second, split, N_PACKETS);
+
+    g_assert(merge_tap_listener(merged->st, second.st));
+    merge_conversation_table(&merged->conv, &second.conv);
+    merge_hostlist_table(&merged->hosts, &second.hosts);
+    time_stat_merge(&merged->rtt, &second.rtt);
+
+    tap_results_cleanup(&second);
+}
+
+static gchar *
+stats_tree_to_str(const stats_tree *st)
+{
+    GString *s;
+
+    s = stats_tree_format_as_str(st, ST_FORMAT_PLAIN, 0 /* by name */, FALSE);
+    return g_string_free(s, FALSE);
+}
+
+static void
+check_stats_tree(const tap_results_t *single, const tap_results_t *merged)
+{
+    gchar *single_str = stats_tree_to_str(single->st);
+    gchar *merged_str = stats_tree_to_str(merged->st);
+
+    g_assert_cmpstr(merged_str, ==, single_str);
+    g_assert(merged->st->start == single->st->start);
+    g_assert(merged->st->now == single->st->now);
+    g_free(single_str);
+    g_free(merged_str);
+}
+
+/* The merge appends the conversations that are new to the first half in
+   the order the second half found them, so they come out in the same
+   order as in a single pass */
+static void
+check_conversations(const tap_results_t *single, const tap_results_t *merged)
+{
+    guint i;
+
+    g_assert_cmpuint(merged->conv.conv_array->len, ==, single->conv.conv_array->len);
+    for (i = 0; i < single->conv.conv_array->len; i++) {
+        conv_item_t *a = &g_array_index(single->conv.conv_array, conv_item_t, i);
+        conv_item_t *b = &g_array_index(merged->conv.conv_array, conv_item_t, i);
+
+        g_assert(ADDRESSES_EQUAL(&a->src_address, &b->src_address));
+        g_assert(ADDRESSES_EQUAL(&a->dst_address, &b->dst_address));
+        g_assert_cmpuint(a->src_port, ==, b->src_port);
+        g_assert_cmpuint(a->dst_port, ==, b->dst_port);
+        g_assert_cmpuint(a->tx_frames, ==, b->tx_frames);
+        g_assert_cmpuint(a->rx_frames, ==, b->rx_frames);
+        g_assert_cmpuint(a->tx_bytes, ==, b->tx_bytes);
+        g_assert_cmpuint(a->rx_bytes, ==, b->rx_bytes);
+        g_assert_cmpint(nstime_cmp(&a->start_time, &b->start_time), ==, 0);
+        g_assert_cmpint(nstime_cmp(&a->stop_time, &b->stop_time), ==, 0);
+        g_assert_cmpint(nstime_cmp(&a->start_abs_time, &b->start_abs_time), ==, 0);
+    }
+}
+
+static void
+check_hosts(const tap_results_t *single, const tap_results_t *merged)
+{
+    guint i;
+
+    g_assert_cmpuint(merged->hosts.conv_array->len, ==, single->hosts.conv_array->len);
+    for (i = 0; i < single->hosts.conv_array->len; i++) {
+        hostlist_talker_t *a = &g_array_index(single->hosts.conv_array, hostlist_talker_t, i);
+        hostlist_talker_t *b = &g_array_index(merged->hosts.conv_array, hostlist_talker_t, i);
+
+        g_assert(ADDRESSES_EQUAL(&a->myaddress, &b->myaddress));
+        g_assert_cmpuint(a->port, ==, b->port);
+        g_assert_cmpuint(a->tx_frames, ==, b->tx_frames);
+        g_assert_cmpuint(a->rx_frames, ==, b->rx_frames);
+        g_assert_cmpuint(a->tx_bytes, ==, b->tx_bytes);
+        g_assert_cmpuint(a->rx_bytes, ==, b->rx_bytes);
+    }
+}
+
+static void
+check_time_stat(const tap_results_t *single, const tap_results_t *merged)
+{
+    g_assert_cmpuint(merged->rtt.num, ==, single->rtt.num);
+    g_assert_cmpint(nstime_cmp(&merged->rtt.min, &single->rtt.min), ==, 0);
+    g_assert_cmpint(nstime_cmp(&merged->rtt.max, &single->rtt.max), ==, 0);
+    g_assert_cmpint(nstime_cmp(&merged->rtt.tot, &single->rtt.tot), ==, 0);
+    g_assert_cmpuint(merged->rtt.min_num, ==, single->rtt.min_num);
+    g_assert_cmpuint(merged->rtt.max_num, ==, single->rtt.max_num);
+}
+
+static void
+tap_merge_test_halves(void)
+{
+    tap_results_t single, merged;
+    int split;
+
+    /* Splitting anywhere, including before the first packet and after
+       the last, must give the single pass's results */
+    for (split = 0; split <= N_PACKETS; split++) {
+        tap_merge_test_split(&single, &merged, split);
+        check_stats_tree(&single, &merged);
+        check_conversations(&single, &merged);
+        check_hosts(&single, &merged);
+        check_time_stat(&single, &merged);
+        tap_results_cleanup(&single);
+        tap_results_cleanup(&merged);
+    }
+}
+
+static void
+tap_merge_test_listener(void)
+{
+    tap_results_t results;
+    stats_tree *other;
+
+    tap_results_init(&results);
+    other = stats_tree_new(stats_tree_get_cfg_by_abbr(TEST_TAP), NULL, NULL);
+
+    /* Only a registered listener with a merge callback can be merged into */
+    g_assert(!merge_tap_listener(other, results.st));
+    set_tap_merge(results.st, NULL);
+    g_assert(!merge_tap_listener(results.st, other));
+    set_tap_merge(results.st, stats_tree_merge);
+    g_assert(merge_tap_listener(results.st, other));
+
+    stats_tree_free(other);
+    tap_results_cleanup(&results);
+}
+
+int
+main(int argc, char **argv)
+{
+    int result;
+
+    g_test_init(&argc, &argv, NULL);
+
+    register_tap(TEST_TAP);
+    stats_tree_register(TEST_TAP, TEST_TAP, "Tap merge test", 0,
+            test_stats_tree_packet, test_stats_tree_init, NULL);
+
+    g_test_add_func("/tap_merge/halves", tap_merge_test_halves);
+    g_test_add_func("/tap_merge/listener", tap_merge_test_listener);
+
+    result = g_test_run();
+
+    return result;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
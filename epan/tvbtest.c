@@ -494,6 +494,89 @@ run_tests(void)
 	tvb_free_chain(tvb_parent);  /* should free all tvb's and associated data */
 }
 
+/* Build a composite out of many small members, as TCP reassembly of a
+ * large PDU does, and time member lookups, reads that span members and
+ * searches across it.  Lookups used to be linear in the number of
+ * members, which made dissecting such a PDU quadratic. */
+#define BENCH_MEMBERS		20000
+#define BENCH_MEMBER_LENGTH	64
+
+static void
+composite_benchmark(void)
+{
+	tvbuff_t	*tvb_parent;
+	tvbuff_t	*tvb_backing;
+	tvbuff_t	*tvb_comp;
+	guint8		*data;
+	guint		length = BENCH_MEMBERS * BENCH_MEMBER_LENGTH;
+	guint		i, offset;
+	guint32		sum = 0, expected_sum = 0;
+	gint		found;
+	GTimer		*timer;
+
+	data = g_new(guint8, length);
+	for (i = 0; i < length; i++) {
+		data[i] = (guint8)(i % 251);
+	}
+	/* A single needle near the end, for the search. */
+	data[length - 10] = 0xff;
+
+	tvb_parent  = tvb_new_real_data("", 0, 0);
+	tvb_backing = tvb_new_child_real_data(tvb_parent, data, length, length);
+	tvb_set_free_cb(tvb_backing, g_free);
+
+	tvb_comp = tvb_new_composite();
+	for (i = 0; i < BENCH_MEMBERS; i++) {
+		tvb_composite_append(tvb_comp, tvb_new_subset(tvb_backing,
+			i * BENCH_MEMBER_LENGTH, BENCH_MEMBER_LENGTH, BENCH_MEMBER_LENGTH));
+	}
+	tvb_composite_finalize(tvb_comp);
+
+	timer = g_timer_new();
+
+	/* Byte-by-byte reads; every one needs a member lookup. */
+	g_timer_start(timer);
+	for (offset = 0; offset < length; offset++) {
+		sum += tvb_get_guint8(tvb_comp, offset);
+		expected_sum += data[offset];
+	}
+	g_timer_stop(timer);
+	if (sum != expected_sum) {
+		printf("Composite benchmark: byte reads returned wrong data\n");
+		failed = TRUE;
+	}
+	printf("Composite benchmark: %u byte reads over %u members: %.3f s\n",
+	       length, BENCH_MEMBERS, g_timer_elapsed(timer, NULL));
+
+	/* 32-bit reads straddling every member boundary. */
+	g_timer_start(timer);
+	for (i = 1; i < BENCH_MEMBERS; i++) {
+		offset = i * BENCH_MEMBER_LENGTH - 2;
+		if (tvb_get_ntohl(tvb_comp, offset) != pntoh32(&data[offset])) {
+			printf("Composite benchmark: spanning read at %u returned wrong data\n", offset);
+			failed = TRUE;
+			break;
+		}
+	}
+	g_timer_stop(timer);
+	printf("Composite benchmark: %u spanning reads: %.3f s\n",
+	       BENCH_MEMBERS - 1, g_timer_elapsed(timer, NULL));
+
+	/* A search through (nearly) the whole composite. */
+	g_timer_start(timer);
+	found = tvb_find_guint8(tvb_comp, 1, -1, 0xff);
+	g_timer_stop(timer);
+	if (found != (gint)(length - 10)) {
+		printf("Composite benchmark: search found %d, expected %u\n", found, length - 10);
+		failed = TRUE;
+	}
+	printf("Composite benchmark: search across members: %.3f s\n",
+	       g_timer_elapsed(timer, NULL));
+
+	g_timer_destroy(timer);
+	tvb_free_chain(tvb_parent);
+}
+
 /* Note: valgrind can be used to check for tvbuff memory leaks */
 int
 main(void)
@@ -504,6 +587,7 @@ main(void)
 
 	except_init();
 	run_tests();
+	composite_benchmark();
 	except_deinit();
 	exit(failed?1:0);
 }
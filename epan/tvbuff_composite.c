@@ -23,21 +23,40 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <epan/emem.h>
 
 #include "tvbuff.h"
 #include "tvbuff-int.h"
 #include "proto.h"	/* XXX - only used for DISSECTOR_ASSERT, probably a new header file? */
 
+/* A contiguous copy of a range that spans member tvbuffs. */
+typedef struct {
+	guint		start;
+	guint		length;
+	guint8		*data;
+} tvb_comp_span_t;
+
 typedef struct {
-	GSList		*tvbs;
+	/* Members are collected here until the tvbuff is finalized... */
+	GQueue		tvbs;
+
+	/* ...and then moved to an array, so that the member containing
+	 * an offset can be found with a binary search over
+	 * end_offsets. */
+	tvbuff_t	**members;
+	guint		num_members;
 
-	/* Used for quick testing to see if this
-	 * is the tvbuff that a COMPOSITE is
-	 * interested in. */
 	guint		*start_offsets;
 	guint		*end_offsets;
 
+	/* Copies made for reads that cross member boundaries, indexed
+	 * by the member in which they start (allocated on the first such
+	 * read), and their total size. */
+	GSList		**spans;
+	guint		spans_length;
+
 } tvb_comp_t;
 
 struct tvb_composite {
@@ -51,11 +70,28 @@ composite_free(tvbuff_t *tvb)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	tvb_comp_t *composite = &composite_tvb->composite;
+	GSList	   *slist;
+	guint	    i;
+
+	g_queue_clear(&composite->tvbs);
+
+	if (composite->spans) {
+		for (i = 0; i < composite->num_members; i++) {
+			for (slist = composite->spans[i]; slist != NULL; slist = slist->next) {
+				tvb_comp_span_t *span = (tvb_comp_span_t *)slist->data;
 
-	g_slist_free(composite->tvbs);
+				g_free(span->data);
+				g_free(span);
+			}
+			g_slist_free(composite->spans[i]);
+		}
+		g_free(composite->spans);
+	}
 
+	g_free(composite->members);
 	g_free(composite->start_offsets);
 	g_free(composite->end_offsets);
+
 	if (tvb->real_data) {
 		/*
 		 * XXX - do this with a union?
@@ -68,42 +104,57 @@ static guint
 composite_offset(const tvbuff_t *tvb, const guint counter)
 {
 	const struct tvb_composite *composite_tvb = (const struct tvb_composite *) tvb;
-	const tvbuff_t *member = (const tvbuff_t *)composite_tvb->composite.tvbs->data;
+	const tvbuff_t *member = composite_tvb->composite.members[0];
 
 	return tvb_offset_from_real_beginning_counter(member, counter);
 }
 
+/*
+ * Return the index of the member containing abs_offset, or
+ * num_members if abs_offset is past the end of the last member.
+ */
+static guint
+composite_find_member(const tvb_comp_t *composite, guint abs_offset)
+{
+	guint low  = 0;
+	guint high = composite->num_members;
+	guint mid;
+
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		if (abs_offset <= composite->end_offsets[mid])
+			high = mid;
+		else
+			low = mid + 1;
+	}
+	return low;
+}
+
 static const guint8*
 composite_get_ptr(tvbuff_t *tvb, guint abs_offset, guint abs_length)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
-	guint	    i, num_members;
+	guint	    i;
 	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
+	tvbuff_t   *member_tvb;
 	guint	    member_offset;
 	GSList	   *slist;
+	tvb_comp_span_t *span;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
 
 	/* Maybe the range specified by offset/length
 	 * is contiguous inside one of the member tvbuffs */
 	composite = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
-
-	for (i = 0; i < num_members; i++) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			slist = g_slist_nth(composite->tvbs, i);
-			member_tvb = (tvbuff_t *)slist->data;
-			break;
-		}
-	}
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->num_members) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
 		return "";
 	}
 
+	member_tvb    = composite->members[i];
 	member_offset = abs_offset - composite->start_offsets[i];
 
 	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
@@ -113,12 +164,41 @@ composite_get_ptr(tvbuff_t *tvb, guint abs_offset, guint abs_length)
 		DISSECTOR_ASSERT(!tvb->real_data);
 		return tvb_get_ptr(member_tvb, member_offset, abs_length);
 	}
-	else {
+
+	/*
+	 * The range spans members.  Reuse an earlier copy, starting in
+	 * the same member, that covers it, if there is one.
+	 */
+	if (!composite->spans)
+		composite->spans = g_new0(GSList *, composite->num_members);
+
+	for (slist = composite->spans[i]; slist != NULL; slist = slist->next) {
+		span = (tvb_comp_span_t *)slist->data;
+		if (abs_offset >= span->start &&
+		    abs_offset + abs_length <= span->start + span->length)
+			return span->data + (abs_offset - span->start);
+	}
+
+	/*
+	 * Copy only the requested range, unless we have already copied
+	 * as much as the whole tvbuff; in that case, flatten it once and
+	 * for all, so that all further accesses go straight to real_data.
+	 */
+	if (composite->spans_length + abs_length >= tvb->length) {
 		tvb->real_data = (guint8 *)tvb_memdup(NULL, tvb, 0, -1);
 		return tvb->real_data + abs_offset;
 	}
 
-	DISSECTOR_ASSERT_NOT_REACHED();
+	span	     = g_new(tvb_comp_span_t, 1);
+	span->start  = abs_offset;
+	span->length = abs_length;
+	span->data   = (guint8 *)g_malloc(abs_length);
+	tvb_memcpy(tvb, span->data, abs_offset, abs_length);
+
+	composite->spans[i]	 = g_slist_prepend(composite->spans[i], span);
+	composite->spans_length += abs_length;
+
+	return span->data;
 }
 
 static void *
@@ -127,63 +207,119 @@ composite_memcpy(tvbuff_t *tvb, void* _target, guint abs_offset, guint abs_lengt
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	guint8 *target = (guint8 *) _target;
 
-	guint	    i, num_members;
+	guint	    i;
 	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
+	tvbuff_t   *member_tvb;
 	guint	    member_offset, member_length;
-	GSList	   *slist;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
 
 	/* Maybe the range specified by offset/length
 	 * is contiguous inside one of the member tvbuffs */
-	composite   = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
-
-	for (i = 0; i < num_members; i++) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			slist = g_slist_nth(composite->tvbs, i);
-			member_tvb = (tvbuff_t *)slist->data;
-			break;
-		}
-	}
+	composite = &composite_tvb->composite;
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->num_members) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
 		return target;
 	}
 
+	member_tvb    = composite->members[i];
 	member_offset = abs_offset - composite->start_offsets[i];
 
 	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
 		DISSECTOR_ASSERT(!tvb->real_data);
 		return tvb_memcpy(member_tvb, target, member_offset, abs_length);
 	}
-	else {
-		/* The requested data is non-contiguous inside
-		 * the member tvb. We have to memcpy() the part that's in the member tvb,
-		 * then iterate across the other member tvb's, copying their portions
-		 * until we have copied all data.
-		 */
+
+	/* The requested data is non-contiguous inside
+	 * the member tvb. We have to memcpy() the part that's in the member tvb,
+	 * then walk across the following member tvb's, copying their portions
+	 * until we have copied all data.
+	 */
+	while (abs_length > 0) {
+		DISSECTOR_ASSERT(i < composite->num_members);
+		member_tvb    = composite->members[i];
 		member_length = tvb_length_remaining(member_tvb, member_offset);
 
 		/* composite_memcpy() can't handle a member_length of zero. */
 		DISSECTOR_ASSERT(member_length > 0);
 
+		if (member_length > abs_length)
+			member_length = abs_length;
+
 		tvb_memcpy(member_tvb, target, member_offset, member_length);
-		abs_offset	+= member_length;
-		abs_length	-= member_length;
+		target	   += member_length;
+		abs_length -= member_length;
 
-		/* Recurse */
-		if (abs_length > 0) {
-			composite_memcpy(tvb, target + member_length, abs_offset, abs_length);
-		}
+		member_offset = 0;
+		i++;
+	}
 
-		return target;
+	return _target;
+}
+
+static gint
+composite_find_guint8(tvbuff_t *tvb, guint abs_offset, guint limit, guint8 needle)
+{
+	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
+	tvb_comp_t *composite = &composite_tvb->composite;
+	tvbuff_t   *member_tvb;
+	guint	    i, member_offset, member_length;
+	gint	    result;
+
+	/* Search each member in turn, without flattening the tvbuff. */
+	i = composite_find_member(composite, abs_offset);
+	member_offset = abs_offset - (i < composite->num_members ? composite->start_offsets[i] : 0);
+
+	while (limit > 0 && i < composite->num_members) {
+		member_tvb    = composite->members[i];
+		member_length = tvb_length_remaining(member_tvb, member_offset);
+		if (member_length > limit)
+			member_length = limit;
+
+		result = tvb_find_guint8(member_tvb, member_offset, member_length, needle);
+		if (result != -1)
+			return composite->start_offsets[i] + result;
+
+		limit -= member_length;
+		member_offset = 0;
+		i++;
 	}
 
-	DISSECTOR_ASSERT_NOT_REACHED();
+	return -1;
+}
+
+static gint
+composite_pbrk_guint8(tvbuff_t *tvb, guint abs_offset, guint limit, const guint8 *needles, guchar *found_needle)
+{
+	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
+	tvb_comp_t *composite = &composite_tvb->composite;
+	tvbuff_t   *member_tvb;
+	guint	    i, member_offset, member_length;
+	gint	    result;
+
+	/* Search each member in turn, without flattening the tvbuff. */
+	i = composite_find_member(composite, abs_offset);
+	member_offset = abs_offset - (i < composite->num_members ? composite->start_offsets[i] : 0);
+
+	while (limit > 0 && i < composite->num_members) {
+		member_tvb    = composite->members[i];
+		member_length = tvb_length_remaining(member_tvb, member_offset);
+		if (member_length > limit)
+			member_length = limit;
+
+		result = tvb_pbrk_guint8(member_tvb, member_offset, member_length, needles, found_needle);
+		if (result != -1)
+			return composite->start_offsets[i] + result;
+
+		limit -= member_length;
+		member_offset = 0;
+		i++;
+	}
+
+	return -1;
 }
 
 static const struct tvb_ops tvb_composite_ops = {
@@ -193,8 +329,8 @@ static const struct tvb_ops tvb_composite_ops = {
 	composite_offset,     /* offset */
 	composite_get_ptr,    /* get_ptr */
 	composite_memcpy,     /* memcpy */
-	NULL,                 /* find_guint8 XXX */
-	NULL,                 /* pbrk_guint8 XXX */
+	composite_find_guint8, /* find_guint8 */
+	composite_pbrk_guint8, /* pbrk_guint8 */
 	NULL,                 /* clone */
 };
 
@@ -213,9 +349,13 @@ tvb_new_composite(void)
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	tvb_comp_t *composite = &composite_tvb->composite;
 
-	composite->tvbs		 = NULL;
+	g_queue_init(&composite->tvbs);
+	composite->members	 = NULL;
+	composite->num_members	 = 0;
 	composite->start_offsets = NULL;
 	composite->end_offsets	 = NULL;
+	composite->spans	 = NULL;
+	composite->spans_length	 = 0;
 
 	return tvb;
 }
@@ -234,8 +374,8 @@ tvb_composite_append(tvbuff_t *tvb, tvbuff_t *member)
 	 */
 	DISSECTOR_ASSERT(member->length);
 
-	composite       = &composite_tvb->composite;
-	composite->tvbs = g_slist_append(composite->tvbs, member);
+	composite = &composite_tvb->composite;
+	g_queue_push_tail(&composite->tvbs, member);
 }
 
 void
@@ -252,19 +392,19 @@ tvb_composite_prepend(tvbuff_t *tvb, tvbuff_t *member)
 	 */
 	DISSECTOR_ASSERT(member->length);
 
-	composite       = &composite_tvb->composite;
-	composite->tvbs = g_slist_prepend(composite->tvbs, member);
+	composite = &composite_tvb->composite;
+	g_queue_push_head(&composite->tvbs, member);
 }
 
 void
 tvb_composite_finalize(tvbuff_t *tvb)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
-	GSList	   *slist;
+	GList	   *list;
 	guint	    num_members;
 	tvbuff_t   *member_tvb;
 	tvb_comp_t *composite;
-	int	    i = 0;
+	guint	    i = 0;
 
 	DISSECTOR_ASSERT(tvb && !tvb->initialized);
 	DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops);
@@ -272,7 +412,7 @@ tvb_composite_finalize(tvbuff_t *tvb)
 	DISSECTOR_ASSERT(tvb->reported_length == 0);
 
 	composite   = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
+	num_members = g_queue_get_length(&composite->tvbs);
 
 	/* Dissectors should not create composite TVBs if they're not going to
 	 * put at least one TVB in them.
@@ -280,22 +420,24 @@ tvb_composite_finalize(tvbuff_t *tvb)
 	 */
 	DISSECTOR_ASSERT(num_members);
 
+	composite->members = g_new(tvbuff_t *, num_members);
 	composite->start_offsets = g_new(guint, num_members);
 	composite->end_offsets = g_new(guint, num_members);
 
-	for (slist = composite->tvbs; slist != NULL; slist = slist->next) {
-		DISSECTOR_ASSERT((guint) i < num_members);
-		member_tvb = (tvbuff_t *)slist->data;
+	for (list = composite->tvbs.head; list != NULL; list = list->next) {
+		DISSECTOR_ASSERT(i < num_members);
+		member_tvb = (tvbuff_t *)list->data;
+		composite->members[i] = member_tvb;
 		composite->start_offsets[i] = tvb->length;
 		tvb->length += member_tvb->length;
 		tvb->reported_length += member_tvb->reported_length;
 		composite->end_offsets[i] = tvb->length - 1;
 		i++;
 	}
+	composite->num_members = num_members;
+	g_queue_clear(&composite->tvbs);
 
-	DISSECTOR_ASSERT(composite->tvbs);
-
-	tvb_add_to_chain((tvbuff_t *)composite->tvbs->data, tvb); /* chain composite tvb to first member */
+	tvb_add_to_chain(composite->members[0], tvb); /* chain composite tvb to first member */
 	tvb->initialized = TRUE;
 }
 
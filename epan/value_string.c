@@ -23,6 +23,7 @@
 #include "config.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "emem.h"
@@ -585,6 +586,194 @@ try_rval_to_str(const guint32 val, const range_string *rs)
     return try_rval_to_str_idx(val, rs, &ignore_me);
 }
 
+/* INDEXED VALUE AND RANGE STRING MATCHING */
+
+/* Arrays with fewer entries than this are searched about as fast linearly */
+#define VS_INDEX_MIN_ENTRIES 8
+/* Largest span of values for which a direct lookup table is built */
+#define VS_INDEX_MAX_SPAN    65536
+
+struct _value_string_index {
+    enum { VSI_DIRECT, VSI_BSEARCH, VSI_RANGE_BSEARCH } type;
+    guint32              first_value;   /* VSI_DIRECT */
+    guint                num_entries;
+    const gchar        **strings;       /* VSI_DIRECT, NULL for a gap */
+    const value_string **values;        /* VSI_BSEARCH, sorted */
+    const range_string **ranges;        /* VSI_RANGE_BSEARCH, sorted */
+};
+
+/* Sort by value; entries with the same value stay in array order, so the
+   first of them, which is what a linear search would find, comes first */
+static int
+vs_index_compare(const void *a, const void *b)
+{
+    const value_string *vs_a = *(const value_string * const *)a;
+    const value_string *vs_b = *(const value_string * const *)b;
+
+    if (vs_a->value != vs_b->value)
+        return vs_a->value < vs_b->value ? -1 : 1;
+    return vs_a < vs_b ? -1 : (vs_a > vs_b);
+}
+
+static int
+rs_index_compare(const void *a, const void *b)
+{
+    const range_string *rs_a = *(const range_string * const *)a;
+    const range_string *rs_b = *(const range_string * const *)b;
+
+    if (rs_a->value_min != rs_b->value_min)
+        return rs_a->value_min < rs_b->value_min ? -1 : 1;
+    return rs_a < rs_b ? -1 : (rs_a > rs_b);
+}
+
+/* Builds an index over the {0, NULL}-terminated value_string array vs,
+ * giving the same results as try_val_to_str(), in constant time if the
+ * values are dense enough and in log(n) time otherwise.  Unlike with a
+ * value_string_ext, the values needn't be in any particular order.
+ * Returns NULL if vs is too small for an index to pay off.
+ * The index refers to vs, which must outlive it.
+ */
+value_string_index *
+value_string_index_new(const value_string *vs)
+{
+    value_string_index *vsi;
+    guint32 min_value, max_value;
+    guint   num_entries, i, j;
+
+    for (num_entries = 0; vs[num_entries].strptr; num_entries++)
+        ;
+    if (num_entries < VS_INDEX_MIN_ENTRIES)
+        return NULL;
+
+    min_value = max_value = vs[0].value;
+    for (i = 1; i < num_entries; i++) {
+        if (vs[i].value < min_value)
+            min_value = vs[i].value;
+        if (vs[i].value > max_value)
+            max_value = vs[i].value;
+    }
+
+    vsi = g_new0(value_string_index, 1);
+    if (max_value - min_value < VS_INDEX_MAX_SPAN &&
+            max_value - min_value < 4 * num_entries) {
+        vsi->type        = VSI_DIRECT;
+        vsi->first_value = min_value;
+        vsi->num_entries = max_value - min_value + 1;
+        vsi->strings     = g_new0(const gchar *, vsi->num_entries);
+        /* Backwards, so that the first of several equal values wins */
+        for (i = num_entries; i-- > 0; )
+            vsi->strings[vs[i].value - min_value] = vs[i].strptr;
+        return vsi;
+    }
+
+    vsi->type   = VSI_BSEARCH;
+    vsi->values = g_new(const value_string *, num_entries);
+    for (i = 0; i < num_entries; i++)
+        vsi->values[i] = &vs[i];
+    qsort(vsi->values, num_entries, sizeof vsi->values[0], vs_index_compare);
+    /* Only keep the first of several equal values */
+    for (i = j = 1; i < num_entries; i++) {
+        if (vsi->values[i]->value != vsi->values[j-1]->value)
+            vsi->values[j++] = vsi->values[i];
+    }
+    vsi->num_entries = j;
+    return vsi;
+}
+
+/* Like value_string_index_new() for a range_string array; the results
+ * are those of try_rval_to_str().  Returns NULL if rs is too small, or
+ * if some of its ranges overlap, in which case the order of the entries
+ * matters and only a linear search gets it right.
+ */
+value_string_index *
+range_string_index_new(const range_string *rs)
+{
+    value_string_index *vsi;
+    guint num_entries, i;
+
+    for (num_entries = 0; rs[num_entries].strptr; num_entries++) {
+        if (rs[num_entries].value_min > rs[num_entries].value_max)
+            return NULL;
+    }
+    if (num_entries < VS_INDEX_MIN_ENTRIES)
+        return NULL;
+
+    vsi = g_new0(value_string_index, 1);
+    vsi->type        = VSI_RANGE_BSEARCH;
+    vsi->num_entries = num_entries;
+    vsi->ranges      = g_new(const range_string *, num_entries);
+    for (i = 0; i < num_entries; i++)
+        vsi->ranges[i] = &rs[i];
+    qsort(vsi->ranges, num_entries, sizeof vsi->ranges[0], rs_index_compare);
+    for (i = 1; i < num_entries; i++) {
+        if (vsi->ranges[i]->value_min <= vsi->ranges[i-1]->value_max) {
+            value_string_index_free(vsi);
+            return NULL;
+        }
+    }
+    return vsi;
+}
+
+void
+value_string_index_free(value_string_index *vsi)
+{
+    if (vsi == NULL)
+        return;
+
+    g_free(vsi->strings);
+    g_free(vsi->values);
+    g_free(vsi->ranges);
+    g_free(vsi);
+}
+
+/* Like try_val_to_str or try_rval_to_str, depending on what the index
+   was built from */
+const gchar *
+value_string_index_lookup(const guint32 val, const value_string_index *vsi)
+{
+    guint low, mid, high;
+
+    switch (vsi->type) {
+
+    case VSI_DIRECT:
+        if (val - vsi->first_value < vsi->num_entries)
+            return vsi->strings[val - vsi->first_value];
+        return NULL;
+
+    case VSI_BSEARCH:
+        low  = 0;
+        high = vsi->num_entries;
+        while (low < high) {
+            mid = low + (high - low) / 2;
+            if (val < vsi->values[mid]->value)
+                high = mid;
+            else if (val > vsi->values[mid]->value)
+                low = mid + 1;
+            else
+                return vsi->values[mid]->strptr;
+        }
+        return NULL;
+
+    case VSI_RANGE_BSEARCH:
+        /* Find the last range starting at or below val */
+        low  = 0;
+        high = vsi->num_entries;
+        while (low < high) {
+            mid = low + (high - low) / 2;
+            if (val < vsi->ranges[mid]->value_min)
+                high = mid;
+            else
+                low = mid + 1;
+        }
+        if (low > 0 && val <= vsi->ranges[low-1]->value_max)
+            return vsi->ranges[low-1]->strptr;
+        return NULL;
+    }
+
+    g_assert_not_reached();
+    return NULL;
+}
+
 /* MISC */
 
 /* Functions for use by proto_registrar_dump_values(), see proto.c */
@@ -255,6 +255,28 @@ WS_DLL_PUBLIC
 const gchar *
 try_rval_to_str_idx(const guint32 val, const range_string *rs, gint *idx);
 
+/* INDEXED VALUE AND RANGE STRING MATCHING */
+
+/* A lookup index built at run time over a plain value_string or
+ * range_string array; used by proto.c for the strings of fields. */
+typedef struct _value_string_index value_string_index;
+
+WS_DLL_PUBLIC
+value_string_index *
+value_string_index_new(const value_string *vs);
+
+WS_DLL_PUBLIC
+value_string_index *
+range_string_index_new(const range_string *rs);
+
+WS_DLL_PUBLIC
+void
+value_string_index_free(value_string_index *vsi);
+
+WS_DLL_PUBLIC
+const gchar *
+value_string_index_lookup(const guint32 val, const value_string_index *vsi);
+
 /* MISC (generally do not use) */
 
 WS_DLL_LOCAL
@@ -0,0 +1,304 @@
+/* value_string_bench.c
+ * Compares looking up the names of field values by searching the
+ * fields' value_strings and range_strings from the start with looking
+ * them up in the indexes proto.c builds over them.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <wsutil/filesystem.h>
+#include <wsutil/privileges.h>
+#include <wsutil/report_err.h>
+
+#include "epan.h"
+#include "proto.h"
+#include "value_string.h"
+#include "register.h"
+
+/* Protocols whose tables are looked at if none are given */
+static const char *default_protocols[] = { "gsm_map", "wlan", "diameter" };
+
+#define DEFAULT_ROUNDS	200
+
+/* A value of a field to look up */
+typedef struct {
+    const header_field_info    *hfinfo;
+    const value_string_index   *vsi;
+    guint32                     value;
+} lookup_t;
+
+static void
+failure_message(const char *msg_format, va_list ap)
+{
+    fprintf(stderr, "value_string_bench: ");
+    vfprintf(stderr, msg_format, ap);
+    fprintf(stderr, "\n");
+}
+
+static void
+open_failure_message(const char *filename, int err, gboolean for_writing _U_)
+{
+    fprintf(stderr, "value_string_bench: Can't open \"%s\": %s.\n",
+            filename, g_strerror(err));
+}
+
+static void
+read_failure_message(const char *filename, int err)
+{
+    fprintf(stderr, "value_string_bench: An error occurred while reading from the file \"%s\": %s.\n",
+            filename, g_strerror(err));
+}
+
+static void
+write_failure_message(const char *filename, int err)
+{
+    fprintf(stderr, "value_string_bench: An error occurred while writing to the file \"%s\": %s.\n",
+            filename, g_strerror(err));
+}
+
+/* The lookups that proto.c does with an index, i.e. those of fields
+   with a plain value_string or range_string */
+static gboolean
+has_plain_strings(const header_field_info *hfinfo)
+{
+    if (!hfinfo->strings)
+        return FALSE;
+    if (!IS_FT_INT(hfinfo->type) && !IS_FT_UINT(hfinfo->type))
+        return FALSE;
+    if (hfinfo->type == FT_INT64 || hfinfo->type == FT_UINT64 ||
+        hfinfo->type == FT_FRAMENUM)
+        return FALSE;
+    if (hfinfo->display & (BASE_EXT_STRING|BASE_VAL64_STRING))
+        return FALSE;
+    if ((hfinfo->display & FIELD_DISPLAY_E_MASK) == BASE_CUSTOM)
+        return FALSE;
+    return TRUE;
+}
+
+static void
+add_lookup(GArray *lookups, const header_field_info *hfinfo,
+           const value_string_index *vsi, guint32 value)
+{
+    lookup_t l;
+
+    l.hfinfo = hfinfo;
+    l.vsi = vsi;
+    l.value = value;
+    g_array_append_val(lookups, l);
+}
+
+/* Add a lookup of every value in the field's table, and of one value
+   that isn't in it, as the values in packets mostly are in the table */
+static void
+add_field_lookups(GArray *lookups, GPtrArray *indexes,
+                  const header_field_info *hfinfo)
+{
+    value_string_index *vsi;
+    guint32 max = 0;
+
+    if (hfinfo->display & BASE_RANGE_STRING) {
+        const range_string *rs = (const range_string *)hfinfo->strings;
+
+        vsi = range_string_index_new(rs);
+        for (; rs->strptr; rs++) {
+            add_lookup(lookups, hfinfo, vsi, rs->value_min);
+            if (rs->value_max != rs->value_min)
+                add_lookup(lookups, hfinfo, vsi, rs->value_max);
+            if (rs->value_max > max)
+                max = rs->value_max;
+        }
+    } else {
+        const value_string *vs = (const value_string *)hfinfo->strings;
+
+        vsi = value_string_index_new(vs);
+        for (; vs->strptr; vs++) {
+            add_lookup(lookups, hfinfo, vsi, vs->value);
+            if (vs->value > max)
+                max = vs->value;
+        }
+    }
+    if (max < G_MAXUINT32)
+        add_lookup(lookups, hfinfo, vsi, max + 1);
+    if (vsi)
+        g_ptr_array_add(indexes, vsi);
+}
+
+static const gchar *
+linear_lookup(const lookup_t *l)
+{
+    if (l->hfinfo->display & BASE_RANGE_STRING)
+        return try_rval_to_str(l->value, (const range_string *)l->hfinfo->strings);
+    return try_val_to_str(l->value, (const value_string *)l->hfinfo->strings);
+}
+
+/* As proto.c does it: with the index if the table has one */
+static const gchar *
+indexed_lookup(const lookup_t *l)
+{
+    if (l->vsi)
+        return value_string_index_lookup(l->value, l->vsi);
+    return linear_lookup(l);
+}
+
+/* Returns the time, in milliseconds, that looking up every value rounds
+   times takes */
+static double
+time_lookups(GArray *lookups, int rounds,
+             const gchar *(*lookup)(const lookup_t *), guint *found)
+{
+    GTimer *timer;
+    double elapsed;
+    guint i;
+    int r;
+
+    *found = 0;
+    timer = g_timer_new();
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < lookups->len; i++) {
+            if (lookup(&g_array_index(lookups, lookup_t, i)))
+                (*found)++;
+        }
+    }
+    elapsed = g_timer_elapsed(timer, NULL) * 1000;
+    g_timer_destroy(timer);
+    return elapsed;
+}
+
+/* Looks up the values of the fields of a protocol both ways and prints
+   how long each took; returns FALSE if they didn't get the same names */
+static gboolean
+bench_protocol(const char *name, int rounds)
+{
+    GArray *lookups;
+    GPtrArray *indexes;
+    header_field_info *hfinfo;
+    void *cookie;
+    int proto_id;
+    guint fields = 0, linear_found, indexed_found, i;
+    double linear_ms, indexed_ms;
+    gboolean same = TRUE;
+
+    proto_id = proto_get_id_by_filter_name(name);
+    if (proto_id == -1) {
+        fprintf(stderr, "value_string_bench: There's no protocol \"%s\".\n", name);
+        return FALSE;
+    }
+
+    lookups = g_array_new(FALSE, FALSE, sizeof(lookup_t));
+    indexes = g_ptr_array_new();
+    for (hfinfo = proto_get_first_protocol_field(proto_id, &cookie);
+         hfinfo != NULL;
+         hfinfo = proto_get_next_protocol_field(proto_id, &cookie)) {
+        if (!has_plain_strings(hfinfo))
+            continue;
+        add_field_lookups(lookups, indexes, hfinfo);
+        fields++;
+    }
+
+    for (i = 0; i < lookups->len; i++) {
+        const lookup_t *l = &g_array_index(lookups, lookup_t, i);
+
+        if (linear_lookup(l) != indexed_lookup(l)) {
+            fprintf(stderr, "value_string_bench: %s: %u looks up different names\n",
+                    l->hfinfo->abbrev, l->value);
+            same = FALSE;
+        }
+    }
+
+    linear_ms = time_lookups(lookups, rounds, linear_lookup, &linear_found);
+    indexed_ms = time_lookups(lookups, rounds, indexed_lookup, &indexed_found);
+    printf("%-12s %8u %8u %12.1f %12.1f\n", name, fields, lookups->len,
+           linear_ms, indexed_ms);
+    if (linear_found != indexed_found)
+        same = FALSE;
+
+    for (i = 0; i < indexes->len; i++)
+        value_string_index_free((value_string_index *)g_ptr_array_index(indexes, i));
+    g_ptr_array_free(indexes, TRUE);
+    g_array_free(lookups, TRUE);
+    return same;
+}
+
+int
+main(int argc, char **argv)
+{
+    char *init_progfile_dir_error;
+    int rounds = DEFAULT_ROUNDS;
+    int first_arg = 1;
+    int i;
+    int ret = 0;
+
+    if (argc > 1 && strcmp(argv[1], "-n") == 0) {
+        if (argc < 3 || (rounds = atoi(argv[2])) <= 0) {
+            fprintf(stderr, "Usage: value_string_bench [-n rounds] [protocol ...]\n");
+            return 1;
+        }
+        first_arg = 3;
+    }
+
+    init_process_policies();
+    init_progfile_dir_error = init_progfile_dir(argv[0], main);
+    if (init_progfile_dir_error != NULL) {
+        fprintf(stderr, "value_string_bench: Can't get pathname of value_string_bench program: %s.\n",
+                init_progfile_dir_error);
+    }
+    init_report_err(failure_message, open_failure_message,
+                    read_failure_message, write_failure_message);
+
+    epan_init(register_all_protocols, register_all_protocol_handoffs,
+              NULL, NULL);
+
+    printf("%-12s %8s %8s %12s %12s\n", "Protocol", "Fields", "Values",
+           "linear (ms)", "indexed (ms)");
+    if (first_arg < argc) {
+        for (i = first_arg; i < argc; i++) {
+            if (!bench_protocol(argv[i], rounds))
+                ret = 1;
+        }
+    } else {
+        for (i = 0; i < (int)G_N_ELEMENTS(default_protocols); i++) {
+            if (!bench_protocol(default_protocols[i], rounds))
+                ret = 1;
+        }
+    }
+
+    epan_cleanup();
+    return ret;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -136,6 +136,7 @@ static void lua_frame_end(void)
     clear_outstanding_PrivateTable();
     clear_outstanding_TreeItem();
     clear_outstanding_FieldInfo();
+    wslua_clear_field_cache();
 }
 
 static int wslua_not_register_menu(lua_State* LS) {
@@ -72,93 +72,79 @@ WSLUA_METAMETHOD FieldInfo__unm(lua_State* L) {
     return 1;
 }
 
-/* WSLUA_ATTRIBUTE FieldInfo_value RO The value of this field. */
-WSLUA_METAMETHOD FieldInfo__call(lua_State* L) {
-    /*
-       Obtain the Value of the field.
-
-       Previous to 1.11.4, this function retrieved the value for most field types,
-       but for `ftypes.UINT_BYTES` it retrieved the `ByteArray` of the field's entire `TvbRange`.
-       In other words, it returned a `ByteArray` that included the leading length byte(s),
-       instead of just the *value* bytes. That was a bug, and has been changed in 1.11.4.
-       Furthermore, it retrieved an `ftypes.GUID` as a `ByteArray`, which is also incorrect.
-
-       If you wish to still get a `ByteArray` of the `TvbRange`, use `FieldInfo:get_range()`
-       to get the `TvbRange`, and then use `Tvb:bytes()` to convert it to a `ByteArray`.
-       */
-    FieldInfo fi = checkFieldInfo(L,1);
-
-    switch(fi->ws_fi->hfinfo->type) {
+/* Push the value of a field, as FieldInfo.value and Field:values() return it. */
+static int push_field_info_value(lua_State* L, field_info* ws_fi) {
+    switch(ws_fi->hfinfo->type) {
         case FT_BOOLEAN:
-                lua_pushboolean(L,(int)fvalue_get_uinteger(&(fi->ws_fi->value)));
+                lua_pushboolean(L,(int)fvalue_get_uinteger(&(ws_fi->value)));
                 return 1;
         case FT_UINT8:
         case FT_UINT16:
         case FT_UINT24:
         case FT_UINT32:
         case FT_FRAMENUM:
-                lua_pushnumber(L,(lua_Number)(fvalue_get_uinteger(&(fi->ws_fi->value))));
+                lua_pushnumber(L,(lua_Number)(fvalue_get_uinteger(&(ws_fi->value))));
                 return 1;
         case FT_INT8:
         case FT_INT16:
         case FT_INT24:
         case FT_INT32:
-                lua_pushnumber(L,(lua_Number)(fvalue_get_sinteger(&(fi->ws_fi->value))));
+                lua_pushnumber(L,(lua_Number)(fvalue_get_sinteger(&(ws_fi->value))));
                 return 1;
         case FT_FLOAT:
         case FT_DOUBLE:
-                lua_pushnumber(L,(lua_Number)(fvalue_get_floating(&(fi->ws_fi->value))));
+                lua_pushnumber(L,(lua_Number)(fvalue_get_floating(&(ws_fi->value))));
                 return 1;
         case FT_INT64: {
-                pushInt64(L,(Int64)(fvalue_get_integer64(&(fi->ws_fi->value))));
+                pushInt64(L,(Int64)(fvalue_get_integer64(&(ws_fi->value))));
                 return 1;
             }
         case FT_UINT64: {
-                pushUInt64(L,fvalue_get_integer64(&(fi->ws_fi->value)));
+                pushUInt64(L,fvalue_get_integer64(&(ws_fi->value)));
                 return 1;
             }
         case FT_ETHER: {
                 Address eth = (Address)g_malloc(sizeof(address));
                 eth->type = AT_ETHER;
-                eth->len = fi->ws_fi->length;
-                eth->data = tvb_memdup(NULL,fi->ws_fi->ds_tvb,fi->ws_fi->start,fi->ws_fi->length);
+                eth->len = ws_fi->length;
+                eth->data = tvb_memdup(NULL,ws_fi->ds_tvb,ws_fi->start,ws_fi->length);
                 pushAddress(L,eth);
                 return 1;
             }
         case FT_IPv4:{
                 Address ipv4 = (Address)g_malloc(sizeof(address));
                 ipv4->type = AT_IPv4;
-                ipv4->len = fi->ws_fi->length;
-                ipv4->data = tvb_memdup(NULL,fi->ws_fi->ds_tvb,fi->ws_fi->start,fi->ws_fi->length);
+                ipv4->len = ws_fi->length;
+                ipv4->data = tvb_memdup(NULL,ws_fi->ds_tvb,ws_fi->start,ws_fi->length);
                 pushAddress(L,ipv4);
                 return 1;
             }
         case FT_IPv6: {
                 Address ipv6 = (Address)g_malloc(sizeof(address));
                 ipv6->type = AT_IPv6;
-                ipv6->len = fi->ws_fi->length;
-                ipv6->data = tvb_memdup(NULL,fi->ws_fi->ds_tvb,fi->ws_fi->start,fi->ws_fi->length);
+                ipv6->len = ws_fi->length;
+                ipv6->data = tvb_memdup(NULL,ws_fi->ds_tvb,ws_fi->start,ws_fi->length);
                 pushAddress(L,ipv6);
                 return 1;
             }
         case FT_IPXNET:{
                 Address ipx = (Address)g_malloc(sizeof(address));
                 ipx->type = AT_IPX;
-                ipx->len = fi->ws_fi->length;
-                ipx->data = tvb_memdup(NULL,fi->ws_fi->ds_tvb,fi->ws_fi->start,fi->ws_fi->length);
+                ipx->len = ws_fi->length;
+                ipx->data = tvb_memdup(NULL,ws_fi->ds_tvb,ws_fi->start,ws_fi->length);
                 pushAddress(L,ipx);
                 return 1;
             }
         case FT_ABSOLUTE_TIME:
         case FT_RELATIVE_TIME: {
                 NSTime nstime = (NSTime)g_malloc(sizeof(nstime_t));
-                *nstime = *(NSTime)fvalue_get(&(fi->ws_fi->value));
+                *nstime = *(NSTime)fvalue_get(&(ws_fi->value));
                 pushNSTime(L,nstime);
                 return 1;
             }
         case FT_STRING:
         case FT_STRINGZ: {
-                gchar* repr = fvalue_to_string_repr(&fi->ws_fi->value,FTREPR_DISPLAY,NULL);
+                gchar* repr = fvalue_to_string_repr(&ws_fi->value,FTREPR_DISPLAY,NULL);
                 if (repr)
                     lua_pushstring(L,repr);
                 else
@@ -167,7 +153,7 @@ WSLUA_METAMETHOD FieldInfo__call(lua_State* L) {
                 return 1;
             }
         case FT_NONE:
-                if (fi->ws_fi->length == 0) {
+                if (ws_fi->length == 0) {
                         lua_pushnil(L);
                         return 1;
                 }
@@ -180,8 +166,8 @@ WSLUA_METAMETHOD FieldInfo__call(lua_State* L) {
         case FT_OID:
             {
                 ByteArray ba = g_byte_array_new();
-                g_byte_array_append(ba, (const guint8 *) fvalue_get(&fi->ws_fi->value),
-                                    fvalue_length(&fi->ws_fi->value));
+                g_byte_array_append(ba, (const guint8 *) fvalue_get(&ws_fi->value),
+                                    fvalue_length(&ws_fi->value));
                 pushByteArray(L,ba);
                 return 1;
             }
@@ -192,6 +178,25 @@ WSLUA_METAMETHOD FieldInfo__call(lua_State* L) {
     }
 }
 
+/* WSLUA_ATTRIBUTE FieldInfo_value RO The value of this field. */
+WSLUA_METAMETHOD FieldInfo__call(lua_State* L) {
+    /*
+       Obtain the Value of the field.
+
+       Previous to 1.11.4, this function retrieved the value for most field types,
+       but for `ftypes.UINT_BYTES` it retrieved the `ByteArray` of the field's entire `TvbRange`.
+       In other words, it returned a `ByteArray` that included the leading length byte(s),
+       instead of just the *value* bytes. That was a bug, and has been changed in 1.11.4.
+       Furthermore, it retrieved an `ftypes.GUID` as a `ByteArray`, which is also incorrect.
+
+       If you wish to still get a `ByteArray` of the `TvbRange`, use `FieldInfo:get_range()`
+       to get the `TvbRange`, and then use `Tvb:bytes()` to convert it to a `ByteArray`.
+       */
+    FieldInfo fi = checkFieldInfo(L,1);
+
+    return push_field_info_value(L,fi->ws_fi);
+}
+
 /* WSLUA_ATTRIBUTE FieldInfo_label RO The string representing this field */
 WSLUA_METAMETHOD FieldInfo__tostring(lua_State* L) {
     /* The string representation of the field. */
@@ -552,11 +557,64 @@ WSLUA_CONSTRUCTOR Field_list(lua_State *L) {
     WSLUA_RETURN(1); /* The array table of field filter names */
 }
 
+/*
+ * Lua code often gets the same field several times for each packet, e.g.
+ * from several post-dissectors, so the FieldInfos that Field__call()
+ * returns are kept, for each Field, in a table in the registry, and
+ * returned again as long as no new instances of the field have been added.
+ * The cache is emptied, in effect, at the end of each packet by bumping
+ * field_cache_epoch.
+ */
+typedef struct {
+    guint epoch;        /* field_cache_epoch when the FieldInfos were made */
+    int   count;        /* number of FieldInfos */
+    int   ref;          /* registry reference to the table holding them */
+} field_cache_entry;
+
+static GHashTable* field_cache = NULL;  /* Field -> field_cache_entry */
+static guint field_cache_epoch = 1;
+
+void wslua_clear_field_cache(void) {
+    field_cache_epoch++;
+}
+
+/* Get the instances of a field, and of fields with the same name, in the
+ * current tree, adding them to found. */
+static void get_field_instances(header_field_info* in, GPtrArray* found) {
+    while (in) {
+        GPtrArray* instances = proto_get_finfo_ptr_array(lua_tree->tree, in->id);
+        guint i;
+
+        if (instances) {
+            for (i=0; i<instances->len; i++)
+                g_ptr_array_add(found,g_ptr_array_index(instances,i));
+        }
+        in = (in->same_name_prev_id != -1) ? proto_registrar_get_nth(in->same_name_prev_id) : NULL;
+    }
+}
+
+static int count_field_instances(header_field_info* in) {
+    int count = 0;
+
+    while (in) {
+        GPtrArray* instances = proto_get_finfo_ptr_array(lua_tree->tree, in->id);
+
+        if (instances)
+            count += instances->len;
+        in = (in->same_name_prev_id != -1) ? proto_registrar_get_nth(in->same_name_prev_id) : NULL;
+    }
+    return count;
+}
+
 WSLUA_METAMETHOD Field__call (lua_State* L) {
     /* Obtain all values (see `FieldInfo`) for this field. */
     Field f = checkField(L,1);
     header_field_info* in = *f;
-    int items_found = 0;
+    field_cache_entry* entry;
+    GPtrArray* found;
+    int items_found;
+    int table;
+    int i;
 
     if (! in) {
         luaL_error(L,"invalid field");
@@ -568,25 +626,114 @@ WSLUA_METAMETHOD Field__call (lua_State* L) {
         return 0;
     }
 
-    while (in) {
-        GPtrArray* found = proto_get_finfo_ptr_array(lua_tree->tree, in->id);
-        guint i;
-        if (found) {
-            for (i=0; i<found->len; i++) {
-                FieldInfo fi = (FieldInfo)g_malloc(sizeof(struct _wslua_field_info));
-                fi->ws_fi = (field_info *)g_ptr_array_index(found,i);
-                fi->expired = FALSE;
-
-                PUSH_FIELDINFO(L,fi);
-                items_found++;
-            }
-        }
-	in = (in->same_name_prev_id != -1) ? proto_registrar_get_nth(in->same_name_prev_id) : NULL;
+    items_found = count_field_instances(in);
+    if (items_found == 0)
+        return 0;
+
+    luaL_checkstack(L,items_found+2,"too many instances of the field");
+
+    entry = (field_cache_entry *)g_hash_table_lookup(field_cache,f);
+    if (entry && entry->epoch == field_cache_epoch && entry->count == items_found) {
+        lua_rawgeti(L,LUA_REGISTRYINDEX,entry->ref);
+        table = lua_gettop(L);
+        for (i=1; i<=items_found; i++)
+            lua_rawgeti(L,table,i);
+        lua_remove(L,table);
+        WSLUA_RETURN(items_found); /* All the values of this field */
+    }
+
+    if (!entry) {
+        entry = g_new(field_cache_entry,1);
+        lua_newtable(L);
+        entry->ref = luaL_ref(L,LUA_REGISTRYINDEX);
+        g_hash_table_insert(field_cache,f,entry);
+    }
+    entry->epoch = field_cache_epoch;
+    entry->count = items_found;
+
+    lua_rawgeti(L,LUA_REGISTRYINDEX,entry->ref);
+    table = lua_gettop(L);
+
+    found = g_ptr_array_sized_new(items_found);
+    get_field_instances(in,found);
+    for (i=0; i<items_found; i++) {
+        FieldInfo fi = (FieldInfo)g_malloc(sizeof(struct _wslua_field_info));
+        fi->ws_fi = (field_info *)g_ptr_array_index(found,i);
+        fi->expired = FALSE;
+
+        PUSH_FIELDINFO(L,fi);
+        lua_pushvalue(L,-1);
+        lua_rawseti(L,table,i+1);
+    }
+    g_ptr_array_free(found,TRUE);
+    lua_remove(L,table);
+
+    WSLUA_RETURN(items_found); /* All the values of this field */
+}
+
+WSLUA_METHOD Field_values(lua_State* L) {
+    /* Obtain the values of all instances of this field directly, as
+       `FieldInfo.value` would return them, without making a `FieldInfo`
+       for each of them; much cheaper if only the values are needed.
+
+       @since 1.99.0
+     */
+    Field f = checkField(L,1);
+    GPtrArray* found;
+    guint i;
+    int items_found = 0;
+
+    if (! *f) {
+        luaL_error(L,"invalid field");
+        return 0;
     }
 
+    if (! lua_pinfo ) {
+        WSLUA_ERROR(Field_values,"Fields cannot be used outside dissectors or taps");
+        return 0;
+    }
+
+    found = g_ptr_array_new();
+    get_field_instances(*f,found);
+    luaL_checkstack(L,found->len+1,"too many instances of the field");
+    for (i=0; i<found->len; i++)
+        items_found += push_field_info_value(L,(field_info *)g_ptr_array_index(found,i));
+    g_ptr_array_free(found,TRUE);
+
     WSLUA_RETURN(items_found); /* All the values of this field */
 }
 
+WSLUA_METHOD Field_value(lua_State* L) {
+    /* Obtain the value of the first instance of this field directly, as
+       `FieldInfo.value` would return it, or nil if there isn't one.
+
+       @since 1.99.0
+     */
+    Field f = checkField(L,1);
+    header_field_info* in = *f;
+    GPtrArray* instances;
+
+    if (! in) {
+        luaL_error(L,"invalid field");
+        return 0;
+    }
+
+    if (! lua_pinfo ) {
+        WSLUA_ERROR(Field_value,"Fields cannot be used outside dissectors or taps");
+        return 0;
+    }
+
+    while (in) {
+        instances = proto_get_finfo_ptr_array(lua_tree->tree, in->id);
+        if (instances && instances->len > 0)
+            return push_field_info_value(L,(field_info *)g_ptr_array_index(instances,0));
+        in = (in->same_name_prev_id != -1) ? proto_registrar_get_nth(in->same_name_prev_id) : NULL;
+    }
+
+    lua_pushnil(L);
+    WSLUA_RETURN(1); /* The value of the field, or nil */
+}
+
 WSLUA_METAMETHOD Field__tostring(lua_State* L) {
 	/* Obtain a string with the field name. */
     Field f = checkField(L,1);
@@ -608,6 +755,8 @@ static int Field__gc(lua_State* L _U_) {
 WSLUA_METHODS Field_methods[] = {
     WSLUA_CLASS_FNREG(Field,new),
     WSLUA_CLASS_FNREG(Field,list),
+    WSLUA_CLASS_FNREG(Field,values),
+    WSLUA_CLASS_FNREG(Field,value),
     { NULL, NULL }
 };
 
@@ -623,6 +772,9 @@ int Field_register(lua_State* L) {
 
     WSLUA_REGISTER_CLASS(Field);
     outstanding_FieldInfo = g_ptr_array_new();
+    if (field_cache)
+        g_hash_table_destroy(field_cache);
+    field_cache = g_hash_table_new_full(g_direct_hash,g_direct_equal,NULL,g_free);
 
     return 0;
 }
@@ -124,6 +124,7 @@ static int lua_tap_packet(void *tapdata, packet_info *pinfo, epan_dissect_t *edt
 
     clear_outstanding_Pinfo();
     clear_outstanding_Tvb();
+    wslua_clear_field_cache();
 
     lua_pinfo = NULL;
     lua_tvb = NULL;
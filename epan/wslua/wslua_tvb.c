@@ -417,11 +417,36 @@ void clear_outstanding_Tvb(void) {
     }
 }
 
+/*
+ * Lua code typically makes many TvbRanges for each packet, each needing a
+ * TvbRange and a Tvb; once both Lua and the end of the packet are done with
+ * them, they're kept here for reuse rather than freed.
+ */
+#define TVBRANGE_POOL_MAX 1024
+static GPtrArray* free_TvbRanges = NULL;
+
+static TvbRange new_TvbRange(void) {
+    TvbRange tvbr;
+
+    if (free_TvbRanges && free_TvbRanges->len) {
+        tvbr = (TvbRange)g_ptr_array_remove_index_fast(free_TvbRanges,free_TvbRanges->len-1);
+    } else {
+        tvbr = (TvbRange)g_malloc(sizeof(struct _wslua_tvbrange));
+        tvbr->tvb = (Tvb)g_malloc(sizeof(struct _wslua_tvb));
+    }
+    tvbr->tvb->expired = FALSE;
+    tvbr->tvb->need_free = FALSE;
+    return tvbr;
+}
+
 static void free_TvbRange(TvbRange tvbr) {
     if (!(tvbr && tvbr->tvb)) return;
 
     if (!tvbr->tvb->expired) {
         tvbr->tvb->expired = TRUE;
+    } else if (free_TvbRanges && free_TvbRanges->len < TVBRANGE_POOL_MAX &&
+               !tvbr->tvb->need_free) {
+        g_ptr_array_add(free_TvbRanges,tvbr);
     } else {
         free_Tvb(tvbr->tvb);
         g_free(tvbr);
@@ -596,11 +621,8 @@ gboolean push_TvbRange(lua_State* L, tvbuff_t* ws_tvb, int offset, int len) {
         return FALSE;
     }
 
-    tvbr = (TvbRange)g_malloc(sizeof(struct _wslua_tvbrange));
-    tvbr->tvb = (Tvb)g_malloc(sizeof(struct _wslua_tvb));
+    tvbr = new_TvbRange();
     tvbr->tvb->ws_tvb = ws_tvb;
-    tvbr->tvb->expired = FALSE;
-    tvbr->tvb->need_free = FALSE;
     tvbr->offset = offset;
     tvbr->len = len;
 
@@ -1361,7 +1383,7 @@ WSLUA_METHOD TvbRange_bytes(lua_State* L) {
     ba = g_byte_array_new();
 
     if (encoding == 0) {
-        g_byte_array_append(ba,(const guint8 *)tvb_memdup(wmem_packet_scope(),tvbr->tvb->ws_tvb,tvbr->offset,tvbr->len),tvbr->len);
+        g_byte_array_append(ba,tvb_get_ptr(tvbr->tvb->ws_tvb,tvbr->offset,tvbr->len),tvbr->len);
         pushByteArray(L,ba);
         lua_pushinteger(L, tvbr->len);
     }
@@ -1618,6 +1640,8 @@ WSLUA_META TvbRange_meta[] = {
 int TvbRange_register(lua_State* L) {
     outstanding_Tvb = g_ptr_array_new();
     outstanding_TvbRange = g_ptr_array_new();
+    if (!free_TvbRanges)
+        free_TvbRanges = g_ptr_array_new();
     WSLUA_REGISTER_CLASS(TvbRange);
     return 0;
 }
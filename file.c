@@ -45,6 +45,7 @@
 #include <wsutil/ws_version_info.h>
 
 #include <wiretap/merge.h>
+#include <wiretap/frame_index.h>
 
 #include <epan/exceptions.h>
 #include <epan/epan-int.h>
@@ -108,6 +109,11 @@ gboolean auto_scroll_live;
 
 static int read_packet(capture_file *cf, dfilter_t *dfcode, epan_dissect_t *edt,
     column_info *cinfo, gint64 offset);
+static void read_indexed_packets(capture_file *cf, const frame_index *idx,
+    column_info *cinfo);
+static void first_pass_run(capture_file *cf, guint32 until,
+    gboolean show_progress);
+static void first_pass_before(capture_file *cf, const frame_data *fdata);
 
 static void rescan_packets(capture_file *cf, const char *action, const char *action_item, gboolean redissect);
 
@@ -152,6 +158,8 @@ static void ref_time_packets(capture_file *cf);
 /* We read around 200k/100ms don't update the progress bar more often than that */
 #define MIN_QUANTUM         200000
 #define MIN_NUMBER_OF_PACKET 1500
+/* Dissect this many packets added from an index each time the UI is idle */
+#define FIRST_PASS_BATCH    500
 
 /*
  * We could probably use g_signal_...() instead of the callbacks below but that
@@ -165,6 +173,13 @@ typedef struct {
 
 static GList *cf_callbacks = NULL;
 
+/* Index of the file being read by cf_read(), if we're writing one */
+static frame_index *cf_frame_index = NULL;
+
+/* TRUE while first_pass_run() is dissecting, so that it isn't reentered
+   from a progress dialog */
+static gboolean first_pass_running = FALSE;
+
 static void
 cf_callback_invoke(int event, gpointer data)
 {
@@ -376,6 +391,7 @@ cf_open(capture_file *cf, const char *fname, unsigned int type, gboolean is_temp
   cf->open_type   = type;
   cf->linktypes = g_array_sized_new(FALSE, FALSE, (guint) sizeof(int), 1);
   cf->count     = 0;
+  cf->first_pass_next = 0;
   cf->packet_comment_count = 0;
   cf->displayed_count = 0;
   cf->marked_count = 0;
@@ -495,6 +511,7 @@ cf_close(capture_file *cf)
 
   /* No frames, no frame selected, no field in that frame selected. */
   cf->count = 0;
+  cf->first_pass_next = 0;
   cf->current_frame = 0;
   cf->current_row = 0;
   cf->finfo_selected = NULL;
@@ -570,6 +587,7 @@ cf_read(capture_file *cf, gboolean reloading)
   volatile gboolean    create_proto_tree;
   guint                tap_flags;
   gboolean             compiled;
+  frame_index         *loaded_index   = NULL;
 
   /* Compile the current display filter.
    * We assume this will not fail since cf->dfilter is only set in
@@ -596,6 +614,35 @@ cf_read(capture_file *cf, gboolean reloading)
      XXX - do we know this at open time? */
   cf->iscompressed = wtap_iscompressed(cf->wth);
 
+  /*
+   * If asked to, use an index of the file's packets written when it was
+   * last read, rather than reading it all again, if nothing needs to
+   * see every packet as it's read; otherwise write one as we read it.
+   * Compressed files are left alone, as seeking in them is only fast
+   * after they've been read sequentially.  No index is written for a
+   * file with records other than packets and interface descriptions,
+   * e.g. pcapng name resolution and interface statistics blocks, as
+   * those are only seen when the file is read.
+   */
+  cf->first_pass_next = 0;
+  if (prefs.gui_frame_index && !cf->iscompressed && cf->rfcode == NULL) {
+    if (dfcode == NULL && !tap_listeners_require_dissection()) {
+      loaded_index = frame_index_load(cf->filename, cf->cd_t);
+      if (loaded_index != NULL) {
+        wtapng_iface_descriptions_t *idb_inf = wtap_file_get_idb_info(cf->wth);
+
+        /* Interfaces described later in the file aren't known yet */
+        if (frame_index_interface_count(loaded_index) > idb_inf->interface_data->len) {
+          frame_index_free(loaded_index);
+          loaded_index = NULL;
+        }
+        g_free(idb_inf);
+      }
+    }
+    if (loaded_index == NULL)
+      cf_frame_index = frame_index_new(cf->filename);
+  }
+
   /* The packet list window will be empty until the file is completly loaded */
   packet_list_freeze();
 
@@ -637,7 +684,13 @@ cf_read(capture_file *cf, gboolean reloading)
     }else
       progbar_quantum = 0;
 
-    while ((wtap_read(cf->wth, &err, &err_info, &data_offset))) {
+    if (loaded_index != NULL) {
+      read_indexed_packets(cf, loaded_index, cinfo);
+      cf->first_pass_next = 1;
+      err = 0;
+    }
+    while (loaded_index == NULL &&
+           wtap_read(cf->wth, &err, &err_info, &data_offset)) {
       if (size >= 0) {
         count++;
         file_pos = wtap_read_so_far(cf->wth);
@@ -714,6 +767,16 @@ cf_read(capture_file *cf, gboolean reloading)
 
   epan_dissect_cleanup(&edt);
 
+  /* Only keep an index of a file we've read completely. */
+  if (cf_frame_index != NULL) {
+    int index_err;
+
+    if (!stop_flag && err == 0 && !wtap_metadata_seen(cf->wth))
+      frame_index_save(cf_frame_index, cf->filename, cf->cd_t, &index_err);
+    frame_index_free(cf_frame_index);
+    cf_frame_index = NULL;
+  }
+
   /* We're done reading the file; destroy the progress bar if it was created. */
   if (progbar != NULL)
     destroy_progress_dlg(progbar);
@@ -725,8 +788,11 @@ cf_read(capture_file *cf, gboolean reloading)
   wtap_sequential_close(cf->wth);
 
   /* Allow the protocol dissectors to free up memory that they
-   * don't need after the sequential run-through of the packets. */
-  postseq_cleanup_all_protocols();
+   * don't need after the sequential run-through of the packets.
+   * If the packets came from an index, none of them has been
+   * dissected yet; first_pass_run() does this once they all have. */
+  if (loaded_index == NULL)
+    postseq_cleanup_all_protocols();
 
   /* compute the time it took to load the file */
   compute_elapsed(cf, &start_time);
@@ -736,6 +802,12 @@ cf_read(capture_file *cf, gboolean reloading)
      there's more than one type (and thus whether it's
      WTAP_ENCAP_PER_PACKET). */
   cf->lnk_t = wtap_file_encap(cf->wth);
+  if (loaded_index != NULL) {
+    /* We didn't look at the packets, but the index did */
+    if (cf->linktypes->len > 1)
+      cf->lnk_t = WTAP_ENCAP_PER_PACKET;
+    frame_index_free(loaded_index);
+  }
 
   cf->current_frame = frame_data_sequence_find(cf->frames, cf->first_displayed);
   cf->current_row = 0;
@@ -1263,6 +1335,9 @@ read_packet(capture_file *cf, dfilter_t *dfcode, epan_dissect_t *edt,
       cf->packet_comment_count++;
     cf->f_datalen = offset + fdlocal.cap_len;
 
+    if (cf_frame_index != NULL)
+      frame_index_add(cf_frame_index, phdr, offset);
+
     if (!cf->redissecting) {
       row = add_packet_to_packet_list(fdata, cf, edt, dfcode,
                                       cinfo, phdr, buf, TRUE);
@@ -1272,6 +1347,181 @@ read_packet(capture_file *cf, dfilter_t *dfcode, epan_dissect_t *edt,
   return row;
 }
 
+/* Add the packets listed in an index of the file to the packet list,
+   without reading or dissecting them.  They're first dissected when
+   they're displayed, after all the packets before them; see
+   first_pass_before(). */
+static void
+read_indexed_packets(capture_file *cf, const frame_index *idx,
+                     column_info *cinfo)
+{
+  const frame_index_rec *rec;
+  struct wtap_pkthdr phdr;
+  frame_data    fdlocal;
+  frame_data   *fdata;
+  guint32       i, count;
+
+  memset(&phdr, 0, sizeof phdr);
+  phdr.rec_type = REC_TYPE_PACKET;
+
+  count = frame_index_count(idx);
+  for (i = 0; i < count; i++) {
+    rec = frame_index_get(idx, i);
+
+    phdr.presence_flags = WTAP_HAS_CAP_LEN;
+    if (rec->flags & FRAME_INDEX_HAS_TS)
+      phdr.presence_flags |= WTAP_HAS_TS;
+    if (rec->flags & FRAME_INDEX_HAS_INTERFACE_ID)
+      phdr.presence_flags |= WTAP_HAS_INTERFACE_ID;
+    phdr.ts.secs = (time_t)rec->ts_secs;
+    phdr.ts.nsecs = rec->ts_nsecs;
+    phdr.caplen = rec->caplen;
+    phdr.len = rec->len;
+    phdr.pkt_encap = rec->pkt_encap;
+    phdr.interface_id = rec->interface_id;
+
+    cf_add_encapsulation_type(cf, phdr.pkt_encap);
+    frame_data_init(&fdlocal, cf->count + 1, &phdr, rec->offset, cf->cum_bytes);
+    fdlocal.flags.has_phdr_comment = (rec->flags & FRAME_INDEX_HAS_COMMENT) ? 1 : 0;
+
+    fdata = frame_data_sequence_add(cf->frames, &fdlocal);
+    cf->count++;
+    if (fdata->flags.has_phdr_comment)
+      cf->packet_comment_count++;
+    cf->f_datalen = rec->offset + fdata->cap_len;
+
+    /* As add_packet_to_packet_list() does with no display filter */
+    frame_data_set_before_dissect(fdata, &cf->elapsed_time,
+                                  &cf->ref, cf->prev_dis);
+    cf->prev_cap = fdata;
+    fdata->flags.passed_dfilter = 1;
+    cf->displayed_count++;
+    packet_list_append(cinfo, fdata);
+    frame_data_set_after_dissect(fdata, &cf->cum_bytes);
+    cf->prev_dis = fdata;
+    if (cf->first_displayed == 0)
+      cf->first_displayed = fdata->num;
+    cf->last_displayed = fdata->num;
+  }
+}
+
+/* If the packets were added from an index, dissect those before frame
+   number "until" that haven't been dissected yet, in order, so that
+   dissectors keeping state see each packet for the first time in the
+   same order as if the file had been read; e.g., TCP analysis and
+   reassembly depend on it.  Once all of them have been, let the
+   dissectors clean up, as cf_read() does after reading a file. */
+static void
+first_pass_run(capture_file *cf, guint32 until, gboolean show_progress)
+{
+  epan_dissect_t      edt;
+  struct wtap_pkthdr  phdr;
+  Buffer              buf;
+  frame_data         *prev;
+  guint32             framenum;
+  guint32             first;
+  progdlg_t          *progbar = NULL;
+  gboolean            stop_flag;
+  GTimeVal            start_time;
+  float               progbar_val;
+  gchar               status_str[100];
+  guint32             progbar_nextstep;
+  guint32             progbar_quantum;
+
+  if (first_pass_running || cf->first_pass_next == 0)
+    return;
+  first_pass_running = TRUE;
+
+  first = cf->first_pass_next;
+  progbar_nextstep = first;
+  progbar_quantum = (until > first) ? (until - first)/N_PROGBAR_UPDATES : 0;
+  if (progbar_quantum == 0)
+    progbar_quantum = 1;
+  stop_flag = FALSE;
+  g_get_current_time(&start_time);
+
+  memset(&phdr, 0, sizeof phdr);
+  ws_buffer_init(&buf, 1500);
+  epan_dissect_init(&edt, cf->epan, FALSE, FALSE);
+  while (cf->first_pass_next != 0 && cf->first_pass_next < until) {
+    framenum = cf->first_pass_next;
+
+    if (show_progress && framenum >= progbar_nextstep) {
+      progbar_val = (gfloat) (framenum - first) / (until - first);
+      if (progbar == NULL)
+        progbar = delayed_create_progress_dlg(cf->window, "Dissecting", "earlier packets",
+                                              TRUE, &stop_flag, &start_time, progbar_val);
+      if (progbar != NULL) {
+        g_snprintf(status_str, sizeof(status_str),
+                   "%u of %u packets", framenum - first, until - first);
+        update_progress_dlg(progbar, progbar_val, status_str);
+      }
+      progbar_nextstep += progbar_quantum;
+    }
+
+    if (stop_flag) {
+      /* The rest are left to cf_first_pass_continue(); the packet
+         being read is dissected without them. */
+      break;
+    }
+
+    /* Move on first, so that reading prev doesn't come back here */
+    cf->first_pass_next = framenum + 1;
+    prev = frame_data_sequence_find(cf->frames, framenum);
+    if (prev == NULL || prev->flags.visited)
+      continue;
+    if (!cf_read_record_r(cf, prev, &phdr, &buf))
+      break;
+    epan_dissect_run(&edt, cf->cd_t, &phdr, frame_tvbuff_new_buffer(prev, &buf),
+                     prev, NULL);
+    epan_dissect_reset(&edt);
+  }
+  epan_dissect_cleanup(&edt);
+  ws_buffer_free(&buf);
+
+  if (progbar != NULL)
+    destroy_progress_dlg(progbar);
+
+  if (cf->first_pass_next > cf->count) {
+    cf->first_pass_next = 0;
+    postseq_cleanup_all_protocols();
+  }
+  first_pass_running = FALSE;
+}
+
+/* Dissect the packets before fdata that haven't been yet, if it's about
+   to be dissected. */
+static void
+first_pass_before(capture_file *cf, const frame_data *fdata)
+{
+  if (cf->first_pass_next == 0 || fdata->num <= cf->first_pass_next)
+    return;
+
+  first_pass_run(cf, fdata->num, TRUE);
+}
+
+gboolean
+cf_first_pass_continue(capture_file *cf, float *progress)
+{
+  guint32 until;
+
+  if (cf->state != FILE_READ_DONE || cf->first_pass_next == 0)
+    return FALSE;
+
+  /* Packets being dissected again will all be seen in order anyway */
+  if (!cf->redissecting) {
+    until = cf->first_pass_next + FIRST_PASS_BATCH;
+    if (until > cf->count + 1 || until < cf->first_pass_next)
+      until = cf->count + 1;
+    first_pass_run(cf, until, FALSE);
+    if (cf->first_pass_next == 0)
+      return FALSE;
+  }
+
+  *progress = (float) (cf->first_pass_next - 1) / cf->count;
+  return TRUE;
+}
+
 cf_status_t
 cf_merge_files(char **out_filenamep, int in_file_count,
                char *const *in_filenames, int file_type, gboolean do_append)
@@ -1747,6 +1997,9 @@ cf_read_record_r(capture_file *cf, const frame_data *fdata,
   gchar *err_info;
   gchar *display_basename;
 
+  /* Whoever reads a packet is about to dissect it */
+  first_pass_before(cf, fdata);
+
 #ifdef WANT_PACKET_EDITOR
   /* if fdata->file_off == -1 it means packet was edited, and we must find data inside edited_frames tree */
   if (G_UNLIKELY(fdata->file_off == -1)) {
@@ -136,6 +136,19 @@ void cf_reload(capture_file *cf);
  */
 cf_read_status_t cf_read(capture_file *cf, gboolean from_save);
 
+/**
+ * If cf_read() filled in the packet list from an index of the file,
+ * dissect the next batch of packets that haven't been dissected yet, in
+ * order.  The UI calls this when it's idle, until it returns FALSE;
+ * a packet that's read before its turn has those before it dissected
+ * first.
+ *
+ * @param cf the capture file
+ * @param progress set to the fraction of the packets dissected so far
+ * @return TRUE if there are more to dissect, FALSE if they all have been
+ */
+gboolean cf_first_pass_continue(capture_file *cf, float *progress);
+
 /**
  * Read the metadata and raw data for a record.  It will pop
  * up an alert box if there's an error.
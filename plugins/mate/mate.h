@@ -119,6 +119,7 @@ typedef struct _mate_cfg_pdu {
 	avpl_match_mode criterium_match_mode;
 	accept_mode_t criterium_accept_mode;
 	AVPL* criterium;
+	AVPL_Match_Prog* criterium_prog; /* the criterium compiled, if its match mode is strict */
 } mate_cfg_pdu;
 
 
@@ -135,6 +136,10 @@ typedef struct _mate_cfg_gop {
 	AVPL* stop;  /* stop candidate avpl */
 	AVPL* extra; /* attributes to be added */
 
+	AVPL_Match_Prog* start_prog; /* start and stop compiled */
+	AVPL_Match_Prog* stop_prog;
+	GPtrArray* gog_key_progs; /* the keys of the gogs this gop can belong to, compiled; prog->avpl->name is the gog's name */
+
 	float expiration;
 	float idle_timeout;
 	float lifetime;
@@ -170,6 +175,7 @@ typedef struct _mate_cfg_gog {
 	GPtrArray* transforms; /* transformations to be applied */
 
 	LoAL* keys;
+	GPtrArray* key_progs; /* keys compiled; prog->avpl->name is the gop's name */
 	AVPL* extra; /* attributes to be added */
 
 	float expiration;
@@ -272,6 +278,9 @@ typedef struct _mate_runtime_data {
 
 	GHashTable* frames; /* k=frame.num v=pdus */
 
+	GQueue* released_gops; /* gops and gogs in the order they have been released, */
+	GQueue* released_gogs; /* to be discarded once they expire if there are too many items */
+
 } mate_runtime_data;
 
 typedef struct _mate_pdu mate_pdu;
@@ -328,6 +337,7 @@ struct _mate_gop {
 	mate_pdu* last_pdu; /* last pdu in pdu's list */
 
 	gboolean released; /* has this gop been released? */
+	gboolean queued; /* is it in released_gops? */
 };
 
 
@@ -355,6 +365,7 @@ struct _mate_gog {
 	int num_of_counting_gops;  /* how many of them count for gog release */
 	int num_of_released_gops;  /* how many of them have already been released */
 	GPtrArray* gog_keys; /* the keys under which this gog is stored in the gogs hash */
+	gboolean queued; /* is it in released_gogs? */
 };
 
 typedef union _mate_max_size {
@@ -367,6 +378,7 @@ typedef union _mate_max_size {
 extern void initialize_mate_runtime(void);
 extern mate_pdu* mate_get_pdus(guint32 framenum);
 extern void mate_analyze_frame(packet_info *pinfo, proto_tree* tree);
+extern void mate_set_max_items(guint max_items);
 
 /* from mate_setup.c */
 extern mate_config* mate_make_config(const gchar* filename, int mate_hfid);
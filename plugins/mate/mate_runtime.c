@@ -48,6 +48,9 @@ typedef struct _gogkey {
 static mate_runtime_data* rd = NULL;
 static mate_config* mc = NULL;
 
+/* when there are more items than this, expired gogs and gops get discarded */
+static guint max_items = 0;
+
 static int zero = 5;
 
 static int* dbg = &zero;
@@ -144,12 +147,16 @@ extern void initialize_mate_runtime(void) {
 			g_hash_table_foreach(mc->gogcfgs,destroy_gogs_in_cfg,NULL);
 
 			g_hash_table_destroy(rd->frames);
+			g_queue_free(rd->released_gops);
+			g_queue_free(rd->released_gogs);
 		}
 
 		rd->current_items = 0;
 		rd->now = -1.0f;
 		rd->highest_analyzed_frame = 0;
 		rd->frames = g_hash_table_new(g_direct_hash,g_direct_equal);
+		rd->released_gops = g_queue_new();
+		rd->released_gogs = g_queue_new();
 
 
 		/*mc->dbg_gop_lvl = 5;
@@ -199,6 +206,9 @@ static mate_gop* new_gop(mate_cfg_gop* cfg, mate_pdu* pdu, gchar* key) {
 	gop->last_pdu = pdu;
 
 	gop->released = FALSE;
+	gop->queued = FALSE;
+
+	rd->current_items++;
 
 	pdu->gop = gop;
 	pdu->next = NULL;
@@ -258,6 +268,9 @@ static mate_gog* new_gog(mate_cfg_gog* cfg, mate_gop* gop) {
 	gog->num_of_released_gops = 0;
 
 	gog->gog_keys = g_ptr_array_new();
+	gog->queued = FALSE;
+
+	rd->current_items++;
 
 	adopt_gop(gog,gop);
 
@@ -301,14 +314,104 @@ static void gog_remove_keys (mate_gog* gog) {
 
 }
 
+/* gops that belong to a gog are discarded along with it */
+static void queue_released_gop(mate_gop* gop) {
+	if (max_items && ! gop->queued && ! gop->gog) {
+		g_queue_push_tail(rd->released_gops,gop);
+		gop->queued = TRUE;
+	}
+}
+
+/* takes a pdu out of the list of pdus of its frame */
+static void forget_pdu(mate_pdu* pdu) {
+	mate_pdu* first = (mate_pdu *)g_hash_table_lookup(rd->frames,GUINT_TO_POINTER(pdu->frame));
+	mate_pdu* p;
+
+	if (first == pdu) {
+		if (pdu->next_in_frame) {
+			g_hash_table_insert(rd->frames,GUINT_TO_POINTER(pdu->frame),pdu->next_in_frame);
+		} else {
+			g_hash_table_remove(rd->frames,GUINT_TO_POINTER(pdu->frame));
+		}
+	} else {
+		for (p = first; p; p = p->next_in_frame) {
+			if (p->next_in_frame == pdu) {
+				p->next_in_frame = pdu->next_in_frame;
+				break;
+			}
+		}
+	}
+}
+
+static void discard_gop(mate_gop* gop) {
+	mate_pdu* pdu;
+	mate_pdu* next;
+
+	dbg_print (dbg_gop,2,dbg_facility,"discard_gop: %s:%d",gop->cfg->name,gop->id);
+
+	/* it was released before joining the gog being discarded */
+	if (gop->queued) g_queue_remove(rd->released_gops,gop);
+
+	for (pdu = gop->pdus; pdu; pdu = next) {
+		next = pdu->next;
+		forget_pdu(pdu);
+		destroy_mate_pdus(NULL,pdu,NULL);
+		rd->current_items--;
+	}
+
+	destroy_mate_gops(NULL,gop,NULL);
+	rd->current_items--;
+}
+
+static void discard_gog(mate_gog* gog) {
+	mate_gop* gop;
+	mate_gop* next;
+
+	dbg_print (dbg_gog,2,dbg_facility,"discard_gog: %s:%d",gog->cfg->name,gog->id);
+
+	for (gop = gog->gops; gop; gop = next) {
+		next = gop->next;
+		discard_gop(gop);
+	}
+
+	destroy_mate_gogs(NULL,gog,NULL);
+	rd->current_items--;
+}
+
+/* while there are more items than max_items, discards the released gogs
+   and gops that have expired, in the order they were released */
+static void discard_expired(void) {
+	mate_gog* gog;
+	mate_gop* gop;
+
+	while (rd->current_items > max_items && ( gog = (mate_gog *)g_queue_peek_head(rd->released_gogs) )) {
+		if (gog->released && gog->expiration >= rd->now) break;
+
+		g_queue_pop_head(rd->released_gogs);
+		gog->queued = FALSE;
+
+		/* one that got more gops since will be queued again once released */
+		if (gog->released) discard_gog(gog);
+	}
+
+	while (rd->current_items > max_items && ( gop = (mate_gop *)g_queue_peek_head(rd->released_gops) )) {
+		if ( ! gop->gog && gop->last_time + MAX(gop->cfg->expiration, 0.0f) >= rd->now) break;
+
+		g_queue_pop_head(rd->released_gops);
+		gop->queued = FALSE;
+
+		if ( ! gop->gog ) discard_gop(gop);
+	}
+}
+
 static void reanalyze_gop(mate_gop* gop) {
-	LoAL* gog_keys = NULL;
-	AVPL* curr_gogkey = NULL;
+	GPtrArray* gog_keys = NULL;
+	AVPL_Match_Prog* curr_gogkey = NULL;
 	mate_cfg_gop* gop_cfg = NULL;
-	void* cookie = NULL;
-	AVPL* gogkey_match = NULL;
+	gchar* key;
 	mate_gog* gog = gop->gog;
 	gogkey* gog_key;
+	guint i;
 
 	if ( ! gog ) return;
 
@@ -328,17 +431,17 @@ static void reanalyze_gop(mate_gop* gop) {
 
 		dbg_print (dbg_gog,2,dbg_facility,"reanalyze_gop: gog has new attributes let's look for new keys");
 
-		gog_keys = gog->cfg->keys;
+		gog_keys = gog->cfg->key_progs;
 
-		while (( curr_gogkey = get_next_avpl(gog_keys,&cookie) )) {
-			gop_cfg = (mate_cfg_gop *)g_hash_table_lookup(mc->gopcfgs,curr_gogkey->name);
+		for (i = 0; i < gog_keys->len; i++) {
+			curr_gogkey = (AVPL_Match_Prog *)g_ptr_array_index(gog_keys,i);
 
-			if (( gogkey_match = new_avpl_exact_match(gop_cfg->name,gog->avpl,curr_gogkey,FALSE) )) {
+			if (( key = avpl_prog_exact_match_str(curr_gogkey,gog->avpl) )) {
+				gop_cfg = (mate_cfg_gop *)g_hash_table_lookup(mc->gopcfgs,curr_gogkey->avpl->name);
 
 				gog_key = (gogkey *)g_malloc(sizeof(gogkey));
 
-				gog_key->key = avpl_to_str(gogkey_match);
-				delete_avpl(gogkey_match,FALSE);
+				gog_key->key = key;
 
 				gog_key->cfg = gop_cfg;
 
@@ -367,6 +470,11 @@ static void reanalyze_gop(mate_gop* gop) {
 	if (gog->num_of_released_gops == gog->num_of_counting_gops) {
 		gog->released =  TRUE;
 		gog->expiration = gog->cfg->expiration + rd->now;
+
+		if (max_items && ! gog->queued) {
+			g_queue_push_tail(rd->released_gogs,gog);
+			gog->queued = TRUE;
+		}
 	} else {
 		gog->released =  FALSE;
 	}
@@ -374,32 +482,31 @@ static void reanalyze_gop(mate_gop* gop) {
 
 static void analyze_gop(mate_gop* gop) {
 	mate_cfg_gog* cfg = NULL;
-	LoAL* gog_keys = NULL;
-	AVPL* curr_gogkey = NULL;
-	void* cookie = NULL;
-	AVPL* gogkey_match = NULL;
+	GPtrArray* gog_keys = NULL;
+	AVPL_Match_Prog* curr_gogkey = NULL;
 	mate_gog* gog = NULL;
 	gchar* key = NULL;
+	guint i;
 
 	if ( ! gop->gog  ) {
 		/* no gog, let's either find one or create it if due */
 		dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: no gog");
 
-		gog_keys = (LoAL *)g_hash_table_lookup(mc->gogs_by_gopname,gop->cfg->name);
+		gog_keys = gop->cfg->gog_key_progs;
 
-		if ( ! gog_keys ) {
+		if ( ! gog_keys->len ) {
 			dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: no gog_keys for this gop");
 			return;
 		}
 
 		/* We have gog_keys! look for matching gogkeys */
 
-		dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: got gog_keys: %s",gog_keys->name) ;
+		dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: got gog_keys: %s",gop->cfg->name) ;
 
-		while (( curr_gogkey = get_next_avpl(gog_keys,&cookie) )) {
-			if (( gogkey_match = new_avpl_exact_match(gop->cfg->name,gop->avpl,curr_gogkey,TRUE) )) {
+		for (i = 0; i < gog_keys->len; i++) {
+			curr_gogkey = (AVPL_Match_Prog *)g_ptr_array_index(gog_keys,i);
 
-				key = avpl_to_str(gogkey_match);
+			if (( key = avpl_prog_exact_match_str(curr_gogkey,gop->avpl) )) {
 
 				dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: got gogkey_match: %s",key);
 
@@ -422,9 +529,9 @@ static void analyze_gop(mate_gop* gop) {
 						break;
 					}
 				} else {
-					dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: no such gog in hash, let's create a new %s",curr_gogkey->name);
+					dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: no such gog in hash, let's create a new %s",curr_gogkey->avpl->name);
 
-					cfg = (mate_cfg_gog *)g_hash_table_lookup(mc->gogcfgs,curr_gogkey->name);
+					cfg = (mate_cfg_gog *)g_hash_table_lookup(mc->gogcfgs,curr_gogkey->avpl->name);
 
 					if (cfg) {
 						gog = new_gog(cfg,gop);
@@ -435,7 +542,7 @@ static void analyze_gop(mate_gop* gop) {
 						}
 
 					} else {
-						dbg_print (dbg_gog,0,dbg_facility,"analyze_gop: no such gog_cfg: %s",curr_gogkey->name);
+						dbg_print (dbg_gog,0,dbg_facility,"analyze_gop: no such gog_cfg: %s",curr_gogkey->avpl->name);
 					}
 
 					break;
@@ -445,14 +552,12 @@ static void analyze_gop(mate_gop* gop) {
 				g_assert_not_reached();
 			}
 
-			dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: no gogkey_match: %s",key);
-		} /* while */
+			dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: no gogkey_match: %s",curr_gogkey->avpl->name);
+		} /* for */
 
 		g_free(key);
 		key = NULL;
 
-		if (gogkey_match) delete_avpl(gogkey_match,TRUE);
-
 		reanalyze_gop(gop);
 	}
 }
@@ -468,16 +573,12 @@ static void analyze_pdu(mate_pdu* pdu) {
 	mate_gop* gop = NULL;
 	gchar* gop_key;
 	gchar* orig_gop_key = NULL;
-	AVPL* candidate_start = NULL;
-	AVPL* candidate_stop = NULL;
-	AVPL* is_start = NULL;
-	AVPL* is_stop = NULL;
+	gboolean is_stop;
 	AVPL* gopkey_match = NULL;
-	LoAL* gog_keys = NULL;
-	AVPL* curr_gogkey = NULL;
-	void* cookie = NULL;
-	AVPL* gogkey_match = NULL;
+	GPtrArray* gog_keys = NULL;
+	AVPL_Match_Prog* curr_gogkey = NULL;
 	gchar* gogkey_str = NULL;
+	guint i;
 
 	dbg_print (dbg_gop,1,dbg_facility,"analyze_pdu: %s",pdu->cfg->name);
 
@@ -498,6 +599,7 @@ static void analyze_pdu(mate_pdu* pdu) {
 				   ( gop->cfg->idle_timeout > 0.0 && gop->time_to_timeout >= rd->now) ) ) {
 				dbg_print (dbg_gop,4,dbg_facility,"analyze_pdu: expiring released gop");
 				gop->released = TRUE;
+				queue_released_gop(gop);
 
 				if (gop->gog && gop->cfg->start) gop->gog->num_of_released_gops++;
 			}
@@ -508,12 +610,11 @@ static void analyze_pdu(mate_pdu* pdu) {
 
 			dbg_print (dbg_gop,2,dbg_facility,"analyze_pdu: got gop: %s",gop_key);
 
-			if (( candidate_start = cfg->start )) {
+			if ( cfg->start_prog ) {
 
 				dbg_print (dbg_gop,2,dbg_facility,"analyze_pdu: got candidate start");
 
-				if (( is_start = new_avpl_exact_match("",pdu->avpl, candidate_start, FALSE) )) {
-					delete_avpl(is_start,FALSE);
+				if ( avpl_prog_exact_match(cfg->start_prog,pdu->avpl) ) {
 					if ( gop->released ) {
 						dbg_print (dbg_gop,3,dbg_facility,"analyze_pdu: start on released gop, let's create a new gop");
 
@@ -546,44 +647,31 @@ static void analyze_pdu(mate_pdu* pdu) {
 
 				apply_extras(pdu->avpl,gopkey_match,cfg->extra);
 
-				gog_keys = (LoAL *)g_hash_table_lookup(mc->gogs_by_gopname,cfg->name);
-
-				if (gog_keys) {
+				gog_keys = cfg->gog_key_progs;
 
-					while (( curr_gogkey = get_next_avpl(gog_keys,&cookie) )) {
-						if (( gogkey_match = new_avpl_exact_match(cfg->name,gopkey_match,curr_gogkey,FALSE) )) {
-							gogkey_str = avpl_to_str(gogkey_match);
+				for (i = 0; i < gog_keys->len; i++) {
+					curr_gogkey = (AVPL_Match_Prog *)g_ptr_array_index(gog_keys,i);
 
-							if (g_hash_table_lookup(cfg->gog_index,gogkey_str)) {
-								gop = new_gop(cfg,pdu,gop_key);
-								g_hash_table_insert(cfg->gop_index,gop_key,gop);
-								delete_avpl(gogkey_match,FALSE);
-								g_free(gogkey_str);
-								break;
-							} else {
-								delete_avpl(gogkey_match,FALSE);
-								g_free(gogkey_str);
-							}
+					if (( gogkey_str = avpl_prog_exact_match_str(curr_gogkey,gopkey_match) )) {
+						if (g_hash_table_lookup(cfg->gog_index,gogkey_str)) {
+							gop = new_gop(cfg,pdu,gop_key);
+							g_hash_table_insert(cfg->gop_index,gop_key,gop);
+							g_free(gogkey_str);
+							break;
+						} else {
+							g_free(gogkey_str);
 						}
 					}
+				}
 
-					if ( ! gop ) {
-						g_free(gop_key);
-						delete_avpl(gopkey_match,TRUE);
-						return;
-					}
-
-				} else {
+				if ( ! gop ) {
 					g_free(gop_key);
 					delete_avpl(gopkey_match,TRUE);
 					return;
 				}
 
 			} else {
-				candidate_start = cfg->start;
-
-				if (( is_start = new_avpl_exact_match("",pdu->avpl, candidate_start, FALSE) )) {
-					delete_avpl(is_start,FALSE);
+				if ( avpl_prog_exact_match(cfg->start_prog,pdu->avpl) ) {
 					gop = new_gop(cfg,pdu,gop_key);
 				} else {
 					g_free(gop_key);
@@ -615,21 +703,19 @@ static void analyze_pdu(mate_pdu* pdu) {
 		gop->last_time = pdu->rel_time;
 
 		if ( ! gop->released) {
-			candidate_stop = cfg->stop;
-
-			if (candidate_stop) {
-				is_stop = new_avpl_exact_match("",pdu->avpl, candidate_stop,FALSE);
+			if (cfg->stop_prog) {
+				is_stop = avpl_prog_exact_match(cfg->stop_prog,pdu->avpl);
 			} else {
-				is_stop = new_avpl("");
+				is_stop = TRUE;
 			}
 
 			if(is_stop) {
 				dbg_print (dbg_gop,1,dbg_facility,"analyze_pdu: is a `stop");
-				delete_avpl(is_stop,FALSE);
 
 				if (! gop->released) {
 					gop->released = TRUE;
 					gop->release_time = pdu->rel_time;
+					queue_released_gop(gop);
 					if (gop->gog && gop->cfg->start) gop->gog->num_of_released_gops++;
 				}
 
@@ -724,6 +810,8 @@ static mate_pdu* new_pdu(mate_cfg_pdu* cfg, guint32 framenum, field_info* proto,
 	pdu->id = ++(cfg->last_id);
 	pdu->cfg = cfg;
 
+	rd->current_items++;
+
 	pdu->avpl = new_avpl(cfg->name);
 
 	pdu->frame = framenum;
@@ -838,6 +926,7 @@ extern void mate_analyze_frame(packet_info *pinfo, proto_tree* tree) {
 	field_info* proto;
 	guint i,j;
 	AVPL* criterium_match;
+	gboolean matches;
 
 	mate_pdu* pdu = NULL;
 	mate_pdu* last = NULL;
@@ -864,17 +953,23 @@ extern void mate_analyze_frame(packet_info *pinfo, proto_tree* tree) {
 					pdu = new_pdu(cfg, pinfo->fd->num, proto, tree);
 
 					if (cfg->criterium) {
-						criterium_match = new_avpl_from_match(cfg->criterium_match_mode,"",pdu->avpl,cfg->criterium,FALSE);
-
-						if (criterium_match) {
-							delete_avpl(criterium_match,FALSE);
+						if (cfg->criterium_prog) {
+							matches = avpl_prog_exact_match(cfg->criterium_prog,pdu->avpl);
+						} else {
+							criterium_match = new_avpl_from_match(cfg->criterium_match_mode,"",pdu->avpl,cfg->criterium,FALSE);
+							matches = criterium_match != NULL;
+
+							if (criterium_match) {
+								delete_avpl(criterium_match,FALSE);
+							}
 						}
 
-						if ( (criterium_match && cfg->criterium_accept_mode == REJECT_MODE )
-							 || ( ! criterium_match && cfg->criterium_accept_mode == ACCEPT_MODE )) {
+						if ( (matches && cfg->criterium_accept_mode == REJECT_MODE )
+							 || ( ! matches && cfg->criterium_accept_mode == ACCEPT_MODE )) {
 
 							delete_avpl(pdu->avpl,TRUE);
 							g_slice_free(mate_max_size,(mate_max_size*)pdu);
+							rd->current_items--;
 							pdu = NULL;
 
 							continue;
@@ -886,6 +981,7 @@ extern void mate_analyze_frame(packet_info *pinfo, proto_tree* tree) {
 					if ( ! pdu->gop && cfg->drop_unassigned) {
 						delete_avpl(pdu->avpl,TRUE);
 						g_slice_free(mate_max_size,(mate_max_size*)pdu);
+						rd->current_items--;
 						pdu = NULL;
 						continue;
 					}
@@ -910,9 +1006,15 @@ extern void mate_analyze_frame(packet_info *pinfo, proto_tree* tree) {
 		}
 
 		rd->highest_analyzed_frame = pinfo->fd->num;
+
+		if (max_items) discard_expired();
 	}
 }
 
+extern void mate_set_max_items(guint n) {
+	max_items = n;
+}
+
 extern mate_pdu* mate_get_pdus(guint32 framenum) {
 
 	if (rd) {
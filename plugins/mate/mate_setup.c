@@ -65,6 +65,7 @@ extern mate_cfg_pdu* new_pducfg(gchar* name) {
 	cfg->ett_attr = -1;
 
 	cfg->criterium = NULL;
+	cfg->criterium_prog = NULL;
 	cfg->criterium_match_mode = AVPL_NO_MATCH;
 	cfg->criterium_accept_mode = ACCEPT_MODE;
 
@@ -87,6 +88,10 @@ extern mate_cfg_gop* new_gopcfg(gchar* name) {
 
 	cfg->extra = new_avpl("extra");
 
+	cfg->start_prog = NULL;
+	cfg->stop_prog = NULL;
+	cfg->gog_key_progs = g_ptr_array_new();
+
 	cfg->hfid = -1;
 
 	cfg->ett = -1;
@@ -121,6 +126,7 @@ extern mate_cfg_gog* new_gogcfg(gchar* name) {
 	cfg->transforms = NULL;
 
 	cfg->extra = new_avpl("extra");
+	cfg->key_progs = g_ptr_array_new();
 
 	cfg->my_hfids = g_hash_table_new(g_str_hash,g_str_equal);
 	cfg->hfid = -1;
@@ -173,7 +179,7 @@ extern gboolean add_hfid(header_field_info*  hfi, gchar* how, GHashTable* where)
 				return FALSE;
 			}
 		} else {
-			h = g_strdup(how);
+			h = avp_name(how);
 			g_hash_table_insert(where,ip,h);
 		}
 
@@ -309,6 +315,10 @@ static void analyze_pdu_config(mate_cfg_pdu* cfg) {
 	g_array_append_val(matecfg->ett,ett);
 
 	analyze_transform_hfrs(cfg->name,cfg->transforms,cfg->my_hfids);
+
+	if (cfg->criterium && cfg->criterium_match_mode == AVPL_STRICT) {
+		cfg->criterium_prog = new_avpl_match_prog(cfg->criterium);
+	}
 }
 
 static void analyze_gop_config(gpointer k _U_, gpointer v, gpointer p _U_) {
@@ -421,6 +431,9 @@ static void analyze_gop_config(gpointer k _U_, gpointer v, gpointer p _U_) {
 	g_array_append_val(matecfg->ett,ett);
 
 	g_hash_table_insert(matecfg->gops_by_pduname,cfg->name,cfg);
+
+	if (cfg->start) cfg->start_prog = new_avpl_match_prog(cfg->start);
+	if (cfg->stop) cfg->stop_prog = new_avpl_match_prog(cfg->stop);
 }
 
 static void analyze_gog_config(gpointer k _U_, gpointer v, gpointer p _U_) {
@@ -432,6 +445,7 @@ static void analyze_gog_config(gpointer k _U_, gpointer v, gpointer p _U_) {
 	AVPL* gopkey_avpl;
 	AVPL* key_avps;
 	LoAL* gog_keys = NULL;
+	mate_cfg_gop* gop_cfg;
 	hf_register_info hfri = { NULL, {NULL, NULL, FT_STRING, BASE_NONE, NULL, 0, NULL, HFILL}};
 	gint* ett;
 
@@ -512,6 +526,12 @@ static void analyze_gog_config(gpointer k _U_, gpointer v, gpointer p _U_) {
 		gopkey_avpl = new_avpl_from_avpl(cfg->name, avpl, TRUE);
 		loal_append(gog_keys,gopkey_avpl);
 
+		g_ptr_array_add(cfg->key_progs,new_avpl_match_prog(avpl));
+
+		if (( gop_cfg = (mate_cfg_gop *)g_hash_table_lookup(matecfg->gopcfgs,avpl->name) )) {
+			g_ptr_array_add(gop_cfg->gog_key_progs,new_avpl_match_prog(gopkey_avpl));
+		}
+
 		avp_cookie = NULL;
 		while (( avp = get_next_avp(avpl,&avp_cookie) )) {
 			if (! g_hash_table_lookup(cfg->my_hfids,avp->n))  {
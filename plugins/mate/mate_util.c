@@ -242,6 +242,11 @@ typedef union _any_avp_type {
 
 static SCS_collection* avp_strings = NULL;
 
+/* The names of the avps.  There are few of them and they are used over and
+   over, so they are never released: an avp holds the only copy of its name
+   without subscribing to it, and names can be compared by address. */
+static GHashTable* avp_names = NULL;
+
 #ifdef _AVP_DEBUGGING
 static FILE* dbg_fp = NULL;
 
@@ -294,11 +299,34 @@ extern void avp_init(void) {
 	if (avp_strings) destroy_scs_collection(avp_strings);
 	avp_strings = scs_init();
 
+	if (avp_names) g_hash_table_destroy(avp_names);
+	avp_names = g_hash_table_new(g_str_hash,g_str_equal);
+
+}
+
+/**
+ * avp_name:
+ * @param name an attribute name.
+ *
+ * Interns an attribute name.
+ *
+ * Return value: the one copy of the name that all the avps having it share.
+ *
+ **/
+extern gchar* avp_name(const gchar* name) {
+	gchar* n = (gchar *)g_hash_table_lookup(avp_names,name);
+
+	if (! n) {
+		n = g_strdup(name);
+		g_hash_table_insert(avp_names,n,n);
+	}
+
+	return n;
 }
 
 /**
  * new_avp_from_finfo:
- * @param name the name the avp will have.
+ * @param name the name the avp will have, as returned by avp_name().
  * @param finfo the field_info from which to fetch the data.
  *
  * Creates an avp from a field_info record.
@@ -311,12 +339,13 @@ extern AVP* new_avp_from_finfo(const gchar* name, field_info* finfo) {
 	gchar* value;
 	gchar* repr;
 
-	new_avp_val->n = scs_subscribe(avp_strings, name);
+	new_avp_val->n = (gchar *)name;
 
 	repr = fvalue_to_string_repr(&finfo->value,FTREPR_DISPLAY,NULL);
 
 	if (repr) {
 		value = scs_subscribe(avp_strings, repr);
+		g_free(repr);
 #ifdef _AVP_DEBUGGING
 		dbg_print (dbg_avp,2,dbg_fp,"new_avp_from_finfo: from string: %s",value);
 #endif
@@ -353,7 +382,7 @@ extern AVP* new_avp_from_finfo(const gchar* name, field_info* finfo) {
 extern AVP* new_avp(const gchar* name, const gchar* value, gchar o) {
 	AVP* new_avp_val = (AVP*)g_slice_new(any_avp_type);
 
-	new_avp_val->n = scs_subscribe(avp_strings, name);
+	new_avp_val->n = avp_name(name);
 	new_avp_val->v = scs_subscribe(avp_strings, value);
 	new_avp_val->o = o;
 
@@ -376,7 +405,6 @@ extern void delete_avp(AVP* avp) {
 	dbg_print(dbg_avp,1,dbg_fp,"delete_avp: %X %s%c%s;",(guint32) avp,avp->n,avp->o,avp->v);
 #endif
 
-	scs_unsubscribe(avp_strings, avp->n);
 	scs_unsubscribe(avp_strings, avp->v);
 	g_slice_free(any_avp_type,(any_avp_type*)avp);
 }
@@ -394,7 +422,7 @@ extern void delete_avp(AVP* avp) {
 extern AVP* avp_copy(AVP* from) {
 	AVP* new_avp_val = (AVP*)g_slice_new(any_avp_type);
 
-	new_avp_val->n = scs_subscribe(avp_strings, from->n);
+	new_avp_val->n = from->n;
 	new_avp_val->v = scs_subscribe(avp_strings, from->v);
 	new_avp_val->o = from->o;
 
@@ -522,7 +550,7 @@ extern AVP* get_avp_by_name(AVPL* avpl, gchar* name, void** cookie) {
 	dbg_print(dbg_avpl_op,7,dbg_fp,"get_avp_by_name: entering: %X %s %X",avpl,name,*cookie);
 #endif
 
-	name = scs_subscribe(avp_strings, name);
+	name = (gchar *)g_hash_table_lookup(avp_names, name);
 
 	if (!start) start = avpl->null.next;
 
@@ -538,8 +566,6 @@ extern AVP* get_avp_by_name(AVPL* avpl, gchar* name, void** cookie) {
 	dbg_print(dbg_avpl_op,5,dbg_fp,"get_avp_by_name: got avp: %X",curr);
 #endif
 
-	scs_unsubscribe(avp_strings, name);
-
 	return curr->avp;
 }
 
@@ -561,7 +587,7 @@ extern AVP* extract_avp_by_name(AVPL* avpl, gchar* name) {
 	dbg_print(dbg_avpl_op,7,dbg_fp,"extract_avp_by_name: entering: %X %s",avpl,name);
 #endif
 
-	name = scs_subscribe(avp_strings, name);
+	name = (gchar *)g_hash_table_lookup(avp_names, name);
 
 	for ( curr = avpl->null.next; curr->avp; curr = curr->next ) {
 		if ( curr->avp->n == name ) {
@@ -569,8 +595,6 @@ extern AVP* extract_avp_by_name(AVPL* avpl, gchar* name) {
 		}
 	}
 
-	scs_unsubscribe(avp_strings, name);
-
 	if( ! curr->avp ) return NULL;
 
 	curr->next->prev = curr->prev;
@@ -731,6 +755,15 @@ extern AVP* get_next_avp(AVPL* avpl, void** cookie) {
 	return node->avp;
 }
 
+/* appends " name<op>value;" to s, as avpl_to_str() does for every avp */
+static void append_avp_str(GString* s, AVP* avp) {
+	g_string_append_c(s,' ');
+	g_string_append(s,avp->n);
+	g_string_append_c(s,avp->o);
+	g_string_append(s,avp->v);
+	g_string_append_c(s,';');
+}
+
 /**
  * avpl_to_str:
  * @param avpl the avpl to represent.
@@ -743,13 +776,10 @@ extern AVP* get_next_avp(AVPL* avpl, void** cookie) {
 gchar* avpl_to_str(AVPL* avpl) {
 	AVPN* c;
 	GString* s = g_string_new("");
-	gchar* avp_s;
 	gchar* r;
 
 	for(c=avpl->null.next; c->avp; c = c->next) {
-		avp_s = avp_to_str(c->avp);
-		g_string_append_printf(s," %s;",avp_s);
-		g_free(avp_s);
+		append_avp_str(s,c->avp);
 	}
 
 	r = s->str;
@@ -1252,6 +1282,158 @@ extern AVPL* new_avpl_from_match(avpl_match_mode mode, const gchar* name,AVPL* s
 	return avpl;
 }
 
+/**
+ * new_avpl_match_prog:
+ * @param op the "op" avpl to be compiled.
+ *
+ * Compiles an "op" avpl that is going to be matched over and over: the
+ * values of its operators are split or converted once, here, rather than
+ * on every match as match_avp() does.  The op avpl must outlive the
+ * program.
+ *
+ * Return value: a pointer to the newly created program.
+ **/
+extern AVPL_Match_Prog* new_avpl_match_prog(AVPL* op) {
+	AVPL_Match_Prog* prog = (AVPL_Match_Prog *)g_malloc(sizeof(AVPL_Match_Prog));
+	AVPL_Match_Op* mop;
+	AVPN* co;
+
+	prog->avpl = op;
+	prog->len = op->len;
+	prog->ops = g_new0(AVPL_Match_Op, op->len);
+
+	for (co = op->null.next, mop = prog->ops; co->avp; co = co->next, mop++) {
+		mop->avp = co->avp;
+
+		switch (co->avp->o) {
+			case AVP_OP_ONEOFF:
+				mop->alternatives = g_strsplit(co->avp->v,"|",0);
+				break;
+			case AVP_OP_LOWER:
+			case AVP_OP_HIGHER:
+				mop->value = (float) g_ascii_strtod(co->avp->v, NULL);
+				break;
+			default:
+				mop->value_len = strlen(co->avp->v);
+				break;
+		}
+	}
+
+	return prog;
+}
+
+/* the same as match_avp(src,mop->avp), given that the names are equal */
+static gboolean match_avp_op(AVP* src, AVPL_Match_Op* mop) {
+	gchar** alt;
+	gsize ls;
+	float fs;
+
+	switch (mop->avp->o) {
+		case AVP_OP_EXISTS:
+			return TRUE;
+		case AVP_OP_EQUAL:
+			return src->v == mop->avp->v;
+		case AVP_OP_NOTEQUAL:
+			return src->v != mop->avp->v;
+		case AVP_OP_STARTS:
+			return strncmp(src->v,mop->avp->v,mop->value_len) == 0;
+		case AVP_OP_ONEOFF:
+			for (alt = mop->alternatives; alt && *alt; alt++) {
+				if (g_str_equal(*alt,src->v)) return TRUE;
+			}
+			return FALSE;
+		case AVP_OP_LOWER:
+			fs = (float) g_ascii_strtod(src->v, NULL);
+			return fs < mop->value;
+		case AVP_OP_HIGHER:
+			fs = (float) g_ascii_strtod(src->v, NULL);
+			return fs > mop->value;
+		case AVP_OP_ENDS:
+			ls = strlen(src->v);
+			return ls >= mop->value_len && g_str_equal(src->v + (ls - mop->value_len),mop->avp->v);
+		default:
+			return FALSE;
+	}
+}
+
+/* walks src as new_avpl_exact_match() does, appending the matching avps
+   of src to s if it is given */
+static gboolean prog_exact_match(AVPL_Match_Prog* prog, AVPL* src, GString* s) {
+	AVPN* cs;
+	AVPL_Match_Op* mop;
+	guint i = 0;
+	ptrdiff_t c;
+
+	if (prog->len == 0)
+		return TRUE;
+
+	if (src->len == 0)
+		return FALSE;
+
+	cs = src->null.next;
+	while(1) {
+		mop = &prog->ops[i];
+
+		c = ADDRDIFF(mop->avp->n,cs->avp->n);
+
+		if ( c > 0 ) {
+			return FALSE;
+		} else if (c < 0) {
+			cs = cs->next;
+			if (! cs->avp ) {
+				return FALSE;
+			}
+		} else {
+			if (! match_avp_op(cs->avp,mop)) {
+				return FALSE;
+			}
+
+			if (s) append_avp_str(s,cs->avp);
+
+			cs = cs->next;
+
+			if (++i == prog->len) {
+				return TRUE;
+			}
+			if (!cs->avp) {
+				return FALSE;
+			}
+		}
+	}
+}
+
+/**
+ * avpl_prog_exact_match:
+ * @param prog the compiled "op" avpl
+ * @param src avpl to be matched against it
+ *
+ * Return value: whether new_avpl_exact_match() would return an avpl for
+ *               src and prog's avpl; but no avpl gets created.
+ **/
+extern gboolean avpl_prog_exact_match(AVPL_Match_Prog* prog, AVPL* src) {
+	return prog_exact_match(prog,src,NULL);
+}
+
+/**
+ * avpl_prog_exact_match_str:
+ * @param prog the compiled "op" avpl
+ * @param src avpl to be matched against it
+ *
+ * Return value: a newly allocated string equal to the avpl_to_str() of the
+ *               avpl new_avpl_exact_match() would return for src and prog's
+ *               avpl, or NULL if it wouldn't return one.
+ **/
+extern gchar* avpl_prog_exact_match_str(AVPL_Match_Prog* prog, AVPL* src) {
+	GString* s = g_string_new("");
+
+	if (prog_exact_match(prog,src,s)) {
+		return g_string_free(s,FALSE);
+	}
+
+	g_string_free(s,TRUE);
+	return NULL;
+}
+
 /**
  * delete_avpl_transform:
  * @param op a pointer to the avpl transformation object
@@ -120,6 +120,20 @@ struct _avpl_transf {
 	AVPL_Transf* next;
 };
 
+/* an "op" avpl compiled to be matched over and over */
+typedef struct _avpl_match_op {
+	AVP* avp;
+	gchar** alternatives; /* the values of an AVP_OP_ONEOFF */
+	gsize value_len; /* the length of the value */
+	float value; /* the value of an AVP_OP_LOWER or AVP_OP_HIGHER */
+} AVPL_Match_Op;
+
+typedef struct _avpl_match_prog {
+	AVPL* avpl; /* the avpl it has been compiled from */
+	guint len;
+	AVPL_Match_Op* ops; /* one for every avp, in the order of the avpl */
+} AVPL_Match_Prog;
+
 /* loalnodes are used in LoALs */
 typedef struct _loal_node {
 	AVPL* avpl;
@@ -144,6 +158,9 @@ extern void avp_init(void);
 extern void setup_avp_debug(FILE* fp, int* general, int* avp, int* avp_op, int* avpl, int* avpl_op);
 #endif /* _AVP_DEBUGGING */
 
+/* returns the interned copy of an attribute name, the one avps point to */
+extern gchar* avp_name(const gchar* name);
+
 /*
  * avp constructors
  */
@@ -154,7 +171,7 @@ extern AVP* new_avp(const gchar* name, const gchar* value, gchar op);
 /* creates a copy od an avp */
 extern AVP* avp_copy(AVP* from);
 
-/* creates an avp from a field_info record */
+/* creates an avp from a field_info record, name must come from avp_name() */
 extern AVP* new_avp_from_finfo(const gchar* name, field_info* finfo);
 
 /*
@@ -199,6 +216,18 @@ extern AVPL* new_avpl_exact_match(const gchar* name,AVPL* src, AVPL* op, gboolea
 extern AVPL* new_avpl_from_match(avpl_match_mode mode, const gchar* name,AVPL* src, AVPL* op, gboolean copy_avps);
 
 
+/* compiles an "op" avpl, which must outlive the program; like the rest of
+ * the configuration, programs are never freed */
+extern AVPL_Match_Prog* new_avpl_match_prog(AVPL* op);
+
+/* whether new_avpl_exact_match() would create a list, without creating it */
+extern gboolean avpl_prog_exact_match(AVPL_Match_Prog* prog, AVPL* src);
+
+/* returns a newly allocated string with the representation of the list
+   new_avpl_exact_match() would create, or NULL if it wouldn't create one */
+extern gchar* avpl_prog_exact_match_str(AVPL_Match_Prog* prog, AVPL* src);
+
+
 /*
  * functions on avpls
  */
@@ -40,6 +40,7 @@ static int proto_mate = -1;
 
 static const gchar* pref_mate_config_filename = "";
 static const gchar* current_mate_config_filename = NULL;
+static guint pref_mate_max_items = 0;
 
 static proto_item *mate_i = NULL;
 
@@ -307,6 +308,8 @@ proto_reg_handoff_mate(void)
 {
 	GString* tap_error = NULL;
 
+	mate_set_max_items(pref_mate_max_items);
+
 	if ( *pref_mate_config_filename != '\0' ) {
 
 		if (current_mate_config_filename) {
@@ -361,6 +364,13 @@ proto_register_mate(void)
 					   "Configuration Filename",
 					   "The name of the file containing the mate module's configuration",
 					   &pref_mate_config_filename);
+	prefs_register_uint_preference(mate_module, "max_items",
+					   "Maximum number of items",
+					   "When more PDUs, GOPs and GOGs than this are being kept, "
+					   "released GOGs and GOPs that have expired are discarded "
+					   "along with their PDUs, oldest first, and their frames "
+					   "won't show them anymore. 0 means no limit",
+					   10, &pref_mate_max_items);
 
 	mate_handle = find_dissector("mate");
 	register_postdissector(mate_handle);
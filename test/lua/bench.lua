@@ -0,0 +1,114 @@
+-- Post-dissector exercising the wslua calls that are usually on a Lua
+-- dissector's hot path, to measure their cost; run by wslua-bench.sh.
+--
+-- The first script argument selects what to do for each packet:
+--   none    nothing, to measure the cost of having a post-dissector at all
+--   call    get fields with Field() and read their FieldInfo values
+--   values  get the same values with Field:value() and Field:values()
+--   range   make TvbRanges and read numbers and bytes from them
+-- The second is how many times to repeat that for each packet (default 1).
+-- If the third is "check", the results of each repeat are also checked
+-- against the first, as the FieldInfos and TvbRanges are reused, and
+-- "All tests passed!" is printed at the end if they all matched; the
+-- wslua test suite runs it that way.
+
+local arg = { ... }
+local mode = arg[1] or "call"
+local repeats = tonumber(arg[2]) or 1
+local check = (arg[3] == "check")
+
+local f_frame_len = Field.new("frame.len")
+local f_eth_type  = Field.new("eth.type")
+local f_ip_src    = Field.new("ip.src")
+local f_ip_proto  = Field.new("ip.proto")
+local f_ip_ttl    = Field.new("ip.ttl")
+
+local bench = Proto("wslua_bench", "wslua benchmark")
+
+local work = {
+    none = function(tvb)
+        return ""
+    end,
+
+    call = function(tvb)
+        local len = f_frame_len()()
+        local eth_type, src, proto, ttl
+        local fi = f_eth_type()
+        if fi then eth_type = fi() end
+        fi = f_ip_src()
+        if fi then
+            src = fi()
+            proto = f_ip_proto()()
+            ttl = f_ip_ttl()()
+        end
+        return tostring(len) .. " " .. tostring(eth_type) .. " " ..
+            tostring(src) .. " " .. tostring(proto) .. " " .. tostring(ttl)
+    end,
+
+    values = function(tvb)
+        local len = f_frame_len:value()
+        local eth_type = f_eth_type:value()
+        local src = f_ip_src:value()
+        local proto, ttl
+        if src then
+            proto = f_ip_proto:value()
+            ttl = f_ip_ttl:value()
+        end
+        return tostring(len) .. " " .. tostring(eth_type) .. " " ..
+            tostring(src) .. " " .. tostring(proto) .. " " .. tostring(ttl)
+    end,
+
+    range = function(tvb)
+        local len = tvb:len()
+        if len >= 14 then
+            local hdr = tvb(0, 14)
+            local eth_type = tvb(12, 2):uint()
+            local dst = tvb(0, 6):bytes()
+            local src = hdr:range(6, 6):bytes()
+            -- hdr must still be the same range after the others were made
+            return tostring(dst) .. " " .. tostring(src) .. " " ..
+                eth_type .. " " .. tostring(hdr:bytes())
+        end
+        return tostring(len)
+    end,
+}
+
+local fn = work[mode]
+if not fn then
+    error("unknown benchmark mode " .. tostring(mode))
+end
+
+local packets = 0
+local mismatches = 0
+
+function bench.dissector(tvb, pinfo, tree)
+    if check then
+        local first = fn(tvb)
+        for i = 2, repeats do
+            if fn(tvb) ~= first then
+                print("Frame " .. pinfo.number .. ": repeat " .. i ..
+                      " of " .. mode .. " got a different result")
+                mismatches = mismatches + 1
+            end
+        end
+        packets = packets + 1
+        return
+    end
+    for i = 1, repeats do
+        fn(tvb)
+    end
+end
+
+register_postdissector(bench)
+
+if check then
+    local tap = Listener.new("frame")
+
+    function tap.draw()
+        if packets > 0 and mismatches == 0 then
+            print("All tests passed!\n\n")
+        else
+            print(packets .. " packets, " .. mismatches .. " mismatches")
+        end
+    end
+end
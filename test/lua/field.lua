@@ -130,6 +130,20 @@ function tap.packet(pinfo,tvb)
     test("FieldInfo.len-1", fi_eth_src.len == 6)
     test("FieldInfo.len-2",not pcall(setFieldInfo,fi_eth_src,"len",6))
 
+    testing("Field values")
+
+    -- the same FieldInfos are handed out again within a packet
+    test("Field__call-3", rawequal(f_eth_src(), f_eth_src()))
+    test("Field__call-4", rawequal(select(2, f_eth_mac()), eth_macs[2]))
+
+    test("Field.value-1", f_udp_srcport:value() == f_udp_srcport()())
+    test("Field.value-2", f_udp_dstport:value() == 67 or f_udp_dstport:value() == 68)
+    test("Field.value-3", tostring(f_eth_src:value()) == tostring(f_eth_src()()))
+
+    local eth_mac_values = { f_eth_mac:values() }
+    test("Field.values-1", #eth_mac_values == #eth_macs)
+    test("Field.values-2", tostring(eth_mac_values[2]) == tostring(eth_macs[2]()))
+
     if packet_count == 4 then
         print("\n-----------------------------\n")
         print("All tests passed!\n\n")
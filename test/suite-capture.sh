@@ -254,6 +254,41 @@ capture_step_stdin() {
 	fi
 }
 
+# Capture via stdin with TShark, getting the packets from dumpcap in
+# shared memory.  TShark dissects the Ethernet packets of dhcp.pcap
+# straight out of shared memory, while the 802.11 packets of
+# wpa-Induction.pcap make it stop using it at the first packet and read
+# them from the capture file instead.  Either way every packet must be
+# dissected exactly once.
+capture_step_shm_handoff() {
+	if [ "$WS_SYSTEM" == "Windows" ] ; then
+		test_step_skipped
+		return
+	fi
+
+	for CAPTURE in dhcp.pcap wpa-Induction.pcap.gz ; do
+		EXPECTED=`$TSHARK -n -r "${CAPTURE_DIR}$CAPTURE" | wc -l`
+		gzip -dcf "${CAPTURE_DIR}$CAPTURE" | \
+		$TSHARK -n -i - --shm-handoff \
+			-a duration:$TRAFFIC_CAPTURE_DURATION \
+			> ./testout.txt 2> ./testerr.txt
+		RETURNVALUE=$?
+		if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+			capture_test_output_print ./testout.txt ./testerr.txt
+			test_step_failed "Exit status of $TSHARK capturing $CAPTURE: $RETURNVALUE"
+			return
+		fi
+
+		GOT=`wc -l < ./testout.txt`
+		if [ $GOT -ne $EXPECTED ]; then
+			capture_test_output_print ./testout.txt ./testerr.txt
+			test_step_failed "Dissected $GOT packets of $CAPTURE, expected $EXPECTED"
+			return
+		fi
+	done
+	test_step_ok
+}
+
 # capture exactly 2 times 10 packets (multiple files)
 capture_step_2multi_10packets() {
 	if [ $SKIP_CAPTURE -ne 0 ] ; then
@@ -449,6 +484,7 @@ tshark_capture_suite() {
 		test_step_add "Capture via fifo" capture_step_fifo
 	fi
 	test_step_add "Capture via stdin" capture_step_stdin
+	test_step_add "Capture via stdin in shared memory" capture_step_shm_handoff
 	# tshark now using dumpcap for capturing, read filters won't work by definition
 	#test_step_add "Capture read filter (${TRAFFIC_CAPTURE_DURATION}s)" capture_step_read_filter
 	test_step_add "Capture snapshot length 68 bytes (${TRAFFIC_CAPTURE_DURATION}s)" capture_step_snapshot
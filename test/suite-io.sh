@@ -142,6 +142,32 @@ io_step_rawshark_pcap_stdin() {
 	test_step_ok
 }
 
+# Read a compressed pcap with more records than fit in one batch, as a
+# file and from a pipe; both must give the same packets
+io_step_tshark_pcap_pipe() {
+	$TSHARK -n -r "${CAPTURE_DIR}wpa-Induction.pcap.gz" > ./testout.txt 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		cat ./testout.txt
+		test_step_failed "exit status of $TSHARK reading the file: $RETURNVALUE"
+		return
+	fi
+	gzip -dc "${CAPTURE_DIR}wpa-Induction.pcap.gz" | $TSHARK -n -r - > ./testout2.txt 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		cat ./testout2.txt
+		test_step_failed "exit status of $TSHARK reading the pipe: $RETURNVALUE"
+		return
+	fi
+	diff -u ./testout.txt ./testout2.txt > $DIFF_OUT 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Reading the capture from a pipe gave different packets"
+		cat $DIFF_OUT
+		return
+	fi
+	test_step_ok
+}
 
 wireshark_gtk_io_suite() {
 	# Q: quit after cap, k: start capture immediately
@@ -153,6 +179,7 @@ tshark_io_suite() {
 	DUT=$TSHARK
 	test_step_add "Input file" io_step_input_file
 	test_step_add "Output piping" io_step_output_piping
+	test_step_add "Compressed file and pipe input" io_step_tshark_pcap_pipe
 	#test_step_add "Piping" io_step_input_piping
 }
 
@@ -77,6 +77,12 @@ unittests_step_exntest() {
 	unittests_step_test
 }
 
+unittests_step_frame_index_test() {
+	set_dut ../wiretap/frame_index_test
+	ARGS=
+	unittests_step_test
+}
+
 unittests_step_oids_test() {
 	set_dut oids_test
 	ARGS=
@@ -89,6 +95,12 @@ unittests_step_reassemble_test() {
 	unittests_step_test
 }
 
+unittests_step_tap_merge_test() {
+	set_dut tap_merge_test
+	ARGS=
+	unittests_step_test
+}
+
 unittests_step_tvbtest() {
 	set_dut tvbtest
 	ARGS=
@@ -109,8 +121,10 @@ unittests_suite() {
 	test_step_set_pre unittests_cleanup_step
 	test_step_set_post unittests_cleanup_step
 	test_step_add "exntest" unittests_step_exntest
+	test_step_add "frame_index_test" unittests_step_frame_index_test
 	test_step_add "oids_test" unittests_step_oids_test
 	test_step_add "reassemble_test" unittests_step_reassemble_test
+	test_step_add "tap_merge_test" unittests_step_tap_merge_test
 	test_step_add "tvbtest" unittests_step_tvbtest
 	test_step_add "wmem_test" unittests_step_wmem_test
 }
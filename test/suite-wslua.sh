@@ -20,6 +20,28 @@
 # Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #
 
+wslua_step_bench_test() {
+	if [ $HAVE_LUA -ne 0 ]; then
+		test_step_skipped
+		return
+	fi
+
+	# Run each mode of the benchmark script, repeating its work and
+	# checking that the reused FieldInfos and TvbRanges give the same
+	# results every time.
+	for MODE in none call values range ; do
+		$TSHARK -r $CAPTURE_DIR/dhcp.pcap -q -Y frame \
+			-X lua_script:$TESTS_DIR/lua/bench.lua \
+			-X lua_script1:$MODE -X lua_script1:3 -X lua_script1:check > testout.txt 2>&1
+		if ! grep -q "All tests passed!" testout.txt; then
+			cat testout.txt
+			test_step_failed "didn't find pass marker for mode $MODE"
+			return
+		fi
+	done
+	test_step_ok
+}
+
 wslua_step_dir_test() {
 	if [ $HAVE_LUA -ne 0 ]; then
 		test_step_skipped
@@ -396,6 +418,7 @@ wslua_cleanup_step() {
 wslua_suite() {
 	test_step_set_pre wslua_cleanup_step
 	test_step_set_post wslua_cleanup_step
+	test_step_add "wslua benchmark script" wslua_step_bench_test
 	test_step_add "wslua dir" wslua_step_dir_test
 	test_step_add "wslua dissector" wslua_step_dissector_test
 	test_step_add "wslua field/fieldinfo" wslua_step_field_test
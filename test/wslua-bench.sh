@@ -0,0 +1,95 @@
+#!/bin/bash
+
+# Measure how much Lua post-dissectors slow TShark down: time reading a
+# capture file without Lua, and with lua/bench.lua in each of its modes,
+# and print the average wall-clock time of each in milliseconds along
+# with the overhead relative to the run without Lua.
+#
+# Wireshark - Network traffic analyzer
+# By Gerald Combs <gerald@wireshark.org>
+# Copyright 1998 Gerald Combs
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+# Directory containing binaries.  Default current directory.
+BIN_DIR=.
+# Number of times to run each command
+RUNS=5
+# Number of times bench.lua repeats its work for each packet
+REPEATS=10
+# Capture file to read; use a big one for meaningful numbers
+CAPTURE_FILE=`dirname $0`/captures/dhcp.pcap
+SCRIPT=`dirname $0`/lua/bench.lua
+
+while getopts ":b:n:r:x:" OPTCHAR ; do
+    case $OPTCHAR in
+        b) BIN_DIR=$OPTARG ;;
+        n) RUNS=$OPTARG ;;
+        r) CAPTURE_FILE=$OPTARG ;;
+        x) REPEATS=$OPTARG ;;
+        *) printf "Usage: $(basename $0) [-b bin_dir] [-n runs] [-r capture_file] [-x repeats]\n"
+           exit 1 ;;
+    esac
+done
+shift $(($OPTIND - 1))
+
+TSHARK="$BIN_DIR/tshark"
+if [ ! -x "$TSHARK" ]; then
+    echo "Couldn't find \"$TSHARK\""
+    exit 1
+fi
+if [ "$BIN_DIR" = "." ]; then
+    export WIRESHARK_RUN_FROM_BUILD_DIRECTORY=1
+fi
+if ! $TSHARK -v 2>&1 | grep -q "with Lua" ; then
+    echo "$TSHARK wasn't built with Lua"
+    exit 1
+fi
+
+# Don't let personal preferences or plugins skew the results
+export WIRESHARK_CONFIG_DIR=`mktemp -d ${TMPDIR:-/tmp}/wslua-bench.XXXXXX` || exit 1
+trap "rm -rf $WIRESHARK_CONFIG_DIR" EXIT
+
+# Print the average time, in milliseconds, that "$@" takes to run
+function average_ms() {
+    local total=0
+    local i start end
+
+    # Warm up the file system cache first
+    "$@" > /dev/null 2>&1
+    for (( i = 0; i < RUNS; i++ )) ; do
+        start=`date +%s%N`
+        "$@" > /dev/null 2>&1
+        end=`date +%s%N`
+        total=$(( total + (end - start) / 1000000 ))
+    done
+    echo $(( total / RUNS ))
+}
+
+# Lua field extractors need a protocol tree, so make sure there's one in
+# every run with a display filter that matches every packet.
+BASE=`average_ms $TSHARK -r $CAPTURE_FILE -q -Y frame`
+printf "%-12s %10s %10s\n" "Mode" "time (ms)" "overhead"
+printf "%-12s %10s %10s\n" "no Lua" $BASE "-"
+for MODE in none call values range ; do
+    TIME=`average_ms $TSHARK -r $CAPTURE_FILE -q -Y frame \
+        -X lua_script:$SCRIPT -X lua_script1:$MODE -X lua_script1:$REPEATS`
+    if [ $BASE -gt 0 ] ; then
+        OVERHEAD="$(( (TIME - BASE) * 100 / BASE ))%"
+    else
+        OVERHEAD="-"
+    fi
+    printf "%-12s %10s %10s\n" $MODE $TIME $OVERHEAD
+done
@@ -0,0 +1,94 @@
+#!/bin/bash
+
+# Measure how long TShark takes to start up, so that we can keep track
+# of it from release to release: time "tshark -v" and reading a tiny
+# capture file, with and without a field snapshot (--field-snapshot),
+# and print the average wall-clock time of each in milliseconds.  With
+# -o, the results are also appended to a CSV file, one line per command,
+# labelled with the version of TShark.
+#
+# Wireshark - Network traffic analyzer
+# By Gerald Combs <gerald@wireshark.org>
+# Copyright 1998 Gerald Combs
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+# Directory containing binaries.  Default current directory.
+BIN_DIR=.
+# Number of times to run each command
+RUNS=10
+# Capture file to read
+CAPTURE_FILE=`dirname $0`/../test/captures/dhcp.pcap
+# CSV file to append the results to
+RESULTS_FILE=
+
+while getopts ":b:n:o:r:" OPTCHAR ; do
+    case $OPTCHAR in
+        b) BIN_DIR=$OPTARG ;;
+        n) RUNS=$OPTARG ;;
+        o) RESULTS_FILE=$OPTARG ;;
+        r) CAPTURE_FILE=$OPTARG ;;
+        *) printf "Usage: $(basename $0) [-b bin_dir] [-n runs] [-o results.csv] [-r capture_file]\n"
+           exit 1 ;;
+    esac
+done
+shift $(($OPTIND - 1))
+
+TSHARK="$BIN_DIR/tshark"
+if [ ! -x "$TSHARK" ]; then
+    echo "Couldn't find \"$TSHARK\""
+    exit 1
+fi
+if [ "$BIN_DIR" = "." ]; then
+    export WIRESHARK_RUN_FROM_BUILD_DIRECTORY=1
+fi
+
+# Don't let personal preferences or plugins skew the results
+export WIRESHARK_CONFIG_DIR=`mktemp -d ${TMPDIR:-/tmp}/startup-time.XXXXXX` || exit 1
+trap "rm -rf $WIRESHARK_CONFIG_DIR" EXIT
+
+# Print the average time, in milliseconds, that "$@" takes to run
+function average_ms() {
+    local total=0
+    local i start end
+
+    # Warm up the file system cache first
+    "$@" > /dev/null 2>&1
+    for (( i = 0; i < RUNS; i++ )) ; do
+        start=`date +%s%N`
+        "$@" > /dev/null 2>&1
+        end=`date +%s%N`
+        total=$(( total + (end - start) / 1000000 ))
+    done
+    echo $(( total / RUNS ))
+}
+
+SNAPSHOT=$WIRESHARK_CONFIG_DIR/field_snapshot
+VERSION=`$TSHARK -v 2>/dev/null | head -1`
+
+echo "$VERSION"
+printf "%-40s %12s %14s\n" "Command" "default (ms)" "snapshot (ms)"
+for CMD in "-v" "-r $CAPTURE_FILE" "-r $CAPTURE_FILE -Y bootp.type" ; do
+    DEFAULT=`average_ms $TSHARK $CMD`
+    # The first run writes the snapshot; average_ms discards it
+    SNAP=`average_ms $TSHARK --field-snapshot $SNAPSHOT $CMD`
+    printf "%-40s %12s %14s\n" "tshark $CMD" $DEFAULT $SNAP
+    if [ -n "$RESULTS_FILE" ]; then
+        if [ ! -s "$RESULTS_FILE" ]; then
+            echo "version,command,default_ms,snapshot_ms" > "$RESULTS_FILE"
+        fi
+        echo "\"$VERSION\",\"tshark ${CMD//$CAPTURE_FILE/<capture>}\",$DEFAULT,$SNAP" >> "$RESULTS_FILE"
+    fi
+done
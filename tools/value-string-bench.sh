@@ -0,0 +1,65 @@
+#!/bin/bash
+
+# Measure how much the lookup indexes that libwireshark builds for the
+# value_strings and range_strings of fields speed up looking up the
+# names of their values: run epan/value_string_bench, which looks up
+# every value in the tables of the fields of each protocol given, both
+# by searching the table from the start and with the table's index, and
+# prints how long each took in milliseconds.
+#
+# The default protocols are GSM MAP, IEEE 802.11 and Diameter, which
+# have the largest tables.
+#
+# Wireshark - Network traffic analyzer
+# By Gerald Combs <gerald@wireshark.org>
+# Copyright 1998 Gerald Combs
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+# Directory containing binaries.  Default current directory.
+BIN_DIR=.
+# Number of times to look up each value
+ROUNDS=200
+
+while getopts ":b:n:" OPTCHAR ; do
+    case $OPTCHAR in
+        b) BIN_DIR=$OPTARG ;;
+        n) ROUNDS=$OPTARG ;;
+        *) printf "Usage: $(basename $0) [-b bin_dir] [-n rounds] [protocol ...]\n"
+           exit 1 ;;
+    esac
+done
+shift $(($OPTIND - 1))
+
+# Out-of-tree builds put it with the other binaries, and their data
+# files (such as the Diameter dictionary) next to it; in-tree builds
+# leave it in epan
+BENCH="$BIN_DIR/value_string_bench"
+if [ -x "$BENCH" ]; then
+    export WIRESHARK_RUN_FROM_BUILD_DIRECTORY=1
+else
+    BENCH="$BIN_DIR/epan/value_string_bench"
+fi
+if [ ! -x "$BENCH" ]; then
+    echo "Couldn't find value_string_bench in \"$BIN_DIR\"; build it with"
+    echo "\"make -C epan value_string_bench\""
+    exit 1
+fi
+
+# Don't let personal preferences or plugins skew the results
+export WIRESHARK_CONFIG_DIR=`mktemp -d ${TMPDIR:-/tmp}/value-string-bench.XXXXXX` || exit 1
+trap "rm -rf $WIRESHARK_CONFIG_DIR" EXIT
+
+"$BENCH" -n $ROUNDS "$@"
@@ -121,6 +121,7 @@
 #include <capchild/capture_session.h>
 #include <capchild/capture_sync.h>
 #include "capture_opts.h"
+#include "capture_shm.h"
 #endif /* HAVE_LIBPCAP */
 #include "log.h"
 #include <epan/funnel.h>
@@ -153,7 +154,8 @@ static gboolean perform_two_pass_analysis;
 typedef enum {
   WRITE_TEXT,   /* summary or detail text */
   WRITE_XML,    /* PDML or PSML */
-  WRITE_FIELDS  /* User defined list of fields */
+  WRITE_FIELDS, /* User defined list of fields */
+  WRITE_EK      /* JSON bulk insert to Elasticsearch */
   /* Add CSV and the like here */
 } output_action_e;
 
@@ -183,6 +185,23 @@ static gboolean print_packet_counts;
 static capture_options global_capture_opts;
 static capture_session global_capture_session;
 
+/*
+ * Shared-memory ring dumpcap hands us the packets in, if we asked for
+ * one with --shm-handoff, and the number of packets we've taken out
+ * of it so far, i.e. that we have to skip in the capture file once
+ * we go back to reading that.  Once the ring has been abandoned, we
+ * also count the packets dumpcap told us about before it flushed the
+ * file; we read them once it has.
+ */
+#define LONGOPT_SHM_HANDOFF MIN_NON_CAPTURE_LONGOPT
+#define LONGOPT_FIELD_SNAPSHOT (MIN_NON_CAPTURE_LONGOPT+1)
+#define LONGOPT_TAP_TIMING (MIN_NON_CAPTURE_LONGOPT+2)
+
+static gboolean         shm_handoff;
+static capture_shm_ring *shm_ring;
+static guint32          shm_ring_consumed;
+static int              shm_reads_pending;
+
 #ifdef SIGINFO
 static gboolean infodelay;      /* if TRUE, don't print capture info in SIGINFO handler */
 static gboolean infoprint;      /* if TRUE, print capture info after clearing infodelay */
@@ -322,6 +341,9 @@ print_usage(FILE *output)
   fprintf(output, "  -b <ringbuffer opt.> ... duration:NUM - switch to next file after NUM secs\n");
   fprintf(output, "                           filesize:NUM - switch to next file after NUM KB\n");
   fprintf(output, "                              files:NUM - ringbuffer: replace after NUM files\n");
+#ifndef _WIN32
+  fprintf(output, "  --shm-handoff            get captured packets from dumpcap in shared memory\n");
+#endif
 #endif  /* HAVE_LIBPCAP */
 #ifdef HAVE_PCAP_REMOTE
   fprintf(output, "RPCAP options:\n");
@@ -358,7 +380,7 @@ print_usage(FILE *output)
   fprintf(output, "  -P                       print packet summary even when writing to a file\n");
   fprintf(output, "  -S <separator>           the line separator to print between packets\n");
   fprintf(output, "  -x                       add output of hex and ASCII dump (Packet Bytes)\n");
-  fprintf(output, "  -T pdml|ps|psml|text|fields\n");
+  fprintf(output, "  -T pdml|ps|psml|text|fields|ek\n");
   fprintf(output, "                           format of text output (def: text)\n");
   fprintf(output, "  -e <field>               field to print if -Tfields selected (e.g. tcp.port,\n");
   fprintf(output, "                           _ws.col.Info)\n");
@@ -393,6 +415,8 @@ print_usage(FILE *output)
   fprintf(output, "  -G [report]              dump one of several available reports and exit\n");
   fprintf(output, "                           default report=\"fields\"\n");
   fprintf(output, "                           use \"-G ?\" for more help\n");
+  fprintf(output, "  --field-snapshot <file>  keep a snapshot of the field name table in <file>\n");
+  fprintf(output, "  --tap-timing             print the time spent in each statistics tap at exit\n");
 #ifdef __linux__
   fprintf(output, "\n");
   fprintf(output, "WARNING: dumpcap will enable kernel BPF JIT compiler if available.\n");
@@ -960,6 +984,11 @@ main(int argc, char *argv[])
   static const struct option long_options[] = {
     {(char *)"help", no_argument, NULL, 'h'},
     {(char *)"version", no_argument, NULL, 'v'},
+#if defined(HAVE_LIBPCAP) && !defined(_WIN32)
+    {(char *)"shm-handoff", no_argument, NULL, LONGOPT_SHM_HANDOFF},
+#endif
+    {(char *)"field-snapshot", required_argument, NULL, LONGOPT_FIELD_SNAPSHOT},
+    {(char *)"tap-timing", no_argument, NULL, LONGOPT_TAP_TIMING},
     LONGOPT_CAPTURE_COMMON
     {0, 0, 0, 0 }
   };
@@ -1009,7 +1038,7 @@ main(int argc, char *argv[])
   gchar               *output_only = NULL;
 
 /* the leading - ensures that getopt() does not permute the argv[] entries
-   we have to make sure that the first getopt() preserves the content of argv[]
+   we have to make sure that the first getopt_long() preserves the content of argv[]
    for the subsequent getopt_long() call */
 #define OPTSTRING "-2" OPTSTRING_CAPTURE_COMMON "C:d:e:E:F:gG:hH:" "K:lnN:o:O:PqQr:R:S:t:T:u:vVw:W:xX:Y:z:"
 
@@ -1080,7 +1109,7 @@ main(int argc, char *argv[])
   opterr = 0;
   optind_initial = optind;
 
-  while ((opt = getopt(argc, argv, optstring)) != -1) {
+  while ((opt = getopt_long(argc, argv, optstring, long_options, NULL)) != -1) {
     switch (opt) {
     case 'C':        /* Configuration Profile */
       if (profile_exists (optarg, FALSE)) {
@@ -1111,6 +1140,9 @@ main(int argc, char *argv[])
     case 'X':
       ex_opt_add(optarg);
       break;
+    case LONGOPT_FIELD_SNAPSHOT:
+      proto_set_field_snapshot(optarg);
+      break;
     default:
       break;
     }
@@ -1368,10 +1400,21 @@ main(int argc, char *argv[])
     case 'C':
       /* Configuration profile settings were already processed just ignore them this time*/
       break;
+    case LONGOPT_FIELD_SNAPSHOT:
+      /* Already processed; ignore it this time */
+      break;
+    case LONGOPT_TAP_TIMING: /* Time the statistics taps */
+      tap_set_timing(TRUE);
+      break;
     case 'd':        /* Decode as rule */
       if (!add_decode_as(optarg))
         return 1;
       break;
+#if defined(HAVE_LIBPCAP) && !defined(_WIN32)
+    case LONGOPT_SHM_HANDOFF: /* Get captured packets in shared memory */
+      shm_handoff = TRUE;
+      break;
+#endif
 #if defined(HAVE_HEIMDAL_KERBEROS) || defined(HAVE_MIT_KERBEROS)
     case 'K':        /* Kerberos keytab file */
       read_keytab_file(optarg);
@@ -1580,9 +1623,15 @@ main(int argc, char *argv[])
         output_action = WRITE_FIELDS;
         print_details = TRUE;   /* Need full tree info */
         print_summary = FALSE;  /* Don't allow summary */
+      } else if (strcmp(optarg, "ek") == 0) {
+        output_action = WRITE_EK;
+        print_details = TRUE;   /* Need details */
+        print_summary = FALSE;  /* Don't allow summary */
       } else {
         cmdarg_err("Invalid -T parameter \"%s\"; it must be one of:", optarg);                   /* x */
-        cmdarg_err_cont("\t\"fields\" The values of fields specified with the -e option, in a form\n"
+        cmdarg_err_cont("\t\"ek\"     Newline delimited JSON format for bulk import into\n"
+                        "\t         Elasticsearch.\n"
+                        "\t\"fields\" The values of fields specified with the -e option, in a form\n"
                         "\t         specified by the -E option.\n"
                         "\t\"pdml\"   Packet Details Markup Language, an XML-based format for the\n"
                         "\t         details of a decoded packet. This information is equivalent to\n"
@@ -2247,6 +2296,7 @@ main(int argc, char *argv[])
 
   draw_tap_listeners(TRUE);
   funnel_dump_all_text_windows();
+  tap_print_timing(stderr);
   epan_free(cfile.epan);
   epan_cleanup();
 
@@ -2497,6 +2547,21 @@ capture(void)
   fflush(stderr);
   g_string_free(str, TRUE);
 
+  /* The ring only works if all the packets go to the one file we're
+     reading, and there's no point in it if we're not dissecting them. */
+  if (shm_handoff && do_dissection && !global_capture_opts.multi_files_on) {
+    int shm_err;
+
+    shm_ring = capture_shm_create(&global_capture_opts.shm_ring_file,
+                                  CAPTURE_SHM_DEFAULT_SIZE, &shm_err);
+    if (shm_ring == NULL) {
+      cmdarg_err("Can't create the shared-memory ring: %s; reading the capture file instead.",
+                 g_strerror(shm_err));
+    }
+    shm_ring_consumed = 0;
+    shm_reads_pending = 0;
+  }
+
   ret = sync_pipe_start(&global_capture_opts, &global_capture_session, NULL);
 
   if (!ret)
@@ -2672,6 +2737,109 @@ capture_input_new_file(capture_session *cap_session, gchar *new_file)
 }
 
 
+/*
+ * Once the shared-memory ring has been abandoned, go back to reading
+ * the capture file, skipping the packets we got from the ring, so that
+ * we go on with the first packet that wasn't put into it.  That can
+ * only be done once dumpcap has flushed those packets to the file;
+ * returns FALSE if it hasn't yet.
+ */
+static gboolean
+capture_shm_resume_file(capture_file *cf)
+{
+  int     err;
+  gchar  *err_info;
+  gint64  data_offset;
+
+  if (!capture_shm_flushed(shm_ring))
+    return FALSE;
+
+  capture_shm_close(shm_ring);
+  shm_ring = NULL;
+
+  for (; shm_ring_consumed != 0; shm_ring_consumed--) {
+    wtap_cleareof(cf->wth);
+    if (!wtap_read(cf->wth, &err, &err_info, &data_offset)) {
+      /* Let the next read report the problem */
+      g_free(err_info);
+      break;
+    }
+  }
+  return TRUE;
+}
+
+/*
+ * Get the next packet from the shared-memory ring, if there is one,
+ * filling in *phdr the way wiretap would have; returns FALSE if we have
+ * to read it from the capture file instead.
+ */
+static gboolean
+capture_shm_next_packet(capture_file *cf, struct wtap_pkthdr *phdr,
+                        const guint8 **pd, gint64 *data_offset)
+{
+  capture_shm_record rec;
+  int encap;
+
+  if (!capture_shm_get(shm_ring, &rec, pd)) {
+    /* dumpcap puts a packet into the ring before telling us about
+       it, so if the ring is empty it has stopped using it, or never
+       started to; either way, it flushed the file before telling us
+       about this packet. */
+    capture_shm_abandon(shm_ring);
+    capture_shm_set_flushed(shm_ring);
+    return FALSE;
+  }
+
+  encap = wtap_file_encap(cf->wth);
+  if (encap == WTAP_ENCAP_PER_PACKET) {
+    wtapng_iface_descriptions_t *idb_info;
+
+    idb_info = wtap_file_get_idb_info(cf->wth);
+    if (rec.interface_id < idb_info->interface_data->len)
+      encap = g_array_index(idb_info->interface_data, wtapng_if_descr_t,
+                            rec.interface_id).wtap_encap;
+    g_free(idb_info);
+  }
+
+  memset(phdr, 0, sizeof *phdr);
+  switch (encap) {
+
+  case WTAP_ENCAP_ETHERNET:
+    phdr->pseudo_header.eth.fcs_len = -1;
+    break;
+
+  case WTAP_ENCAP_RAW_IP:
+  case WTAP_ENCAP_RAW_IP4:
+  case WTAP_ENCAP_RAW_IP6:
+  case WTAP_ENCAP_NULL:
+  case WTAP_ENCAP_SLL:
+  case WTAP_ENCAP_PPP:
+    break;
+
+  default:
+    /* Needs a pseudo-header, or some other help from wiretap;
+       let it do the work.  dumpcap flushes the file when it next
+       tries to put a packet into the ring. */
+    capture_shm_abandon(shm_ring);
+    return FALSE;
+  }
+
+  phdr->rec_type = REC_TYPE_PACKET;
+  phdr->presence_flags = WTAP_HAS_TS|WTAP_HAS_CAP_LEN;
+  if (wtap_file_type_subtype(cf->wth) == WTAP_FILE_TYPE_SUBTYPE_PCAPNG)
+    phdr->presence_flags |= WTAP_HAS_INTERFACE_ID;
+  phdr->ts.secs = (time_t)rec.ts_secs;
+  phdr->ts.nsecs = rec.ts_nsecs;
+  phdr->caplen = rec.caplen;
+  phdr->len = rec.len;
+  phdr->pkt_encap = encap;
+  phdr->interface_id = rec.interface_id;
+
+  *data_offset = rec.file_offset;
+  shm_ring_consumed++;
+  return TRUE;
+}
+
 /* capture child tells us we have new packets to read */
 void
 capture_input_new_packets(capture_session *cap_session, int to_read)
@@ -2715,7 +2883,27 @@ capture_input_new_packets(capture_session *cap_session, int to_read)
        ("packet_details" is true). */
     edt = epan_dissect_new(cf->epan, create_proto_tree, print_packet_info && print_details);
 
+    to_read += shm_reads_pending;
+    shm_reads_pending = 0;
     while (to_read-- && cf->wth) {
+      if (shm_ring != NULL) {
+        struct wtap_pkthdr  phdr;
+        const guint8       *pd;
+
+        if (!capture_shm_abandoned(shm_ring) &&
+            capture_shm_next_packet(cf, &phdr, &pd, &data_offset)) {
+          ret = process_packet(cf, edt, data_offset, &phdr, pd, tap_flags);
+          capture_shm_release(shm_ring);
+          if (ret != FALSE)
+            packet_count++;
+          continue;
+        }
+        if (!capture_shm_resume_file(cf)) {
+          /* Read this packet, and the rest, once they're in the file */
+          shm_reads_pending = to_read + 1;
+          break;
+        }
+      }
       wtap_cleareof(cf->wth);
       ret = wtap_read(cf->wth, &err, &err_info, &data_offset);
       if (ret == FALSE) {
@@ -2828,6 +3016,19 @@ capture_input_closed(capture_session *cap_session, gchar *msg)
   if (msg != NULL)
     fprintf(stderr, "tshark: %s\n", msg);
 
+  if (shm_ring != NULL) {
+    if (shm_reads_pending != 0 && cf != NULL && cf->wth != NULL) {
+      /* dumpcap has closed the capture file, so everything it
+         told us about is in it now */
+      capture_shm_set_flushed(shm_ring);
+      capture_input_new_packets(cap_session, 0);
+    }
+    if (shm_ring != NULL) {
+      capture_shm_close(shm_ring);
+      shm_ring = NULL;
+    }
+  }
+
   report_counts();
 
   if (cf != NULL && cf->wth != NULL) {
@@ -3095,6 +3296,8 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
   struct wtap_pkthdr phdr;
   Buffer       buf;
   epan_dissect_t *edt = NULL;
+  wtap_batch  *batch;
+  wtap_batch_rec *rec;
 
   memset(&phdr, 0, sizeof(struct wtap_pkthdr));
 
@@ -3207,14 +3410,23 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
       if (cf->rfcode || cf->dfcode)
         create_proto_tree = TRUE;
 
+      /* Dissectors only look up host names when building a tree, so
+         build one if we're going to look names up with DNS, to start
+         the lookups now and have them done by the second pass. */
+      if (gbl_resolv_flags.network_name && gbl_resolv_flags.concurrent_dns &&
+          gbl_resolv_flags.use_external_net_name_resolver)
+        create_proto_tree = TRUE;
+
       /* We're not going to display the protocol tree on this pass,
          so it's not going to be "visible". */
       edt = epan_dissect_new(cf->epan, create_proto_tree, FALSE);
     }
 
-    while (wtap_read(cf->wth, &err, &err_info, &data_offset)) {
-      if (process_packet_first_pass(cf, edt, data_offset, wtap_phdr(cf->wth),
-                         wtap_buf_ptr(cf->wth))) {
+    batch = wtap_batch_new(256);
+    while ((rec = wtap_batch_next(cf->wth, batch, &err, &err_info)) != NULL) {
+      data_offset = rec->data_offset;
+      if (process_packet_first_pass(cf, edt, data_offset, &rec->phdr,
+                         rec->data)) {
         /* Stop reading if we have the maximum number of packets;
          * When the -c option has not been used, max_packet_count
          * starts at 0, which practically means, never stop reading.
@@ -3226,12 +3438,18 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
         }
       }
     }
+    wtap_batch_free(batch);
 
     if (edt) {
       epan_dissect_free(edt);
       edt = NULL;
     }
 
+    /* Wait for the answers to the DNS queries made in the first pass. */
+    if (gbl_resolv_flags.network_name && gbl_resolv_flags.concurrent_dns &&
+        gbl_resolv_flags.use_external_net_name_resolver)
+      host_name_lookup_wait();
+
     /* Close the sequential I/O side, to free up memory it requires. */
     wtap_sequential_close(cf->wth);
 
@@ -3342,17 +3560,18 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
       edt = epan_dissect_new(cf->epan, create_proto_tree, print_packet_info && print_details);
     }
 
-    while (wtap_read(cf->wth, &err, &err_info, &data_offset)) {
+    batch = wtap_batch_new(256);
+    while ((rec = wtap_batch_next(cf->wth, batch, &err, &err_info)) != NULL) {
       framenum++;
+      data_offset = rec->data_offset;
 
-      if (process_packet(cf, edt, data_offset, wtap_phdr(cf->wth),
-                         wtap_buf_ptr(cf->wth),
+      if (process_packet(cf, edt, data_offset, &rec->phdr, rec->data,
                          tap_flags)) {
         /* Either there's no read filtering or this packet passed the
            filter, so, if we're writing to a capture file, write
            this packet out. */
         if (pdh != NULL) {
-          if (!wtap_dump(pdh, wtap_phdr(cf->wth), wtap_buf_ptr(cf->wth), &err)) {
+          if (!wtap_dump(pdh, &rec->phdr, rec->data, &err)) {
             /* Error writing to a capture file */
             switch (err) {
 
@@ -3400,6 +3619,7 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
         break;
       }
     }
+    wtap_batch_free(batch);
 
     if (edt) {
       epan_dissect_free(edt);
@@ -3634,6 +3854,10 @@ write_preamble(capture_file *cf)
     write_fields_preamble(output_fields, stdout);
     return !ferror(stdout);
 
+  case WRITE_EK:
+    write_ek_preamble(stdout);
+    return !ferror(stdout);
+
   default:
     g_assert_not_reached();
     return FALSE;
@@ -3935,6 +4159,7 @@ print_packet(capture_file *cf, epan_dissect_t *edt)
         proto_tree_write_psml(edt, stdout);
         return !ferror(stdout);
       case WRITE_FIELDS: /*No non-verbose "fields" format */
+      case WRITE_EK:
         g_assert_not_reached();
         break;
       }
@@ -3973,6 +4198,9 @@ print_packet(capture_file *cf, epan_dissect_t *edt)
       proto_tree_write_fields(output_fields, edt, &cf->cinfo, stdout);
       printf("\n");
       return !ferror(stdout);
+    case WRITE_EK:
+      proto_tree_write_ek(edt, stdout);
+      return !ferror(stdout);
     }
   }
   if (print_hex) {
@@ -4007,6 +4235,10 @@ write_finale(void)
     write_fields_finale(output_fields, stdout);
     return !ferror(stdout);
 
+  case WRITE_EK:
+    write_ek_finale(stdout);
+    return !ferror(stdout);
+
   default:
     g_assert_not_reached();
     return FALSE;
@@ -106,6 +106,19 @@ afpstat_draw(void *pss)
 }
 
 
+/* merge the results of another afp,srt instance into this one */
+static void
+afpstat_merge(void *pss, const void *psrc)
+{
+	afpstat_t *ss=(afpstat_t *)pss;
+	const afpstat_t *src=(const afpstat_t *)psrc;
+	int i;
+
+	for(i=0;i<256;i++){
+		time_stat_merge(&ss->proc[i], &src->proc[i]);
+	}
+}
+
 static void
 afpstat_init(const char *opt_arg, void* userdata _U_)
 {
@@ -150,6 +163,8 @@ afpstat_init(const char *opt_arg, void* userdata _U_)
 		g_string_free(error_string, TRUE);
 		exit(1);
 	}
+
+	set_tap_merge(ss, afpstat_merge);
 }
 
 void
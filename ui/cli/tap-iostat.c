@@ -94,6 +94,106 @@ typedef struct _io_stat_item_t {
 
 static guint64 last_relative_time;
 
+/* Append an empty interval to the column mit is the head of */
+static io_stat_item_t *
+iostat_new_item(io_stat_item_t *mit)
+{
+    io_stat_item_t *it = mit->prev;
+
+    it->next = (io_stat_item_t *)g_malloc(sizeof(io_stat_item_t));
+    it->next->prev = it;
+    it->next->next = NULL;
+    it = it->next;
+    mit->prev = it;
+
+    it->time = it->prev->time + mit->parent->interval;
+    it->frames = 0;
+    it->counter = 0;
+    it->float_counter = 0;
+    it->double_counter = 0;
+    it->num = 0;
+    it->calc_type = it->prev->calc_type;
+    it->hf_index = it->prev->hf_index;
+    it->colnum = it->prev->colnum;
+
+    return it;
+}
+
+/* Store the highest value for this item in order to determine the width of each stat column.
+*  For real numbers we only need to know its magnitude (the value to the left of the decimal point
+*  so round it up before storing it as an integer in max_vals. For AVG of RELATIVE_TIME fields,
+*  calc the average, round it to the next second and store the seconds. For all other calc types
+*  of RELATIVE_TIME fields, store the counters without modification.
+*  fields. */
+static void
+iostat_update_max_vals(io_stat_t *parent, io_stat_item_t *it)
+{
+    int ftype;
+
+    switch(it->calc_type) {
+        case CALC_TYPE_FRAMES:
+        case CALC_TYPE_FRAMES_AND_BYTES:
+            parent->max_frame[it->colnum] =
+                MAX(parent->max_frame[it->colnum], it->frames);
+            if (it->calc_type==CALC_TYPE_FRAMES_AND_BYTES)
+                parent->max_vals[it->colnum] =
+                    MAX(parent->max_vals[it->colnum], it->counter);
+
+        case CALC_TYPE_BYTES:
+        case CALC_TYPE_COUNT:
+        case CALC_TYPE_LOAD:
+            parent->max_vals[it->colnum] = MAX(parent->max_vals[it->colnum], it->counter);
+            break;
+        case CALC_TYPE_SUM:
+        case CALC_TYPE_MIN:
+        case CALC_TYPE_MAX:
+            ftype=proto_registrar_get_ftype(it->hf_index);
+            switch(ftype) {
+                case FT_FLOAT:
+                    parent->max_vals[it->colnum] =
+                        MAX(parent->max_vals[it->colnum], (guint64)(it->float_counter+0.5));
+                    break;
+                case FT_DOUBLE:
+                    parent->max_vals[it->colnum] =
+                        MAX(parent->max_vals[it->colnum],(guint64)(it->double_counter+0.5));
+                    break;
+                case FT_RELATIVE_TIME:
+                    parent->max_vals[it->colnum] =
+                        MAX(parent->max_vals[it->colnum], it->counter);
+                    break;
+                default:
+                    /* UINT16-64 and INT8-64 */
+                    parent->max_vals[it->colnum] =
+                        MAX(parent->max_vals[it->colnum], it->counter);
+                    break;
+            }
+            break;
+        case CALC_TYPE_AVG:
+            if (it->num==0) /* avoid division by zero */
+               break;
+            ftype=proto_registrar_get_ftype(it->hf_index);
+            switch(ftype) {
+                case FT_FLOAT:
+                    parent->max_vals[it->colnum] =
+                        MAX(parent->max_vals[it->colnum], (guint64)it->float_counter/it->num);
+                    break;
+                case FT_DOUBLE:
+                    parent->max_vals[it->colnum] =
+                        MAX(parent->max_vals[it->colnum],(guint64)it->double_counter/it->num);
+                    break;
+                case FT_RELATIVE_TIME:
+                    parent->max_vals[it->colnum] =
+                        MAX(parent->max_vals[it->colnum], ((it->counter/(guint64)it->num) + G_GUINT64_CONSTANT(500000000)) / NANOSECS_PER_SEC);
+                    break;
+                default:
+                    /* UINT16-64 and INT8-64 */
+                    parent->max_vals[it->colnum] =
+                        MAX(parent->max_vals[it->colnum], it->counter/it->num);
+                    break;
+            }
+    }
+}
+
 static int
 iostat_packet(void *arg, packet_info *pinfo, epan_dissect_t *edt, const void *dummy _U_)
 {
@@ -131,21 +231,7 @@ iostat_packet(void *arg, packet_info *pinfo, epan_dissect_t *edt, const void *du
     *  struct will be created for it. */
     rt = relative_time;
     while (rt >= it->time + parent->interval) {
-        it->next = (io_stat_item_t *)g_malloc(sizeof(io_stat_item_t));
-        it->next->prev = it;
-        it->next->next = NULL;
-        it = it->next;
-        mit->prev = it;
-
-        it->time = it->prev->time + parent->interval;
-        it->frames = 0;
-        it->counter = 0;
-        it->float_counter = 0;
-        it->double_counter = 0;
-        it->num = 0;
-        it->calc_type = it->prev->calc_type;
-        it->hf_index = it->prev->hf_index;
-        it->colnum = it->prev->colnum;
+        it = iostat_new_item(mit);
     }
 
     /* Store info in the current structure */
@@ -427,75 +513,89 @@ iostat_packet(void *arg, packet_info *pinfo, epan_dissect_t *edt, const void *du
         }
         break;
     }
-    /* Store the highest value for this item in order to determine the width of each stat column.
-    *  For real numbers we only need to know its magnitude (the value to the left of the decimal point
-    *  so round it up before storing it as an integer in max_vals. For AVG of RELATIVE_TIME fields,
-    *  calc the average, round it to the next second and store the seconds. For all other calc types
-    *  of RELATIVE_TIME fields, store the counters without modification.
-    *  fields. */
-    switch(it->calc_type) {
-        case CALC_TYPE_FRAMES:
-        case CALC_TYPE_FRAMES_AND_BYTES:
-            parent->max_frame[it->colnum] =
-                MAX(parent->max_frame[it->colnum], it->frames);
-            if (it->calc_type==CALC_TYPE_FRAMES_AND_BYTES)
-                parent->max_vals[it->colnum] =
-                    MAX(parent->max_vals[it->colnum], it->counter);
+    iostat_update_max_vals(parent, it);
 
-        case CALC_TYPE_BYTES:
-        case CALC_TYPE_COUNT:
-        case CALC_TYPE_LOAD:
-            parent->max_vals[it->colnum] = MAX(parent->max_vals[it->colnum], it->counter);
-            break;
-        case CALC_TYPE_SUM:
+    return TRUE;
+}
+
+/* For MIN and MAX: is a's value lower than b's? */
+static gboolean
+iostat_item_less(int ftype, const io_stat_item_t *a, const io_stat_item_t *b)
+{
+    switch(ftype) {
+    case FT_INT8:
+    case FT_INT16:
+    case FT_INT24:
+    case FT_INT32:
+        return (gint32)a->counter < (gint32)b->counter;
+    case FT_INT64:
+        return (gint64)a->counter < (gint64)b->counter;
+    case FT_FLOAT:
+        return a->float_counter < b->float_counter;
+    case FT_DOUBLE:
+        return a->double_counter < b->double_counter;
+    default:
+        /* UINT8-64 and RELATIVE_TIME */
+        return a->counter < b->counter;
+    }
+}
+
+/* Add the intervals of another column with the same statistic, gathered
+*  over another part of the same capture (so with times relative to the
+*  same first frame), to the column mit is the head of. */
+static void
+iostat_merge(void *arg, const void *src_arg)
+{
+    io_stat_item_t *mit = (io_stat_item_t *)arg;
+    const io_stat_item_t *sit = (const io_stat_item_t *)src_arg;
+    io_stat_t *parent = mit->parent;
+    io_stat_item_t *it = mit;
+    int ftype = 0;
+
+    if (sit->parent->start_time != 0 &&
+        (parent->start_time == 0 || sit->parent->start_time < parent->start_time)) {
+        parent->start_time = sit->parent->start_time;
+    }
+
+    if (mit->calc_type == CALC_TYPE_MIN || mit->calc_type == CALC_TYPE_MAX) {
+        ftype = proto_registrar_get_ftype(mit->hf_index);
+    }
+
+    for (; sit; sit = sit->next) {
+        while (it->time < sit->time) {
+            it = it->next ? it->next : iostat_new_item(mit);
+        }
+
+        if (sit->frames == 0) {
+            continue;
+        }
+
+        switch(it->calc_type) {
         case CALC_TYPE_MIN:
-        case CALC_TYPE_MAX:
-            ftype=proto_registrar_get_ftype(it->hf_index);
-            switch(ftype) {
-                case FT_FLOAT:
-                    parent->max_vals[it->colnum] =
-                        MAX(parent->max_vals[it->colnum], (guint64)(it->float_counter+0.5));
-                    break;
-                case FT_DOUBLE:
-                    parent->max_vals[it->colnum] =
-                        MAX(parent->max_vals[it->colnum],(guint64)(it->double_counter+0.5));
-                    break;
-                case FT_RELATIVE_TIME:
-                    parent->max_vals[it->colnum] =
-                        MAX(parent->max_vals[it->colnum], it->counter);
-                    break;
-                default:
-                    /* UINT16-64 and INT8-64 */
-                    parent->max_vals[it->colnum] =
-                        MAX(parent->max_vals[it->colnum], it->counter);
-                    break;
+            if (it->frames == 0 || iostat_item_less(ftype, sit, it)) {
+                it->counter = sit->counter;
+                it->float_counter = sit->float_counter;
+                it->double_counter = sit->double_counter;
             }
             break;
-        case CALC_TYPE_AVG:
-            if (it->num==0) /* avoid division by zero */
-               break;
-            ftype=proto_registrar_get_ftype(it->hf_index);
-            switch(ftype) {
-                case FT_FLOAT:
-                    parent->max_vals[it->colnum] =
-                        MAX(parent->max_vals[it->colnum], (guint64)it->float_counter/it->num);
-                    break;
-                case FT_DOUBLE:
-                    parent->max_vals[it->colnum] =
-                        MAX(parent->max_vals[it->colnum],(guint64)it->double_counter/it->num);
-                    break;
-                case FT_RELATIVE_TIME:
-                    parent->max_vals[it->colnum] =
-                        MAX(parent->max_vals[it->colnum], ((it->counter/(guint64)it->num) + G_GUINT64_CONSTANT(500000000)) / NANOSECS_PER_SEC);
-                    break;
-                default:
-                    /* UINT16-64 and INT8-64 */
-                    parent->max_vals[it->colnum] =
-                        MAX(parent->max_vals[it->colnum], it->counter/it->num);
-                    break;
+        case CALC_TYPE_MAX:
+            if (it->frames == 0 || iostat_item_less(ftype, it, sit)) {
+                it->counter = sit->counter;
+                it->float_counter = sit->float_counter;
+                it->double_counter = sit->double_counter;
             }
+            break;
+        default:
+            it->counter += sit->counter;
+            it->float_counter += sit->float_counter;
+            it->double_counter += sit->double_counter;
+            it->num += sit->num;
+            break;
+        }
+        it->frames += sit->frames;
+
+        iostat_update_max_vals(parent, it);
     }
-    return TRUE;
 }
 
 static int
@@ -1353,6 +1453,8 @@ register_io_tap(io_stat_t *io, int i, const char *filter)
         g_string_free(error_string, TRUE);
         exit(1);
     }
+
+    set_tap_merge(&io->items[i], iostat_merge);
 }
 
 static void
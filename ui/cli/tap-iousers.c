@@ -183,6 +183,12 @@ iousers_draw(void *arg)
 	printf("================================================================================\n");
 }
 
+static void
+iousers_merge(void *arg, const void *src_arg)
+{
+	merge_conversation_table((conv_hash_t*)arg, (const conv_hash_t*)src_arg);
+}
+
 void init_iousers(struct register_ct* ct, const char *filter)
 {
 	io_users_t *iu;
@@ -202,6 +208,7 @@ void init_iousers(struct register_ct* ct, const char *filter)
 		exit(1);
 	}
 
+	set_tap_merge(&iu->hash, iousers_merge);
 }
 
 /*
@@ -70,6 +70,24 @@ megacostat_draw(void *pms)
 }
 
 
+/* merge the results of another megaco,rtd instance into this one */
+static void
+megacostat_merge(void *pms, const void *psrc)
+{
+	megacostat_t *ms=(megacostat_t *)pms;
+	const megacostat_t *src=(const megacostat_t *)psrc;
+	int i;
+
+	for(i=0;i<NUM_TIMESTATS;i++){
+		time_stat_merge(&ms->rtd[i], &src->rtd[i]);
+	}
+
+	ms->open_req_num+=src->open_req_num;
+	ms->disc_rsp_num+=src->disc_rsp_num;
+	ms->req_dup_num+=src->req_dup_num;
+	ms->rsp_dup_num+=src->rsp_dup_num;
+}
+
 static void
 megacostat_init(const char *opt_arg, void* userdata _U_)
 {
@@ -127,6 +145,8 @@ megacostat_init(const char *opt_arg, void* userdata _U_)
 		g_string_free(error_string, TRUE);
 		exit(1);
 	}
+
+	set_tap_merge(ms, megacostat_merge);
 }
 
 
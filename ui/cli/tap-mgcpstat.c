@@ -169,6 +169,24 @@ mgcpstat_draw(void *pms)
 }
 
 
+/* merge the results of another mgcp,rtd instance into this one */
+static void
+mgcpstat_merge(void *pms, const void *psrc)
+{
+	mgcpstat_t *ms=(mgcpstat_t *)pms;
+	const mgcpstat_t *src=(const mgcpstat_t *)psrc;
+	int i;
+
+	for(i=0;i<NUM_TIMESTATS;i++){
+		time_stat_merge(&ms->rtd[i], &src->rtd[i]);
+	}
+
+	ms->open_req_num+=src->open_req_num;
+	ms->disc_rsp_num+=src->disc_rsp_num;
+	ms->req_dup_num+=src->req_dup_num;
+	ms->rsp_dup_num+=src->rsp_dup_num;
+}
+
 static void
 mgcpstat_init(const char *opt_arg, void* userdata _U_)
 {
@@ -211,6 +229,8 @@ mgcpstat_init(const char *opt_arg, void* userdata _U_)
 		g_string_free(error_string, TRUE);
 		exit(1);
 	}
+
+	set_tap_merge(ms, mgcpstat_merge);
 }
 
 
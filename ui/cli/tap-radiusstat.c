@@ -185,6 +185,24 @@ radiusstat_draw(void *prs)
 }
 
 
+/* merge the results of another radius,rtd instance into this one */
+static void
+radiusstat_merge(void *prs, const void *psrc)
+{
+	radiusstat_t *rs=(radiusstat_t *)prs;
+	const radiusstat_t *src=(const radiusstat_t *)psrc;
+	int i;
+
+	for(i=0;i<RADIUS_CAT_NUM_TIMESTATS;i++){
+		time_stat_merge(&rs->rtd[i], &src->rtd[i]);
+	}
+
+	rs->open_req_num+=src->open_req_num;
+	rs->disc_rsp_num+=src->disc_rsp_num;
+	rs->req_dup_num+=src->req_dup_num;
+	rs->rsp_dup_num+=src->rsp_dup_num;
+}
+
 static void
 radiusstat_init(const char *opt_arg, void* userdata _U_)
 {
@@ -227,6 +245,8 @@ radiusstat_init(const char *opt_arg, void* userdata _U_)
 		g_string_free(error_string, TRUE);
 		exit(1);
 	}
+
+	set_tap_merge(rs, radiusstat_merge);
 }
 
 
@@ -180,6 +180,21 @@ smbstat_draw(void *pss)
 }
 
 
+/* merge the results of another smb,srt instance into this one */
+static void
+smbstat_merge(void *pss, const void *psrc)
+{
+	smbstat_t *ss=(smbstat_t *)pss;
+	const smbstat_t *src=(const smbstat_t *)psrc;
+	int i;
+
+	for(i=0;i<256;i++){
+		time_stat_merge(&ss->proc[i], &src->proc[i]);
+		time_stat_merge(&ss->trans2[i], &src->trans2[i]);
+		time_stat_merge(&ss->nt_trans[i], &src->nt_trans[i]);
+	}
+}
+
 static void
 smbstat_init(const char *opt_arg,void* userdata _U_)
 {
@@ -244,6 +259,8 @@ smbstat_init(const char *opt_arg,void* userdata _U_)
 		g_string_free(error_string, TRUE);
 		exit(1);
 	}
+
+	set_tap_merge(ss, smbstat_merge);
 }
 
 
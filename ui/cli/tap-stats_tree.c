@@ -103,6 +103,8 @@ init_stats_tree(const char *opt_arg, void *userdata _U_)
 		return;
 	}
 
+	set_tap_merge(st, stats_tree_merge);
+
 	if (cfg->init) cfg->init(st);
 
 }
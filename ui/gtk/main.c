@@ -249,6 +249,7 @@ GString *comp_info_str, *runtime_info_str;
 static gboolean have_capture_file = FALSE; /* XXX - is there an equivalent in cfile? */
 
 static guint  tap_update_timer_id;
+static guint  first_pass_idle_id = 0;
 
 static void console_log_handler(const char *log_domain,
     GLogLevelFlags log_level, const char *message, gpointer user_data);
@@ -1415,6 +1416,10 @@ main_cf_cb_file_closing(capture_file *cf)
                                   simple_dialog_primary_end());
         gtk_window_set_position(GTK_WINDOW(close_dlg), GTK_WIN_POS_CENTER_ON_PARENT);
     }
+    if (first_pass_idle_id != 0) {
+        g_source_remove(first_pass_idle_id);
+        first_pass_idle_id = 0;
+    }
     /* Clear maunally resolved addresses */
     manually_resolve_cleanup();
     /* Destroy all windows that refer to the
@@ -1460,6 +1465,24 @@ main_cf_cb_file_read_started(capture_file *cf _U_)
     main_set_for_capture_file(TRUE);
 }
 
+/* Dissect the packets added from an index of the file while there's
+   nothing else to do */
+static gboolean
+first_pass_idle_cb(gpointer data)
+{
+    capture_file *cf = (capture_file *)data;
+    float progress;
+
+    if (cf_first_pass_continue(cf, &progress)) {
+        statusbar_first_pass_progress(cf, FALSE, progress);
+        return TRUE;
+    }
+    if (cf->state == FILE_READ_DONE)
+        statusbar_first_pass_progress(cf, TRUE, 1.0f);
+    first_pass_idle_id = 0;
+    return FALSE;
+}
+
 static void
 main_cf_cb_file_read_finished(capture_file *cf)
 {
@@ -1480,6 +1503,9 @@ main_cf_cb_file_read_finished(capture_file *cf)
 
     /* Enable menu items that make sense if you have some captured packets. */
     main_set_for_captured_packets(TRUE);
+
+    if (cf->first_pass_next != 0 && first_pass_idle_id == 0)
+        first_pass_idle_id = g_idle_add(first_pass_idle_cb, cf);
 }
 
 static void
@@ -722,6 +722,23 @@ statusbar_set_filename(const char *file_name, gint64 file_length, nstime_t *file
 }
 
 
+/*
+ * Show how far dissecting the packets added from an index of the file
+ * has got, or, once that's done, the file alone again.
+ */
+void
+statusbar_first_pass_progress(capture_file *cf, gboolean done, float progress)
+{
+    statusbar_pop_file_msg();
+    if (done) {
+        statusbar_set_filename(cf->filename, cf->f_datalen, &(cf->elapsed_time));
+        return;
+    }
+    statusbar_push_file_msg(" File: \"%s\" (dissecting: %d%%)",
+                            cf->filename ? cf->filename : "", (int)(progress * 100));
+}
+
+
 static void
 statusbar_cf_file_closing_cb(capture_file *cf _U_)
 {
@@ -31,6 +31,7 @@ void statusbar_widgets_emptying(GtkWidget *statusbar);
 void statusbar_widgets_pack(GtkWidget *statusbar);
 void statusbar_widgets_show_or_hide(GtkWidget *statusbar);
 void statusbar_cf_callback(gint event, gpointer data, gpointer user_data);
+void statusbar_first_pass_progress(capture_file *cf, gboolean done, float progress);
 #ifdef HAVE_LIBPCAP
 void statusbar_capture_callback(gint event, capture_session *cap_session,
                                 gpointer user_data);
@@ -31,12 +31,9 @@
 
 #include "ui/io_graph_item.h"
 
-int get_io_graph_index(packet_info *pinfo, int interval) {
+gint64 get_io_graph_offset(packet_info *pinfo) {
     nstime_t time_delta;
 
-    /*
-     * Find in which interval this is supposed to go and store the interval index as idx
-     */
     time_delta = pinfo->rel_ts;
     if (time_delta.nsecs<0) {
         time_delta.secs--;
@@ -45,7 +42,81 @@ int get_io_graph_index(packet_info *pinfo, int interval) {
     if (time_delta.secs<0) {
         return -1;
     }
-    return (int) ((time_delta.secs*1000 + time_delta.nsecs/1000000) / interval);
+    return (gint64) time_delta.secs*1000 + time_delta.nsecs/1000000;
+}
+
+int get_io_graph_index(packet_info *pinfo, int interval) {
+    gint64 offset;
+
+    /*
+     * Find in which interval this is supposed to go and store the interval index as idx
+     */
+    offset = get_io_graph_offset(pinfo);
+    if (offset < 0 || offset / interval > G_MAXINT) {
+        return -1;
+    }
+    return (int) (offset / interval);
+}
+
+void merge_io_graph_item(io_graph_item_t *dst, const io_graph_item_t *src)
+{
+    if (src->first_frame_in_invl != 0 &&
+        (dst->first_frame_in_invl == 0 || src->first_frame_in_invl < dst->first_frame_in_invl)) {
+        dst->first_frame_in_invl = src->first_frame_in_invl;
+    }
+    if (src->last_frame_in_invl > dst->last_frame_in_invl) {
+        dst->last_frame_in_invl = src->last_frame_in_invl;
+    }
+
+    /* As in update_io_graph_item(), min/max values are only valid if
+     * fields != 0. */
+    if (src->fields != 0) {
+        if (dst->fields == 0) {
+            dst->int_max    = src->int_max;
+            dst->int_min    = src->int_min;
+            dst->float_max  = src->float_max;
+            dst->float_min  = src->float_min;
+            dst->double_max = src->double_max;
+            dst->double_min = src->double_min;
+            dst->time_max   = src->time_max;
+            dst->time_min   = src->time_min;
+        } else {
+            if (src->int_max > dst->int_max) {
+                dst->int_max = src->int_max;
+            }
+            if (src->int_min < dst->int_min) {
+                dst->int_min = src->int_min;
+            }
+            if (src->float_max > dst->float_max) {
+                dst->float_max = src->float_max;
+            }
+            if (src->float_min < dst->float_min) {
+                dst->float_min = src->float_min;
+            }
+            if (src->double_max > dst->double_max) {
+                dst->double_max = src->double_max;
+            }
+            if (src->double_min < dst->double_min) {
+                dst->double_min = src->double_min;
+            }
+            if (nstime_cmp(&src->time_max, &dst->time_max) > 0) {
+                dst->time_max = src->time_max;
+            }
+            if (nstime_cmp(&src->time_min, &dst->time_min) < 0) {
+                dst->time_min = src->time_min;
+            }
+        }
+        dst->fields += src->fields;
+    }
+
+    dst->frames     += src->frames;
+    dst->bytes      += src->bytes;
+    dst->int_tot    += src->int_tot;
+    dst->float_tot  += src->float_tot;
+    dst->double_tot += src->double_tot;
+    /* LOAD spreads time_tot over earlier items, which may have no
+     * frames or fields of their own. */
+    nstime_add(&dst->time_tot, &src->time_tot);
 }
 
 GString *check_field_unit(const char *field_name, int *hf_index, io_graph_item_unit_t item_unit)
@@ -101,16 +101,34 @@ reset_io_graph_items(io_graph_item_t *items, gsize count) {
     }
 }
 
+/** Get the time of a packet relative to the first one in milliseconds
+ *
+ * @param [in] pinfo Packet of interest.
+ * @return The time in milliseconds, or -1 if it's before the first packet.
+ */
+gint64 get_io_graph_offset(packet_info *pinfo);
+
 /** Get the interval (array index) for a packet
  *
  * It is up to the caller to determine if the return value is valid.
  *
  * @param [in] pinfo Packet of interest.
  * @param [in] interval Time interval in milliseconds.
- * @return Array index on success, -1 on failure.
+ * @return Array index on success, -1 on failure or if it doesn't fit in an int.
  */
 int get_io_graph_index(packet_info *pinfo, int interval);
 
+/** Merge the values of one io_graph_item_t into another
+ *
+ * This can be used to derive the items for a long interval from the
+ * items for a shorter one, as long as the long interval is a multiple
+ * of the short one.
+ *
+ * @param dst [in,out] Item to merge into.
+ * @param src [in] Item to merge from.
+ */
+void merge_io_graph_item(io_graph_item_t *dst, const io_graph_item_t *src);
+
 /** Check field and item unit compatibility
  *
  * @param field_name [in] Header field name to check
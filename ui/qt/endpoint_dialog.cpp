@@ -37,6 +37,7 @@
 #include "wireshark_application.h"
 
 #include <QMessageBox>
+#include <QVector>
 
 
 const QString table_name_ = QObject::tr("Endpoint");
@@ -487,6 +488,28 @@ void EndpointTreeWidget::updateItems()
     }
 #endif
 
+#ifdef HAVE_GEOIP
+    // Look the new endpoints up in address order, which is quicker than
+    // in table order; their items' update() then finds them in the cache.
+    if (geoip_db_num_dbs() > 0) {
+        QVector<guint32> addrs4;
+        QVector<struct e_in6_addr> addrs6;
+
+        for (guint i = (guint) topLevelItemCount(); i < hash_.conv_array->len; i++) {
+            hostlist_talker_t *endp_item = &g_array_index(hash_.conv_array, hostlist_talker_t, i);
+            if (endp_item->myaddress.type == AT_IPv4) {
+                addrs4 << pntoh32(endp_item->myaddress.data);
+            } else if (endp_item->myaddress.type == AT_IPv6) {
+                addrs6 << *(const struct e_in6_addr *) endp_item->myaddress.data;
+            }
+        }
+        for (unsigned db = 0; db < geoip_db_num_dbs(); db++) {
+            geoip_db_lookup_ipv4_bulk(db, addrs4.constData(), addrs4.size(), NULL, NULL);
+            geoip_db_lookup_ipv6_bulk(db, addrs6.constData(), addrs6.size(), NULL, NULL);
+        }
+    }
+#endif
+
     setSortingEnabled(false);
     for (int i = topLevelItemCount(); i < (int) hash_.conv_array->len; i++) {
         EndpointTreeWidgetItem *etwi = new EndpointTreeWidgetItem(this);
@@ -217,6 +217,7 @@ IOGraphDialog::IOGraphDialog(QWidget *parent, capture_file *cf) :
     ui->intervalComboBox->addItem(tr("10 sec"),  10000);
     ui->intervalComboBox->addItem(tr("1 min"),   60000);
     ui->intervalComboBox->addItem(tr("10 min"), 600000);
+    ui->intervalComboBox->addItem(tr("1 hour"), 3600000);
     ui->intervalComboBox->setCurrentIndex(3);
 
     ui->todCheckBox->setChecked(false);
@@ -348,7 +349,11 @@ void IOGraphDialog::addGraph(bool checked, QString name, QString dfilter, int co
 
     syncGraphSettings(ti);
     if (iog->visible()) {
-        scheduleRetap();
+        if (iog->needsRetap()) {
+            scheduleRetap();
+        } else {
+            scheduleRecalc();
+        }
     }
 }
 
@@ -433,7 +438,7 @@ void IOGraphDialog::syncGraphSettings(QTreeWidgetItem *item)
     updateLegend();
 
     if (visible) {
-        if (retap) {
+        if (retap && iog->needsRetap()) {
             scheduleRetap();
         } else {
             scheduleReplot();
@@ -950,7 +955,9 @@ void IOGraphDialog::updateStatistics()
 
     if (need_retap_) {
         need_retap_ = false;
-        cf_retap_packets(cap_file_);
+        if (cf_retap_packets(cap_file_) == CF_READ_OK) {
+            IOGraphBuckets::setTapped(ui->ioPlot);
+        }
         ui->ioPlot->setFocus();
     } else {
         if (need_recalc_) {
@@ -1117,7 +1124,7 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int index)
     Q_UNUSED(index);
 
     int interval = ui->intervalComboBox->itemData(ui->intervalComboBox->currentIndex()).toInt();
-    bool need_retap = false;
+    bool need_recalc = false;
 
     for (int i = 0; i < ui->graphTreeWidget->topLevelItemCount(); i++) {
         QTreeWidgetItem *item = ui->graphTreeWidget->topLevelItem(i);
@@ -1127,14 +1134,16 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int index)
             if (iog) {
                 iog->setInterval(interval);
                 if (iog->visible()) {
-                    need_retap = true;
+                    need_recalc = true;
                 }
             }
         }
     }
 
-    if (need_retap) {
-        scheduleRetap(true);
+    // Every interval in the combo box is a bucket interval, so the
+    // graphs can be recalculated from the data we already have.
+    if (need_recalc) {
+        scheduleRecalc(true);
     }
 }
 
@@ -1509,32 +1518,25 @@ IOGraph::IOGraph(QCustomPlot *parent) :
     visible_(false),
     graph_(NULL),
     bars_(NULL),
+    val_units_(IOG_ITEM_UNIT_PACKETS),
     hf_index_(-1),
+    interval_(1000),
+    start_time_(0.0),
+    buckets_(NULL),
+    items_(NULL),
     cur_idx_(-1)
 {
     Q_ASSERT(parent_ != NULL);
     graph_ = parent_->addGraph(parent_->xAxis, parent_->yAxis);
     Q_ASSERT(graph_ != NULL);
 
-    GString *error_string;
-    error_string = register_tap_listener("frame",
-                          this,
-                          "",
-                          TL_REQUIRES_PROTO_TREE,
-                          tapReset,
-                          tapPacket,
-                          tapDraw);
-    if (error_string) {
-//        QMessageBox::critical(this, tr("%1 failed to register tap listener").arg(name_),
-//                             error_string->str);
-        g_string_free(error_string, TRUE);
-    }
-
     setFilter(QString());
 }
 
 IOGraph::~IOGraph() {
-    remove_tap_listener(this);
+    if (buckets_) {
+        buckets_->unref();
+    }
     if (graph_) {
         parent_->removeGraph(graph_);
     }
@@ -1575,24 +1577,47 @@ void IOGraph::setFilter(const QString &filter)
 
     // Make sure vu_field_ survives edt tree pruning by adding it to our filter
     // expression.
+    int bucket_hf_index = -1;
+    io_graph_item_unit_t bucket_unit = IOG_ITEM_UNIT_PACKETS;
     if (val_units_ >= IOG_ITEM_UNIT_CALC_SUM && !vu_field_.isEmpty() && hf_index_ >= 0) {
         if (full_filter.isEmpty()) {
             full_filter = vu_field_;
         } else {
             full_filter += QString(" && (%1)").arg(vu_field_);
         }
+        // LOAD is the only calculation that fills in the items differently.
+        bucket_hf_index = hf_index_;
+        bucket_unit = val_units_ == IOG_ITEM_UNIT_CALC_LOAD ? IOG_ITEM_UNIT_CALC_LOAD : IOG_ITEM_UNIT_CALC_FIELDS;
     }
 
-    error_string = set_tap_dfilter(this, full_filter.toUtf8().constData());
-    if (error_string) {
-        config_err_ = error_string->str;
-        g_string_free(error_string, TRUE);
+    QString err;
+    IOGraphBuckets *buckets = IOGraphBuckets::ref(parent_, full_filter, bucket_hf_index, bucket_unit, err);
+    if (!buckets) {
+        config_err_ = err;
         return;
-    } else {
-        if (filter_.compare(filter) && visible_) {
+    }
+
+    filter_ = filter;
+    if (buckets == buckets_) {
+        buckets->unref();
+        return;
+    }
+
+    if (buckets_) {
+        disconnect(buckets_, 0, this, 0);
+        buckets_->unref();
+    }
+    buckets_ = buckets;
+    items_ = NULL;
+    connect(buckets_, SIGNAL(bucketsReset()), this, SLOT(bucketsReset()));
+    connect(buckets_, SIGNAL(bucketsChanged()), this, SIGNAL(requestRecalc()));
+
+    if (visible_) {
+        if (buckets_->isTapped()) {
+            emit requestRecalc();
+        } else {
             emit requestRetap();
         }
-        filter_ = filter;
     }
 }
 
@@ -1771,9 +1796,15 @@ double IOGraph::startOffset()
 
 int IOGraph::packetFromTime(double ts)
 {
+    if (!buckets_) {
+        return -1;
+    }
+
+    int num_items;
+    const io_graph_item_t *items = buckets_->items(interval_, &num_items);
     int idx = ts * 1000 / interval_;
-    if (idx >= 0 && idx < (int) cur_idx_) {
-        return items_[idx].last_frame_in_invl;
+    if (items && idx >= 0 && idx < num_items - 1) {
+        return items[idx].last_frame_in_invl;
     }
     return -1;
 }
@@ -1781,7 +1812,7 @@ int IOGraph::packetFromTime(double ts)
 void IOGraph::clearAllData()
 {
     cur_idx_ = -1;
-    reset_io_graph_items(items_, max_io_items_);
+    items_ = NULL;
     if (graph_) {
         graph_->clearData();
     }
@@ -1855,6 +1886,12 @@ void IOGraph::recalcGraphData(capture_file *cap_file)
         x_axis = bars_->keyAxis();
     }
 
+    // Nothing can be tapped while we're in here, so items_ stays valid.
+    int num_items = 0;
+    items_ = buckets_ ? buckets_->items(interval_, &num_items) : NULL;
+    cur_idx_ = items_ ? num_items - 1 : -1;
+    start_time_ = buckets_ ? buckets_->startTime() : 0.0;
+
     if (moving_avg_period_ > 0 && cur_idx_ >= 0) {
         /* "Warm-up phase" - calculate average on some data not displayed;
          * just to make sure average on leftmost and rightmost displayed
@@ -1933,10 +1970,10 @@ double IOGraph::getItemValue(int idx, capture_file *cap_file)
 {
     double     value = 0;          /* FIXME: loss of precision, visible on the graph for small values */
     int        adv_type;
-    io_graph_item_t *item;
+    const io_graph_item_t *item;
     guint32    interval;
 
-    g_assert(idx < max_io_items_);
+    g_assert(items_ && idx <= cur_idx_);
 
     item = &items_[idx];
 
@@ -2082,79 +2119,219 @@ double IOGraph::getItemValue(int idx, capture_file *cap_file)
     return value;
 }
 
+void IOGraph::bucketsReset()
+{
+//    qDebug() << "=bucketsReset" << name_;
+    clearAllData();
+}
+
+// IOGraphBuckets
+
+// Bucket intervals in ms. Each one must be a multiple of the one before.
+static const int bucket_intervals_[] = { 1, 10, 100, 1000, 10000, 60000, 600000, 3600000 };
+static const int num_bucket_intervals_ = sizeof(bucket_intervals_) / sizeof(bucket_intervals_[0]);
+
+QHash<QString, IOGraphBuckets *> IOGraphBuckets::buckets_;
+
+IOGraphBuckets::IOGraphBuckets(QCustomPlot *plot, const QString &key, int hf_index, io_graph_item_unit_t item_unit) :
+    plot_(plot),
+    key_(key),
+    hf_index_(hf_index),
+    item_unit_(item_unit),
+    ref_count_(1),
+    tapped_(false),
+    start_time_(0.0),
+    added_(num_bucket_intervals_),
+    merged_(num_bucket_intervals_),
+    merged_valid_(false)
+{
+}
+
+IOGraphBuckets::~IOGraphBuckets()
+{
+    remove_tap_listener(this);
+    buckets_.remove(key_);
+}
+
+IOGraphBuckets *IOGraphBuckets::ref(QCustomPlot *plot, const QString &filter, int hf_index,
+                                    io_graph_item_unit_t item_unit, QString &err)
+{
+    QString key = QString("%1\t%2\t%3\t%4")
+            .arg((quintptr) plot)
+            .arg(hf_index)
+            .arg(item_unit)
+            .arg(filter);
+
+    IOGraphBuckets *buckets = buckets_.value(key, NULL);
+    if (buckets) {
+        buckets->ref_count_++;
+        return buckets;
+    }
+
+    buckets = new IOGraphBuckets(plot, key, hf_index, item_unit);
+
+    GString *error_string;
+    error_string = register_tap_listener("frame",
+                          buckets,
+                          filter.toUtf8().constData(),
+                          TL_REQUIRES_PROTO_TREE,
+                          tapReset,
+                          tapPacket,
+                          tapDraw);
+    if (error_string) {
+        err = error_string->str;
+        g_string_free(error_string, TRUE);
+        // Not in buckets_ yet and not registered; the destructor copes.
+        delete buckets;
+        return NULL;
+    }
+
+    buckets_.insert(key, buckets);
+    return buckets;
+}
+
+void IOGraphBuckets::unref()
+{
+    if (--ref_count_ < 1) {
+        delete this;
+    }
+}
+
+void IOGraphBuckets::setTapped(QCustomPlot *plot)
+{
+    foreach (IOGraphBuckets *buckets, buckets_) {
+        if (buckets->plot_ == plot) {
+            buckets->tapped_ = true;
+        }
+    }
+}
+
+const io_graph_item_t *IOGraphBuckets::items(int interval, int *num_items)
+{
+    int level;
+
+    *num_items = 0;
+    for (level = 0; level < num_bucket_intervals_; level++) {
+        if (bucket_intervals_[level] == interval) {
+            break;
+        }
+    }
+    if (level >= num_bucket_intervals_) {
+        return NULL;
+    }
+
+    if (!merged_valid_) {
+        // Roll each interval up into the next one, shortest first.
+        merged_[0] = added_[0];
+        for (int i = 1; i < num_bucket_intervals_; i++) {
+            const QVector<io_graph_item_t> &below = merged_[i - 1];
+            QVector<io_graph_item_t> &merged = merged_[i];
+            int ratio = bucket_intervals_[i] / bucket_intervals_[i - 1];
+            int count = qMax(added_[i].size(), (below.size() + ratio - 1) / ratio);
+
+            merged = added_[i];
+            if (merged.size() < count) {
+                int old_count = merged.size();
+                merged.resize(count);
+                reset_io_graph_items(merged.data() + old_count, count - old_count);
+            }
+            for (int idx = 0; idx < below.size(); idx++) {
+                merge_io_graph_item(&merged[idx / ratio], &below[idx]);
+            }
+        }
+        merged_valid_ = true;
+    }
+
+    *num_items = merged_[level].size();
+    return merged_[level].constData();
+}
+
+void IOGraphBuckets::clear()
+{
+    for (int i = 0; i < num_bucket_intervals_; i++) {
+        added_[i].clear();
+        merged_[i].clear();
+    }
+    merged_valid_ = false;
+    start_time_ = 0.0;
+}
+
 // "tap_reset" callback for register_tap_listener
-void IOGraph::tapReset(void *iog_ptr)
+void IOGraphBuckets::tapReset(void *buckets_ptr)
 {
-    IOGraph *iog = static_cast<IOGraph *>(iog_ptr);
-    if (!iog) return;
+    IOGraphBuckets *buckets = static_cast<IOGraphBuckets *>(buckets_ptr);
+    if (!buckets) return;
 
-//    qDebug() << "=tapReset" << iog->name_;
-    iog->clearAllData();
+    buckets->clear();
+    buckets->tapped_ = false;
+    emit buckets->bucketsReset();
 }
 
 // "tap_packet" callback for register_tap_listener
-gboolean IOGraph::tapPacket(void *iog_ptr, packet_info *pinfo, epan_dissect_t *edt, const void *data)
+gboolean IOGraphBuckets::tapPacket(void *buckets_ptr, packet_info *pinfo, epan_dissect_t *edt, const void *data)
 {
     Q_UNUSED(data);
-    IOGraph *iog = static_cast<IOGraph *>(iog_ptr);
-    if (!pinfo || !iog) {
+    IOGraphBuckets *buckets = static_cast<IOGraphBuckets *>(buckets_ptr);
+    if (!pinfo || !buckets) {
         return FALSE;
     }
 
-    int idx = get_io_graph_index(pinfo, iog->interval_);
-    bool recalc = false;
-
-    /* some sanity checks */
-    if ((idx < 0) || (idx >= max_io_items_)) {
-        iog->cur_idx_ = max_io_items_ - 1;
+    /* Add the packet at the shortest interval that has room for it */
+    gint64 offset = get_io_graph_offset(pinfo);
+    if (offset < 0) {
+        return FALSE;
+    }
+    int level, idx = -1;
+    for (level = 0; level < num_bucket_intervals_; level++) {
+        if (offset / bucket_intervals_[level] < max_io_items_) {
+            idx = (int) (offset / bucket_intervals_[level]);
+            break;
+        }
+    }
+    if (level >= num_bucket_intervals_) {
         return FALSE;
     }
 
-    /* update num_items */
-    if (idx > iog->cur_idx_) {
-        iog->cur_idx_ = (guint32) idx;
-        recalc = true;
+    QVector<io_graph_item_t> &items = buckets->added_[level];
+    bool changed = false;
+    if (idx >= items.size()) {
+        int old_count = items.size();
+        items.resize(idx + 1);
+        reset_io_graph_items(items.data() + old_count, idx + 1 - old_count);
+        changed = true;
     }
 
     /* set start time */
-    if (iog->start_time_ == 0.0) {
+    if (buckets->start_time_ == 0.0) {
         nstime_t start_nstime;
         nstime_set_zero(&start_nstime);
         nstime_delta(&start_nstime, &pinfo->fd->abs_ts, &pinfo->rel_ts);
-        iog->start_time_ = nstime_to_sec(&start_nstime);
+        buckets->start_time_ = nstime_to_sec(&start_nstime);
     }
 
     epan_dissect_t *adv_edt = NULL;
     /* For ADVANCED mode we need to keep track of some more stuff than just frame and byte counts */
-    if (iog->val_units_ >= IOG_ITEM_UNIT_CALC_SUM) {
+    if (buckets->hf_index_ >= 0) {
         adv_edt = edt;
     }
 
-    if (!update_io_graph_item(iog->items_, idx, pinfo, adv_edt, iog->hf_index_, iog->val_units_, iog->interval_)) {
+    buckets->merged_valid_ = false;
+    if (!update_io_graph_item(items.data(), idx, pinfo, adv_edt, buckets->hf_index_, buckets->item_unit_, bucket_intervals_[level])) {
         return FALSE;
     }
 
-//    qDebug() << "=tapPacket" << iog->name_ << idx << iog->hf_index_ << iog->val_units_ << iog->num_items_;
-
-    if (recalc) {
-        emit iog->requestRecalc();
+    if (changed) {
+        emit buckets->bucketsChanged();
     }
     return TRUE;
 }
 
 // "tap_draw" callback for register_tap_listener
-void IOGraph::tapDraw(void *iog_ptr)
+void IOGraphBuckets::tapDraw(void *buckets_ptr)
 {
-    IOGraph *iog = static_cast<IOGraph *>(iog_ptr);
-    if (!iog) return;
-    emit iog->requestRecalc();
-
-    if (iog->graph_) {
-//        qDebug() << "=tapDraw g" << iog->name_ << iog->graph_->data()->keys().size();
-    }
-    if (iog->bars_) {
-//        qDebug() << "=tapDraw b" << iog->name_ << iog->bars_->data()->keys().size();
-    }
+    IOGraphBuckets *buckets = static_cast<IOGraphBuckets *>(buckets_ptr);
+    if (!buckets) return;
+    emit buckets->bucketsChanged();
 }
 
 // Stat command + args
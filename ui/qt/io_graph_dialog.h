@@ -37,17 +37,73 @@
 
 #include <QComboBox>
 #include <QDialog>
+#include <QHash>
 #include <QIcon>
 #include <QLineEdit>
 #include <QMenu>
 #include <QRubberBand>
 #include <QTimer>
 #include <QTreeWidgetItem>
+#include <QVector>
 #include "qcustomplot.h"
 
 // GTK+ sets this to 100000 (NUM_IO_ITEMS)
 const int max_io_items_ = 250000;
 
+// Per-interval statistics for the packets that match a display filter,
+// kept at every interval from 1 ms to 1 hour. Each packet is only added
+// at the shortest interval that has room for it; longer intervals are
+// derived from shorter ones by merging. Graphs in the same plot with the
+// same filter, value field and kind of calculation share a set of
+// buckets, so changing the interval or adding such a graph doesn't need
+// a retap.
+class IOGraphBuckets : public QObject {
+Q_OBJECT
+public:
+    // Find or create the buckets for the given settings. Returns NULL
+    // and sets err if the filter is invalid.
+    static IOGraphBuckets *ref(QCustomPlot *plot, const QString &filter, int hf_index,
+                               io_graph_item_unit_t item_unit, QString &err);
+    void unref();
+    // Do we have data for every packet, or is a retap needed?
+    bool isTapped() { return tapped_; }
+    // Called after all of the packets in the capture file have been tapped.
+    static void setTapped(QCustomPlot *plot);
+    // The items for the given interval, valid until the next packet is
+    // tapped. Returns NULL if interval isn't a bucket interval.
+    const io_graph_item_t *items(int interval, int *num_items);
+    double startTime() { return start_time_; }
+
+signals:
+    void bucketsReset();
+    void bucketsChanged();
+
+private:
+    IOGraphBuckets(QCustomPlot *plot, const QString &key, int hf_index, io_graph_item_unit_t item_unit);
+    ~IOGraphBuckets();
+    void clear();
+
+    // Callbacks for register_tap_listener
+    static void tapReset(void *buckets_ptr);
+    static gboolean tapPacket(void *buckets_ptr, packet_info *pinfo, epan_dissect_t *edt, const void *data);
+    static void tapDraw(void *buckets_ptr);
+
+    static QHash<QString, IOGraphBuckets *> buckets_;
+
+    QCustomPlot *plot_;
+    QString key_;
+    int hf_index_;
+    io_graph_item_unit_t item_unit_;
+    int ref_count_;
+    bool tapped_;
+    double start_time_;
+    // Items added at each interval, and added + merged from the
+    // interval below it.
+    QVector<QVector<io_graph_item_t> > added_;
+    QVector<QVector<io_graph_item_t> > merged_;
+    bool merged_valid_;
+};
+
 // XXX - Move to its own file?
 class IOGraph : public QObject {
 Q_OBJECT
@@ -79,6 +135,8 @@ public:
     QCPBars *bars() { return bars_; }
     double startOffset();
     int packetFromTime(double ts);
+    // Does this graph need a retap to have data?
+    bool needsRetap() { return !buckets_ || !buckets_->isTapped(); }
 
     void clearAllData();
 
@@ -96,12 +154,11 @@ signals:
     void requestRecalc();
     void requestRetap();
 
+private slots:
+    void bucketsReset();
+
 private:
     double getItemValue(int idx, capture_file *cap_file);
-    // Callbacks for register_tap_listener
-    static void tapReset(void *iog_ptr);
-    static gboolean tapPacket(void *iog_ptr, packet_info *pinfo, epan_dissect_t *edt, const void *data);
-    static void tapDraw(void *iog_ptr);
 
     QCustomPlot *parent_;
     QString config_err_;
@@ -119,7 +176,8 @@ private:
 
     // Cached data. We should be able to change the Y axis without retapping as
     // much as is feasible.
-    io_graph_item_t items_[max_io_items_];
+    IOGraphBuckets *buckets_;
+    const io_graph_item_t *items_;
     int cur_idx_;
 };
 
@@ -117,6 +117,9 @@ MainWindow::MainWindow(QWidget *parent) :
 
     connect(wsApp, SIGNAL(recentFilesRead()), this, SLOT(loadWindowGeometry()));
 
+    // Packets added from an index of the file are dissected in the background
+    connect(&first_pass_timer_, SIGNAL(timeout()), this, SLOT(continueFirstPass()));
+
     connect(wsApp, SIGNAL(updateRecentItemStatus(const QString &, qint64, bool)), this, SLOT(updateRecentFiles()));
     updateRecentFiles();
 
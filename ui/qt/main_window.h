@@ -41,10 +41,9 @@
 
 #include <QMainWindow>
 #include <QSplitter>
+#include <QTimer>
 
-#ifdef _WIN32
-# include <QTimer>
-#else
+#ifndef _WIN32
 # include <QSocketNotifier>
 #endif
 
@@ -118,6 +117,7 @@ private:
 
     bool capture_stopping_;
     bool capture_filter_valid_;
+    QTimer first_pass_timer_;
 #ifdef HAVE_LIBPCAP
     CaptureInterfacesDialog capture_interfaces_dialog_;
 #endif
@@ -195,6 +195,7 @@ private slots:
     void pipeActivated(int source);
     void pipeNotifierDestroyed();
     void stopCapture();
+    void continueFirstPass();
 
     void loadWindowGeometry();
     void updateRecentFiles();
@@ -508,11 +508,17 @@ void MainWindow::captureFileReadFinished(const capture_file *cf) {
     QString msg = QString().sprintf("%s", get_basename(cf->filename));
     main_ui_->statusBar->pushFileStatus(msg);
     emit setDissectedCaptureFile(cap_file_);
+
+    if (cf->first_pass_next != 0) {
+        first_pass_timer_.start(0);
+    }
 }
 
 void MainWindow::captureFileClosing(const capture_file *cf) {
     if (cf != cap_file_) return;
 
+    first_pass_timer_.stop();
+
     setMenusForCaptureFile(true);
     setForCapturedPackets(false);
     setMenusForSelectedPacket();
@@ -730,6 +736,26 @@ void MainWindow::stopCapture() {
 #endif // HAVE_LIBPCAP
 }
 
+void MainWindow::continueFirstPass() {
+    float progress = 0.0;
+
+    if (cap_file_ && cf_first_pass_continue(cap_file_, &progress)) {
+        main_ui_->statusBar->popFileStatus();
+        QString msg = tr("%1 (dissecting: %2%)")
+                .arg(get_basename(cap_file_->filename))
+                .arg((int) (progress * 100));
+        main_ui_->statusBar->pushFileStatus(msg);
+        return;
+    }
+
+    first_pass_timer_.stop();
+    if (cap_file_ && cap_file_->state == FILE_READ_DONE) {
+        main_ui_->statusBar->popFileStatus();
+        QString msg = QString().sprintf("%s", get_basename(cap_file_->filename));
+        main_ui_->statusBar->pushFileStatus(msg);
+    }
+}
+
 // XXX - Copied from ui/gtk/menus.c
 
 /**
@@ -21,7 +21,13 @@
 
 #include "packet_list_model.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
 #include <wsutil/nstime.h>
+#include <epan/column.h>
 #include <epan/prefs.h>
 
 #include "ui/packet_list_utils.h"
@@ -34,10 +40,26 @@
 #include "wireshark_application.h"
 #include <QColor>
 #include <QModelIndex>
+#include <QTime>
+
+// Number of rows on either side of the last displayed row to dissect
+// ahead of time
+const int idle_dissection_window_ = 2000;
+// Maximum time, in milliseconds, to spend on each pass
+const int idle_dissection_interval_ = 50;
 
 PacketListModel::PacketListModel(QObject *parent, capture_file *cf) :
-    QAbstractItemModel(parent)
+    QAbstractItemModel(parent),
+    sort_column_(0),
+    sort_order_(Qt::AscendingOrder),
+    idle_dissection_row_(0),
+    idle_dissection_dist_(0)
 {
+    idle_dissection_timer_ = new QTimer(this);
+    idle_dissection_timer_->setSingleShot(true);
+    idle_dissection_timer_->setInterval(0);
+    connect(idle_dissection_timer_, SIGNAL(timeout()), this, SLOT(dissectIdle()));
+
     setCaptureFile(cf);
 }
 
@@ -90,6 +112,9 @@ guint PacketListModel::recreateVisibleRows()
         }
     }
     endInsertRows();
+    if (sort_column_ > 0 || sort_order_ != Qt::AscendingOrder) {
+        sort(sort_column_, sort_order_);
+    }
     return visible_rows_.count();
 }
 
@@ -99,9 +124,14 @@ void PacketListModel::setColorEnabled(bool enable_color) {
 
 void PacketListModel::clear() {
     beginResetModel();
+    idle_dissection_timer_->stop();
+    idle_dissection_row_ = 0;
+    idle_dissection_dist_ = 0;
+    qDeleteAll(physical_rows_);
     physical_rows_.clear();
     visible_rows_.clear();
     number_to_row_.clear();
+    PacketListRecord::invalidateColumns();
     endResetModel();
 }
 
@@ -193,6 +223,11 @@ QVariant PacketListModel::data(const QModelIndex &index, int role) const
     case Qt::DisplayRole:
     {
         int column = index.column();
+        if (index.row() != idle_dissection_row_) {
+            idle_dissection_row_ = index.row();
+            idle_dissection_dist_ = 0;
+            idle_dissection_timer_->start();
+        }
         //    g_log(NULL, G_LOG_LEVEL_DEBUG, "showing col %d", col_num);
         return record->columnString(cap_file_, column);
     }
@@ -220,6 +255,198 @@ QVariant PacketListModel::headerData(int section, Qt::Orientation orientation,
     return QVariant();
 }
 
+// Sort keys for one column, extracted before sorting so that comparing
+// two rows never needs to dissect anything.
+struct PacketListSortKey {
+    PacketListRecord *record;
+    const gchar *text;
+    double number;
+};
+
+class PacketListSortLessThan
+{
+public:
+    PacketListSortLessThan(capture_file *cf, int col_fmt, bool text_based, bool numeric, Qt::SortOrder order) :
+        cap_file_(cf),
+        col_fmt_(col_fmt),
+        text_based_(text_based),
+        numeric_(numeric),
+        order_(order)
+    {
+    }
+
+    bool operator()(const PacketListSortKey &a, const PacketListSortKey &b) const
+    {
+        gint ret = compare(a, b);
+        return order_ == Qt::AscendingOrder ? ret < 0 : ret > 0;
+    }
+
+private:
+    // packet_list_store.c:packet_list_compare_records
+    gint compare(const PacketListSortKey &a, const PacketListSortKey &b) const
+    {
+        frame_data *fdata_a = a.record->frameData();
+        frame_data *fdata_b = b.record->frameData();
+        gint ret = 0;
+
+        if (!text_based_) {
+            return frame_data_compare(cap_file_->epan, fdata_a, fdata_b, col_fmt_);
+        }
+
+        if (numeric_) {
+            if (a.number < b.number) {
+                ret = -1;
+            } else if (a.number > b.number) {
+                ret = 1;
+            }
+        } else if (a.text != b.text) {
+            // The keys are interned, so equal pointers mean equal text.
+            ret = strcmp(a.text, b.text);
+        }
+
+        if (ret == 0) {
+            ret = frame_data_compare(cap_file_->epan, fdata_a, fdata_b, COL_NUMBER);
+        }
+        return ret;
+    }
+
+    capture_file *cap_file_;
+    int col_fmt_;
+    bool text_based_;
+    bool numeric_;
+    Qt::SortOrder order_;
+};
+
+void PacketListModel::sort(int column, Qt::SortOrder order)
+{
+    if (!cap_file_ || column < 0 || column >= prefs.num_cols) {
+        return;
+    }
+
+    sort_column_ = column;
+    sort_order_ = order;
+
+    if (visible_rows_.count() < 1) {
+        return;
+    }
+
+    int col_fmt = cap_file_->cinfo.col_fmt[column];
+    bool text_based = !col_based_on_frame_data(&cap_file_->cinfo, column);
+    bool numeric = false;
+
+    if (col_fmt == COL_CUSTOM) {
+        // packet_list_store.c:packet_list_compare_custom
+        header_field_info *hfi = proto_registrar_get_byname(cap_file_->cinfo.col_custom_field[column]);
+
+        if (hfi == NULL) {
+            text_based = false;
+            col_fmt = COL_NUMBER;
+        } else if ((hfi->strings == NULL) &&
+                   (((IS_FT_INT(hfi->type) || IS_FT_UINT(hfi->type)) &&
+                     ((hfi->display == BASE_DEC) || (hfi->display == BASE_DEC_HEX) ||
+                      (hfi->display == BASE_OCT))) ||
+                    (hfi->type == FT_DOUBLE) || (hfi->type == FT_FLOAT) ||
+                    (hfi->type == FT_BOOLEAN) || (hfi->type == FT_FRAMENUM) ||
+                    (hfi->type == FT_RELATIVE_TIME))) {
+            numeric = true;
+        }
+    }
+
+    // Pull the keys out of the column store first; dissecting a row
+    // may evict the text of the others. The text keys are interned
+    // in a pool of their own for the duration of the sort.
+    QVector<PacketListSortKey> keys(visible_rows_.count());
+    GStringChunk *sort_pool = NULL;
+
+    if (text_based && !numeric) {
+        sort_pool = g_string_chunk_new(1 * 1024 * 1024);
+    }
+
+    for (int row = 0; row < visible_rows_.count(); row++) {
+        PacketListRecord *record = visible_rows_[row];
+        PacketListSortKey &key = keys[row];
+
+        key.record = record;
+        key.text = NULL;
+        key.number = 0.0;
+        if (text_based) {
+            const gchar *text = record->columnText(cap_file_, column);
+
+            if (!text) {
+                text = "";
+            }
+            if (numeric) {
+                key.number = atof(text);
+            } else {
+                key.text = g_string_chunk_insert_const(sort_pool, text);
+            }
+        }
+    }
+
+    emit layoutAboutToBeChanged();
+
+    std::sort(keys.begin(), keys.end(), PacketListSortLessThan(cap_file_, col_fmt, text_based, numeric, order));
+
+    number_to_row_.clear();
+    for (int row = 0; row < keys.count(); row++) {
+        visible_rows_[row] = keys[row].record;
+        number_to_row_[keys[row].record->frameData()->num] = row;
+    }
+
+    if (sort_pool) {
+        g_string_chunk_free(sort_pool);
+    }
+
+    QModelIndexList old_indexes = persistentIndexList();
+    QModelIndexList new_indexes;
+    foreach (QModelIndex old_index, old_indexes) {
+        PacketListRecord *record = static_cast<PacketListRecord*>(old_index.internalPointer());
+        int row = record ? number_to_row_.value(record->frameData()->num, -1) : -1;
+
+        new_indexes << index(row, old_index.column());
+    }
+    changePersistentIndexList(old_indexes, new_indexes);
+
+    emit layoutChanged();
+}
+
+void PacketListModel::dissectIdle()
+{
+    QTime elapsed;
+    int rows = visible_rows_.count();
+
+    if (!cap_file_ || cap_file_->state == FILE_READ_IN_PROGRESS || cap_file_->redissecting) {
+        return;
+    }
+
+    elapsed.start();
+    while (idle_dissection_dist_ <= idle_dissection_window_) {
+        // Leave room in the column store for what's actually displayed.
+        if (PacketListRecord::columnStoreSize() > PACKET_LIST_COLUMN_STORE_MAX / 2) {
+            return;
+        }
+
+        int after = idle_dissection_row_ + idle_dissection_dist_;
+        int before = idle_dissection_row_ - idle_dissection_dist_ - 1;
+
+        if (after >= rows && before < 0) {
+            break;
+        }
+        if (after < rows) {
+            visible_rows_[after]->cache(cap_file_);
+        }
+        if (before >= 0) {
+            visible_rows_[before]->cache(cap_file_);
+        }
+        idle_dissection_dist_++;
+
+        if (elapsed.elapsed() >= idle_dissection_interval_) {
+            idle_dissection_timer_->start();
+            return;
+        }
+    }
+}
+
 gint PacketListModel::appendPacket(frame_data *fdata)
 {
     PacketListRecord *record = new PacketListRecord(fdata);
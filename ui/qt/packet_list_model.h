@@ -32,6 +32,7 @@
 
 #include <QAbstractItemModel>
 #include <QFont>
+#include <QTimer>
 #include <QVector>
 
 #include "packet_list_record.h"
@@ -57,6 +58,7 @@ public:
     QVariant data(const QModelIndex &index, int role) const;
     QVariant headerData(int section, Qt::Orientation orientation,
                              int role = Qt::DisplayRole) const;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
 
     gint appendPacket(frame_data *fdata);
     frame_data *getRowFdata(int row);
@@ -67,6 +69,9 @@ signals:
 
 public slots:
 
+private slots:
+    void dissectIdle();
+
 private:
     capture_file *cap_file_;
     QList<QString> col_names_;
@@ -77,6 +82,15 @@ private:
 
     int header_height_;
     bool enable_color_;
+
+    int sort_column_;
+    Qt::SortOrder sort_order_;
+
+    // Rows near the last one displayed are dissected ahead of time,
+    // nearest first, whenever the GUI is idle.
+    QTimer *idle_dissection_timer_;
+    mutable int idle_dissection_row_;
+    mutable int idle_dissection_dist_;
 };
 
 #endif // PACKET_LIST_MODEL_H
@@ -21,6 +21,8 @@
 
 #include "packet_list_record.h"
 
+#include <string.h>
+
 #include <file.h>
 
 #include <epan/epan_dissect.h>
@@ -31,39 +33,73 @@
 #include "color_filters.h"
 #include "frame_tvbuff.h"
 
+#include <QByteArray>
 #include <QStringList>
 
 QMap<int, int> cinfo_column_;
 
+GStringChunk *PacketListRecord::string_pool_ = NULL;
+GHashTable *PacketListRecord::string_table_ = NULL;
+gsize PacketListRecord::string_pool_size_ = 0;
+unsigned PacketListRecord::col_data_ver_ = 1;
+
 PacketListRecord::PacketListRecord(frame_data *frameData) :
+    col_text_(NULL),
+    data_ver_(0),
     fdata_(frameData),
 //    columnized_(false),
     colorized_(false)
 {
 }
 
+PacketListRecord::~PacketListRecord()
+{
+    g_free(col_text_);
+}
+
 QVariant PacketListRecord::columnString(capture_file *cap_file, int column)
+{
+    if (!cap_file || column < 0 || column >= cap_file->cinfo.num_cols) {
+        return QVariant();
+    }
+
+    return QByteArray(columnText(cap_file, column));
+}
+
+const gchar *PacketListRecord::columnText(capture_file *cap_file, int column)
 {
     // packet_list_store.c:packet_list_get_value
     g_assert(fdata_);
 
-    if (!cap_file || column < 0 || column > cap_file->cinfo.num_cols) {
-        return QVariant();
+    if (!cap_file || column < 0 || column >= cap_file->cinfo.num_cols) {
+        return NULL;
     }
 
-    if (column >= col_text_.size() || col_text_[column].isNull() || !colorized_) {
-        dissect(cap_file, !colorized_);
-    }
+    cache(cap_file);
 
-    return col_text_.value(column, QByteArray());
+    if (!col_text_ || data_ver_ != col_data_ver_) {
+        return NULL;
+    }
+    return col_text_[column];
 }
 
 frame_data *PacketListRecord::frameData() {
     return fdata_;
 }
 
+void PacketListRecord::cache(capture_file *cap_file)
+{
+    if (!isCached()) {
+        dissect(cap_file, !colorized_);
+    }
+}
+
 void PacketListRecord::resetColumns(column_info *cinfo)
 {
+    // The text of frame_data based columns (times, lengths, ...) may have
+    // changed along with the columns themselves.
+    invalidateColumns();
+
     if (!cinfo) {
         return;
     }
@@ -78,6 +114,18 @@ void PacketListRecord::resetColumns(column_info *cinfo)
     }
 }
 
+void PacketListRecord::invalidateColumns()
+{
+    if (string_table_) {
+        g_hash_table_remove_all(string_table_);
+    }
+    if (string_pool_) {
+        g_string_chunk_clear(string_pool_);
+    }
+    string_pool_size_ = 0;
+    col_data_ver_++;
+}
+
 void PacketListRecord::dissect(capture_file *cap_file, bool dissect_color)
 {
     // packet_list_store.c:packet_list_dissect_and_cache_record
@@ -86,7 +134,7 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_color)
     gboolean create_proto_tree;
     struct wtap_pkthdr phdr; /* Packet header */
     Buffer buf; /* Packet data */
-    gboolean dissect_columns = col_text_.isEmpty();
+    gboolean dissect_columns = !col_text_ || data_ver_ != col_data_ver_;
 
     if (!cap_file) {
         return;
@@ -158,7 +206,6 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_color)
     ws_buffer_free(&buf);
 }
 
-//#define MINIMIZE_STRING_COPYING 1
 void PacketListRecord::cacheColumnStrings(column_info *cinfo)
 {
     // packet_list_store.c:packet_list_change_record(PacketList *packet_list, PacketListRecord *record, gint col, column_info *cinfo)
@@ -166,81 +213,54 @@ void PacketListRecord::cacheColumnStrings(column_info *cinfo)
         return;
     }
 
-    col_text_.clear();
-
-    for (int column = 0; column < cinfo->num_cols; ++column) {
+    if (!string_pool_) {
+        string_pool_ = g_string_chunk_new(1 * 1024 * 1024);
+        string_table_ = g_hash_table_new(g_str_hash, g_str_equal);
+    }
 
-#ifdef MINIMIZE_STRING_COPYING
-        int text_col = cinfo_column_.value(column, -1);
+    // Keep the working set bounded. Everything is thrown away at once;
+    // records that are displayed again are simply dissected again.
+    if (string_pool_size_ >= PACKET_LIST_COLUMN_STORE_MAX) {
+        invalidateColumns();
+    }
 
-        /* Column based on frame_data or it already contains a value */
-        if (text_col < 0) {
-            col_fill_in_frame_data(fdata_, cinfo, column, FALSE);
-            col_text_.append(cinfo->col_data[column]);
-            continue;
-        }
+    g_free(col_text_);
+    col_text_ = g_new(const gchar *, cinfo->num_cols);
 
-        switch (cinfo->col_fmt[column]) {
-        case COL_DEF_SRC:
-        case COL_RES_SRC:        /* COL_DEF_SRC is currently just like COL_RES_SRC */
-        case COL_UNRES_SRC:
-        case COL_DEF_DL_SRC:
-        case COL_RES_DL_SRC:
-        case COL_UNRES_DL_SRC:
-        case COL_DEF_NET_SRC:
-        case COL_RES_NET_SRC:
-        case COL_UNRES_NET_SRC:
-        case COL_DEF_DST:
-        case COL_RES_DST:        /* COL_DEF_DST is currently just like COL_RES_DST */
-        case COL_UNRES_DST:
-        case COL_DEF_DL_DST:
-        case COL_RES_DL_DST:
-        case COL_UNRES_DL_DST:
-        case COL_DEF_NET_DST:
-        case COL_RES_NET_DST:
-        case COL_UNRES_NET_DST:
-        case COL_PROTOCOL:
-        case COL_INFO:
-        case COL_IF_DIR:
-        case COL_DCE_CALL:
-        case COL_8021Q_VLAN_ID:
-        case COL_EXPERT:
-        case COL_FREQ_CHAN:
-            if (cinfo->col_data[column] && cinfo->col_data[column] != cinfo->col_buf[column]) {
-                /* This is a constant string, so we don't have to copy it */
-                // XXX - ui/gtk/packet_list_store.c uses G_MAXUSHORT. We don't do proper UTF8
-                // truncation in either case.
-                int col_text_len = MIN(qstrlen(cinfo->col_data[column]) + 1, COL_MAX_INFO_LEN);
-                col_text_.append(QByteArray::fromRawData(cinfo->col_data[column], col_text_len));
-                break;
-            }
-            /* !! FALL-THROUGH!! */
-
-        default:
-            if (!get_column_resolved(column) && cinfo->col_expr.col_expr_val[column]) {
-                /* Use the unresolved value in col_expr_val */
-                // XXX Use QContiguousCache?
-                col_text_.append(cinfo->col_expr.col_expr_val[column]);
-            } else {
-                col_text_.append(cinfo->col_data[column]);
-            }
-            break;
-        }
-#else // MINIMIZE_STRING_COPYING
-        // XXX Use QContiguousCache?
+    for (int column = 0; column < cinfo->num_cols; ++column) {
         if (!get_column_resolved(column) && cinfo->col_expr.col_expr_val[column]) {
             /* Use the unresolved value in col_expr_val */
-            col_text_.append(cinfo->col_expr.col_expr_val[column]);
+            col_text_[column] = internColumnString(cinfo->col_expr.col_expr_val[column]);
         } else {
             int text_col = cinfo_column_.value(column, -1);
 
             if (text_col < 0) {
                 col_fill_in_frame_data(fdata_, cinfo, column, FALSE);
             }
-            col_text_.append(cinfo->col_data[column]);
+            col_text_[column] = internColumnString(cinfo->col_data[column]);
         }
-#endif // MINIMIZE_STRING_COPYING
     }
+    data_ver_ = col_data_ver_;
+}
+
+const gchar *PacketListRecord::internColumnString(const gchar *str)
+{
+    gchar *interned;
+
+    if (!str) {
+        str = "";
+    }
+
+    interned = (gchar *) g_hash_table_lookup(string_table_, str);
+    if (!interned) {
+        gsize len = strlen(str);
+
+        interned = g_string_chunk_insert_len(string_pool_, str, len);
+        g_hash_table_insert(string_table_, interned, interned);
+        // The string plus (roughly) its hash table entry
+        string_pool_size_ += len + 1 + 3 * sizeof(gpointer);
+    }
+    return interned;
 }
 
 /*
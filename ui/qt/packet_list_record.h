@@ -31,23 +31,39 @@
 #include <epan/column-info.h>
 #include <epan/packet.h>
 
-#include <QByteArray>
-#include <QList>
 #include <QVariant>
 
+// Once the column store gets this big, it's cleared and records are
+// dissected again as they're displayed.
+#define PACKET_LIST_COLUMN_STORE_MAX (128 * 1024 * 1024)
+
 class PacketListRecord
 {
 public:
     PacketListRecord(frame_data *frameData);
+    ~PacketListRecord();
     // Return the string value for a column. Data is cached if possible.
     QVariant columnString(capture_file *cap_file, int column);
+    // Same as columnString, but returns a pointer into the column store,
+    // which is valid until the next call to dissect() on any record.
+    const gchar *columnText(capture_file *cap_file, int column);
     frame_data *frameData();
+    // Have the columns and colors of this record been cached?
+    bool isCached() const { return col_text_ && data_ver_ == col_data_ver_ && colorized_; }
+    // Dissect the record if it isn't cached.
+    void cache(capture_file *cap_file);
 
     static void resetColumns(column_info *cinfo);
+    // Throw away the column text of all records.
+    static void invalidateColumns();
+    // Approximate number of bytes used by the column store.
+    static gsize columnStoreSize() { return string_pool_size_; }
 
 private:
-    /** The column text for some columns */
-    QList<QByteArray> col_text_;
+    /** The column text, one pointer per column into string_pool_ */
+    const gchar **col_text_;
+    /** col_data_ver_ at the time col_text_ was filled in */
+    unsigned data_ver_;
 
     frame_data *fdata_;
 
@@ -64,6 +80,19 @@ private:
 
     void dissect(capture_file *cap_file, bool dissect_color = false);
     void cacheColumnStrings(column_info *cinfo);
+    const gchar *internColumnString(const gchar *str);
+
+    /*
+     * Column text is interned in a single string store shared by all
+     * records, the same way ui/gtk/packet_list_store.c does it, so that
+     * repeated strings (protocols, addresses, ...) are only stored once
+     * and a record only costs one pointer per column.
+     */
+    static GStringChunk *string_pool_;
+    static GHashTable *string_table_;
+    static gsize string_pool_size_;
+    /** Bumped whenever the column store is cleared */
+    static unsigned col_data_ver_;
 
 };
 
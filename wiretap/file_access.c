@@ -386,6 +386,97 @@ struct open_info *open_routines = NULL;
 /* this points to the first OPEN_INFO_HEURISTIC type in the array */
 static guint heuristic_open_routine_idx = 0;
 
+/*
+ * Magic numbers at the very beginning of the file, for the
+ * OPEN_INFO_MAGIC readers that check for one before anything else.
+ * wtap_open_offline() reads the beginning of the file once, and if
+ * it starts with one of these, tries that reader before any other;
+ * only if it doesn't accept the file are all the readers tried in
+ * order, so opening a file of one of the common types doesn't cost
+ * a call to every reader before it, or, for the types near the end
+ * of the list, to the heuristic readers.
+ */
+#define OPEN_INFO_MAGIC_MAX_LEN	17
+
+static const struct {
+	const char	*name;		/* name of the open_info entry */
+	guint		len;
+	const guint8	magic[OPEN_INFO_MAGIC_MAX_LEN];
+} open_info_magics[] = {
+	{ "Pcap",      4,  { 0xa1, 0xb2, 0xc3, 0xd4 } },
+	{ "Pcap",      4,  { 0xd4, 0xc3, 0xb2, 0xa1 } },
+	{ "Pcap",      4,  { 0xa1, 0xb2, 0xcd, 0x34 } },
+	{ "Pcap",      4,  { 0x34, 0xcd, 0xb2, 0xa1 } },
+	{ "Pcap",      4,  { 0xa1, 0xb2, 0x3c, 0x4d } },
+	{ "Pcap",      4,  { 0x4d, 0x3c, 0xb2, 0xa1 } },
+	{ "PcapNG",    4,  { 0x0a, 0x0d, 0x0d, 0x0a } },
+	{ "NgSniffer", 17, { 'T', 'R', 'S', 'N', 'I', 'F', 'F', ' ', 'd', 'a', 't', 'a',
+			     ' ', ' ', ' ', ' ', 0x1a } },
+	{ "Snoop",     8,  { 's', 'n', 'o', 'o', 'p', '\0', '\0', '\0' } },
+	{ "Netmon",    4,  { 'R', 'T', 'S', 'S' } },
+	{ "Netmon",    4,  { 'G', 'M', 'B', 'U' } },
+	{ "Netxray",   4,  { 'V', 'L', '\0', '\0' } },
+	{ "Netxray",   4,  { 'X', 'C', 'P', '\0' } },
+	{ "Visual",    4,  { 5, 'V', 'N', 'F' } },
+	{ "Aethra",    5,  { 'V', '0', '2', '0', '8' } },
+	{ "BTSNOOP",   8,  { 'b', 't', 's', 'n', 'o', 'o', 'p', '\0' } },
+	{ "EYESDN",    6,  { 'E', 'y', 'e', 'S', 'D', 'N' } },
+};
+
+#define N_OPEN_INFO_MAGICS	(sizeof open_info_magics / sizeof open_info_magics[0])
+
+/* Index in open_routines[] of the reader for each open_info_magics[]
+ * entry, or -1 if it mustn't be tried first: if it's not there, or if
+ * a magic-number reader that isn't one of ours, e.g. one written in Lua,
+ * comes before it and so gets to see the file first.
+ */
+static int open_info_magic_idx[N_OPEN_INFO_MAGICS];
+
+static gboolean is_open_info_base(const struct open_info *oi) {
+	guint i;
+
+	for (i = 0; i < N_OPEN_INFO_ROUTINES; i++) {
+		if (oi->open_routine == open_info_base[i].open_routine)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static void set_magic_routines(void) {
+	guint i, j, first_foreign;
+
+	/* Find the first magic-number reader that isn't built in */
+	for (first_foreign = 0; first_foreign < heuristic_open_routine_idx; first_foreign++) {
+		if (!is_open_info_base(&open_routines[first_foreign]))
+			break;
+	}
+
+	for (i = 0; i < N_OPEN_INFO_MAGICS; i++) {
+		open_info_magic_idx[i] = -1;
+		for (j = 0; j < first_foreign; j++) {
+			if (open_routines[j].name != NULL &&
+			    strcmp(open_routines[j].name, open_info_magics[i].name) == 0) {
+				open_info_magic_idx[i] = j;
+				break;
+			}
+		}
+	}
+}
+
+/* Returns the index in open_routines[] of the reader to try first for a
+   file that begins with the len bytes in header, or -1 if there's none */
+static int find_magic_routine(const guint8 *header, int len) {
+	guint i;
+
+	for (i = 0; i < N_OPEN_INFO_MAGICS; i++) {
+		if (open_info_magic_idx[i] != -1 &&
+		    (guint)len >= open_info_magics[i].len &&
+		    memcmp(header, open_info_magics[i].magic, open_info_magics[i].len) == 0)
+			return open_info_magic_idx[i];
+	}
+	return -1;
+}
+
 static void set_heuristic_routine(void) {
 	guint i;
 	g_assert(open_info_arr != NULL);
@@ -400,6 +491,8 @@ static void set_heuristic_routine(void) {
 	}
 
 	g_assert(heuristic_open_routine_idx > 0);
+
+	set_magic_routines();
 }
 
 void init_open_routines(void) {
@@ -684,6 +777,9 @@ wtap* wtap_open_offline(const char *filename, unsigned int type, int *err, char
 	unsigned int	i;
 	gboolean use_stdin = FALSE;
 	gchar *extension;
+	guint8	header[OPEN_INFO_MAGIC_MAX_LEN];
+	int	header_len;
+	int	magic_idx;
 
 	init_open_routines();
 
@@ -848,8 +944,52 @@ wtap* wtap_open_offline(const char *filename, unsigned int type, int *err, char
 		}
 	}
 
+	/* Read the beginning of the file, and if it has the magic number
+	   of one of the readers that check for one, try that one first. */
+	if (file_seek(wth->fh, 0, SEEK_SET, err) == -1) {
+		/* I/O error - give up */
+		wtap_close(wth);
+		return NULL;
+	}
+	header_len = file_read(header, OPEN_INFO_MAGIC_MAX_LEN, wth->fh);
+	if (header_len < 0) {
+		*err = file_error(wth->fh, err_info);
+		wtap_close(wth);
+		return NULL;
+	}
+	magic_idx = find_magic_routine(header, header_len);
+	if (magic_idx != -1) {
+		if (file_seek(wth->fh, 0, SEEK_SET, err) == -1) {
+			/* I/O error - give up */
+			wtap_close(wth);
+			return NULL;
+		}
+
+		wth->wslua_data = open_routines[magic_idx].wslua_data;
+
+		switch ((*open_routines[magic_idx].open_routine)(wth, err, err_info)) {
+
+		case -1:
+			/* I/O error - give up */
+			wtap_close(wth);
+			return NULL;
+
+		case 0:
+			/* No I/O error, but not that type of file after all */
+			break;
+
+		case 1:
+			/* We found the file type */
+			goto success;
+		}
+	}
+
 	/* Try all file types that support magic numbers */
 	for (i = 0; i < heuristic_open_routine_idx; i++) {
+		/* We've already tried this one */
+		if ((int)i == magic_idx)
+			continue;
+
 		/* Seek back to the beginning of the file; the open routine
 		   for the previous file type may have left the file
 		   position somewhere other than the beginning, and the
@@ -0,0 +1,263 @@
+/* frame_index.c
+ * Sidecar files holding the offsets, lengths and time stamps of the
+ * records of a capture file, so that it can be reopened without reading
+ * it all
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <glib.h>
+
+#include <wsutil/file_util.h>
+
+#include "wtap-int.h"
+#include "frame_index.h"
+
+#define FRAME_INDEX_MAGIC	0x58495357	/* "WSIX" */
+#define FRAME_INDEX_VERSION	1
+
+/* Start of an index file; the records follow it. */
+typedef struct {
+	guint32	magic;
+	guint32	version;
+	gint64	file_size;		/* of the capture file */
+	gint64	file_mtime;		/* of the capture file */
+	gint32	file_type_subtype;
+	guint32	rec_size;		/* sizeof (frame_index_rec) */
+	guint32	count;
+	guint32	reserved;
+} frame_index_file_hdr;
+
+struct frame_index {
+	GArray	*recs;			/* of frame_index_rec */
+	gint64	file_size;
+	gint64	file_mtime;
+	guint32	n_interfaces;
+};
+
+static gchar *
+frame_index_path(const char *filename)
+{
+	return g_strconcat(filename, FRAME_INDEX_SUFFIX, NULL);
+}
+
+static frame_index *
+frame_index_alloc(void)
+{
+	frame_index *idx;
+
+	idx = g_new0(frame_index, 1);
+	idx->recs = g_array_new(FALSE, FALSE, sizeof (frame_index_rec));
+	return idx;
+}
+
+frame_index *
+frame_index_new(const char *filename)
+{
+	ws_statb64 statb;
+	frame_index *idx;
+
+	if (ws_stat64(filename, &statb) < 0)
+		return NULL;
+
+	idx = frame_index_alloc();
+	idx->file_size = statb.st_size;
+	idx->file_mtime = statb.st_mtime;
+	return idx;
+}
+
+void
+frame_index_add(frame_index *idx, const struct wtap_pkthdr *phdr,
+    gint64 offset)
+{
+	frame_index_rec rec;
+
+	rec.offset = offset;
+	rec.ts_secs = phdr->ts.secs;
+	rec.ts_nsecs = phdr->ts.nsecs;
+	rec.caplen = phdr->caplen;
+	rec.len = phdr->len;
+	rec.interface_id = 0;
+	rec.pkt_encap = phdr->pkt_encap;
+	rec.flags = 0;
+	if (phdr->presence_flags & WTAP_HAS_TS)
+		rec.flags |= FRAME_INDEX_HAS_TS;
+	if (phdr->presence_flags & WTAP_HAS_INTERFACE_ID) {
+		rec.flags |= FRAME_INDEX_HAS_INTERFACE_ID;
+		rec.interface_id = phdr->interface_id;
+		if (phdr->interface_id >= idx->n_interfaces)
+			idx->n_interfaces = phdr->interface_id + 1;
+	}
+	if (phdr->opt_comment != NULL)
+		rec.flags |= FRAME_INDEX_HAS_COMMENT;
+	g_array_append_val(idx->recs, rec);
+}
+
+gboolean
+frame_index_save(const frame_index *idx, const char *filename,
+    int file_type_subtype, int *err)
+{
+	ws_statb64 statb;
+	frame_index_file_hdr hdr;
+	gchar *path;
+	FILE *fp;
+	gboolean ok;
+
+	if (ws_stat64(filename, &statb) < 0) {
+		*err = errno;
+		return FALSE;
+	}
+	if (statb.st_size != idx->file_size ||
+	    (gint64)statb.st_mtime != idx->file_mtime) {
+		/* It changed while we were reading it */
+		*err = 0;
+		return FALSE;
+	}
+
+	memset(&hdr, 0, sizeof hdr);
+	hdr.magic = FRAME_INDEX_MAGIC;
+	hdr.version = FRAME_INDEX_VERSION;
+	hdr.file_size = idx->file_size;
+	hdr.file_mtime = idx->file_mtime;
+	hdr.file_type_subtype = file_type_subtype;
+	hdr.rec_size = (guint32)sizeof (frame_index_rec);
+	hdr.count = idx->recs->len;
+
+	path = frame_index_path(filename);
+	fp = ws_fopen(path, "wb");
+	if (fp == NULL) {
+		*err = errno;
+		g_free(path);
+		return FALSE;
+	}
+	ok = fwrite(&hdr, sizeof hdr, 1, fp) == 1 &&
+	    (idx->recs->len == 0 ||
+	     fwrite(idx->recs->data, sizeof (frame_index_rec), idx->recs->len,
+	         fp) == idx->recs->len);
+	if (!ok)
+		*err = errno;
+	if (fclose(fp) == EOF && ok) {
+		*err = errno;
+		ok = FALSE;
+	}
+	if (!ok) {
+		/* Don't leave a truncated index behind */
+		ws_unlink(path);
+	}
+	g_free(path);
+	return ok;
+}
+
+frame_index *
+frame_index_load(const char *filename, int file_type_subtype)
+{
+	ws_statb64 statb, idx_statb;
+	frame_index_file_hdr hdr;
+	frame_index *idx;
+	frame_index_rec *rec;
+	gchar *path;
+	FILE *fp;
+	guint32 i;
+
+	if (ws_stat64(filename, &statb) < 0)
+		return NULL;
+
+	path = frame_index_path(filename);
+	fp = ws_fopen(path, "rb");
+	g_free(path);
+	if (fp == NULL)
+		return NULL;
+
+	if (ws_fstat64(fileno(fp), &idx_statb) < 0 ||
+	    fread(&hdr, sizeof hdr, 1, fp) != 1 ||
+	    hdr.magic != FRAME_INDEX_MAGIC ||
+	    hdr.version != FRAME_INDEX_VERSION ||
+	    hdr.rec_size != sizeof (frame_index_rec) ||
+	    hdr.file_type_subtype != file_type_subtype ||
+	    hdr.file_size != statb.st_size ||
+	    hdr.file_mtime != (gint64)statb.st_mtime ||
+	    idx_statb.st_size !=
+	        (gint64)sizeof hdr + (gint64)hdr.count * hdr.rec_size) {
+		fclose(fp);
+		return NULL;
+	}
+
+	idx = frame_index_alloc();
+	g_array_set_size(idx->recs, hdr.count);
+	if (hdr.count != 0 &&
+	    fread(idx->recs->data, sizeof (frame_index_rec), hdr.count, fp) != hdr.count) {
+		fclose(fp);
+		frame_index_free(idx);
+		return NULL;
+	}
+	fclose(fp);
+
+	/* Make sure the records at least lie within the capture file. */
+	for (i = 0; i < hdr.count; i++) {
+		rec = &g_array_index(idx->recs, frame_index_rec, i);
+		if (rec->offset < 0 || rec->offset >= hdr.file_size ||
+		    rec->caplen > WTAP_MAX_PACKET_SIZE ||
+		    rec->pkt_encap < 0 || rec->pkt_encap > G_MAXINT16) {
+			frame_index_free(idx);
+			return NULL;
+		}
+		if ((rec->flags & FRAME_INDEX_HAS_INTERFACE_ID) &&
+		    rec->interface_id >= idx->n_interfaces)
+			idx->n_interfaces = rec->interface_id + 1;
+	}
+	idx->file_size = hdr.file_size;
+	idx->file_mtime = hdr.file_mtime;
+	return idx;
+}
+
+void
+frame_index_free(frame_index *idx)
+{
+	if (idx == NULL)
+		return;
+
+	g_array_free(idx->recs, TRUE);
+	g_free(idx);
+}
+
+guint32
+frame_index_count(const frame_index *idx)
+{
+	return idx->recs->len;
+}
+
+const frame_index_rec *
+frame_index_get(const frame_index *idx, guint32 i)
+{
+	if (i >= idx->recs->len)
+		return NULL;
+	return &g_array_index(idx->recs, frame_index_rec, i);
+}
+
+guint32
+frame_index_interface_count(const frame_index *idx)
+{
+	return idx->n_interfaces;
+}
@@ -0,0 +1,106 @@
+/* frame_index.h
+ * Sidecar files holding the offsets, lengths and time stamps of the
+ * records of a capture file, so that it can be reopened without reading
+ * it all
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __FRAME_INDEX_H__
+#define __FRAME_INDEX_H__
+
+#include "wiretap/wtap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * The index of a capture file is kept in a file next to it, with
+ * FRAME_INDEX_SUFFIX appended to its name.  It holds one entry for each
+ * record, in the order in which they were read, and is only used if the
+ * capture file's size and modification time, and the file type, are the
+ * same as when it was written.  It's in the byte order of the machine
+ * that wrote it; one written on another machine is ignored.
+ */
+#define FRAME_INDEX_SUFFIX ".wsidx"
+
+/* Flags in frame_index_rec */
+#define FRAME_INDEX_HAS_TS            0x00000001
+#define FRAME_INDEX_HAS_INTERFACE_ID  0x00000002
+#define FRAME_INDEX_HAS_COMMENT       0x00000004
+
+/** One record; laid out without padding, as it's written as is. */
+typedef struct {
+    gint64  offset;         /* as returned by wtap_read() */
+    gint64  ts_secs;
+    gint32  ts_nsecs;
+    guint32 caplen;
+    guint32 len;
+    guint32 interface_id;
+    gint32  pkt_encap;
+    guint32 flags;
+} frame_index_rec;
+
+typedef struct frame_index frame_index;
+
+/** Create an empty index for the capture file filename, to be filled with
+ * frame_index_add() as it's read.  Returns NULL if the file can't be
+ * looked at. */
+WS_DLL_PUBLIC
+frame_index *frame_index_new(const char *filename);
+
+/** Add a record read with wtap_read() at the given offset. */
+WS_DLL_PUBLIC
+void frame_index_add(frame_index *idx, const struct wtap_pkthdr *phdr,
+    gint64 offset);
+
+/** Write the index for the capture file filename, of the given file type.
+ * Returns FALSE, with *err set, on failure; *err is 0 if the file has
+ * changed since frame_index_new() was called. */
+WS_DLL_PUBLIC
+gboolean frame_index_save(const frame_index *idx, const char *filename,
+    int file_type_subtype, int *err);
+
+/** Load the index for the capture file filename, of the given file type.
+ * Returns NULL if there isn't one, or it's out of date or damaged. */
+WS_DLL_PUBLIC
+frame_index *frame_index_load(const char *filename, int file_type_subtype);
+
+WS_DLL_PUBLIC
+void frame_index_free(frame_index *idx);
+
+/** Number of records in the index. */
+WS_DLL_PUBLIC
+guint32 frame_index_count(const frame_index *idx);
+
+/** Get record i of the index. */
+WS_DLL_PUBLIC
+const frame_index_rec *frame_index_get(const frame_index *idx, guint32 i);
+
+/** The number of interfaces the records refer to, i.e. one more than the
+ * highest interface ID in the index, or 0 if none has one. */
+WS_DLL_PUBLIC
+guint32 frame_index_interface_count(const frame_index *idx);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __FRAME_INDEX_H__ */
@@ -0,0 +1,319 @@
+/* frame_index_test.c
+ * Tests for the sidecar index files of capture files
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <wsutil/file_util.h>
+
+#include "wtap.h"
+#include "frame_index.h"
+
+/* The capture file only needs to exist; its contents aren't looked at */
+#define CAPTURE_SIZE	1000
+#define N_RECS		3
+
+/* Where the capture file's modification time is in the index's header */
+#define HDR_MTIME_OFFSET	16
+
+static gchar *capture_path;
+static gchar *index_path;
+
+static struct wtap_pkthdr test_phdrs[N_RECS];
+static const gint64 test_offsets[N_RECS] = { 24, 100, 600 };
+
+static void
+write_file(const gchar *path, const gchar *contents, gsize len)
+{
+	GError *error = NULL;
+
+	if (!g_file_set_contents(path, contents, len, &error))
+		g_error("Can't write %s: %s", path, error->message);
+}
+
+/* Create a capture file, and an index for it with the test records */
+static void
+setup(void)
+{
+	gchar contents[CAPTURE_SIZE];
+	frame_index *idx;
+	int err;
+	int i;
+
+	memset(contents, 0xa5, sizeof contents);
+	write_file(capture_path, contents, sizeof contents);
+	ws_unlink(index_path);
+
+	idx = frame_index_new(capture_path);
+	g_assert(idx != NULL);
+	for (i = 0; i < N_RECS; i++)
+		frame_index_add(idx, &test_phdrs[i], test_offsets[i]);
+	g_assert(frame_index_save(idx, capture_path,
+	    WTAP_FILE_TYPE_SUBTYPE_PCAP, &err));
+	frame_index_free(idx);
+}
+
+/* Read the index file, for the tests to damage it */
+static gchar *
+read_index(gsize *len)
+{
+	gchar *contents;
+
+	g_assert(g_file_get_contents(index_path, &contents, len, NULL));
+	return contents;
+}
+
+static void
+frame_index_test_roundtrip(void)
+{
+	frame_index *idx;
+	const frame_index_rec *rec;
+	guint32 i;
+
+	setup();
+	idx = frame_index_load(capture_path, WTAP_FILE_TYPE_SUBTYPE_PCAP);
+	g_assert(idx != NULL);
+	g_assert_cmpuint(frame_index_count(idx), ==, N_RECS);
+	g_assert_cmpuint(frame_index_interface_count(idx), ==, 2);
+
+	for (i = 0; i < N_RECS; i++) {
+		rec = frame_index_get(idx, i);
+		g_assert(rec != NULL);
+		g_assert_cmpint(rec->offset, ==, test_offsets[i]);
+		g_assert_cmpint(rec->ts_secs, ==, test_phdrs[i].ts.secs);
+		g_assert_cmpint(rec->ts_nsecs, ==, test_phdrs[i].ts.nsecs);
+		g_assert_cmpuint(rec->caplen, ==, test_phdrs[i].caplen);
+		g_assert_cmpuint(rec->len, ==, test_phdrs[i].len);
+		g_assert_cmpint(rec->pkt_encap, ==, test_phdrs[i].pkt_encap);
+		g_assert_cmpuint(!!(rec->flags & FRAME_INDEX_HAS_TS), ==,
+		    !!(test_phdrs[i].presence_flags & WTAP_HAS_TS));
+		g_assert_cmpuint(!!(rec->flags & FRAME_INDEX_HAS_COMMENT), ==,
+		    test_phdrs[i].opt_comment != NULL);
+		if (test_phdrs[i].presence_flags & WTAP_HAS_INTERFACE_ID) {
+			g_assert(rec->flags & FRAME_INDEX_HAS_INTERFACE_ID);
+			g_assert_cmpuint(rec->interface_id, ==,
+			    test_phdrs[i].interface_id);
+		} else {
+			g_assert(!(rec->flags & FRAME_INDEX_HAS_INTERFACE_ID));
+		}
+	}
+	g_assert(frame_index_get(idx, N_RECS) == NULL);
+	frame_index_free(idx);
+}
+
+static void
+frame_index_test_file_type(void)
+{
+	setup();
+	g_assert(frame_index_load(capture_path,
+	    WTAP_FILE_TYPE_SUBTYPE_PCAPNG) == NULL);
+}
+
+static void
+frame_index_test_stale_size(void)
+{
+	gchar contents[CAPTURE_SIZE + 1];
+
+	setup();
+	memset(contents, 0xa5, sizeof contents);
+	write_file(capture_path, contents, sizeof contents);
+	g_assert(frame_index_load(capture_path,
+	    WTAP_FILE_TYPE_SUBTYPE_PCAP) == NULL);
+}
+
+static void
+frame_index_test_stale_mtime(void)
+{
+	gchar *contents;
+	gsize len;
+	gint64 mtime;
+
+	setup();
+	/* As if the capture file had been written since */
+	contents = read_index(&len);
+	memcpy(&mtime, contents + HDR_MTIME_OFFSET, sizeof mtime);
+	mtime++;
+	memcpy(contents + HDR_MTIME_OFFSET, &mtime, sizeof mtime);
+	write_file(index_path, contents, len);
+	g_free(contents);
+	g_assert(frame_index_load(capture_path,
+	    WTAP_FILE_TYPE_SUBTYPE_PCAP) == NULL);
+}
+
+static void
+frame_index_test_changed_while_read(void)
+{
+	gchar contents[CAPTURE_SIZE + 1];
+	frame_index *idx;
+	int err = -1;
+
+	setup();
+	ws_unlink(index_path);
+	idx = frame_index_new(capture_path);
+	g_assert(idx != NULL);
+	frame_index_add(idx, &test_phdrs[0], test_offsets[0]);
+	memset(contents, 0xa5, sizeof contents);
+	write_file(capture_path, contents, sizeof contents);
+	g_assert(!frame_index_save(idx, capture_path,
+	    WTAP_FILE_TYPE_SUBTYPE_PCAP, &err));
+	g_assert_cmpint(err, ==, 0);
+	g_assert(!g_file_test(index_path, G_FILE_TEST_EXISTS));
+	frame_index_free(idx);
+}
+
+static void
+frame_index_test_truncated(void)
+{
+	gchar *contents;
+	gsize len;
+
+	setup();
+	contents = read_index(&len);
+
+	/* Part of the last record missing */
+	write_file(index_path, contents, len - 1);
+	g_assert(frame_index_load(capture_path,
+	    WTAP_FILE_TYPE_SUBTYPE_PCAP) == NULL);
+
+	/* Part of the header missing */
+	write_file(index_path, contents, 8);
+	g_assert(frame_index_load(capture_path,
+	    WTAP_FILE_TYPE_SUBTYPE_PCAP) == NULL);
+
+	/* Empty */
+	write_file(index_path, contents, 0);
+	g_assert(frame_index_load(capture_path,
+	    WTAP_FILE_TYPE_SUBTYPE_PCAP) == NULL);
+	g_free(contents);
+}
+
+static void
+frame_index_test_corrupt(void)
+{
+	gchar *contents;
+	gsize len;
+	frame_index_rec rec;
+
+	setup();
+	contents = read_index(&len);
+
+	/* Bad magic number */
+	contents[0] ^= 0xff;
+	write_file(index_path, contents, len);
+	g_assert(frame_index_load(capture_path,
+	    WTAP_FILE_TYPE_SUBTYPE_PCAP) == NULL);
+	contents[0] ^= 0xff;
+
+	/* Unknown version */
+	contents[4] ^= 0xff;
+	write_file(index_path, contents, len);
+	g_assert(frame_index_load(capture_path,
+	    WTAP_FILE_TYPE_SUBTYPE_PCAP) == NULL);
+	contents[4] ^= 0xff;
+
+	/* A record that's past the end of the capture file */
+	memcpy(&rec, contents + len - sizeof rec, sizeof rec);
+	rec.offset = CAPTURE_SIZE;
+	memcpy(contents + len - sizeof rec, &rec, sizeof rec);
+	write_file(index_path, contents, len);
+	g_assert(frame_index_load(capture_path,
+	    WTAP_FILE_TYPE_SUBTYPE_PCAP) == NULL);
+
+	/* One that's too big */
+	rec.offset = test_offsets[N_RECS - 1];
+	rec.caplen = WTAP_MAX_PACKET_SIZE + 1;
+	memcpy(contents + len - sizeof rec, &rec, sizeof rec);
+	write_file(index_path, contents, len);
+	g_assert(frame_index_load(capture_path,
+	    WTAP_FILE_TYPE_SUBTYPE_PCAP) == NULL);
+	g_free(contents);
+}
+
+static void
+frame_index_test_missing(void)
+{
+	setup();
+	ws_unlink(index_path);
+	g_assert(frame_index_load(capture_path,
+	    WTAP_FILE_TYPE_SUBTYPE_PCAP) == NULL);
+}
+
+int
+main(int argc, char **argv)
+{
+	GError *error = NULL;
+	int fd;
+	int result;
+
+	g_test_init(&argc, &argv, NULL);
+
+	fd = g_file_open_tmp("frame_index_test_XXXXXX", &capture_path, &error);
+	if (fd == -1)
+		g_error("Can't create a temporary file: %s", error->message);
+	ws_close(fd);
+	index_path = g_strconcat(capture_path, FRAME_INDEX_SUFFIX, NULL);
+
+	test_phdrs[0].presence_flags = WTAP_HAS_TS|WTAP_HAS_CAP_LEN;
+	test_phdrs[0].ts.secs = 1400000000;
+	test_phdrs[0].ts.nsecs = 123456000;
+	test_phdrs[0].caplen = 60;
+	test_phdrs[0].len = 60;
+	test_phdrs[0].pkt_encap = WTAP_ENCAP_ETHERNET;
+
+	test_phdrs[1].presence_flags = WTAP_HAS_TS|WTAP_HAS_CAP_LEN|WTAP_HAS_INTERFACE_ID;
+	test_phdrs[1].ts.secs = 1400000001;
+	test_phdrs[1].ts.nsecs = 0;
+	test_phdrs[1].caplen = 96;
+	test_phdrs[1].len = 1514;
+	test_phdrs[1].interface_id = 1;
+	test_phdrs[1].pkt_encap = WTAP_ENCAP_ETHERNET;
+	test_phdrs[1].opt_comment = (gchar *)"a comment";
+
+	test_phdrs[2].presence_flags = WTAP_HAS_CAP_LEN;
+	test_phdrs[2].caplen = 20;
+	test_phdrs[2].len = 20;
+	test_phdrs[2].pkt_encap = WTAP_ENCAP_RAW_IP;
+
+	g_test_add_func("/frame_index/roundtrip", frame_index_test_roundtrip);
+	g_test_add_func("/frame_index/missing", frame_index_test_missing);
+	g_test_add_func("/frame_index/file_type", frame_index_test_file_type);
+	g_test_add_func("/frame_index/stale/size", frame_index_test_stale_size);
+	g_test_add_func("/frame_index/stale/mtime", frame_index_test_stale_mtime);
+	g_test_add_func("/frame_index/stale/changed_while_read",
+	    frame_index_test_changed_while_read);
+	g_test_add_func("/frame_index/truncated", frame_index_test_truncated);
+	g_test_add_func("/frame_index/corrupt", frame_index_test_corrupt);
+
+	result = g_test_run();
+
+	ws_unlink(index_path);
+	ws_unlink(capture_path);
+	g_free(index_path);
+	g_free(capture_path);
+
+	return result;
+}
+
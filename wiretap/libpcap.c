@@ -55,6 +55,9 @@ typedef struct {
 #define BIT_SWAPPED_MAC_ADDRS
 #endif
 
+/* How much libpcap_read_batch() reads at a time */
+#define LIBPCAP_BATCH_READ_SIZE	(256*1024)
+
 /* Try to read the first two records of the capture file. */
 static int libpcap_try(wtap *wth, int *err);
 static int libpcap_try_header(wtap *wth, FILE_T fh, int *err, gchar **err_info,
@@ -68,6 +71,9 @@ static gboolean libpcap_read_packet(wtap *wth, FILE_T fh,
     struct wtap_pkthdr *phdr, Buffer *buf, int *err, gchar **err_info);
 static gboolean libpcap_dump(wtap_dumper *wdh, const struct wtap_pkthdr *phdr,
     const guint8 *pd, int *err);
+static void libpcap_fixup_header(libpcap_t *libpcap, struct pcaprec_hdr *hdr);
+static guint libpcap_read_batch(wtap *wth, wtap_batch *batch, int *err,
+    gchar **err_info);
 static int libpcap_read_header(wtap *wth, FILE_T fh, int *err, gchar **err_info,
     struct pcaprec_ss990915_hdr *hdr);
 
@@ -460,6 +466,15 @@ done:
 		 */
 		erf_populate_interfaces(wth);
 	}
+
+	/*
+	 * Records in the simple formats can be parsed straight out of a
+	 * big buffer, as long as they have no pseudo-header to read.
+	 */
+	if ((wth->file_type_subtype == WTAP_FILE_TYPE_SUBTYPE_PCAP ||
+	     wth->file_type_subtype == WTAP_FILE_TYPE_SUBTYPE_PCAP_NSEC) &&
+	    !pcap_pseudo_header_in_file(wth->file_type_subtype, wth->file_encap))
+		wth->subtype_read_batch = libpcap_read_batch;
 	return 1;
 }
 
@@ -746,7 +761,6 @@ static int libpcap_read_header(wtap *wth, FILE_T fh, int *err, gchar **err_info,
     struct pcaprec_ss990915_hdr *hdr)
 {
 	int bytes_to_read, bytes_read;
-	guint32 temp;
 	libpcap_t *libpcap;
 
 	errno = WTAP_ERR_CANT_READ;
@@ -785,12 +799,22 @@ static int libpcap_read_header(wtap *wth, FILE_T fh, int *err, gchar **err_info,
 	}
 
 	libpcap = (libpcap_t *)wth->priv;
+	libpcap_fixup_header(libpcap, &hdr->hdr);
+	return TRUE;
+}
+
+/* Put the fields of a record header into host byte order, and undo
+   any swapping of the lengths. */
+static void libpcap_fixup_header(libpcap_t *libpcap, struct pcaprec_hdr *hdr)
+{
+	guint32 temp;
+
 	if (libpcap->byte_swapped) {
 		/* Byte-swap the record header fields. */
-		hdr->hdr.ts_sec = GUINT32_SWAP_LE_BE(hdr->hdr.ts_sec);
-		hdr->hdr.ts_usec = GUINT32_SWAP_LE_BE(hdr->hdr.ts_usec);
-		hdr->hdr.incl_len = GUINT32_SWAP_LE_BE(hdr->hdr.incl_len);
-		hdr->hdr.orig_len = GUINT32_SWAP_LE_BE(hdr->hdr.orig_len);
+		hdr->ts_sec = GUINT32_SWAP_LE_BE(hdr->ts_sec);
+		hdr->ts_usec = GUINT32_SWAP_LE_BE(hdr->ts_usec);
+		hdr->incl_len = GUINT32_SWAP_LE_BE(hdr->incl_len);
+		hdr->orig_len = GUINT32_SWAP_LE_BE(hdr->orig_len);
 	}
 
 	/* Swap the "incl_len" and "orig_len" fields, if necessary. */
@@ -800,7 +824,7 @@ static int libpcap_read_header(wtap *wth, FILE_T fh, int *err, gchar **err_info,
 		break;
 
 	case MAYBE_SWAPPED:
-		if (hdr->hdr.incl_len <= hdr->hdr.orig_len) {
+		if (hdr->incl_len <= hdr->orig_len) {
 			/*
 			 * The captured length is <= the actual length,
 			 * so presumably they weren't swapped.
@@ -810,13 +834,132 @@ static int libpcap_read_header(wtap *wth, FILE_T fh, int *err, gchar **err_info,
 		/* FALLTHROUGH */
 
 	case SWAPPED:
-		temp = hdr->hdr.orig_len;
-		hdr->hdr.orig_len = hdr->hdr.incl_len;
-		hdr->hdr.incl_len = temp;
+		temp = hdr->orig_len;
+		hdr->orig_len = hdr->incl_len;
+		hdr->incl_len = temp;
 		break;
 	}
+}
 
-	return TRUE;
+/* Append up to bytes_to_read bytes of the file to the batch's buffer;
+   returns the number of bytes read, or -1 on an error. */
+static int libpcap_batch_fill(wtap *wth, wtap_batch *batch,
+    guint bytes_to_read, int *err, gchar **err_info)
+{
+	int bytes_read;
+
+	ws_buffer_assure_space(&batch->buf, bytes_to_read);
+	bytes_read = file_read(ws_buffer_end_ptr(&batch->buf), bytes_to_read,
+	    wth->fh);
+	if (bytes_read < 0) {
+		*err = file_error(wth->fh, err_info);
+		return -1;
+	}
+	ws_buffer_increase_length(&batch->buf, bytes_read);
+	return bytes_read;
+}
+
+/* Read as many records as fit in one large read, parsing them in place
+   in the batch's buffer; only used for files with standard record
+   headers and no pseudo-headers.  Whatever follows the last complete
+   record is carried over to the next batch rather than seeked back
+   over, so this works for pipes and doesn't make the file_wrappers
+   rewind a compressed file.  Returns the number of records added,
+   which is 0 only at the end of the file or on an error. */
+static guint libpcap_read_batch(wtap *wth, wtap_batch *batch, int *err,
+    gchar **err_info)
+{
+	libpcap_t *libpcap = (libpcap_t *)wth->priv;
+	struct pcaprec_hdr hdr;
+	struct wtap_pkthdr *phdr;
+	gint64 start_offset;
+	gsize len, avail, pos;
+	guint need;
+	int bytes_read;
+	guint8 *data;
+
+	/* The buffer holds what the last batch carried over, if anything */
+	len = ws_buffer_length(&batch->buf);
+	start_offset = len != 0 ? batch->carry_offset : file_tell(wth->fh);
+	if (len < LIBPCAP_BATCH_READ_SIZE &&
+	    libpcap_batch_fill(wth, batch, LIBPCAP_BATCH_READ_SIZE - (guint)len,
+	    err, err_info) < 0)
+		return 0;
+
+	pos = 0;
+	while (batch->count < batch->max_recs) {
+		avail = ws_buffer_length(&batch->buf) - pos;
+		if (avail >= sizeof hdr) {
+			memcpy(&hdr, ws_buffer_start_ptr(&batch->buf) + pos,
+			    sizeof hdr);
+			libpcap_fixup_header(libpcap, &hdr);
+			if (hdr.incl_len > WTAP_MAX_PACKET_SIZE) {
+				/*
+				 * Probably a corrupt capture file, as in
+				 * libpcap_read_packet().
+				 */
+				*err = WTAP_ERR_BAD_FILE;
+				*err_info = g_strdup_printf("pcap: File has %u-byte packet, bigger than maximum of %u",
+				    hdr.incl_len, WTAP_MAX_PACKET_SIZE);
+				break;
+			}
+		}
+		if (avail < sizeof hdr || avail - sizeof hdr < hdr.incl_len) {
+			/*
+			 * The next record isn't all in the buffer.  Leave it
+			 * for the next batch, unless it's the first one, in
+			 * which case we're at the end of the file or it's
+			 * bigger than a batch; try to read the rest of it.
+			 */
+			if (batch->count != 0)
+				break;
+			need = (guint)((avail < sizeof hdr ? sizeof hdr :
+			    sizeof hdr + hdr.incl_len) - avail);
+			bytes_read = libpcap_batch_fill(wth, batch, need, err,
+			    err_info);
+			if (bytes_read < 0)
+				break;
+			if ((guint)bytes_read < need) {
+				if (avail + bytes_read != 0)
+					*err = WTAP_ERR_SHORT_READ;
+				break;
+			}
+			continue;
+		}
+
+		data = ws_buffer_start_ptr(&batch->buf) + pos + sizeof hdr;
+		phdr = &batch->recs[batch->count].phdr;
+		*phdr = wth->phdr;
+		phdr->pkt_encap = wth->file_encap;
+		if (pcap_process_pseudo_header(wth->fh, wth->file_type_subtype,
+		    wth->file_encap, hdr.incl_len, TRUE, phdr, err,
+		    err_info) < 0)
+			break;
+		phdr->rec_type = REC_TYPE_PACKET;
+		phdr->presence_flags = WTAP_HAS_TS|WTAP_HAS_CAP_LEN;
+		phdr->ts.secs = hdr.ts_sec;
+		if (wth->tsprecision == WTAP_FILE_TSPREC_NSEC)
+			phdr->ts.nsecs = hdr.ts_usec;
+		else
+			phdr->ts.nsecs = hdr.ts_usec * 1000;
+		phdr->caplen = hdr.incl_len;
+		phdr->len = hdr.orig_len;
+		pcap_read_post_process(wth->file_type_subtype,
+		    wth->file_encap, phdr, data, libpcap->byte_swapped, -1);
+		if (phdr->caplen > phdr->len)
+			phdr->caplen = phdr->len;
+
+		batch->recs[batch->count].data_offset = start_offset + pos;
+		batch->buf_offsets[batch->count] = pos + sizeof hdr;
+		batch->count++;
+
+		pos += sizeof hdr + hdr.incl_len;
+	}
+
+	/* Carry the rest over to the next batch */
+	batch->carry_len = ws_buffer_length(&batch->buf) - pos;
+	batch->carry_offset = start_offset + pos;
+	return batch->count;
 }
 
 /* Returns 0 if we could write the specified encapsulation type,
@@ -1915,6 +1915,37 @@ pcap_process_pseudo_header(FILE_T fh, int file_type, int wtap_encap,
 	return phdr_len;
 }
 
+/*
+ * TRUE if records with the given encapsulation start with a pseudo-header
+ * that pcap_process_pseudo_header() reads from the file; keep this in
+ * sync with it.
+ */
+gboolean
+pcap_pseudo_header_in_file(int file_type, int wtap_encap)
+{
+	switch (wtap_encap) {
+
+	case WTAP_ENCAP_ETHERNET:
+		return file_type == WTAP_FILE_TYPE_SUBTYPE_PCAP_NOKIA;
+
+	case WTAP_ENCAP_ATM_PDUS:
+	case WTAP_ENCAP_IRDA:
+	case WTAP_ENCAP_MTP2_WITH_PHDR:
+	case WTAP_ENCAP_LINUX_LAPD:
+	case WTAP_ENCAP_SITA:
+	case WTAP_ENCAP_BLUETOOTH_H4_WITH_PHDR:
+	case WTAP_ENCAP_BLUETOOTH_LINUX_MONITOR:
+	case WTAP_ENCAP_NFC_LLCP:
+	case WTAP_ENCAP_PPP_WITH_PHDR:
+	case WTAP_ENCAP_ERF:
+	case WTAP_ENCAP_I2C:
+		return TRUE;
+
+	default:
+		return FALSE;
+	}
+}
+
 void
 pcap_read_post_process(int file_type, int wtap_encap,
     struct wtap_pkthdr *phdr, guint8 *pd, gboolean bytes_swapped, int fcs_len)
@@ -33,6 +33,8 @@ extern int pcap_process_pseudo_header(FILE_T fh, int file_type, int wtap_encap,
     guint packet_size, gboolean check_packet_size,
     struct wtap_pkthdr *phdr, int *err, gchar **err_info);
 
+extern gboolean pcap_pseudo_header_in_file(int file_type, int wtap_encap);
+
 extern void pcap_read_post_process(int file_type, int wtap_encap,
     struct wtap_pkthdr *phdr, guint8 *pd, gboolean bytes_swapped, int fcs_len);
 
@@ -2378,12 +2378,14 @@ pcapng_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
                 /* More name resolution entries */
                 pcapng_debug0("pcapng_read: block type BLOCK_TYPE_NRB");
                 *data_offset += bytes_read;
+                wth->metadata_seen = TRUE;
                 break;
 
             case(BLOCK_TYPE_ISB):
                 /* Another interface statistics report */
                 pcapng_debug0("pcapng_read: block type BLOCK_TYPE_ISB");
                 *data_offset += bytes_read;
+                wth->metadata_seen = TRUE;
                 pcapng_debug1("pcapng_read: *data_offset is updated to %" G_GINT64_MODIFIER "d", *data_offset);
                 if (wth->interface_data->len < wblock.data.if_stats.interface_id) {
                     pcapng_debug1("pcapng_read: BLOCK_TYPE_ISB wblock.if_stats.interface_id %u > number_of_interfaces", wblock.data.if_stats.interface_id);
@@ -2418,6 +2420,7 @@ pcapng_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
                 /* XXX - improve handling of "unknown" blocks */
                 pcapng_debug1("pcapng_read: Unknown block type 0x%08x", wblock.type);
                 *data_offset += bytes_read;
+                wth->metadata_seen = TRUE;
                 pcapng_debug1("pcapng_read: *data_offset is updated to %" G_GINT64_MODIFIER "d", *data_offset);
                 break;
         }
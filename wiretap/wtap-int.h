@@ -41,6 +41,7 @@ WS_DLL_PUBLIC
 int wtap_fstat(wtap *wth, ws_statb64 *statb, int *err);
 
 typedef gboolean (*subtype_read_func)(struct wtap*, int*, char**, gint64*);
+typedef guint (*subtype_read_batch_func)(struct wtap*, struct wtap_batch*, int*, char**);
 typedef gboolean (*subtype_seek_read_func)(struct wtap*, gint64,
                                            struct wtap_pkthdr *, Buffer *buf,
                                            int *, char **);
@@ -62,6 +63,7 @@ struct wtap {
     void                        *wslua_data;    /* this one holds wslua state info and is not free'd */
 
     subtype_read_func           subtype_read;
+    subtype_read_batch_func     subtype_read_batch;     /**< optional, see wtap_read_batch() */
     subtype_seek_read_func      subtype_seek_read;
     void                        (*subtype_sequential_close)(struct wtap*);
     void                        (*subtype_close)(struct wtap*);
@@ -76,6 +78,32 @@ struct wtap {
     wtap_new_ipv4_callback_t    add_new_ipv4;
     wtap_new_ipv6_callback_t    add_new_ipv6;
     GPtrArray                   *fast_seek;
+    gboolean                    metadata_seen;  /**< the sequential read has gone past records other than packets and interface descriptions */
+};
+
+/**
+ * A batch of records, see wtap_read_batch().  A subtype_read_batch routine
+ * adds records to it, putting their data, possibly along with other bytes
+ * of the file, into buf; wtap_read_batch() points the records' data at it
+ * once they're all read, as buf may move while they're being added.
+ *
+ * If the routine reads past the last record it adds, it leaves those
+ * bytes at the end of buf and sets carry_len and carry_offset, rather
+ * than seeking back over them; they're all that's left in buf when it's
+ * next called.  A file type with such a routine must read all its
+ * records with it, as the file isn't positioned at the next record.
+ */
+struct wtap_batch {
+    wtap_batch_rec              *recs;
+    gsize                       *buf_offsets;   /**< offset in buf of each record's data */
+    guint                       max_recs;
+    guint                       count;          /**< records in the batch */
+    guint                       next;           /**< next record for wtap_batch_next() */
+    Buffer                      buf;
+    gsize                       carry_len;      /**< bytes at the end of buf for the next batch */
+    gint64                      carry_offset;   /**< offset in the file of those bytes */
+    int                         err;            /**< error that ended the batch early */
+    gchar                       *err_info;
 };
 
 struct wtap_dumper;
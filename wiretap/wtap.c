@@ -149,6 +149,12 @@ wtap_iscompressed(wtap *wth)
 	return file_iscompressed((wth->fh == NULL) ? wth->random_fh : wth->fh);
 }
 
+gboolean
+wtap_metadata_seen(wtap *wth)
+{
+	return wth->metadata_seen;
+}
+
 guint
 wtap_snapshot_length(wtap *wth)
 {
@@ -1026,6 +1032,127 @@ wtap_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
 	return TRUE;	/* success */
 }
 
+/* The generic batch reader stops adding records after this much data */
+#define WTAP_BATCH_MAX_BYTES	(1024*1024)
+
+wtap_batch *
+wtap_batch_new(guint max_recs)
+{
+	wtap_batch *batch;
+
+	if (max_recs == 0)
+		max_recs = 1;
+	batch = g_new0(wtap_batch, 1);
+	batch->recs = g_new0(wtap_batch_rec, max_recs);
+	batch->buf_offsets = g_new(gsize, max_recs);
+	batch->max_recs = max_recs;
+	ws_buffer_init(&batch->buf, WTAP_BATCH_MAX_BYTES);
+	return batch;
+}
+
+void
+wtap_batch_free(wtap_batch *batch)
+{
+	if (batch == NULL)
+		return;
+
+	ws_buffer_free(&batch->buf);
+	g_free(batch->recs);
+	g_free(batch->buf_offsets);
+	g_free(batch->err_info);
+	g_free(batch);
+}
+
+/*
+ * Add one record, read with the file type's read routine, to the batch.
+ */
+static gboolean
+wtap_batch_add_read(wtap *wth, wtap_batch *batch, int *err, gchar **err_info)
+{
+	wtap_batch_rec *rec;
+	gint64 data_offset;
+
+	if (!wtap_read(wth, err, err_info, &data_offset))
+		return FALSE;
+
+	rec = &batch->recs[batch->count];
+	rec->phdr = wth->phdr;
+	rec->data_offset = data_offset;
+	batch->buf_offsets[batch->count] = ws_buffer_length(&batch->buf);
+	ws_buffer_append(&batch->buf, ws_buffer_start_ptr(wth->frame_buffer),
+	    wth->phdr.caplen);
+	batch->count++;
+	return TRUE;
+}
+
+guint
+wtap_read_batch(wtap *wth, wtap_batch *batch, int *err, gchar **err_info)
+{
+	guint i;
+
+	batch->count = 0;
+	batch->next = 0;
+	/* Keep only what the last batch read past its last record */
+	ws_buffer_remove_start(&batch->buf,
+	    ws_buffer_length(&batch->buf) - batch->carry_len);
+
+	*err = 0;
+	if (batch->err != 0) {
+		/* The last batch ended with an error; report it now */
+		*err = batch->err;
+		*err_info = batch->err_info;
+		batch->err = 0;
+		batch->err_info = NULL;
+		return 0;
+	}
+
+	if (wth->subtype_read_batch != NULL) {
+		wth->subtype_read_batch(wth, batch, err, err_info);
+	} else {
+		/*
+		 * The file type has no routine of its own; read records
+		 * one at a time.
+		 */
+		while (batch->count < batch->max_recs &&
+		    ws_buffer_length(&batch->buf) < WTAP_BATCH_MAX_BYTES) {
+			if (!wtap_batch_add_read(wth, batch, err, err_info))
+				break;
+		}
+	}
+
+	if (*err != 0 && batch->count != 0) {
+		/* Return what we've got, and the error next time */
+		batch->err = *err;
+		batch->err_info = *err_info;
+		*err = 0;
+		*err_info = NULL;
+	}
+
+	for (i = 0; i < batch->count; i++) {
+		batch->recs[i].data = ws_buffer_start_ptr(&batch->buf) +
+		    batch->buf_offsets[i];
+	}
+	return batch->count;
+}
+
+wtap_batch_rec *
+wtap_batch_get(wtap_batch *batch, guint i)
+{
+	if (i >= batch->count)
+		return NULL;
+	return &batch->recs[i];
+}
+
+wtap_batch_rec *
+wtap_batch_next(wtap *wth, wtap_batch *batch, int *err, gchar **err_info)
+{
+	if (batch->next >= batch->count) {
+		if (wtap_read_batch(wth, batch, err, err_info) == 0)
+			return NULL;
+	}
+	return &batch->recs[batch->next++];
+}
+
 /*
  * Read packet data into a Buffer, growing the buffer as necessary.
  *
@@ -1414,12 +1414,61 @@ struct wtap_pkthdr *wtap_phdr(wtap *wth);
 WS_DLL_PUBLIC
 guint8 *wtap_buf_ptr(wtap *wth);
 
+/** A record read by wtap_read_batch() or wtap_batch_next().  data points
+ * into the batch, and stays valid until the next call to either. */
+typedef struct {
+    struct wtap_pkthdr phdr;
+    gint64             data_offset;     /* as returned by wtap_read() */
+    const guint8      *data;
+} wtap_batch_rec;
+
+typedef struct wtap_batch wtap_batch;
+
+/** Allocate a batch of up to max_recs records. */
+WS_DLL_PUBLIC
+wtap_batch *wtap_batch_new(guint max_recs);
+
+WS_DLL_PUBLIC
+void wtap_batch_free(wtap_batch *batch);
+
+/** Read the next records of the file into batch, replacing what it held;
+ * returns the number of records read, which is 0 at the end of the file
+ * or on an error, in which case *err is set as for wtap_read().  If an
+ * error occurs after some records have been read, those are returned,
+ * and the error is reported by the next call.
+ *
+ * The records are read in larger chunks than with wtap_read() where the
+ * file type allows, and their data all lies in one buffer.  A file that's
+ * read with this, or with wtap_batch_next(), mustn't also be read with
+ * wtap_read(), and wtap_phdr() and wtap_buf_ptr() don't apply to it.
+ */
+WS_DLL_PUBLIC
+guint wtap_read_batch(wtap *wth, wtap_batch *batch, int *err, gchar **err_info);
+
+/** Get record i of the last batch read. */
+WS_DLL_PUBLIC
+wtap_batch_rec *wtap_batch_get(wtap_batch *batch, guint i);
+
+/** A drop-in replacement for a wtap_read() loop: returns the next record
+ * of the file, reading a new batch if all of batch's have been returned,
+ * or NULL at the end of the file or on an error, with *err set as for
+ * wtap_read(). */
+WS_DLL_PUBLIC
+wtap_batch_rec *wtap_batch_next(wtap *wth, wtap_batch *batch, int *err,
+    gchar **err_info);
+
 /*** get various information snippets about the current file ***/
 
 /** Return an approximation of the amount of data we've read sequentially
  * from the file so far. */
 WS_DLL_PUBLIC
 gint64 wtap_read_so_far(wtap *wth);
+/** Return TRUE if reading the file sequentially has gone past records
+ * other than packets and interface descriptions, e.g. pcapng name
+ * resolution or interface statistics blocks, which are only seen when
+ * the file is read that way. */
+WS_DLL_PUBLIC
+gboolean wtap_metadata_seen(wtap *wth);
 WS_DLL_PUBLIC
 gint64 wtap_file_size(wtap *wth, int *err);
 WS_DLL_PUBLIC